@@ -72,6 +72,13 @@ static constexpr wq_config_t INS1{"wq:INS1", 6000, -15};
 static constexpr wq_config_t INS2{"wq:INS2", 6000, -16};
 static constexpr wq_config_t INS3{"wq:INS3", 6000, -17};
 
+// additional multi-EKF instances (POSIX only, one thread per instance)
+static constexpr wq_config_t INS4{"wq:INS4", 6000, -17};
+static constexpr wq_config_t INS5{"wq:INS5", 6000, -17};
+static constexpr wq_config_t INS6{"wq:INS6", 6000, -17};
+static constexpr wq_config_t INS7{"wq:INS7", 6000, -17};
+static constexpr wq_config_t INS8{"wq:INS8", 6000, -17};
+
 static constexpr wq_config_t hp_default{"wq:hp_default", 1900, -18};
 
 static constexpr wq_config_t uavcan{"wq:uavcan", 3624, -19};
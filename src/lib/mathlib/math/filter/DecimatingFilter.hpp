@@ -0,0 +1,146 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file DecimatingFilter.hpp
+ *
+ * Anti-aliasing low-pass filter followed by an integer decimation, used to derive
+ * lower rate streams from a filtered high rate signal.
+ */
+
+#pragma once
+
+#include <mathlib/math/Functions.hpp>
+#include <mathlib/math/filter/LowPassFilter2p.hpp>
+
+namespace math
+{
+
+template<typename T>
+class DecimatingFilter
+{
+public:
+	// anti-aliasing cutoff relative to the output rate (half the output Nyquist frequency)
+	static constexpr float CUTOFF_RATIO = 0.25f;
+
+	DecimatingFilter() = default;
+
+	/**
+	 * Set the input sample frequency and the desired output frequency. The output frequency
+	 * is rounded to the closest integer decimation of the sample frequency.
+	 *
+	 * @return false if the frequencies are invalid (filter disabled, no output)
+	 */
+	bool setParameters(float sample_freq, float output_freq)
+	{
+		if ((sample_freq <= 0.f) || (output_freq <= 0.f) || !isFinite(sample_freq) || !isFinite(output_freq)) {
+			disable();
+			return false;
+		}
+
+		_sample_freq = sample_freq;
+		_requested_output_freq = output_freq;
+		_decimation = math::max((int)roundf(sample_freq / output_freq), 1);
+		_sample_count = 0;
+
+		_lp_filter.set_cutoff_frequency(sample_freq, CUTOFF_RATIO * getOutputFreq());
+
+		return true;
+	}
+
+	/**
+	 * Filter a new sample.
+	 *
+	 * @return true if a new decimated output is available (see getOutput())
+	 */
+	inline bool apply(const T &sample)
+	{
+		if (_decimation <= 0) {
+			return false;
+		}
+
+		_output = _lp_filter.apply(sample);
+
+		if (++_sample_count >= _decimation) {
+			_sample_count = 0;
+			return true;
+		}
+
+		return false;
+	}
+
+	// Reset the filter state to this value and restart the decimation
+	void reset(const T &sample)
+	{
+		_output = _lp_filter.reset(sample);
+		_sample_count = 0;
+	}
+
+	void disable()
+	{
+		_lp_filter.disable();
+		_output = {};
+		_sample_freq = 0.f;
+		_requested_output_freq = 0.f;
+		_decimation = 0;
+		_sample_count = 0;
+	}
+
+	// last filtered value
+	const T &getOutput() const { return _output; }
+
+	bool enabled() const { return _decimation > 0; }
+	int getDecimation() const { return _decimation; }
+
+	// actual output frequency after rounding to an integer decimation
+	float getOutputFreq() const { return (_decimation > 0) ? _sample_freq / _decimation : 0.f; }
+
+	// output frequency as requested in setParameters()
+	float getRequestedOutputFreq() const { return _requested_output_freq; }
+
+	float getCutoffFreq() const { return _lp_filter.get_cutoff_freq(); }
+
+private:
+	LowPassFilter2p<T> _lp_filter{};
+
+	T _output{};
+
+	float _sample_freq{0.f};
+	float _requested_output_freq{0.f};
+
+	int _decimation{0};
+	int _sample_count{0};
+};
+
+} // namespace math
@@ -0,0 +1,449 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/*
+ * @file NotchFilterBank.hpp
+ *
+ * @brief Cascade of biquad notch filters applied to three axes at once.
+ *
+ * Every section holds the coefficients and delay elements of one notch filter for the
+ * x, y and z axis, stored as structure of arrays (one 4 wide lane per value, the 4th
+ * lane is padding). A section is applied to a whole block of samples for all axes with
+ * SSE or NEON where available and with a scalar loop otherwise.
+ *
+ * The behaviour of each axis of a section (parameter updates, reset on the first sample,
+ * Direct Form I arithmetic) matches NotchFilter<float>. The outputs can differ by rounding where
+ * the compiler contracts into fused multiply-adds differently.
+ */
+
+#pragma once
+
+#include <mathlib/math/Functions.hpp>
+#include <float.h>
+#include <stdint.h>
+#include <matrix/math.hpp>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace math
+{
+
+class NotchFilterBank
+{
+public:
+	static constexpr int AXES = 3;
+	static constexpr int LANES = 4;
+
+	NotchFilterBank() = default;
+	~NotchFilterBank() { delete[] _sections; }
+
+	NotchFilterBank(const NotchFilterBank &) = delete;
+	NotchFilterBank &operator=(const NotchFilterBank &) = delete;
+
+	/**
+	 * (Re)allocate the bank, all sections start disabled.
+	 *
+	 * @return true if num_sections sections are available
+	 */
+	bool allocate(int num_sections)
+	{
+		delete[] _sections;
+		_sections = nullptr;
+		_num_sections = 0;
+
+		if (num_sections > 0) {
+			_sections = new Section[num_sections];
+
+			if (_sections) {
+				_num_sections = num_sections;
+			}
+		}
+
+		return (_num_sections == num_sections);
+	}
+
+	int sections() const { return _num_sections; }
+
+	bool setParameters(int section, int axis, float sample_freq, float notch_freq, float bandwidth);
+
+	float getNotchFreq(int section, int axis) const { return valid(section, axis) ? _sections[section].notch_freq[axis] : 0.f; }
+	float getBandwidth(int section, int axis) const { return valid(section, axis) ? _sections[section].bandwidth[axis] : 0.f; }
+
+	bool initialized(int section, int axis) const
+	{
+		return valid(section, axis) && (_sections[section].initialized & (1 << axis));
+	}
+
+	// Used in unit test only
+	void getCoefficients(int section, int axis, float a[3], float b[3]) const
+	{
+		const Section &s = _sections[section];
+		a[0] = 1.f;
+		a[1] = s.a1[axis];
+		a[2] = s.a2[axis];
+		b[0] = s.b0[axis];
+		b[1] = s.b1[axis];
+		b[2] = s.b2[axis];
+	}
+
+	// reinitialize the delay elements from the next sample
+	void reset(int section, int axis)
+	{
+		if (valid(section, axis)) {
+			_sections[section].initialized &= ~(1 << axis);
+		}
+	}
+
+	void disable(int section, int axis)
+	{
+		if (valid(section, axis)) {
+			Section &s = _sections[section];
+
+			// no filtering
+			s.notch_freq[axis] = 0.f;
+			s.bandwidth[axis] = 0.f;
+			s.sample_freq[axis] = 0.f;
+
+			s.b0[axis] = 1.f;
+			s.b1[axis] = 0.f;
+			s.b2[axis] = 0.f;
+
+			s.a1[axis] = 0.f;
+			s.a2[axis] = 0.f;
+
+			s.enabled &= ~(1 << axis);
+			s.initialized &= ~(1 << axis);
+		}
+	}
+
+	/**
+	 * Filter a block of samples in place, each section is applied to all axes of the block before moving to the next.
+	 * Sections without any enabled axis are skipped. The padding lane of every sample should be 0.
+	 *
+	 * @param samples [num_samples][LANES] x, y, z, padding
+	 */
+	void applyArray(float samples[][LANES], int num_samples)
+	{
+		if (num_samples <= 0) {
+			return;
+		}
+
+		for (int k = 0; k < _num_sections; k++) {
+			Section &s = _sections[k];
+
+			if (s.enabled == 0) {
+				continue;
+			}
+
+			const uint8_t reset_axes = s.enabled & ~s.initialized;
+
+			if (reset_axes != 0) {
+				for (int axis = 0; axis < AXES; axis++) {
+					if (reset_axes & (1 << axis)) {
+						resetAxis(s, axis, samples[0][axis]);
+					}
+				}
+			}
+
+			applySection(s, samples, num_samples);
+		}
+	}
+
+private:
+
+	struct Section {
+		// All the coefficients are normalized by a0, so a0 becomes 1 here
+		float b0[LANES] {1.f, 1.f, 1.f, 1.f};
+		float b1[LANES] {};
+		float b2[LANES] {};
+		float a1[LANES] {};
+		float a2[LANES] {};
+
+		float x1[LANES] {}; // input delay elements
+		float x2[LANES] {};
+		float y1[LANES] {}; // output delay elements
+		float y2[LANES] {};
+
+		float notch_freq[AXES] {};
+		float bandwidth[AXES] {};
+		float sample_freq[AXES] {};
+
+		uint8_t enabled{0};     // bitmask of axes with a configured notch
+		uint8_t initialized{0}; // bitmask of axes with valid delay elements
+	};
+
+	bool valid(int section, int axis) const
+	{
+		return (section >= 0) && (section < _num_sections) && (axis >= 0) && (axis < AXES);
+	}
+
+	// same as NotchFilter::reset(sample), lanes without a configured notch are left untouched
+	static void resetAxis(Section &s, int axis, float sample)
+	{
+		if ((s.enabled & (1 << axis)) == 0) {
+			return;
+		}
+
+		const float input = isFinite(sample) ? sample : 0.f;
+
+		s.x1[axis] = s.x2[axis] = input;
+		s.y1[axis] = s.y2[axis] = input * (s.b0[axis] + s.b1[axis] + s.b2[axis]) / (1 + s.a1[axis] + s.a2[axis]);
+
+		if (!isFinite(s.y1[axis])) {
+			s.y1[axis] = s.y2[axis] = 0.f;
+		}
+
+		s.initialized |= (1 << axis);
+	}
+
+	static void applySection(Section &s, float samples[][LANES], int num_samples)
+	{
+		// Direct Form I, same operation order as NotchFilter<float>.
+		// Lanes without a configured notch pass their input through, so that a non-finite sample cannot stay in the
+		// delay elements of such a lane (0 * NaN is NaN).
+#if defined(__SSE__) || defined(__ARM_NEON)
+		uint32_t lane_mask[LANES];
+
+		for (int lane = 0; lane < LANES; lane++) {
+			lane_mask[lane] = (s.enabled & (1 << lane)) ? UINT32_MAX : 0;
+		}
+
+#endif
+
+#if defined(__SSE__)
+		const __m128 enabled = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)lane_mask));
+		const __m128 b0 = _mm_loadu_ps(s.b0);
+		const __m128 b1 = _mm_loadu_ps(s.b1);
+		const __m128 b2 = _mm_loadu_ps(s.b2);
+		const __m128 a1 = _mm_loadu_ps(s.a1);
+		const __m128 a2 = _mm_loadu_ps(s.a2);
+
+		__m128 x1 = _mm_loadu_ps(s.x1);
+		__m128 x2 = _mm_loadu_ps(s.x2);
+		__m128 y1 = _mm_loadu_ps(s.y1);
+		__m128 y2 = _mm_loadu_ps(s.y2);
+
+		for (int n = 0; n < num_samples; n++) {
+			const __m128 x0 = _mm_loadu_ps(samples[n]);
+
+			__m128 y0 = _mm_mul_ps(b0, x0);
+			y0 = _mm_add_ps(y0, _mm_mul_ps(b1, x1));
+			y0 = _mm_add_ps(y0, _mm_mul_ps(b2, x2));
+			y0 = _mm_sub_ps(y0, _mm_mul_ps(a1, y1));
+			y0 = _mm_sub_ps(y0, _mm_mul_ps(a2, y2));
+			y0 = _mm_or_ps(_mm_and_ps(enabled, y0), _mm_andnot_ps(enabled, x0));
+
+			x2 = x1;
+			x1 = x0;
+			y2 = y1;
+			y1 = y0;
+
+			_mm_storeu_ps(samples[n], y0);
+		}
+
+		_mm_storeu_ps(s.x1, x1);
+		_mm_storeu_ps(s.x2, x2);
+		_mm_storeu_ps(s.y1, y1);
+		_mm_storeu_ps(s.y2, y2);
+
+#elif defined(__ARM_NEON)
+		const uint32x4_t enabled = vld1q_u32(lane_mask);
+		const float32x4_t b0 = vld1q_f32(s.b0);
+		const float32x4_t b1 = vld1q_f32(s.b1);
+		const float32x4_t b2 = vld1q_f32(s.b2);
+		const float32x4_t a1 = vld1q_f32(s.a1);
+		const float32x4_t a2 = vld1q_f32(s.a2);
+
+		float32x4_t x1 = vld1q_f32(s.x1);
+		float32x4_t x2 = vld1q_f32(s.x2);
+		float32x4_t y1 = vld1q_f32(s.y1);
+		float32x4_t y2 = vld1q_f32(s.y2);
+
+		for (int n = 0; n < num_samples; n++) {
+			const float32x4_t x0 = vld1q_f32(samples[n]);
+
+			float32x4_t y0 = vmulq_f32(b0, x0);
+			y0 = vaddq_f32(y0, vmulq_f32(b1, x1));
+			y0 = vaddq_f32(y0, vmulq_f32(b2, x2));
+			y0 = vsubq_f32(y0, vmulq_f32(a1, y1));
+			y0 = vsubq_f32(y0, vmulq_f32(a2, y2));
+			y0 = vbslq_f32(enabled, y0, x0);
+
+			x2 = x1;
+			x1 = x0;
+			y2 = y1;
+			y1 = y0;
+
+			vst1q_f32(samples[n], y0);
+		}
+
+		vst1q_f32(s.x1, x1);
+		vst1q_f32(s.x2, x2);
+		vst1q_f32(s.y1, y1);
+		vst1q_f32(s.y2, y2);
+
+#else
+
+		for (int axis = 0; axis < AXES; axis++) {
+			if ((s.enabled & (1 << axis)) == 0) {
+				continue;
+			}
+
+			const float b0 = s.b0[axis];
+			const float b1 = s.b1[axis];
+			const float b2 = s.b2[axis];
+			const float a1 = s.a1[axis];
+			const float a2 = s.a2[axis];
+
+			float x1 = s.x1[axis];
+			float x2 = s.x2[axis];
+			float y1 = s.y1[axis];
+			float y2 = s.y2[axis];
+
+			for (int n = 0; n < num_samples; n++) {
+				const float x0 = samples[n][axis];
+				const float y0 = b0 * x0 + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+
+				x2 = x1;
+				x1 = x0;
+				y2 = y1;
+				y1 = y0;
+
+				samples[n][axis] = y0;
+			}
+
+			s.x1[axis] = x1;
+			s.x2[axis] = x2;
+			s.y1[axis] = y1;
+			s.y2[axis] = y2;
+		}
+
+#endif
+	}
+
+	Section *_sections{nullptr};
+	int _num_sections{0};
+};
+
+/**
+ * Set the notch of one axis of a section, see NotchFilter<T>::setParameters().
+ * The filter history is kept unless the notch moves by more than its bandwidth or
+ * the bandwidth or sample frequency change by more than 1%.
+ */
+inline bool NotchFilterBank::setParameters(int section, int axis, float sample_freq, float notch_freq, float bandwidth)
+{
+	if (!valid(section, axis)) {
+		return false;
+	}
+
+	if ((sample_freq <= 0.f) || (notch_freq <= 0.f) || (bandwidth <= 0.f) || (notch_freq >= sample_freq / 2)
+	    || !isFinite(sample_freq) || !isFinite(notch_freq) || !isFinite(bandwidth)) {
+
+		disable(section, axis);
+		return false;
+	}
+
+	Section &s = _sections[section];
+
+	const float freq_min = sample_freq * 0.001f;
+
+	const float notch_freq_new = math::max(notch_freq, freq_min);
+	const float bandwidth_new = math::max(bandwidth, freq_min);
+
+	const float sample_freq_diff = fabsf(sample_freq - s.sample_freq[axis]);
+	const float bandwidth_diff = fabsf(bandwidth_new - s.bandwidth[axis]);
+
+	const bool sample_freq_change = (sample_freq_diff > FLT_EPSILON);
+	const bool bandwidth_change = (bandwidth_diff > FLT_EPSILON);
+
+	if (!sample_freq_change && !bandwidth_change) {
+		const float notch_freq_diff = fabsf(notch_freq_new - s.notch_freq[axis]);
+
+		if (notch_freq_diff > FLT_EPSILON) {
+			// only notch frequency has changed
+			s.notch_freq[axis] = notch_freq_new;
+
+			const float beta = -cosf(2.f * M_PI_F * s.notch_freq[axis] / s.sample_freq[axis]);
+
+			s.b1[axis] = 2.f * beta * s.b0[axis];
+			s.a1[axis] = s.b1[axis];
+
+			if (notch_freq_diff > s.bandwidth[axis]) {
+				// force reset
+				s.initialized &= ~(1 << axis);
+			}
+
+			if (!isFinite(s.b1[axis])) {
+				disable(section, axis);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	s.sample_freq[axis] = sample_freq;
+	s.notch_freq[axis] = notch_freq_new;
+	s.bandwidth[axis] = bandwidth_new;
+
+	const float alpha = tanf(M_PI_F * s.bandwidth[axis] / s.sample_freq[axis]);
+	const float beta = -cosf(2.f * M_PI_F * s.notch_freq[axis] / s.sample_freq[axis]);
+	const float a0_inv = 1.f / (alpha + 1.f);
+
+	s.b0[axis] = a0_inv;
+	s.b1[axis] = 2.f * beta * a0_inv;
+	s.b2[axis] = a0_inv;
+
+	s.a1[axis] = s.b1[axis];
+	s.a2[axis] = (1.f - alpha) * a0_inv;
+
+	if (!isFinite(s.b0[axis]) || !isFinite(s.b1[axis]) || !isFinite(s.b2[axis]) || !isFinite(s.a2[axis])) {
+		disable(section, axis);
+		return false;
+	}
+
+	s.enabled |= (1 << axis);
+
+	// force reset if bandwidth or sample frequency changed by more than 1%
+	if ((bandwidth_diff > 0.01f * s.bandwidth[axis]) || (sample_freq_diff > 0.01f * s.sample_freq[axis])) {
+		s.initialized &= ~(1 << axis);
+	}
+
+	return true;
+}
+
+} // namespace math
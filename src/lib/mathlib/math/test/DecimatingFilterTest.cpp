@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * Test code for the anti-aliased decimating filter
+ * Run this test only using make tests TESTFILTER=DecimatingFilter
+ */
+
+#include <gtest/gtest.h>
+#include <matrix/matrix/math.hpp>
+#include <px4_platform_common/defines.h>
+
+#include <lib/mathlib/math/filter/DecimatingFilter.hpp>
+
+using matrix::Vector3f;
+using math::DecimatingFilter;
+
+class DecimatingFilterTest : public ::testing::Test
+{
+public:
+	// peak output amplitude of a sine at frequency_hz after the filter has settled
+	float steadyStateAmplitude(float frequency_hz)
+	{
+		_filter.reset(Vector3f{});
+
+		float amplitude = 0.f;
+		int outputs = 0;
+
+		for (int n = 0; n < 2 * (int)_sample_freq; n++) {
+			const float value = sinf(2.f * M_PI_F * frequency_hz * n / _sample_freq);
+
+			if (_filter.apply(Vector3f{value, -value, 0.f})) {
+				outputs++;
+
+				// skip the first second
+				if (n > (int)_sample_freq) {
+					amplitude = fmaxf(amplitude, fabsf(_filter.getOutput()(0)));
+					EXPECT_FLOAT_EQ(_filter.getOutput()(1), -_filter.getOutput()(0));
+					EXPECT_FLOAT_EQ(_filter.getOutput()(2), 0.f);
+				}
+			}
+		}
+
+		EXPECT_EQ(outputs, 2 * (int)_sample_freq / _filter.getDecimation());
+
+		return amplitude;
+	}
+
+	DecimatingFilter<Vector3f> _filter{};
+	const float _sample_freq = 8000.f;
+};
+
+TEST_F(DecimatingFilterTest, decimation)
+{
+	EXPECT_FALSE(_filter.enabled());
+	EXPECT_FALSE(_filter.apply(Vector3f{1.f, 2.f, 3.f}));
+
+	EXPECT_TRUE(_filter.setParameters(_sample_freq, 400.f));
+	EXPECT_TRUE(_filter.enabled());
+	EXPECT_EQ(_filter.getDecimation(), 20);
+	EXPECT_FLOAT_EQ(_filter.getOutputFreq(), 400.f);
+	EXPECT_FLOAT_EQ(_filter.getCutoffFreq(), 100.f);
+
+	// output every 20th sample
+	for (int n = 1; n <= 100; n++) {
+		EXPECT_EQ(_filter.apply(Vector3f{}), (n % 20) == 0) << n;
+	}
+
+	// rounded to the closest integer decimation
+	EXPECT_TRUE(_filter.setParameters(_sample_freq, 300.f));
+	EXPECT_EQ(_filter.getDecimation(), 27);
+	EXPECT_FLOAT_EQ(_filter.getRequestedOutputFreq(), 300.f);
+	EXPECT_NEAR(_filter.getOutputFreq(), 296.3f, 0.1f);
+
+	// output rate above the sample rate
+	EXPECT_TRUE(_filter.setParameters(_sample_freq, 10000.f));
+	EXPECT_EQ(_filter.getDecimation(), 1);
+	EXPECT_TRUE(_filter.apply(Vector3f{}));
+}
+
+TEST_F(DecimatingFilterTest, invalidParameters)
+{
+	EXPECT_FALSE(_filter.setParameters(0.f, 100.f));
+	EXPECT_FALSE(_filter.enabled());
+
+	EXPECT_FALSE(_filter.setParameters(_sample_freq, 0.f));
+	EXPECT_FALSE(_filter.setParameters(_sample_freq, NAN));
+	EXPECT_FALSE(_filter.setParameters(INFINITY, 100.f));
+	EXPECT_FALSE(_filter.enabled());
+	EXPECT_EQ(_filter.getDecimation(), 0);
+	EXPECT_FLOAT_EQ(_filter.getOutputFreq(), 0.f);
+}
+
+TEST_F(DecimatingFilterTest, reset)
+{
+	ASSERT_TRUE(_filter.setParameters(_sample_freq, 100.f));
+
+	const Vector3f value{0.1f, -2.f, 3.f};
+	_filter.reset(value);
+
+	for (int n = 0; n < 1000; n++) {
+		if (_filter.apply(value)) {
+			EXPECT_NEAR(_filter.getOutput()(0), value(0), 1e-3f);
+			EXPECT_NEAR(_filter.getOutput()(1), value(1), 1e-3f);
+			EXPECT_NEAR(_filter.getOutput()(2), value(2), 1e-3f);
+		}
+	}
+}
+
+TEST_F(DecimatingFilterTest, antiAliasing)
+{
+	ASSERT_TRUE(_filter.setParameters(_sample_freq, 400.f));
+
+	// pass band
+	EXPECT_GT(steadyStateAmplitude(10.f), 0.95f);
+
+	// 380 Hz aliases to 20 Hz at 400 Hz, plain decimation would keep the full amplitude
+	EXPECT_LT(steadyStateAmplitude(380.f), 0.1f);
+
+	// 1 kHz motor noise
+	EXPECT_LT(steadyStateAmplitude(1000.f), 0.02f);
+}
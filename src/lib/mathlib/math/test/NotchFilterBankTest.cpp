@@ -0,0 +1,291 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * Test code for the notch filter bank, checked against NotchFilter<float>
+ * Run this test only using make tests TESTFILTER=NotchFilterBank
+ */
+
+#include <gtest/gtest.h>
+
+#include <lib/mathlib/math/filter/NotchFilter.hpp>
+#include <lib/mathlib/math/filter/NotchFilterBank.hpp>
+
+using namespace math;
+
+class NotchFilterBankTest : public ::testing::Test
+{
+public:
+	static constexpr int SECTIONS = 5;
+	static constexpr int AXES = NotchFilterBank::AXES;
+	static constexpr int LANES = NotchFilterBank::LANES;
+	static constexpr int BLOCK_MAX = 32;
+
+	// the bank and NotchFilter<float> do the same operations in the same order, but the compiler may contract them
+	// into fused multiply-adds (e.g. on ARM) differently
+	static constexpr float TOLERANCE = 1e-5f;
+
+	void SetUp() override
+	{
+		ASSERT_TRUE(_bank.allocate(SECTIONS));
+	}
+
+	void setParameters(int section, int axis, float notch_freq, float bandwidth)
+	{
+		const bool ret_reference = _reference[section][axis].setParameters(_sample_freq, notch_freq, bandwidth);
+		const bool ret = _bank.setParameters(section, axis, _sample_freq, notch_freq, bandwidth);
+		EXPECT_EQ(ret, ret_reference);
+	}
+
+	void disable(int section, int axis)
+	{
+		_reference[section][axis].disable();
+		_bank.disable(section, axis);
+	}
+
+	// run a block of num_samples through the bank and the reference filters and compare them
+	void runBlock(int num_samples)
+	{
+		float samples[BLOCK_MAX][LANES] {};
+		float reference[AXES][BLOCK_MAX] {};
+
+		for (int n = 0; n < num_samples; n++) {
+			const float t = _sample_index++ / _sample_freq;
+
+			for (int axis = 0; axis < AXES; axis++) {
+				const float input = 0.5f * sinf(2.f * M_PI_F * (60.f + 45.f * axis) * t)
+						    + 0.3f * sinf(2.f * M_PI_F * (170.f + 20.f * axis) * t) + 0.05f * (axis + 1);
+
+				samples[n][axis] = input;
+				reference[axis][n] = input;
+			}
+		}
+
+		for (int section = 0; section < SECTIONS; section++) {
+			for (int axis = 0; axis < AXES; axis++) {
+				if (_reference[section][axis].getNotchFreq() > 0.f) {
+					_reference[section][axis].applyArray(reference[axis], num_samples);
+				}
+			}
+		}
+
+		_bank.applyArray(samples, num_samples);
+
+		for (int n = 0; n < num_samples; n++) {
+			for (int axis = 0; axis < AXES; axis++) {
+				EXPECT_NEAR(samples[n][axis], reference[axis][n], TOLERANCE) << "sample " << n << " axis " << axis;
+			}
+		}
+	}
+
+	NotchFilterBank _bank{};
+	NotchFilter<float> _reference[SECTIONS][AXES] {};
+
+	const float _sample_freq = 1000.f;
+	int _sample_index{0};
+};
+
+TEST_F(NotchFilterBankTest, coefficients)
+{
+	setParameters(0, 1, 50.f, 15.f);
+
+	float a[3];
+	float b[3];
+	float a_reference[3];
+	float b_reference[3];
+
+	_bank.getCoefficients(0, 1, a, b);
+	_reference[0][1].getCoefficients(a_reference, b_reference);
+
+	for (int i = 0; i < 3; i++) {
+		EXPECT_FLOAT_EQ(a[i], a_reference[i]);
+		EXPECT_FLOAT_EQ(b[i], b_reference[i]);
+	}
+
+	EXPECT_EQ(_bank.getNotchFreq(0, 1), 50.f);
+	EXPECT_EQ(_bank.getBandwidth(0, 1), 15.f);
+
+	// other axes and sections untouched
+	EXPECT_EQ(_bank.getNotchFreq(0, 0), 0.f);
+	EXPECT_EQ(_bank.getNotchFreq(1, 1), 0.f);
+}
+
+TEST_F(NotchFilterBankTest, invalidParameters)
+{
+	setParameters(0, 0, 600.f, 15.f); // above Nyquist
+	setParameters(0, 1, 50.f, -1.f);
+	setParameters(0, 2, NAN, 10.f);
+
+	EXPECT_FALSE(_bank.setParameters(SECTIONS, 0, _sample_freq, 50.f, 10.f));
+	EXPECT_FALSE(_bank.setParameters(0, AXES, _sample_freq, 50.f, 10.f));
+
+	for (int axis = 0; axis < AXES; axis++) {
+		EXPECT_EQ(_bank.getNotchFreq(0, axis), 0.f);
+	}
+
+	// disabled sections pass samples through
+	runBlock(8);
+}
+
+TEST_F(NotchFilterBankTest, matchesCascade)
+{
+	// same notch on all axes
+	for (int axis = 0; axis < AXES; axis++) {
+		setParameters(0, axis, 80.f, 20.f);
+		setParameters(4, axis, 200.f, 30.f);
+	}
+
+	// different notch per axis
+	setParameters(1, 0, 60.f, 10.f);
+	setParameters(1, 1, 105.f, 15.f);
+	setParameters(1, 2, 150.f, 25.f);
+
+	// partially enabled section
+	setParameters(2, 2, 190.f, 40.f);
+
+	for (int block = 0; block < 50; block++) {
+		runBlock(1 + (block * 7) % BLOCK_MAX);
+	}
+}
+
+TEST_F(NotchFilterBankTest, matchesParameterChanges)
+{
+	for (int section = 0; section < SECTIONS; section++) {
+		for (int axis = 0; axis < AXES; axis++) {
+			setParameters(section, axis, 50.f + 30.f * section + 5.f * axis, 15.f);
+		}
+	}
+
+	for (int block = 0; block < 200; block++) {
+		const int section = block % SECTIONS;
+		const int axis = (block / SECTIONS) % AXES;
+
+		switch (block % 7) {
+		case 0:
+			// small frequency change, history kept
+			setParameters(section, axis, _bank.getNotchFreq(section, axis) + 1.f, 15.f);
+			break;
+
+		case 1:
+			// large frequency change, forces a reset
+			setParameters(section, axis, 70.f + 4.f * block, 15.f);
+			break;
+
+		case 2:
+			// bandwidth change
+			setParameters(section, axis, 120.f, 10.f + block % 20);
+			break;
+
+		case 3:
+			disable(section, axis);
+			break;
+
+		case 4:
+			_reference[section][axis].reset();
+			_bank.reset(section, axis);
+			break;
+
+		default:
+			break;
+		}
+
+		EXPECT_EQ(_bank.getNotchFreq(section, axis), _reference[section][axis].getNotchFreq());
+		EXPECT_EQ(_bank.getBandwidth(section, axis), _reference[section][axis].getBandwidth());
+
+		runBlock(1 + block % BLOCK_MAX);
+
+		for (int s = 0; s < SECTIONS; s++) {
+			for (int a = 0; a < AXES; a++) {
+				if (_reference[s][a].getNotchFreq() > 0.f) {
+					EXPECT_EQ(_bank.initialized(s, a), _reference[s][a].initialized());
+				}
+			}
+		}
+	}
+}
+
+TEST_F(NotchFilterBankTest, nonFiniteReset)
+{
+	setParameters(0, 0, 80.f, 20.f);
+	setParameters(0, 1, 80.f, 20.f);
+
+	// the first block initializes the delay elements from a non-finite sample on x and y, z has no notch
+	float samples[BLOCK_MAX][LANES] {};
+	float reference[AXES][BLOCK_MAX] {};
+
+	for (int n = 0; n < BLOCK_MAX; n++) {
+		for (int axis = 0; axis < AXES; axis++) {
+			samples[n][axis] = reference[axis][n] = 0.1f * (n % 5);
+		}
+	}
+
+	samples[0][0] = reference[0][0] = NAN;
+	samples[0][1] = reference[1][0] = INFINITY;
+	samples[0][2] = reference[2][0] = NAN;
+
+	_reference[0][0].applyArray(reference[0], BLOCK_MAX);
+	_reference[0][1].applyArray(reference[1], BLOCK_MAX);
+	_bank.applyArray(samples, BLOCK_MAX);
+
+	EXPECT_TRUE(_bank.initialized(0, 0));
+	EXPECT_TRUE(_bank.initialized(0, 1));
+	EXPECT_FALSE(_bank.initialized(0, 2));
+
+	for (int n = 0; n < BLOCK_MAX; n++) {
+		for (int axis = 0; axis < AXES; axis++) {
+			const float value = samples[n][axis];
+			const float value_reference = reference[axis][n];
+			if (std::isnan(value_reference)) {
+				EXPECT_TRUE(std::isnan(value)) << "sample " << n << " axis " << axis;
+
+			} else if (std::isinf(value_reference)) {
+				EXPECT_FLOAT_EQ(value, value_reference) << "sample " << n << " axis " << axis;
+
+			} else {
+				EXPECT_NEAR(value, value_reference, TOLERANCE) << "sample " << n << " axis " << axis;
+			}
+		}
+	}
+}
+
+TEST_F(NotchFilterBankTest, reallocate)
+{
+	setParameters(0, 0, 50.f, 15.f);
+	EXPECT_TRUE(_bank.allocate(2));
+	EXPECT_EQ(_bank.sections(), 2);
+	EXPECT_EQ(_bank.getNotchFreq(0, 0), 0.f);
+
+	EXPECT_TRUE(_bank.allocate(0));
+	EXPECT_EQ(_bank.sections(), 0);
+	EXPECT_FALSE(_bank.initialized(0, 0));
+}
@@ -0,0 +1,252 @@
+/**
+ * @file Expression.hpp
+ *
+ * Opt-in lazy evaluation of element-wise matrix expressions.
+ *
+ * Every operator of Matrix returns a full temporary, so an expression like
+ *   a.emult(kp) + b - c.emult(kd) + d * s
+ * creates five of them and loops over the elements five times. Starting the
+ * expression with lazy() instead builds a tree of lightweight expression
+ * nodes that is evaluated element by element in a single loop when it is
+ * assigned to a Matrix (or Vector, Vector3, SquareMatrix, ...):
+ *   Vector3f r = lazy(a).emult(kp) + b - lazy(c).emult(kd) + d * s;
+ *
+ * The element operations are the same as the ones of the eager operators,
+ * so the results are identical.
+ *
+ * Supported are +, - (also unary), emult(), edivide() and multiplication and
+ * division by a scalar. Matrix products are not lazy, evaluate the expression
+ * first: expr.eval() * m. The same applies to direct initialization, use
+ * Vector3f v = expr; instead of Vector3f v(expr);.
+ *
+ * The nodes only hold references to their operands: do not store an
+ * expression (e.g. in an auto variable) beyond the statement it is built in.
+ */
+
+#pragma once
+
+#include <type_traits>
+
+#include "math.hpp"
+
+// the nodes only pay off if they are inlined completely, also with -Os
+#if defined(__GNUC__)
+#define MATRIX_EXPR_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define MATRIX_EXPR_ALWAYS_INLINE inline
+#endif
+
+namespace matrix
+{
+
+namespace expr
+{
+
+template <typename T>
+struct NonDeduced {
+	using type = T;
+};
+
+template <typename Op, typename L, typename R, typename Type, size_t M, size_t N>
+class Binary;
+
+template <typename Op, typename E, typename Type, size_t M, size_t N>
+class ScalarOp;
+
+template <typename Type, size_t M, size_t N>
+class Leaf;
+
+struct Add {
+	template <typename Type>
+	MATRIX_EXPR_ALWAYS_INLINE static Type apply(Type a, Type b) { return a + b; }
+};
+
+struct Sub {
+	template <typename Type>
+	MATRIX_EXPR_ALWAYS_INLINE static Type apply(Type a, Type b) { return a - b; }
+};
+
+struct Mul {
+	template <typename Type>
+	MATRIX_EXPR_ALWAYS_INLINE static Type apply(Type a, Type b) { return a * b; }
+};
+
+struct Div {
+	template <typename Type>
+	MATRIX_EXPR_ALWAYS_INLINE static Type apply(Type a, Type b) { return a / b; }
+};
+
+template <typename Derived, typename Type, size_t M, size_t N>
+class Expression
+{
+public:
+	MATRIX_EXPR_ALWAYS_INLINE const Derived &derived() const { return static_cast<const Derived &>(*this); }
+
+	// evaluate into any matrix type with matching dimensions
+	template <typename Result, typename = typename std::enable_if<std::is_base_of<Matrix<Type, M, N>, Result>::value>::type>
+	operator Result() const
+	{
+		Result res;
+		evalTo(res);
+		return res;
+	}
+
+	Matrix<Type, M, N> eval() const
+	{
+		Matrix<Type, M, N> res;
+		evalTo(res);
+		return res;
+	}
+
+	MATRIX_EXPR_ALWAYS_INLINE void evalTo(Matrix<Type, M, N> &res) const
+	{
+		const Derived &self = derived();
+
+		for (size_t i = 0; i < M; i++) {
+			for (size_t j = 0; j < N; j++) {
+				res(i, j) = self(i, j);
+			}
+		}
+	}
+
+	Binary<Mul, Derived, Leaf<Type, M, N>, Type, M, N> emult(const Matrix<Type, M, N> &other) const
+	{
+		return {derived(), Leaf<Type, M, N>(other)};
+	}
+
+	template <typename R>
+	Binary<Mul, Derived, R, Type, M, N> emult(const Expression<R, Type, M, N> &other) const
+	{
+		return {derived(), other.derived()};
+	}
+
+	Binary<Div, Derived, Leaf<Type, M, N>, Type, M, N> edivide(const Matrix<Type, M, N> &other) const
+	{
+		return {derived(), Leaf<Type, M, N>(other)};
+	}
+
+	template <typename R>
+	Binary<Div, Derived, R, Type, M, N> edivide(const Expression<R, Type, M, N> &other) const
+	{
+		return {derived(), other.derived()};
+	}
+};
+
+template <typename Type, size_t M, size_t N>
+class Leaf : public Expression<Leaf<Type, M, N>, Type, M, N>
+{
+public:
+	explicit Leaf(const Matrix<Type, M, N> &m) : _m(m) {}
+
+	MATRIX_EXPR_ALWAYS_INLINE Type operator()(size_t i, size_t j) const { return _m(i, j); }
+
+private:
+	const Matrix<Type, M, N> &_m;
+};
+
+template <typename Op, typename L, typename R, typename Type, size_t M, size_t N>
+class Binary : public Expression<Binary<Op, L, R, Type, M, N>, Type, M, N>
+{
+public:
+	Binary(const L &l, const R &r) : _l(l), _r(r) {}
+
+	MATRIX_EXPR_ALWAYS_INLINE Type operator()(size_t i, size_t j) const { return Op::apply(_l(i, j), _r(i, j)); }
+
+private:
+	const L _l;
+	const R _r;
+};
+
+// element-wise operation with a scalar (scalar as right operand)
+template <typename Op, typename E, typename Type, size_t M, size_t N>
+class ScalarOp : public Expression<ScalarOp<Op, E, Type, M, N>, Type, M, N>
+{
+public:
+	ScalarOp(const E &e, Type scalar) : _e(e), _scalar(scalar) {}
+
+	MATRIX_EXPR_ALWAYS_INLINE Type operator()(size_t i, size_t j) const { return Op::apply(_e(i, j), _scalar); }
+
+private:
+	const E _e;
+	const Type _scalar;
+};
+
+template <typename E, typename Type, size_t M, size_t N>
+class Negate : public Expression<Negate<E, Type, M, N>, Type, M, N>
+{
+public:
+	explicit Negate(const E &e) : _e(e) {}
+
+	MATRIX_EXPR_ALWAYS_INLINE Type operator()(size_t i, size_t j) const { return -_e(i, j); }
+
+private:
+	const E _e;
+};
+
+// the matrix operand is a template parameter itself so that e.g. Vector3 is an exact match
+// and does not compete with the eager member operators of Vector3
+template <typename MatrixT, typename Type, size_t M, size_t N>
+using EnableIfMatrix = typename std::enable_if<std::is_base_of<Matrix<Type, M, N>, MatrixT>::value, int>::type;
+
+#define MATRIX_EXPR_BINARY_OPERATOR(op, Op) \
+	template <typename L, typename R, typename Type, size_t M, size_t N> \
+	Binary<Op, L, R, Type, M, N> operator op(const Expression<L, Type, M, N> &l, const Expression<R, Type, M, N> &r) \
+	{ \
+		return {l.derived(), r.derived()}; \
+	} \
+	\
+	template <typename L, typename MatrixT, typename Type, size_t M, size_t N, EnableIfMatrix<MatrixT, Type, M, N> = 0> \
+	Binary<Op, L, Leaf<Type, M, N>, Type, M, N> operator op(const Expression<L, Type, M, N> &l, const MatrixT &r) \
+	{ \
+		return {l.derived(), Leaf<Type, M, N>(r)}; \
+	} \
+	\
+	template <typename MatrixT, typename R, typename Type, size_t M, size_t N, EnableIfMatrix<MatrixT, Type, M, N> = 0> \
+	Binary<Op, Leaf<Type, M, N>, R, Type, M, N> operator op(const MatrixT &l, const Expression<R, Type, M, N> &r) \
+	{ \
+		return {Leaf<Type, M, N>(l), r.derived()}; \
+	}
+
+MATRIX_EXPR_BINARY_OPERATOR(+, Add)
+MATRIX_EXPR_BINARY_OPERATOR(-, Sub)
+
+#undef MATRIX_EXPR_BINARY_OPERATOR
+#undef MATRIX_EXPR_ALWAYS_INLINE
+
+template <typename E, typename Type, size_t M, size_t N>
+Negate<E, Type, M, N> operator-(const Expression<E, Type, M, N> &e)
+{
+	return Negate<E, Type, M, N>(e.derived());
+}
+
+template <typename E, typename Type, size_t M, size_t N>
+ScalarOp<Mul, E, Type, M, N> operator*(const Expression<E, Type, M, N> &e, typename NonDeduced<Type>::type scalar)
+{
+	return {e.derived(), scalar};
+}
+
+template <typename E, typename Type, size_t M, size_t N>
+ScalarOp<Mul, E, Type, M, N> operator*(typename NonDeduced<Type>::type scalar, const Expression<E, Type, M, N> &e)
+{
+	return {e.derived(), scalar};
+}
+
+// same as Matrix::operator/(Type): multiplication with the inverse
+template <typename E, typename Type, size_t M, size_t N>
+ScalarOp<Mul, E, Type, M, N> operator/(const Expression<E, Type, M, N> &e, typename NonDeduced<Type>::type scalar)
+{
+	return {e.derived(), 1 / scalar};
+}
+
+} // namespace expr
+
+/**
+ * Start a lazily evaluated expression, see above
+ */
+template <typename Type, size_t M, size_t N>
+expr::Leaf<Type, M, N> lazy(const Matrix<Type, M, N> &m)
+{
+	return expr::Leaf<Type, M, N>(m);
+}
+
+} // namespace matrix
@@ -18,6 +18,13 @@
 
 #include "math.hpp"
 
+// the unrolled kernels only pay off if they are inlined completely, also with -Os
+#if defined(__GNUC__)
+#define MATRIX_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define MATRIX_ALWAYS_INLINE inline
+#endif
+
 namespace matrix
 {
 
@@ -30,6 +37,98 @@ class Matrix;
 template <typename Type, size_t P, size_t Q, size_t M, size_t N>
 class Slice;
 
+namespace detail
+{
+
+/**
+ * Matrix product kernels
+ *
+ * Small products (3x3, 4x4, 3x1, 4x1, 6x1, ...) are completely unrolled at compile time, products
+ * with a short inner dimension (e.g. 6x6) only unroll the dot products. The terms are summed in the
+ * same order as the generic triple loop, which is kept for everything bigger. The results still
+ * differ from the loop by rounding where the compiler contracts into fused multiply-adds differently.
+ */
+enum class MultiplyKernel {
+	Generic,
+	UnrolledDot,
+	Unrolled
+};
+
+template <size_t M, size_t N, size_t P>
+constexpr MultiplyKernel multiplyKernel()
+{
+	return (M * N * P <= 64) ? MultiplyKernel::Unrolled :
+	       ((N <= 6) ? MultiplyKernel::UnrolledDot : MultiplyKernel::Generic);
+}
+
+// sum of a(i, j) * b(j, k) for j < J
+template <typename Type, size_t M, size_t N, size_t P, size_t J>
+struct DotUnrolled {
+	MATRIX_ALWAYS_INLINE static Type eval(const Matrix<Type, M, N> &a, const Matrix<Type, N, P> &b, size_t i, size_t k)
+	{
+		return DotUnrolled<Type, M, N, P, J - 1>::eval(a, b, i, k) + a(i, J - 1) * b(J - 1, k);
+	}
+};
+
+template <typename Type, size_t M, size_t N, size_t P>
+struct DotUnrolled<Type, M, N, P, 1> {
+	MATRIX_ALWAYS_INLINE static Type eval(const Matrix<Type, M, N> &a, const Matrix<Type, N, P> &b, size_t i, size_t k)
+	{
+		return a(i, 0) * b(0, k);
+	}
+};
+
+// result elements (i, k) with i * P + k < IK
+template <typename Type, size_t M, size_t N, size_t P, size_t IK>
+struct MultiplyUnrolled {
+	MATRIX_ALWAYS_INLINE static void eval(const Matrix<Type, M, N> &a, const Matrix<Type, N, P> &b, Matrix<Type, M, P> &res)
+	{
+		MultiplyUnrolled<Type, M, N, P, IK - 1>::eval(a, b, res);
+		res((IK - 1) / P, (IK - 1) % P) = DotUnrolled<Type, M, N, P, N>::eval(a, b, (IK - 1) / P, (IK - 1) % P);
+	}
+};
+
+template <typename Type, size_t M, size_t N, size_t P>
+struct MultiplyUnrolled<Type, M, N, P, 0> {
+	MATRIX_ALWAYS_INLINE static void eval(const Matrix<Type, M, N> &, const Matrix<Type, N, P> &, Matrix<Type, M, P> &) {}
+};
+
+template <typename Type, size_t M, size_t N, size_t P, MultiplyKernel Kernel = multiplyKernel<M, N, P>()>
+struct Multiply {
+	MATRIX_ALWAYS_INLINE static void eval(const Matrix<Type, M, N> &a, const Matrix<Type, N, P> &b, Matrix<Type, M, P> &res)
+	{
+		for (size_t i = 0; i < M; i++) {
+			for (size_t k = 0; k < P; k++) {
+				for (size_t j = 0; j < N; j++) {
+					res(i, k) += a(i, j) * b(j, k);
+				}
+			}
+		}
+	}
+};
+
+template <typename Type, size_t M, size_t N, size_t P>
+struct Multiply<Type, M, N, P, MultiplyKernel::UnrolledDot> {
+	MATRIX_ALWAYS_INLINE static void eval(const Matrix<Type, M, N> &a, const Matrix<Type, N, P> &b, Matrix<Type, M, P> &res)
+	{
+		for (size_t i = 0; i < M; i++) {
+			for (size_t k = 0; k < P; k++) {
+				res(i, k) = DotUnrolled<Type, M, N, P, N>::eval(a, b, i, k);
+			}
+		}
+	}
+};
+
+template <typename Type, size_t M, size_t N, size_t P>
+struct Multiply<Type, M, N, P, MultiplyKernel::Unrolled> {
+	MATRIX_ALWAYS_INLINE static void eval(const Matrix<Type, M, N> &a, const Matrix<Type, N, P> &b, Matrix<Type, M, P> &res)
+	{
+		MultiplyUnrolled<Type, M, N, P, M * P>::eval(a, b, res);
+	}
+};
+
+} // namespace detail
+
 template<typename Type, size_t M, size_t N>
 class Matrix
 {
@@ -148,17 +247,8 @@ public:
 	template<size_t P>
 	Matrix<Type, M, P> operator*(const Matrix<Type, N, P> &other) const
 	{
-		const Matrix<Type, M, N> &self = *this;
 		Matrix<Type, M, P> res{};
-
-		for (size_t i = 0; i < M; i++) {
-			for (size_t k = 0; k < P; k++) {
-				for (size_t j = 0; j < N; j++) {
-					res(i, k) += self(i, j) * other(j, k);
-				}
-			}
-		}
-
+		detail::Multiply<Type, M, N, P>::eval(*this, other, res);
 		return res;
 	}
 
@@ -821,3 +911,5 @@ std::ostream &operator<<(std::ostream &os,
 #endif // defined(SUPPORT_STDIOSTREAM)
 
 } // namespace matrix
+
+#undef MATRIX_ALWAYS_INLINE
@@ -488,9 +488,7 @@ public:
 	Vector3<Type> rotateVector(const Vector3<Type> &vec) const
 	{
 		const Quaternion &q = *this;
-		Quaternion v(Type(0), vec(0), vec(1), vec(2));
-		Quaternion res = q * v * q.inversed();
-		return Vector3<Type>(res(1), res(2), res(3));
+		return sandwichProduct(q, vec, q.inversed());
 	}
 
 	/**
@@ -505,9 +503,7 @@ public:
 	Vector3<Type> rotateVectorInverse(const Vector3<Type> &vec) const
 	{
 		const Quaternion &q = *this;
-		Quaternion v(Type(0), vec(0), vec(1), vec(2));
-		Quaternion res = q.inversed() * v * q;
-		return Vector3<Type>(res(1), res(2), res(3));
+		return sandwichProduct(q.inversed(), vec, q);
 	}
 
 	/**
@@ -539,6 +535,27 @@ public:
 		R_z(2) = a * a - b * b - c * c + d * d;
 		return R_z;
 	}
+
+private:
+	/**
+	 * Imaginary part of the product p * (0, v) * r
+	 *
+	 * Same operations as the two quaternion products without the terms
+	 * that are zero because of the pure imaginary quaternion (0, v) and
+	 * without the real part of the result.
+	 */
+	static Vector3<Type> sandwichProduct(const Quaternion &p, const Vector3<Type> &v, const Quaternion &r)
+	{
+		const Type pv0 = -p(1) * v(0) - p(2) * v(1) - p(3) * v(2);
+		const Type pv1 = p(0) * v(0) - p(3) * v(1) + p(2) * v(2);
+		const Type pv2 = p(3) * v(0) + p(0) * v(1) - p(1) * v(2);
+		const Type pv3 = -p(2) * v(0) + p(1) * v(1) + p(0) * v(2);
+
+		return Vector3<Type>(
+			       pv1 * r(0) + pv0 * r(1) - pv3 * r(2) + pv2 * r(3),
+			       pv2 * r(0) + pv3 * r(1) + pv0 * r(2) - pv1 * r(3),
+			       pv3 * r(0) - pv2 * r(1) + pv1 * r(2) + pv0 * r(3));
+	}
 };
 
 using Quatf = Quaternion<float>;
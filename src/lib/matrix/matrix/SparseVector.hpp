@@ -199,6 +199,24 @@ matrix::Vector<Type, Q> operator*(const matrix::Matrix<Type, Q, M> &mat,
 	return res;
 }
 
+// P * H' for a symmetric P, only the rows of P selected by the non zero elements of H are used
+template<typename Type, size_t M, size_t ... Idxs>
+matrix::Vector<Type, M> operator*(const matrix::SymmetricMatrix<Type, M> &mat,
+				  const matrix::SparseVector<Type, M, Idxs...> &vec)
+{
+	matrix::Vector<Type, M> res;
+
+	for (size_t i = 0; i < vec.non_zeros(); i++) {
+		const size_t row = vec.index(i);
+
+		for (size_t col = 0; col < M; col++) {
+			res(col) = res(col) + vec.atCompressedIndex(i) * mat(row, col);
+		}
+	}
+
+	return res;
+}
+
 // returns x.T * A * x
 template<typename Type, size_t M, size_t ... Idxs>
 Type quadraticForm(const matrix::SquareMatrix<Type, M> &A, const matrix::SparseVector<Type, M, Idxs...> &x)
@@ -218,6 +236,25 @@ Type quadraticForm(const matrix::SquareMatrix<Type, M> &A, const matrix::SparseV
 	return res;
 }
 
+// returns x.T * A * x for a symmetric A
+template<typename Type, size_t M, size_t ... Idxs>
+Type quadraticForm(const matrix::SymmetricMatrix<Type, M> &A, const matrix::SparseVector<Type, M, Idxs...> &x)
+{
+	Type res = Type(0);
+
+	for (size_t i = 0; i < x.non_zeros(); i++) {
+		Type tmp = Type(0);
+
+		for (size_t j = 0; j < x.non_zeros(); j++) {
+			tmp += A(x.index(i), x.index(j)) * x.atCompressedIndex(j);
+		}
+
+		res += x.atCompressedIndex(i) * tmp;
+	}
+
+	return res;
+}
+
 template<typename Type, size_t M, size_t... Idxs>
 constexpr size_t SparseVector<Type, M, Idxs...>::_indices[SparseVector<Type, M, Idxs...>::N];
 
@@ -0,0 +1,282 @@
+/**
+ * @file SymmetricMatrix.hpp
+ *
+ * A symmetric square matrix that only stores its upper triangle
+ * (M * (M + 1) / 2 elements, packed row by row).
+ *
+ * Writing element (i, j) also writes element (j, i), so the matrix
+ * stays symmetric by construction. Intended for covariance matrices.
+ */
+
+#pragma once
+
+#include "math.hpp"
+
+namespace matrix
+{
+
+template <typename Type, size_t M, size_t N>
+class Matrix;
+
+template <typename Type, size_t M>
+class Vector;
+
+template <typename Type, size_t M>
+class SquareMatrix;
+
+template <typename Type, size_t M>
+class SymmetricMatrix
+{
+public:
+	static constexpr size_t SIZE = M * (M + 1) / 2;
+
+	SymmetricMatrix() = default;
+
+	// the lower triangle of the input is ignored
+	explicit SymmetricMatrix(const SquareMatrix<Type, M> &other)
+	{
+		size_t idx = 0;
+
+		for (size_t i = 0; i < M; i++) {
+			for (size_t j = i; j < M; j++) {
+				_data[idx++] = other(i, j);
+			}
+		}
+	}
+
+	// index of element (i, j) with i <= j in the packed storage
+	static constexpr size_t index(size_t i, size_t j)
+	{
+		return (i <= j) ? (i * (2 * M - i - 1)) / 2 + j : (j * (2 * M - j - 1)) / 2 + i;
+	}
+
+	inline const Type &operator()(size_t i, size_t j) const
+	{
+		assert(i < M);
+		assert(j < M);
+
+		return _data[index(i, j)];
+	}
+
+	inline Type &operator()(size_t i, size_t j)
+	{
+		assert(i < M);
+		assert(j < M);
+
+		return _data[index(i, j)];
+	}
+
+	const Type *data() const { return _data; }
+
+	SquareMatrix<Type, M> dense() const
+	{
+		SquareMatrix<Type, M> res;
+		size_t idx = 0;
+
+		for (size_t i = 0; i < M; i++) {
+			res(i, i) = _data[idx++];
+
+			for (size_t j = i + 1; j < M; j++) {
+				res(i, j) = _data[idx];
+				res(j, i) = _data[idx];
+				idx++;
+			}
+		}
+
+		return res;
+	}
+
+	Vector<Type, M> diag() const
+	{
+		Vector<Type, M> res;
+
+		for (size_t i = 0; i < M; i++) {
+			res(i) = _data[index(i, i)];
+		}
+
+		return res;
+	}
+
+	// diagonal block starting at (first, first)
+	template <size_t Width>
+	SquareMatrix<Type, Width> slice(size_t first) const
+	{
+		static_assert(Width <= M, "Width bigger than matrix");
+		assert(first + Width <= M);
+
+		const SymmetricMatrix<Type, M> &self = *this;
+		SquareMatrix<Type, Width> res;
+
+		for (size_t i = 0; i < Width; i++) {
+			res(i, i) = self(first + i, first + i);
+
+			for (size_t j = i + 1; j < Width; j++) {
+				res(i, j) = res(j, i) = self(first + i, first + j);
+			}
+		}
+
+		return res;
+	}
+
+	// set the diagonal block starting at (first, first) from the upper triangle of the input
+	template <size_t Width>
+	void setSlice(size_t first, const SquareMatrix<Type, Width> &block)
+	{
+		static_assert(Width <= M, "Width bigger than matrix");
+		assert(first + Width <= M);
+
+		SymmetricMatrix<Type, M> &self = *this;
+
+		for (size_t i = 0; i < Width; i++) {
+			for (size_t j = i; j < Width; j++) {
+				self(first + i, first + j) = block(i, j);
+			}
+		}
+	}
+
+	void setZero()
+	{
+		memset(_data, 0, sizeof(_data));
+	}
+
+	inline void zero()
+	{
+		setZero();
+	}
+
+	SymmetricMatrix<Type, M> &operator+=(const SymmetricMatrix<Type, M> &other)
+	{
+		for (size_t i = 0; i < SIZE; i++) {
+			_data[i] += other._data[i];
+		}
+
+		return *this;
+	}
+
+	SymmetricMatrix<Type, M> &operator-=(const SymmetricMatrix<Type, M> &other)
+	{
+		for (size_t i = 0; i < SIZE; i++) {
+			_data[i] -= other._data[i];
+		}
+
+		return *this;
+	}
+
+	template <size_t Width>
+	void uncorrelateCovariance(size_t first)
+	{
+		static_assert(Width <= M, "Width bigger than matrix");
+		assert(first + Width <= M);
+
+		const Vector<Type, Width> diag_elements = slice<Width>(first).diag();
+		uncorrelateCovarianceSetVariance(first, diag_elements);
+	}
+
+	template <size_t Width>
+	void uncorrelateCovarianceSetVariance(size_t first, const Vector<Type, Width> &vec)
+	{
+		static_assert(Width <= M, "Width bigger than matrix");
+		assert(first + Width <= M);
+
+		zeroRowCol(first, Width);
+
+		for (size_t i = 0; i < Width; i++) {
+			_data[index(first + i, first + i)] = vec(i);
+		}
+	}
+
+	template <size_t Width>
+	void uncorrelateCovarianceSetVariance(size_t first, Type val)
+	{
+		static_assert(Width <= M, "Width bigger than matrix");
+		assert(first + Width <= M);
+
+		zeroRowCol(first, Width);
+
+		for (size_t i = first; i < first + Width; i++) {
+			_data[index(i, i)] = val;
+		}
+	}
+
+	// zero the covariances between the block starting at (first, first) and all other elements,
+	// the block itself is kept
+	template <size_t Width>
+	void uncorrelateCovarianceBlock(size_t first)
+	{
+		static_assert(Width <= M, "Width bigger than matrix");
+		assert(first + Width <= M);
+
+		for (size_t i = 0; i < first; i++) {
+			for (size_t j = first; j < first + Width; j++) {
+				_data[index(i, j)] = Type(0);
+			}
+		}
+
+		for (size_t i = first; i < first + Width; i++) {
+			for (size_t j = first + Width; j < M; j++) {
+				_data[index(i, j)] = Type(0);
+			}
+		}
+	}
+
+	// P = P - A with A(i, j) = khp(i, j) a general (non symmetric) matrix, e.g. the K * H * P
+	// term of a Kalman filter update, made symmetric by averaging the two off diagonal values.
+	// This is bit identical to a dense P -= A followed by makeRowColSymmetric(), but only
+	// writes the upper triangle.
+	template <typename Func>
+	void subtractSymmetrized(Func khp)
+	{
+		size_t idx = 0;
+
+		for (size_t i = 0; i < M; i++) {
+			_data[idx] = _data[idx] - khp(i, i);
+			idx++;
+
+			for (size_t j = i + 1; j < M; j++) {
+				const Type upper = _data[idx] - khp(i, j);
+				const Type lower = _data[idx] - khp(j, i);
+				_data[idx] = (upper + lower) / Type(2);
+				idx++;
+			}
+		}
+	}
+
+	// P = P - K * HP, where K * HP is the outer product of two vectors, made symmetric
+	// by averaging the two off diagonal values (see above)
+	void subtractSymmetrized(const Vector<Type, M> &K, const Vector<Type, M> &HP)
+	{
+		size_t idx = 0;
+
+		for (size_t i = 0; i < M; i++) {
+			_data[idx] = _data[idx] - K(i) * HP(i);
+			idx++;
+
+			for (size_t j = i + 1; j < M; j++) {
+				const Type upper = _data[idx] - K(i) * HP(j);
+				const Type lower = _data[idx] - K(j) * HP(i);
+				_data[idx] = (upper + lower) / Type(2);
+				idx++;
+			}
+		}
+	}
+
+private:
+	void zeroRowCol(size_t first, size_t width)
+	{
+		for (size_t i = 0; i < first + width; i++) {
+			const size_t j_start = (i < first) ? first : i;
+			const size_t j_end = (i < first) ? first + width : M;
+
+			for (size_t j = j_start; j < j_end; j++) {
+				_data[index(i, j)] = Type(0);
+			}
+		}
+	}
+
+	Type _data[SIZE] {};
+};
+
+template <typename Type, size_t M>
+constexpr size_t SymmetricMatrix<Type, M>::SIZE;
+
+} // namespace matrix
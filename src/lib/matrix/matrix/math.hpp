@@ -8,6 +8,7 @@
 #include "helper_functions.hpp"
 #include "Matrix.hpp"
 #include "SquareMatrix.hpp"
+#include "SymmetricMatrix.hpp"
 #include "Slice.hpp"
 #include "Vector.hpp"
 #include "Vector2.hpp"
@@ -21,3 +22,4 @@
 #include "Dual.hpp"
 #include "PseudoInverse.hpp"
 #include "SparseVector.hpp"
+#include "Expression.hpp"
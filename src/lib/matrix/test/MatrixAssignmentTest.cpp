@@ -34,6 +34,9 @@
 #include <gtest/gtest.h>
 #include <matrix/math.hpp>
 
+#include <stdlib.h>
+#include <unistd.h>
+
 using namespace matrix;
 
 TEST(MatrixAssignmentTest, Assignment)
@@ -273,13 +276,18 @@ TEST(MatrixAssignmentTest, Assignment)
 	}
 
 	// check print()
-	// Redirect stdout
-	EXPECT_TRUE(freopen("testoutput.txt", "w", stdout) != NULL);
+	// Redirect stdout to a temporary file, outside of the source tree
+	char path[] = "/tmp/matrix_testoutput_XXXXXX";
+	const int fd = mkstemp(path);
+	ASSERT_GE(fd, 0);
+	close(fd);
+	EXPECT_TRUE(freopen(path, "w", stdout) != NULL);
 	// write
 	Comma.print();
 	fclose(stdout);
 	// read
-	FILE *fp = fopen("testoutput.txt", "r");
+	FILE *fp = fopen(path, "r");
+	unlink(path);
 	EXPECT_NE(fp, nullptr);
 	EXPECT_FALSE(fseek(fp, 0, SEEK_SET));
 
@@ -0,0 +1,86 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <matrix/math.hpp>
+
+using namespace matrix;
+
+TEST(MatrixExpressionTest, ElementWise)
+{
+	const Vector3f a(1.f, -2.f, 3.5f);
+	const Vector3f b(0.3f, 0.7f, -1.1f);
+	const Vector3f c(-4.f, 0.25f, 2.f);
+	const Vector3f kp(1.5f, 1.5f, 4.f);
+	const Vector3f kd(0.2f, 0.2f, 0.5f);
+	const float s = 9.81f;
+
+	// bit identical to the eager evaluation
+	const Vector3f eager = a.emult(kp) + b - c.emult(kd) + c * s;
+	const Vector3f lazy_result = lazy(a).emult(kp) + b - lazy(c).emult(kd) + c * s;
+	EXPECT_EQ(lazy_result, eager);
+
+	Vector3f v;
+	v = -lazy(a) * 2.f + 0.5f * lazy(b) - lazy(c) / 4.f;
+	EXPECT_EQ(v, Vector3f(-a * 2.f + b * 0.5f - c / 4.f));
+
+	v = lazy(a).edivide(lazy(kp) + kd) - (b - a);
+	EXPECT_EQ(v, Vector3f(a.edivide(kp + kd) - (b - a)));
+
+	// operands may alias the result
+	v = a;
+	v = lazy(v) + v.emult(b);
+	EXPECT_EQ(v, Vector3f(a + a.emult(b)));
+
+	v += lazy(a) - b;
+	EXPECT_EQ(v, Vector3f(a + a.emult(b) + (a - b)));
+}
+
+TEST(MatrixExpressionTest, Types)
+{
+	float data[9] = {1, 2, 3, 4, 5, 6, 7, 8, 10};
+	const SquareMatrix3f A(data);
+	const Matrix3f B = eye<float, 3>();
+
+	SquareMatrix3f C = lazy(A) - B * 2.f;
+	EXPECT_EQ(C, SquareMatrix3f(A - B * 2.f));
+
+	// evaluate before non element-wise operations
+	const Matrix3f D = (lazy(A) + B).eval() * A;
+	EXPECT_EQ(D, Matrix3f((A + B) * A));
+
+	const Matrix<float, 2, 3> E = Matrix<float, 2, 3>(data);
+	const Matrix<float, 2, 3> F = -lazy(E).emult(E);
+	EXPECT_EQ(F, -E.emult(E));
+}
@@ -98,3 +98,65 @@ TEST(MatrixMultiplicationTest, Multiplication)
 	Matrix<float, 4, 2> m42_plus2 = m42 - (-2);
 	EXPECT_EQ(m42_plus2, m42_plus2_check);
 }
+
+template <size_t M, size_t N, size_t P>
+static void checkMultiplication()
+{
+	Matrix<float, M, N> A;
+	Matrix<float, N, P> B;
+
+	for (size_t i = 0; i < M; i++) {
+		for (size_t j = 0; j < N; j++) {
+			A(i, j) = static_cast<float>((i * N + j) % 7) * 0.37f - 1.1f;
+		}
+	}
+
+	for (size_t i = 0; i < N; i++) {
+		for (size_t j = 0; j < P; j++) {
+			B(i, j) = static_cast<float>((i * P + j) % 5) * -0.61f + 0.9f;
+		}
+	}
+
+	// reference: generic triple loop, and the sum of the absolute terms for the rounding error bound
+	Matrix<float, M, P> C_check;
+	Matrix<float, M, P> C_abs;
+
+	for (size_t i = 0; i < M; i++) {
+		for (size_t k = 0; k < P; k++) {
+			for (size_t j = 0; j < N; j++) {
+				C_check(i, k) += A(i, j) * B(j, k);
+				C_abs(i, k) += fabsf(A(i, j) * B(j, k));
+			}
+		}
+	}
+
+	// the kernels sum in the same order as the loop, but the compiler may contract a product and a sum
+	// into a fused multiply-add (e.g. on ARM) differently in the kernel and in the loop
+	const Matrix<float, M, P> C = A * B;
+
+	for (size_t i = 0; i < M; i++) {
+		for (size_t k = 0; k < P; k++) {
+			EXPECT_NEAR(C(i, k), C_check(i, k), N * FLT_EPSILON * C_abs(i, k))
+					<< M << "x" << N << " * " << N << "x" << P << " (" << i << ", " << k << ")";
+		}
+	}
+}
+
+TEST(MatrixMultiplicationTest, Kernels)
+{
+	// fully unrolled
+	checkMultiplication<3, 3, 3>();
+	checkMultiplication<3, 3, 1>();
+	checkMultiplication<4, 4, 4>();
+	checkMultiplication<4, 4, 1>();
+	checkMultiplication<6, 6, 1>();
+	checkMultiplication<1, 3, 3>();
+
+	// unrolled dot products
+	checkMultiplication<6, 6, 6>();
+	checkMultiplication<16, 6, 16>();
+
+	// generic
+	checkMultiplication<24, 24, 1>();
+	checkMultiplication<6, 16, 6>();
+}
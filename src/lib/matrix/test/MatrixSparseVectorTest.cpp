@@ -147,6 +147,31 @@ TEST(MatrixSparseVectorTest, quadraticForm)
 	EXPECT_FLOAT_EQ(quadraticForm(dense_matrix, sparse_vec), 204.f);
 }
 
+TEST(MatrixSparseVectorTest, multiplicationWithSymmetricMatrix)
+{
+	SquareMatrix<float, 24> dense_matrix;
+
+	for (size_t i = 0; i < 24; i++) {
+		for (size_t j = i; j < 24; j++) {
+			dense_matrix(i, j) = dense_matrix(j, i) = 0.3f * i - 0.07f * j + 0.01f * i * j;
+		}
+	}
+
+	const SymmetricMatrix<float, 24> symmetric_matrix(dense_matrix);
+	const float data[6] = {0.5f, -1.2f, 0.9f, 2.f, -0.3f, 1.1f};
+	const SparseVectorf<24, 0, 1, 2, 3, 22, 23> sparse_vec(data);
+
+	// bit exact with the dense product
+	const Vector<float, 24> res_sparse = symmetric_matrix * sparse_vec;
+	const Vector<float, 24> res_dense = dense_matrix * sparse_vec;
+
+	for (size_t i = 0; i < 24; i++) {
+		EXPECT_EQ(res_sparse(i), res_dense(i));
+	}
+
+	EXPECT_EQ(quadraticForm(symmetric_matrix, sparse_vec), quadraticForm(dense_matrix, sparse_vec));
+}
+
 TEST(MatrixSparseVectorTest, norms)
 {
 	const float data[2] = {3.f, 4.f};
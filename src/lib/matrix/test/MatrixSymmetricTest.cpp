@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <matrix/math.hpp>
+
+using namespace matrix;
+
+namespace
+{
+template <size_t M>
+SquareMatrix<float, M> makeSymmetric()
+{
+	SquareMatrix<float, M> A;
+
+	for (size_t i = 0; i < M; i++) {
+		for (size_t j = i; j < M; j++) {
+			A(i, j) = A(j, i) = 0.1f * (i + 1) + 0.01f * (j + 1);
+		}
+	}
+
+	return A;
+}
+} // namespace
+
+TEST(MatrixSymmetricTest, storage)
+{
+	EXPECT_EQ((SymmetricMatrix<float, 24>::SIZE), 300u);
+	EXPECT_EQ(sizeof(SymmetricMatrix<float, 24>), 300 * sizeof(float));
+
+	SymmetricMatrix<float, 5> S;
+	size_t idx = 0;
+
+	for (size_t i = 0; i < 5; i++) {
+		for (size_t j = i; j < 5; j++) {
+			EXPECT_EQ((SymmetricMatrix<float, 5>::index(i, j)), idx);
+			EXPECT_EQ((SymmetricMatrix<float, 5>::index(j, i)), idx);
+			idx++;
+		}
+	}
+
+	S(3, 1) = 2.f;
+	EXPECT_FLOAT_EQ(S(1, 3), 2.f);
+	EXPECT_FLOAT_EQ(S.data()[(SymmetricMatrix<float, 5>::index(1, 3))], 2.f);
+}
+
+TEST(MatrixSymmetricTest, conversion)
+{
+	const SquareMatrix<float, 6> A = makeSymmetric<6>();
+	const SymmetricMatrix<float, 6> S(A);
+
+	EXPECT_EQ(S.dense(), A);
+	EXPECT_EQ(S.diag(), A.diag());
+
+	const SquareMatrix<float, 3> block = S.slice<3>(2);
+	EXPECT_EQ(block, (SquareMatrix<float, 3>(A.slice<3, 3>(2, 2))));
+
+	SymmetricMatrix<float, 6> T;
+	T.setSlice<3>(2, block);
+	EXPECT_EQ(T.slice<3>(2), block);
+	EXPECT_FLOAT_EQ(T(0, 2), 0.f);
+	EXPECT_FLOAT_EQ(T(5, 4), 0.f);
+
+	T.setZero();
+	EXPECT_EQ(T.dense(), (SquareMatrix<float, 6>()));
+}
+
+TEST(MatrixSymmetricTest, uncorrelateCovariance)
+{
+	const SquareMatrix<float, 6> A = makeSymmetric<6>();
+
+	SquareMatrix<float, 6> A_check = A;
+	SymmetricMatrix<float, 6> S(A);
+	A_check.uncorrelateCovariance<2>(1);
+	S.uncorrelateCovariance<2>(1);
+	EXPECT_EQ(S.dense(), A_check);
+
+	A_check.uncorrelateCovarianceSetVariance<3>(3, 4.f);
+	S.uncorrelateCovarianceSetVariance<3>(3, 4.f);
+	EXPECT_EQ(S.dense(), A_check);
+
+	const Vector2f var(1.f, 2.f);
+	A_check = A;
+	S = SymmetricMatrix<float, 6>(A);
+	A_check.uncorrelateCovarianceSetVariance<2>(0, var);
+	S.uncorrelateCovarianceSetVariance<2>(0, var);
+	EXPECT_EQ(S.dense(), A_check);
+
+	A_check = A;
+	S = SymmetricMatrix<float, 6>(A);
+	A_check.slice<4, 2>(2, 0) = 0.f;
+	A_check.slice<2, 4>(0, 2) = 0.f;
+	S.uncorrelateCovarianceBlock<2>(0);
+	EXPECT_EQ(S.dense(), A_check);
+}
+
+TEST(MatrixSymmetricTest, subtractSymmetrized)
+{
+	// reference: dense P -= K * HP followed by averaging of the off diagonal elements
+	const SquareMatrix<float, 24> P = makeSymmetric<24>();
+	Vector<float, 24> K;
+	Vector<float, 24> HP;
+
+	for (size_t i = 0; i < 24; i++) {
+		K(i) = 0.013f * (i + 1);
+		HP(i) = 0.17f - 0.021f * i;
+	}
+
+	SquareMatrix<float, 24> KHP;
+
+	for (size_t i = 0; i < 24; i++) {
+		for (size_t j = 0; j < 24; j++) {
+			KHP(i, j) = K(i) * HP(j);
+		}
+	}
+
+	SquareMatrix<float, 24> P_check = P;
+	P_check -= KHP;
+	P_check.makeRowColSymmetric<24>(0);
+
+	SymmetricMatrix<float, 24> S(P);
+	S.subtractSymmetrized(K, HP);
+
+	// bit exact
+	for (size_t i = 0; i < 24; i++) {
+		for (size_t j = 0; j < 24; j++) {
+			EXPECT_EQ(S(i, j), P_check(i, j)) << "(" << i << ", " << j << ")";
+		}
+	}
+
+	// same update with a generic element function
+	SymmetricMatrix<float, 24> S2(P);
+	S2.subtractSymmetrized([&K, &HP](size_t row, size_t col) { return K(row) * HP(col); });
+	EXPECT_EQ(S2.dense(), S.dense());
+}
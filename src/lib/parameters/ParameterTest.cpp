@@ -78,6 +78,69 @@ TEST_F(ParameterTest, testParamReadWrite)
 	EXPECT_FLOAT_EQ(42.f, value2);
 }
 
+TEST_F(ParameterTest, testParamVersion)
+{
+	// GIVEN: two parameters and the current version
+	param_t param_dist = param_handle(px4::params::CP_DIST);
+	param_t param_delay = param_handle(px4::params::CP_DELAY);
+	const uint32_t version = param_get_version();
+
+	// THEN: nothing changed since then, but everything since version 0
+	EXPECT_FALSE(param_changed_since(param_dist, version));
+	EXPECT_FALSE(param_changed_since(param_delay, version));
+	EXPECT_TRUE(param_changed_since(param_dist, 0));
+
+	// WHEN: we set one of them
+	float value = 42.f;
+	EXPECT_EQ(0, param_set_no_notification(param_dist, &value));
+
+	// THEN: only that one changed, and the version increased
+	EXPECT_TRUE(param_changed_since(param_dist, version));
+	EXPECT_FALSE(param_changed_since(param_delay, version));
+	EXPECT_GT(param_get_version(), version);
+
+	// WHEN: we set the same value again
+	const uint32_t version2 = param_get_version();
+	EXPECT_EQ(0, param_set_no_notification(param_dist, &value));
+
+	// THEN: it did not change
+	EXPECT_FALSE(param_changed_since(param_dist, version2));
+	EXPECT_EQ(version2, param_get_version());
+
+	// WHEN: we reset it to the default
+	EXPECT_EQ(0, param_reset_no_notification(param_dist));
+
+	// THEN: all parameters count as changed
+	EXPECT_TRUE(param_changed_since(param_dist, version2));
+	EXPECT_TRUE(param_changed_since(param_delay, version2));
+	EXPECT_FALSE(param_changed_since(param_delay, param_get_version()));
+}
+
+TEST_F(ParameterTest, testParamVersionUsed)
+{
+	// GIVEN: a parameter that is not used yet and the current version
+	param_t param_dist = param_handle(px4::params::CP_DIST);
+	param_t param_unused = PARAM_INVALID;
+
+	for (param_t param = 0; param < param_count(); param++) {
+		if (!param_used(param) && param != param_dist) {
+			param_unused = param;
+			break;
+		}
+	}
+
+	ASSERT_NE(param_unused, PARAM_INVALID);
+	const uint32_t version = param_get_version();
+
+	// WHEN: it gets used
+	param_set_used(param_unused);
+
+	// THEN: only that one changed
+	EXPECT_TRUE(param_changed_since(param_unused, version));
+	EXPECT_FALSE(param_changed_since(param_dist, version));
+	EXPECT_FALSE(param_changed_since(param_unused, param_get_version()));
+}
+
 
 TEST_F(ParameterTest, testUorbSendReceive)
 {
@@ -72,6 +72,7 @@
 struct param_wbuf_s {
 	union param_value_u     val;
 	param_t                 param;
+	uint32_t                version;
 };
 
 static int
@@ -433,6 +433,27 @@ __EXPORT int 		param_load_default(void);
  */
 __EXPORT uint32_t	param_hash_check(void);
 
+/**
+ * Get the current parameter version.
+ *
+ * The version is incremented with every change of a parameter value and of the set of used parameters.
+ *
+ * @return		The current version, always > 0
+ */
+__EXPORT uint32_t	param_get_version(void);
+
+/**
+ * Check if a parameter changed after a given version.
+ *
+ * Changes to non-default values and newly used parameters are tracked per parameter. All other
+ * changes (reset to default, new default value) mark all parameters as changed.
+ *
+ * @param param		A handle returned by param_find or passed by param_foreach.
+ * @param version	A version previously returned by param_get_version(), 0 for all parameters.
+ * @return		true if the parameter might have changed after version.
+ */
+__EXPORT bool		param_changed_since(param_t param, uint32_t version);
+
 /**
  * Print the status of the param system
  *
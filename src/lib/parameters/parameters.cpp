@@ -104,8 +104,71 @@ static px4::AtomicBitset<param_info_count> params_unsaved;
 struct param_wbuf_s {
 	union param_value_u val;
 	param_t             param;
+	uint32_t            version; ///< param_version at the last change of the value
 };
 
+// parameter versions (see param_get_version()), both start at 1 so that version 0 means "everything"
+static px4::atomic<uint32_t> param_version{1};
+static px4::atomic<uint32_t> param_untracked_change_version{1}; ///< last change not tracked per parameter
+
+/** mark a change that cannot be tracked per parameter: all parameters count as changed */
+static void param_untracked_change()
+{
+	param_untracked_change_version.store(param_version.fetch_add(1) + 1);
+}
+
+// recently used parameters (param_set_used()), so that a parameter found late only counts as changed itself
+static constexpr unsigned PARAM_USED_CHANGES_MAX = 16;
+static struct {
+	param_t param;
+	uint32_t version;
+} param_used_changes[PARAM_USED_CHANGES_MAX] {};
+static unsigned param_used_changes_count = 0; ///< total number of entries ever added
+static px4_sem_t param_used_changes_lock; ///< this protects param_used_changes and param_used_changes_count
+
+/** mark a parameter as newly used: it counts as changed */
+static void param_used_change(param_t param)
+{
+	do {} while (px4_sem_wait(&param_used_changes_lock) != 0);
+
+	auto &entry = param_used_changes[param_used_changes_count % PARAM_USED_CHANGES_MAX];
+
+	if (param_used_changes_count >= PARAM_USED_CHANGES_MAX) {
+		// the oldest entry gets overwritten: everything before it is no longer tracked per parameter
+		uint32_t untracked = param_untracked_change_version.load();
+
+		while (untracked < entry.version
+		       && !param_untracked_change_version.compare_exchange(&untracked, entry.version)) {
+			// retry with the updated value
+		}
+	}
+
+	entry.param = param;
+	entry.version = param_version.fetch_add(1) + 1;
+	param_used_changes_count++;
+
+	px4_sem_post(&param_used_changes_lock);
+}
+
+/** check if a parameter became used after version */
+static bool param_used_changed_since(param_t param, uint32_t version)
+{
+	bool changed = false;
+
+	do {} while (px4_sem_wait(&param_used_changes_lock) != 0);
+
+	const unsigned count = (param_used_changes_count < PARAM_USED_CHANGES_MAX) ? param_used_changes_count :
+			       PARAM_USED_CHANGES_MAX;
+
+	for (unsigned i = 0; i < count && !changed; i++) {
+		changed = (param_used_changes[i].param == param) && (param_used_changes[i].version > version);
+	}
+
+	px4_sem_post(&param_used_changes_lock);
+
+	return changed;
+}
+
 /** flexible array holding modified parameter values */
 UT_array *param_values{nullptr};
 UT_array *param_custom_default_values{nullptr};
@@ -192,6 +255,7 @@ param_init()
 	px4_sem_init(&param_sem, 0, 1);
 	px4_sem_init(&param_sem_save, 0, 1);
 	px4_sem_init(&reader_lock_holders_lock, 0, 1);
+	px4_sem_init(&param_used_changes_lock, 0, 1);
 
 	param_export_perf = perf_alloc(PC_ELAPSED, "param: export");
 	param_find_perf = perf_alloc(PC_COUNT, "param: find");
@@ -749,8 +813,12 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 			}
 		}
 
-		if ((result == PX4_OK) && param_changed && !mark_saved) { // this is false when importing parameters
-			param_autosave();
+		if ((result == PX4_OK) && param_changed) {
+			s->version = param_version.fetch_add(1) + 1;
+
+			if (!mark_saved) { // this is false when importing parameters
+				param_autosave();
+			}
 		}
 	}
 
@@ -802,8 +870,9 @@ bool param_used(param_t param)
 
 void param_set_used(param_t param)
 {
-	if (handle_in_range(param)) {
+	if (handle_in_range(param) && !params_active[param]) {
 		params_active.set(param, true);
+		param_used_change(param);
 	}
 }
 
@@ -904,6 +973,10 @@ int param_set_default_value(param_t param, const void *val)
 		}
 	}
 
+	if (result == PX4_OK) {
+		param_untracked_change();
+	}
+
 	param_unlock_writer();
 
 	if ((result == PX4_OK) && param_used(param)) {
@@ -929,6 +1002,7 @@ static int param_reset_internal(param_t param, bool notify = true)
 		if (s != nullptr) {
 			int pos = utarray_eltidx(param_values, s);
 			utarray_erase(param_values, pos, 1);
+			param_untracked_change();
 		}
 
 		params_changed.set(param, false);
@@ -964,6 +1038,7 @@ param_reset_all_internal(bool auto_save)
 
 	/* mark as reset / deleted */
 	param_values = nullptr;
+	param_untracked_change();
 
 	if (auto_save) {
 		param_autosave();
@@ -1704,6 +1779,33 @@ uint32_t param_hash_check()
 	return param_hash;
 }
 
+uint32_t param_get_version()
+{
+	return param_version.load();
+}
+
+bool param_changed_since(param_t param, uint32_t version)
+{
+	if (!handle_in_range(param)) {
+		return false;
+	}
+
+	if (version < param_untracked_change_version.load()) {
+		return true;
+	}
+
+	if (param_used_changed_since(param, version)) {
+		return true;
+	}
+
+	param_lock_reader();
+	const param_wbuf_s *s = param_find_changed(param);
+	const bool changed = (s != nullptr) && (s->version > version);
+	param_unlock_reader();
+
+	return changed;
+}
+
 void param_print_status()
 {
 	PX4_INFO("summary: %d/%d (used/total)", param_count_used(), param_count());
@@ -187,6 +187,18 @@ int	param_ioctl(unsigned int cmd, unsigned long arg)
 		}
 		break;
 
+	case PARAMIOCVERSION: {
+			paramiocversion_t *data = (paramiocversion_t *)arg;
+			data->ret = param_get_version();
+		}
+		break;
+
+	case PARAMIOCCHANGEDSINCE: {
+			paramiocchangedsince_t *data = (paramiocchangedsince_t *)arg;
+			data->ret = param_changed_since(data->param, data->version);
+		}
+		break;
+
 	default:
 		ret = -ENOTTY;
 		break;
@@ -159,4 +159,16 @@ typedef struct paramiochash {
 	uint32_t ret;
 } paramiochash_t;
 
+#define PARAMIOCVERSION	_PARAMIOC(19)
+typedef struct paramiocversion {
+	uint32_t ret;
+} paramiocversion_t;
+
+#define PARAMIOCCHANGEDSINCE	_PARAMIOC(20)
+typedef struct paramiocchangedsince {
+	const param_t param;
+	const uint32_t version;
+	bool ret;
+} paramiocchangedsince_t;
+
 int param_ioctl(unsigned int cmd, unsigned long arg);
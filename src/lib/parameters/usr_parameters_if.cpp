@@ -218,3 +218,17 @@ uint32_t param_hash_check()
 	boardctl(PARAMIOCHASH, reinterpret_cast<unsigned long>(&data));
 	return data.ret;
 }
+
+uint32_t param_get_version()
+{
+	paramiocversion_t data = {0};
+	boardctl(PARAMIOCVERSION, reinterpret_cast<unsigned long>(&data));
+	return data.ret;
+}
+
+bool param_changed_since(param_t param, uint32_t version)
+{
+	paramiocchangedsince_t data = {param, version, true};
+	boardctl(PARAMIOCCHANGEDSINCE, reinterpret_cast<unsigned long>(&data));
+	return data.ret;
+}
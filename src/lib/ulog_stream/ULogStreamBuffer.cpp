@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file ULogStreamBuffer.cpp
+ */
+
+#include "ULogStreamBuffer.hpp"
+
+#include <errno.h>
+
+constexpr size_t ULogStreamBuffer::DATA_LEN;
+constexpr uint8_t ULogStreamBuffer::NO_MESSAGE_START;
+constexpr int ULogStreamBuffer::ACK_TIMEOUT_MS;
+constexpr int ULogStreamBuffer::ACK_MAX_TRIES;
+constexpr uint16_t ULogStreamBuffer::CAPACITY;
+
+px4::atomic<ULogStreamBuffer *> ULogStreamBuffer::_instance{nullptr};
+
+ULogStreamBuffer::ULogStreamBuffer()
+{
+	pthread_mutex_init(&_mutex, nullptr);
+}
+
+ULogStreamBuffer *ULogStreamBuffer::create()
+{
+	if (_instance.load() == nullptr) {
+		_instance.store(new ULogStreamBuffer());
+	}
+
+	return _instance.load();
+}
+
+void ULogStreamBuffer::reset()
+{
+	lock();
+	_head = 0;
+	_tail = 0;
+	_count = 0;
+	_next_sequence = 0;
+	_session++;
+	_chunks[_head].length = 0;
+	_chunks[_head].first_message_offset = 0;
+	unlock();
+}
+
+bool ULogStreamBuffer::commit(bool need_ack)
+{
+	lock();
+
+	if (_count >= CAPACITY) {
+		unlock();
+		return false;
+	}
+
+	Chunk &chunk = _chunks[_head];
+	chunk.sequence = _next_sequence++;
+	chunk.need_ack = need_ack;
+	chunk.acked = false;
+	chunk.tries = 0;
+	chunk.sent_time = 0;
+
+	_head = (_head + 1) % NUM_SLOTS;
+	_count++;
+
+	unlock();
+
+	Chunk &next = _chunks[_head];
+	next.length = 0;
+	next.first_message_offset = NO_MESSAGE_START;
+	return true;
+}
+
+void ULogStreamBuffer::drop()
+{
+	lock();
+	_next_sequence++;
+	unlock();
+
+	_dropped_count.fetch_add(1);
+
+	Chunk &chunk = _chunks[_head];
+	chunk.length = 0;
+	chunk.first_message_offset = NO_MESSAGE_START;
+}
+
+void ULogStreamBuffer::release()
+{
+	if (_count > 0) {
+		_tail = (_tail + 1) % NUM_SLOTS;
+		_count--;
+	}
+}
+
+int ULogStreamBuffer::next_to_send(Reader &reader, int max_pending_acks, uint64_t now, Chunk &out)
+{
+	lock();
+
+	if (_session != reader.session) {
+		// the writer started a new log
+		reader.session = _session;
+		reader.session_started = true;
+		reader.num_sent = 0;
+	}
+
+	if (!reader.session_started) {
+		unlock();
+		return 0;
+	}
+
+	// free the oldest chunks that are done: either acked or not requiring an ack
+	while (reader.num_sent > 0) {
+		const Chunk &chunk = this->chunk(0);
+
+		if (chunk.need_ack && !chunk.acked) {
+			break;
+		}
+
+		release();
+		--reader.num_sent;
+	}
+
+	// re-send the oldest chunk for which the ack timed out
+	int pending_acks = 0;
+	Chunk *selected = nullptr;
+
+	for (uint16_t i = 0; i < reader.num_sent; i++) {
+		Chunk &chunk = this->chunk(i);
+
+		if (!chunk.need_ack || chunk.acked) {
+			continue;
+		}
+
+		++pending_acks;
+
+		if (now - chunk.sent_time > (uint64_t)ACK_TIMEOUT_MS * 1000) {
+			if (chunk.tries >= ACK_MAX_TRIES) {
+				unlock();
+				return -ETIMEDOUT;
+			}
+
+			selected = &chunk;
+			break;
+		}
+	}
+
+	// otherwise send the next chunk, limited by the number of chunks waiting for an ack
+	if (!selected && (reader.num_sent < _count)) {
+		Chunk &chunk = this->chunk(reader.num_sent);
+
+		if (!chunk.need_ack || (pending_acks < max_pending_acks)) {
+			selected = &chunk;
+			++reader.num_sent;
+		}
+	}
+
+	if (!selected) {
+		unlock();
+		return 0;
+	}
+
+	selected->sent_time = now;
+	++selected->tries;
+	out = *selected;
+
+	unlock();
+	return 1;
+}
+
+bool ULogStreamBuffer::ack(Reader &reader, uint16_t sequence)
+{
+	bool found = false;
+
+	lock();
+
+	if (reader.session == _session) {
+		const uint16_t num_sent = (reader.num_sent < _count) ? reader.num_sent : _count;
+
+		for (uint16_t i = 0; i < num_sent; i++) {
+			Chunk &chunk = this->chunk(i);
+
+			if (chunk.need_ack && (chunk.sequence == sequence)) {
+				chunk.acked = true;
+				found = true;
+				break;
+			}
+		}
+	}
+
+	unlock();
+	return found;
+}
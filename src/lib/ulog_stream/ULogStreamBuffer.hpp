@@ -0,0 +1,185 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file ULogStreamBuffer.hpp
+ *
+ * Ring buffer of ULog data chunks shared between the logger (writer) and the
+ * MAVLink ULog streaming (reader). Every chunk is the payload of one
+ * LOGGING_DATA or LOGGING_DATA_ACKED message. The logger fills the chunks in
+ * place. The reader copies the next chunk to send out of the buffer under the
+ * lock and transmits the copy, keeping chunks that need an ack in the buffer
+ * until the ack arrives, so that they can be sent again.
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <px4_platform_common/atomic.h>
+
+class ULogStreamBuffer
+{
+public:
+	static constexpr size_t DATA_LEN{249};			///< LOGGING_DATA(_ACKED) data length
+	static constexpr uint8_t NO_MESSAGE_START{255};	///< first_message_offset if no ULog message starts in a chunk
+
+	static constexpr int ACK_TIMEOUT_MS{50};		///< timeout waiting for an ack until the chunk is sent again
+	static constexpr int ACK_MAX_TRIES{50};			///< maximum number of transmissions of a chunk
+
+#if defined(__PX4_NUTTX)
+	static constexpr uint16_t CAPACITY{16};
+#else
+	static constexpr uint16_t CAPACITY{64};
+#endif
+
+	struct Chunk {
+		uint64_t sent_time;		///< reader: time of the last transmission [us], 0 if not sent yet
+		uint16_t sequence;
+		uint8_t length;			///< number of valid bytes in data
+		uint8_t first_message_offset;	///< offset of the first ULog message starting in data or NO_MESSAGE_START
+		uint8_t tries;			///< reader: number of transmissions
+		bool need_ack;
+		bool acked;			///< reader: ack received
+		uint8_t data[DATA_LEN];
+	};
+
+	/**
+	 * State of the reader, owned by the reader and passed to the reader interface
+	 */
+	struct Reader {
+		uint32_t session{0};		///< session the sent chunks belong to
+		bool session_started{false};	///< the writer started a new session since the reader was created
+		uint16_t num_sent{0};		///< number of the oldest committed chunks sent at least once
+	};
+
+	/**
+	 * Create the shared instance, or return the existing one. Called by the logger.
+	 * The instance is never freed.
+	 */
+	static ULogStreamBuffer *create();
+
+	/**
+	 * @return the shared instance, nullptr if no log stream has been started so far
+	 */
+	static ULogStreamBuffer *get() { return _instance.load(); }
+
+	void lock() { pthread_mutex_lock(&_mutex); }
+	void unlock() { pthread_mutex_unlock(&_mutex); }
+
+	/* writer interface */
+
+	/**
+	 * Drop all chunks and restart the sequence for a new log. Increments the session.
+	 */
+	void reset();
+
+	/**
+	 * The chunk the writer fills, it is not visible to the reader before commit()
+	 */
+	Chunk &write_chunk() { return _chunks[_head]; }
+
+	/**
+	 * Pass the write chunk to the reader and start a new one
+	 * @return false if the buffer is full (the write chunk is kept)
+	 */
+	bool commit(bool need_ack);
+
+	/**
+	 * Discard the data of the write chunk. Its sequence number is skipped, so that
+	 * the receiver can detect the gap.
+	 */
+	void drop();
+
+	uint32_t dropped_count() const { return _dropped_count.load(); }
+
+	/* reader interface */
+
+	/**
+	 * Select the next chunk to transmit and copy it to out. Frees the oldest chunks that are done
+	 * (acked or not requiring an ack), then selects the oldest chunk whose ack timed out, or else
+	 * the next unsent chunk as long as fewer than max_pending_acks chunks wait for an ack.
+	 * The selected chunk is marked as sent at time now.
+	 * @return 1 if a chunk was copied to out, 0 if there is nothing to send,
+	 *         -ETIMEDOUT if a chunk was sent ACK_MAX_TRIES times without an ack
+	 */
+	int next_to_send(Reader &reader, int max_pending_acks, uint64_t now, Chunk &out);
+
+	/**
+	 * Mark the sent chunk with the given sequence as acked
+	 * @return true if the chunk was found
+	 */
+	bool ack(Reader &reader, uint16_t sequence);
+
+	/* low-level reader interface, all calls require lock() */
+
+	uint32_t session() const { return _session; }
+
+	/**
+	 * @return number of committed chunks
+	 */
+	uint16_t available() const { return _count; }
+
+	/**
+	 * @return i-th oldest committed chunk, i < available()
+	 */
+	Chunk &chunk(uint16_t i) { return _chunks[(_tail + i) % NUM_SLOTS]; }
+
+	/**
+	 * Free the oldest chunk
+	 */
+	void release();
+
+private:
+	ULogStreamBuffer();
+	~ULogStreamBuffer() = delete;
+
+	static px4::atomic<ULogStreamBuffer *> _instance;
+
+	static constexpr uint16_t NUM_SLOTS{CAPACITY + 1}; ///< committed chunks and the write chunk
+
+	pthread_mutex_t _mutex{};
+
+	Chunk _chunks[NUM_SLOTS] {};
+
+	uint16_t _head{0};	///< index of the write chunk
+	uint16_t _tail{0};	///< index of the oldest committed chunk
+	uint16_t _count{0};	///< number of committed chunks
+
+	uint16_t _next_sequence{0};
+	uint32_t _session{0};
+	px4::atomic<uint32_t> _dropped_count{0};
+};
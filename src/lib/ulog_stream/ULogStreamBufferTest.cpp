@@ -0,0 +1,309 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file ULogStreamBufferTest.cpp
+ * Tests for the ULog stream ring buffer.
+ */
+
+#include <errno.h>
+
+#include <gtest/gtest.h>
+
+#include "ULogStreamBuffer.hpp"
+
+class ULogStreamBufferTest : public ::testing::Test
+{
+public:
+	void SetUp() override
+	{
+		buffer = ULogStreamBuffer::create();
+		ASSERT_NE(buffer, nullptr);
+		buffer->reset();
+	}
+
+	ULogStreamBuffer *buffer{nullptr};
+};
+
+TEST_F(ULogStreamBufferTest, SharedInstance)
+{
+	EXPECT_EQ(ULogStreamBuffer::get(), buffer);
+	EXPECT_EQ(ULogStreamBuffer::create(), buffer);
+}
+
+TEST_F(ULogStreamBufferTest, CommitAndRelease)
+{
+	// a log starts with a ULog message
+	EXPECT_EQ(buffer->write_chunk().first_message_offset, 0);
+
+	buffer->write_chunk().data[0] = 42;
+	buffer->write_chunk().length = 1;
+	EXPECT_TRUE(buffer->commit(true));
+
+	// the new write chunk is empty
+	EXPECT_EQ(buffer->write_chunk().length, 0);
+	EXPECT_EQ(buffer->write_chunk().first_message_offset, ULogStreamBuffer::NO_MESSAGE_START);
+
+	buffer->lock();
+	ASSERT_EQ(buffer->available(), 1);
+	const ULogStreamBuffer::Chunk &chunk = buffer->chunk(0);
+	EXPECT_EQ(chunk.sequence, 0);
+	EXPECT_EQ(chunk.length, 1);
+	EXPECT_EQ(chunk.data[0], 42);
+	EXPECT_TRUE(chunk.need_ack);
+	EXPECT_FALSE(chunk.acked);
+	EXPECT_EQ(chunk.tries, 0);
+	buffer->release();
+	EXPECT_EQ(buffer->available(), 0);
+	buffer->unlock();
+}
+
+TEST_F(ULogStreamBufferTest, Full)
+{
+	for (uint16_t i = 0; i < ULogStreamBuffer::CAPACITY; i++) {
+		buffer->write_chunk().data[0] = i;
+		buffer->write_chunk().length = 1;
+		EXPECT_TRUE(buffer->commit(false));
+	}
+
+	// the write chunk is kept if the buffer is full
+	buffer->write_chunk().data[0] = 0xff;
+	buffer->write_chunk().length = 1;
+	EXPECT_FALSE(buffer->commit(false));
+	EXPECT_EQ(buffer->write_chunk().length, 1);
+
+	buffer->lock();
+	EXPECT_EQ(buffer->available(), ULogStreamBuffer::CAPACITY);
+
+	for (uint16_t i = 0; i < ULogStreamBuffer::CAPACITY; i++) {
+		EXPECT_EQ(buffer->chunk(i).sequence, i);
+		EXPECT_EQ(buffer->chunk(i).data[0], i & 0xff);
+	}
+
+	buffer->release();
+	buffer->unlock();
+
+	EXPECT_TRUE(buffer->commit(false));
+
+	buffer->lock();
+	EXPECT_EQ(buffer->available(), ULogStreamBuffer::CAPACITY);
+	EXPECT_EQ(buffer->chunk(ULogStreamBuffer::CAPACITY - 1).sequence, ULogStreamBuffer::CAPACITY);
+	EXPECT_EQ(buffer->chunk(ULogStreamBuffer::CAPACITY - 1).data[0], 0xff);
+	buffer->unlock();
+}
+
+TEST_F(ULogStreamBufferTest, DropSkipsSequence)
+{
+	buffer->write_chunk().length = 10;
+	EXPECT_TRUE(buffer->commit(false));
+
+	const uint32_t dropped = buffer->dropped_count();
+	buffer->write_chunk().length = 10;
+	buffer->drop();
+	EXPECT_EQ(buffer->write_chunk().length, 0);
+	EXPECT_EQ(buffer->dropped_count(), dropped + 1);
+
+	buffer->write_chunk().length = 10;
+	EXPECT_TRUE(buffer->commit(false));
+
+	buffer->lock();
+	ASSERT_EQ(buffer->available(), 2);
+	EXPECT_EQ(buffer->chunk(0).sequence, 0);
+	EXPECT_EQ(buffer->chunk(1).sequence, 2);
+	buffer->unlock();
+}
+
+TEST_F(ULogStreamBufferTest, ResetStartsNewSession)
+{
+	buffer->write_chunk().length = 10;
+	EXPECT_TRUE(buffer->commit(true));
+
+	buffer->lock();
+	const uint32_t session = buffer->session();
+	buffer->unlock();
+
+	buffer->reset();
+
+	buffer->lock();
+	EXPECT_NE(buffer->session(), session);
+	EXPECT_EQ(buffer->available(), 0);
+	buffer->unlock();
+
+	EXPECT_TRUE(buffer->commit(true));
+
+	buffer->lock();
+	EXPECT_EQ(buffer->chunk(0).sequence, 0);
+	buffer->unlock();
+}
+
+TEST_F(ULogStreamBufferTest, ReaderWaitsForNewSession)
+{
+	ULogStreamBuffer::Reader reader{};
+	ULogStreamBuffer::Chunk out{};
+
+	buffer->lock();
+	reader.session = buffer->session();
+	buffer->unlock();
+
+	// chunks of a log started before the reader are not sent
+	EXPECT_TRUE(buffer->commit(false));
+	EXPECT_EQ(buffer->next_to_send(reader, 1, 1000, out), 0);
+
+	buffer->reset();
+	EXPECT_TRUE(buffer->commit(false));
+	EXPECT_EQ(buffer->next_to_send(reader, 1, 1000, out), 1);
+	EXPECT_EQ(out.sequence, 0);
+	EXPECT_EQ(buffer->next_to_send(reader, 1, 1000, out), 0);
+}
+
+TEST_F(ULogStreamBufferTest, AckWindow)
+{
+	ULogStreamBuffer::Reader reader{};
+	ULogStreamBuffer::Chunk out{};
+	buffer->reset();
+
+	// acked, unacked, acked, acked
+	buffer->write_chunk().data[0] = 7;
+	buffer->write_chunk().length = 1;
+	EXPECT_TRUE(buffer->commit(true));
+	EXPECT_TRUE(buffer->commit(false));
+	EXPECT_TRUE(buffer->commit(true));
+	EXPECT_TRUE(buffer->commit(true));
+
+	const uint64_t now = 1000000;
+
+	// a copy of the chunk is returned and marked as sent in the buffer
+	ASSERT_EQ(buffer->next_to_send(reader, 1, now, out), 1);
+	EXPECT_EQ(out.sequence, 0);
+	EXPECT_EQ(out.length, 1);
+	EXPECT_EQ(out.data[0], 7);
+	EXPECT_EQ(out.tries, 1);
+	EXPECT_EQ(out.sent_time, now);
+
+	// chunks without an ack are not limited by the window, the next acked one is
+	ASSERT_EQ(buffer->next_to_send(reader, 1, now, out), 1);
+	EXPECT_EQ(out.sequence, 1);
+	EXPECT_EQ(buffer->next_to_send(reader, 1, now, out), 0);
+
+	// unknown sequence
+	EXPECT_FALSE(buffer->ack(reader, 2));
+
+	// the ack frees the chunks up to the next one waiting for an ack and opens the window
+	EXPECT_TRUE(buffer->ack(reader, 0));
+	ASSERT_EQ(buffer->next_to_send(reader, 1, now, out), 1);
+	EXPECT_EQ(out.sequence, 2);
+
+	buffer->lock();
+	EXPECT_EQ(buffer->available(), 2);
+	buffer->unlock();
+
+	EXPECT_EQ(buffer->next_to_send(reader, 1, now, out), 0);
+
+	// a larger window
+	ASSERT_EQ(buffer->next_to_send(reader, 2, now, out), 1);
+	EXPECT_EQ(out.sequence, 3);
+	EXPECT_EQ(buffer->next_to_send(reader, 2, now, out), 0);
+
+	EXPECT_TRUE(buffer->ack(reader, 3));
+	EXPECT_TRUE(buffer->ack(reader, 2));
+	EXPECT_EQ(buffer->next_to_send(reader, 1, now, out), 0);
+
+	buffer->lock();
+	EXPECT_EQ(buffer->available(), 0);
+	buffer->unlock();
+}
+
+TEST_F(ULogStreamBufferTest, Retransmit)
+{
+	ULogStreamBuffer::Reader reader{};
+	ULogStreamBuffer::Chunk out{};
+	buffer->reset();
+
+	EXPECT_TRUE(buffer->commit(true));
+	EXPECT_TRUE(buffer->commit(true));
+
+	const uint64_t timeout = ULogStreamBuffer::ACK_TIMEOUT_MS * 1000;
+	uint64_t now = 1000000;
+
+	ASSERT_EQ(buffer->next_to_send(reader, 1, now, out), 1);
+	EXPECT_EQ(out.sequence, 0);
+
+	// no retransmission before the timeout
+	now += timeout;
+	EXPECT_EQ(buffer->next_to_send(reader, 1, now, out), 0);
+
+	// the chunk is sent again after the timeout, the next one is held back by the window
+	now += 1;
+	ASSERT_EQ(buffer->next_to_send(reader, 1, now, out), 1);
+	EXPECT_EQ(out.sequence, 0);
+	EXPECT_EQ(out.tries, 2);
+	EXPECT_EQ(buffer->next_to_send(reader, 1, now, out), 0);
+
+	// a late ack of the first transmission
+	EXPECT_TRUE(buffer->ack(reader, 0));
+	ASSERT_EQ(buffer->next_to_send(reader, 1, now, out), 1);
+	EXPECT_EQ(out.sequence, 1);
+	EXPECT_EQ(out.tries, 1);
+
+	// give up after the maximum number of tries
+	for (int i = 1; i < ULogStreamBuffer::ACK_MAX_TRIES; i++) {
+		now += timeout + 1;
+		ASSERT_EQ(buffer->next_to_send(reader, 1, now, out), 1);
+		EXPECT_EQ(out.sequence, 1);
+		EXPECT_EQ(out.tries, i + 1);
+	}
+
+	now += timeout + 1;
+	EXPECT_EQ(buffer->next_to_send(reader, 1, now, out), -ETIMEDOUT);
+}
+
+TEST_F(ULogStreamBufferTest, AckAfterReset)
+{
+	ULogStreamBuffer::Reader reader{};
+	ULogStreamBuffer::Chunk out{};
+	buffer->reset();
+
+	EXPECT_TRUE(buffer->commit(true));
+	ASSERT_EQ(buffer->next_to_send(reader, 1, 1000, out), 1);
+
+	// an ack of the previous log does not ack the chunk with the same sequence in the new one
+	buffer->reset();
+	EXPECT_TRUE(buffer->commit(true));
+	EXPECT_FALSE(buffer->ack(reader, 0));
+
+	ASSERT_EQ(buffer->next_to_send(reader, 1, 1000, out), 1);
+	EXPECT_EQ(out.sequence, 0);
+	EXPECT_EQ(out.tries, 1);
+	EXPECT_TRUE(buffer->ack(reader, 0));
+}
@@ -0,0 +1,717 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file DatamanTest.cpp
+ * Tests of the data manager storage backends with large missions and fences, and of the batched requests.
+ *
+ * Every data manager instance runs in a child process, so that it can be killed without shutting it down and a new
+ * instance can be started on the same file.
+ */
+
+#include <gtest/gtest.h>
+
+#include "dataman.h"
+
+#include <drivers/drv_hrt.h>
+#include <px4_platform_common/atomic.h>
+
+#include <atomic>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+extern "C" int dataman_main(int argc, char *argv[]);
+
+namespace
+{
+
+constexpr const char *kFile = "dataman_test";
+
+constexpr unsigned kMissionItems = (DM_KEY_WAYPOINTS_OFFBOARD_1_MAX < 5000) ? DM_KEY_WAYPOINTS_OFFBOARD_1_MAX : 5000;
+constexpr unsigned kFencePoints = DM_KEY_FENCE_POINTS_MAX - 1; // the first item holds the stats
+
+enum class Backend {
+	File,
+	Mmap
+};
+
+bool start(Backend backend)
+{
+	const char *argv_file[] = {"dataman", "start", "-f", kFile};
+	const char *argv_mmap[] = {"dataman", "start", "-m", "-f", kFile};
+
+	if (backend == Backend::Mmap) {
+		return dataman_main(5, (char **)argv_mmap) == 0;
+	}
+
+	return dataman_main(4, (char **)argv_file) == 0;
+}
+
+mission_item_s missionItem(unsigned index, unsigned seed)
+{
+	mission_item_s item{};
+	item.lat = 47.0 + index * 1e-5 + seed;
+	item.lon = 8.0 - index * 1e-5;
+	item.altitude = (float)(index % 100);
+	item.nav_cmd = NAV_CMD_WAYPOINT;
+	return item;
+}
+
+mission_fence_point_s fencePoint(unsigned index, unsigned seed)
+{
+	mission_fence_point_s point{};
+	point.lat = 47.0 + index * 1e-4 + seed;
+	point.lon = 8.0 + index * 1e-4;
+	point.vertex_count = kFencePoints;
+	point.nav_cmd = NAV_CMD_FENCE_POLYGON_VERTEX_INCLUSION;
+	return point;
+}
+
+// write the mission item by item and the fence as one batch
+bool writeMissionAndFence(unsigned seed)
+{
+	for (unsigned i = 0; i < kMissionItems; i++) {
+		const mission_item_s item = missionItem(i, seed);
+
+		if (dm_write(DM_KEY_WAYPOINTS_OFFBOARD_1, i, &item, sizeof(item)) != sizeof(item)) {
+			return false;
+		}
+	}
+
+	mission_fence_point_s fence[kFencePoints];
+
+	for (unsigned i = 0; i < kFencePoints; i++) {
+		fence[i] = fencePoint(i, seed);
+	}
+
+	dm_request_t request{DM_REQUEST_WRITE, DM_KEY_FENCE_POINTS, 1, kFencePoints, fence, sizeof(fence[0]), 0};
+	dm_batch_t batch{};
+	batch.requests = &request;
+	batch.num_requests = 1;
+
+	return (dm_submit(&batch) == 0) && (dm_wait(&batch) == 0);
+}
+
+// number of items that do not match what writeMissionAndFence() wrote
+int verifyMissionAndFence(unsigned seed)
+{
+	int errors = 0;
+
+	for (unsigned i = 0; i < kMissionItems; i++) {
+		const mission_item_s expected = missionItem(i, seed);
+		mission_item_s item;
+
+		if ((dm_read(DM_KEY_WAYPOINTS_OFFBOARD_1, i, &item, sizeof(item)) != sizeof(item))
+		    || (memcmp(&item, &expected, sizeof(item)) != 0)) {
+			errors++;
+		}
+	}
+
+	mission_fence_point_s fence[kFencePoints];
+
+	const ssize_t count = dm_read_range(DM_KEY_FENCE_POINTS, 1, kFencePoints, fence, sizeof(mission_fence_point_s));
+	errors += kFencePoints - ((count > 0) ? count : 0);
+
+	for (ssize_t i = 0; i < count; i++) {
+		const mission_fence_point_s expected = fencePoint(i, seed);
+
+		if (memcmp(&fence[i], &expected, sizeof(expected)) != 0) {
+			errors++;
+		}
+	}
+
+	return errors;
+}
+
+// submit a batch and wait for it, return the dm_wait() result
+int submitAndWait(dm_request_t *requests, unsigned num_requests)
+{
+	dm_batch_t batch{};
+	batch.requests = requests;
+	batch.num_requests = num_requests;
+
+	if (dm_submit(&batch) != 0) {
+		return -2;
+	}
+
+	return dm_wait(&batch);
+}
+
+// run a function in a child process and return its exit status, or -signal if it was killed
+template<typename Func>
+int runInChild(Func func)
+{
+	const pid_t pid = fork();
+
+	if (pid == 0) {
+		const int ret = func();
+		fflush(stdout);
+		_exit(((ret >= 0) && (ret < 255)) ? ret : 255);
+	}
+
+	int status = 0;
+
+	if ((pid < 0) || (waitpid(pid, &status, 0) != pid)) {
+		return -1000;
+	}
+
+	return WIFSIGNALED(status) ? -WTERMSIG(status) : WEXITSTATUS(status);
+}
+
+// run a function in a child process and kill it after delay_us, return the exit status or -signal
+template<typename Func>
+int killChildAfter(Func func, useconds_t delay_us)
+{
+	const pid_t pid = fork();
+
+	if (pid == 0) {
+		_exit(func());
+	}
+
+	if (pid < 0) {
+		return -1000;
+	}
+
+	usleep(delay_us);
+	kill(pid, SIGKILL);
+
+	int status = 0;
+
+	if (waitpid(pid, &status, 0) != pid) {
+		return -1000;
+	}
+
+	return WIFSIGNALED(status) ? -WTERMSIG(status) : WEXITSTATUS(status);
+}
+
+} // namespace
+
+class DatamanTest : public ::testing::Test
+{
+public:
+	void SetUp() override { unlink(kFile); }
+	void TearDown() override { unlink(kFile); }
+};
+
+TEST_F(DatamanTest, MmapWritesSurviveCrash)
+{
+	// GIVEN: a mission and fence written through the mapping
+	// WHEN: the process is killed without stopping the data manager
+	EXPECT_EQ(runInChild([]() {
+		if (!start(Backend::Mmap) || !writeMissionAndFence(1)) {
+			return 1;
+		}
+
+		return raise(SIGKILL);
+	}), -SIGKILL);
+
+	// THEN: all items are there after a restart
+	EXPECT_EQ(runInChild([]() {
+		return start(Backend::Mmap) ? verifyMissionAndFence(1) : -1;
+	}), 0);
+}
+
+TEST_F(DatamanTest, MmapNoTornItemsAfterCrash)
+{
+	static constexpr unsigned kSeeds[] {10, 11};
+	static constexpr unsigned kItems = 100; // short passes, so that the kill lands in different passes
+
+	for (useconds_t delay_us : {20000, 35000, 50000, 75000, 110000}) {
+		// GIVEN: the mission being rewritten through the mapping over and over, with alternating contents
+		// WHEN: the process is killed in the middle of it
+		EXPECT_EQ(killChildAfter([]() {
+			if (!start(Backend::Mmap)) {
+				return 1;
+			}
+
+			for (unsigned pass = 0;; pass++) {
+				for (unsigned i = 0; i < kItems; i++) {
+					const mission_item_s item = missionItem(i, kSeeds[pass % 2]);
+					dm_write(DM_KEY_WAYPOINTS_OFFBOARD_1, i, &item, sizeof(item));
+				}
+			}
+		}, delay_us), -SIGKILL);
+
+		// THEN: after a restart every item is either empty or one of the complete versions, never a mix
+		EXPECT_EQ(runInChild([]() {
+			if (!start(Backend::Mmap)) {
+				return 255;
+			}
+
+			int torn = 0;
+
+			for (unsigned i = 0; i < kItems; i++) {
+				mission_item_s item;
+				const ssize_t len = dm_read(DM_KEY_WAYPOINTS_OFFBOARD_1, i, &item, sizeof(item));
+
+				if (len == 0) {
+					continue;
+				}
+
+				bool complete = false;
+
+				for (unsigned seed : kSeeds) {
+					const mission_item_s expected = missionItem(i, seed);
+					complete |= (len == sizeof(item)) && (memcmp(&item, &expected, sizeof(item)) == 0);
+				}
+
+				torn += complete ? 0 : 1;
+			}
+
+			return (torn < 255) ? torn : 254;
+		}), 0) << "killed after " << delay_us << " us";
+	}
+}
+
+TEST_F(DatamanTest, MmapNoTornReads)
+{
+	// GIVEN: one item rewritten through the mapping over and over, with contents that differ in every byte
+	// WHEN: a client reads it directly from the mapping at the same time
+	// THEN: every read returns one of the complete versions, never a mix of both or the cleared length
+	EXPECT_EQ(runInChild([]() {
+		if (!start(Backend::Mmap)) {
+			return 255;
+		}
+
+		static constexpr unsigned kWrites = 20000;
+		static constexpr unsigned kIndex = 7;
+
+		mission_item_s versions[2];
+		memset(&versions[0], 0x55, sizeof(versions[0]));
+		memset(&versions[1], 0xaa, sizeof(versions[1]));
+
+		if (dm_write(DM_KEY_WAYPOINTS_OFFBOARD_1, kIndex, &versions[0], sizeof(versions[0])) != sizeof(versions[0])) {
+			return 254;
+		}
+
+		// both threads wait for each other, so that all of the writes overlap with the reads
+		std::atomic<int> ready{0};
+		std::atomic<bool> writing{true};
+
+		std::thread writer([&]() {
+			ready++;
+
+			while (ready.load() < 2) {
+				std::this_thread::yield();
+			}
+
+			for (unsigned i = 0; i < kWrites; i++) {
+				dm_write(DM_KEY_WAYPOINTS_OFFBOARD_1, kIndex, &versions[i % 2], sizeof(versions[0]));
+			}
+
+			writing.store(false);
+		});
+
+		ready++;
+
+		while (ready.load() < 2) {
+			std::this_thread::yield();
+		}
+
+		unsigned reads = 0;
+		unsigned torn = 0;
+		bool seen[2] {};
+
+		while (writing.load()) {
+			mission_item_s item;
+			const ssize_t len = dm_read(DM_KEY_WAYPOINTS_OFFBOARD_1, kIndex, &item, sizeof(item));
+			bool complete = false;
+
+			for (int v = 0; v < 2; v++) {
+				if ((len == sizeof(item)) && (memcmp(&item, &versions[v], sizeof(item)) == 0)) {
+					complete = true;
+					seen[v] = true;
+				}
+			}
+
+			torn += complete ? 0 : 1;
+			reads++;
+		}
+
+		writer.join();
+
+		// the reader has to have seen both versions, otherwise the threads did not overlap
+		if (!seen[0] || !seen[1]) {
+			return 253;
+		}
+
+		return (torn < 250) ? (int)torn : 250;
+	}), 0);
+}
+
+TEST_F(DatamanTest, FileAndMmapShareTheStorageFile)
+{
+	// GIVEN: items written by the file backend
+	EXPECT_EQ(runInChild([]() {
+		return (start(Backend::File) && writeMissionAndFence(2)) ? 0 : 1;
+	}), 0);
+
+	// WHEN: the file is mapped
+	// THEN: the items are the same, and they can be overwritten
+	EXPECT_EQ(runInChild([]() {
+		if (!start(Backend::Mmap) || (verifyMissionAndFence(2) != 0)) {
+			return 1;
+		}
+
+		return writeMissionAndFence(3) ? 0 : 1;
+	}), 0);
+
+	// AND: the file backend reads what was written through the mapping
+	EXPECT_EQ(runInChild([]() {
+		return start(Backend::File) ? verifyMissionAndFence(3) : -1;
+	}), 0);
+}
+
+TEST_F(DatamanTest, BatchMergesRequests)
+{
+	EXPECT_EQ(runInChild([]() {
+		if (!start(Backend::File)) {
+			return -1;
+		}
+
+		// GIVEN: adjacent writes with adjacent buffers, and a write to a separate range
+		mission_item_s items[10];
+		mission_item_s separate[2];
+
+		for (unsigned i = 0; i < 10; i++) {
+			items[i] = missionItem(i, 5);
+		}
+
+		for (unsigned i = 0; i < 2; i++) {
+			separate[i] = missionItem(20 + i, 5);
+		}
+
+		dm_request_t writes[] {
+			{DM_REQUEST_WRITE, DM_KEY_WAYPOINTS_OFFBOARD_0, 0, 4, &items[0], sizeof(mission_item_s), 0},
+			{DM_REQUEST_WRITE, DM_KEY_WAYPOINTS_OFFBOARD_0, 4, 6, &items[4], sizeof(mission_item_s), 0},
+			{DM_REQUEST_WRITE, DM_KEY_WAYPOINTS_OFFBOARD_0, 20, 2, separate, sizeof(mission_item_s), 0},
+		};
+
+		// WHEN: they are submitted as one batch
+		// THEN: every request is complete
+		if ((submitAndWait(writes, 3) != 0) || (writes[0].result != 4) || (writes[1].result != 6)
+		    || (writes[2].result != 2)) {
+			return 1;
+		}
+
+		// AND: reads with adjacent ranges but separate buffers, and adjacent buffers but separate ranges, return the
+		// items written
+		mission_item_s first[3];
+		mission_item_s second[3];
+		mission_item_s both[4];
+
+		dm_request_t reads[] {
+			{DM_REQUEST_READ, DM_KEY_WAYPOINTS_OFFBOARD_0, 0, 3, first, sizeof(mission_item_s), 0},
+			{DM_REQUEST_READ, DM_KEY_WAYPOINTS_OFFBOARD_0, 3, 3, second, sizeof(mission_item_s), 0},
+			{DM_REQUEST_READ, DM_KEY_WAYPOINTS_OFFBOARD_0, 8, 2, &both[0], sizeof(mission_item_s), 0},
+			{DM_REQUEST_READ, DM_KEY_WAYPOINTS_OFFBOARD_0, 20, 2, &both[2], sizeof(mission_item_s), 0},
+		};
+
+		if (submitAndWait(reads, 4) != 0) {
+			return 2;
+		}
+
+		for (unsigned i = 0; i < 3; i++) {
+			if ((memcmp(&first[i], &items[i], sizeof(mission_item_s)) != 0)
+			    || (memcmp(&second[i], &items[3 + i], sizeof(mission_item_s)) != 0)) {
+				return 3;
+			}
+		}
+
+		if ((memcmp(&both[0], &items[8], 2 * sizeof(mission_item_s)) != 0)
+		    || (memcmp(&both[2], separate, 2 * sizeof(mission_item_s)) != 0)) {
+			return 4;
+		}
+
+		return 0;
+	}), 0);
+}
+
+TEST_F(DatamanTest, BatchPartialResults)
+{
+	EXPECT_EQ(runInChild([]() {
+		if (!start(Backend::File)) {
+			return -1;
+		}
+
+		// GIVEN: items 0 to 9
+		mission_item_s items[10];
+
+		for (unsigned i = 0; i < 10; i++) {
+			items[i] = missionItem(i, 6);
+		}
+
+		dm_request_t write{DM_REQUEST_WRITE, DM_KEY_WAYPOINTS_OFFBOARD_0, 0, 10, items, sizeof(mission_item_s), 0};
+
+		if (submitAndWait(&write, 1) != 0) {
+			return 1;
+		}
+
+		// WHEN: merged reads go beyond the last item, and a separate read starts at an empty item
+		mission_item_s buffer[9];
+
+		dm_request_t reads[] {
+			{DM_REQUEST_READ, DM_KEY_WAYPOINTS_OFFBOARD_0, 5, 3, &buffer[0], sizeof(mission_item_s), 0},
+			{DM_REQUEST_READ, DM_KEY_WAYPOINTS_OFFBOARD_0, 8, 4, &buffer[3], sizeof(mission_item_s), 0},
+			{DM_REQUEST_READ, DM_KEY_WAYPOINTS_OFFBOARD_0, 30, 2, &buffer[7], sizeof(mission_item_s), 0},
+		};
+
+		// THEN: the batch is incomplete, and every request reports its leading items that were read
+		if (submitAndWait(reads, 3) != -1) {
+			return 2;
+		}
+
+		if ((reads[0].result != 3) || (reads[1].result != 2) || (reads[2].result != 0)) {
+			return 3;
+		}
+
+		if (memcmp(buffer, &items[5], 5 * sizeof(mission_item_s)) != 0) {
+			return 4;
+		}
+
+		// AND: dm_read_range() returns the same count
+		return (dm_read_range(DM_KEY_WAYPOINTS_OFFBOARD_0, 8, 4, buffer, sizeof(mission_item_s)) == 2) ? 0 : 5;
+	}), 0);
+}
+
+TEST_F(DatamanTest, BatchPrefetchLargerThanCache)
+{
+	EXPECT_EQ(runInChild([]() {
+		if (!start(Backend::File) || !writeMissionAndFence(7)) {
+			return -1;
+		}
+
+		// GIVEN: a mission with more items than the cache holds (DATAMAN_MISSION_CACHE_ITEMS, 4096 on POSIX)
+		// WHEN: the whole mission is prefetched, split into two merged requests
+		const unsigned half = kMissionItems / 2;
+		dm_request_t prefetch[] {
+			{DM_REQUEST_PREFETCH, DM_KEY_WAYPOINTS_OFFBOARD_1, 0, half, nullptr, sizeof(mission_item_s), 0},
+			{DM_REQUEST_PREFETCH, DM_KEY_WAYPOINTS_OFFBOARD_1, half, kMissionItems - half, nullptr, sizeof(mission_item_s), 0},
+		};
+
+		// THEN: the capped prefetch is complete
+		if ((submitAndWait(prefetch, 2) != 0) || (prefetch[0].result != prefetch[0].count)
+		    || (prefetch[1].result != prefetch[1].count)) {
+			return 1;
+		}
+
+		// AND: a prefetch of empty items is not
+		dm_request_t empty{DM_REQUEST_PREFETCH, DM_KEY_WAYPOINTS_OFFBOARD_0, 0, 10, nullptr, sizeof(mission_item_s), 0};
+
+		if ((submitAndWait(&empty, 1) != -1) || (empty.result != 0)) {
+			return 2;
+		}
+
+		// AND: the items read through the cache are correct
+		return verifyMissionAndFence(7);
+	}), 0);
+}
+
+TEST_F(DatamanTest, BatchCallbackAndDone)
+{
+	EXPECT_EQ(runInChild([]() {
+		if (!start(Backend::File)) {
+			return -1;
+		}
+
+		// GIVEN: a batch that was never submitted
+		dm_batch_t batch{};
+
+		if (!dm_done(&batch)) {
+			return 1;
+		}
+
+		// WHEN: a batch with a completion callback is submitted
+		mission_item_s items[4];
+
+		for (unsigned i = 0; i < 4; i++) {
+			items[i] = missionItem(i, 8);
+		}
+
+		dm_request_t request{DM_REQUEST_WRITE, DM_KEY_WAYPOINTS_OFFBOARD_0, 0, 4, items, sizeof(mission_item_s), 0};
+		static px4::atomic_bool callback_called{false};
+		static px4::atomic<dm_batch_t *> callback_batch{nullptr};
+
+		batch.requests = &request;
+		batch.num_requests = 1;
+		batch.arg = &callback_called;
+		batch.callback = [](dm_batch_t *b, void *arg) {
+			callback_batch.store(b);
+			static_cast<px4::atomic_bool *>(arg)->store(true);
+		};
+
+		if (dm_submit(&batch) != 0) {
+			return 2;
+		}
+
+		// THEN: it cannot be submitted again before it completed
+		if (dm_submit(&batch) != -1) {
+			return 3;
+		}
+
+		// AND: dm_done() returns true once it completed, after the callback was called
+		const hrt_abstime start_time = hrt_absolute_time();
+
+		while (!dm_done(&batch)) {
+			if (hrt_elapsed_time(&start_time) > 5000000) {
+				return 4;
+			}
+
+			usleep(1000);
+		}
+
+		if (!callback_called.load() || (callback_batch.load() != &batch) || (request.result != 4)) {
+			return 5;
+		}
+
+		// AND: dm_wait() after dm_done() returns the result without blocking, and the batch can be submitted again
+		if ((dm_wait(&batch) != 0) || (dm_submit(&batch) != 0) || (dm_wait(&batch) != 0)) {
+			return 6;
+		}
+
+		return 0;
+	}), 0);
+}
+
+TEST_F(DatamanTest, MissionCacheInvalidatedByWrites)
+{
+	for (Backend backend : {Backend::File, Backend::Mmap}) {
+		unlink(kFile);
+
+		EXPECT_EQ(runInChild([backend]() {
+			if (!start(backend)) {
+				return -1;
+			}
+
+			static constexpr unsigned kIndex = 3;
+
+			// read item kIndex with dm_read() or as part of a batch read, 0 if it matches the seed
+			auto check = [](unsigned seed, bool batch) {
+				const mission_item_s expected = missionItem(kIndex, seed);
+				mission_item_s item{};
+
+				if (batch) {
+					dm_request_t read{DM_REQUEST_READ, DM_KEY_WAYPOINTS_OFFBOARD_0, kIndex, 1, &item, sizeof(item), 0};
+
+					if (submitAndWait(&read, 1) != 0) {
+						return 1;
+					}
+
+				} else if (dm_read(DM_KEY_WAYPOINTS_OFFBOARD_0, kIndex, &item, sizeof(item)) != sizeof(item)) {
+					return 1;
+				}
+
+				return (memcmp(&item, &expected, sizeof(item)) == 0) ? 0 : 1;
+			};
+
+			auto write = [](unsigned seed, bool batch) {
+				mission_item_s item = missionItem(kIndex, seed);
+
+				if (batch) {
+					dm_request_t request{DM_REQUEST_WRITE, DM_KEY_WAYPOINTS_OFFBOARD_0, kIndex, 1, &item, sizeof(item), 0};
+					return submitAndWait(&request, 1) == 0;
+				}
+
+				return dm_write(DM_KEY_WAYPOINTS_OFFBOARD_0, kIndex, &item, sizeof(item)) == sizeof(item);
+			};
+
+			// GIVEN: an item in the cache, read with dm_read()
+			if (!write(20, false) || (check(20, false) != 0)) {
+				return 1;
+			}
+
+			// WHEN: it is overwritten with dm_write()
+			// THEN: both paths read the new value
+			if (!write(21, false) || (check(21, false) != 0) || (check(21, true) != 0)) {
+				return 2;
+			}
+
+			// GIVEN: the item in the cache, read with a prefetch
+			dm_request_t prefetch{DM_REQUEST_PREFETCH, DM_KEY_WAYPOINTS_OFFBOARD_0, kIndex, 1, nullptr, sizeof(mission_item_s), 0};
+
+			if (submitAndWait(&prefetch, 1) != 0) {
+				return 3;
+			}
+
+			// WHEN: it is overwritten with a batch write
+			// THEN: both paths read the new value
+			if (!write(22, true) || (check(22, false) != 0) || (check(22, true) != 0)) {
+				return 4;
+			}
+
+			// WHEN: it is overwritten with dm_write() after a batch read
+			if (!write(23, false) || (check(23, true) != 0) || (check(23, false) != 0)) {
+				return 5;
+			}
+
+			// WHEN: the item type is cleared
+			// THEN: the cached item is gone
+			mission_item_s item;
+
+			if ((dm_clear(DM_KEY_WAYPOINTS_OFFBOARD_0) != 0)
+			    || (dm_read(DM_KEY_WAYPOINTS_OFFBOARD_0, kIndex, &item, sizeof(item)) > 0)) {
+				return 6;
+			}
+
+			return 0;
+		}), 0) << ((backend == Backend::Mmap) ? "mmap" : "file");
+	}
+}
+
+TEST_F(DatamanTest, LargeMission)
+{
+	for (Backend backend : {Backend::File, Backend::Mmap}) {
+		unlink(kFile);
+
+		// GIVEN: a mission with thousands of items and a full fence
+		// WHEN: it is written and read back several times, e.g. downloads and feasibility checks
+		// THEN: every item is read back as it was written
+		EXPECT_EQ(runInChild([backend]() {
+			if (!start(backend) || !writeMissionAndFence(4)) {
+				return 255;
+			}
+
+			int errors = 0;
+
+			for (int pass = 0; pass < 10; pass++) {
+				errors += verifyMissionAndFence(4);
+			}
+
+			return (errors < 255) ? errors : 254;
+		}), 0) << ((backend == Backend::Mmap) ? "mmap" : "file");
+	}
+}
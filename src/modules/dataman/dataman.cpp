@@ -42,6 +42,7 @@
  */
 
 #include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/atomic.h>
 #include <px4_platform_common/defines.h>
 #include <px4_platform_common/module.h>
 #include <px4_platform_common/posix.h>
@@ -50,9 +51,17 @@
 #include <drivers/drv_hrt.h>
 #include <lib/parameters/param.h>
 #include <lib/perf/perf_counter.h>
+#include <mathlib/mathlib.h>
 
 #include "dataman.h"
 
+#if defined(__PX4_POSIX)
+// backend serving the storage file from a shared memory mapping
+#define DATAMAN_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 __BEGIN_DECLS
 __EXPORT int dataman_main(int argc, char *argv[]);
 __END_DECLS
@@ -65,6 +74,8 @@ static ssize_t _file_read(dm_item_t item, unsigned index, void *buf, size_t coun
 static int  _file_clear(dm_item_t item);
 static int _file_initialize(unsigned max_offset);
 static void _file_shutdown();
+static unsigned _file_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t buflen);
+static unsigned _file_write_range(dm_item_t item, unsigned index, unsigned count, const void *buf, size_t buflen);
 
 /* Private Ram based Operations */
 static ssize_t _ram_write(dm_item_t item, unsigned index, const void *buf, size_t count);
@@ -72,6 +83,19 @@ static ssize_t _ram_read(dm_item_t item, unsigned index, void *buf, size_t count
 static int  _ram_clear(dm_item_t item);
 static int _ram_initialize(unsigned max_offset);
 static void _ram_shutdown();
+static unsigned _ram_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t buflen);
+static unsigned _ram_write_range(dm_item_t item, unsigned index, unsigned count, const void *buf, size_t buflen);
+
+#if defined(DATAMAN_MMAP)
+/* Private memory mapped file Operations */
+static ssize_t _mmap_write(dm_item_t item, unsigned index, const void *buf, size_t count);
+static ssize_t _mmap_read(dm_item_t item, unsigned index, void *buf, size_t count);
+static int  _mmap_clear(dm_item_t item);
+static int _mmap_initialize(unsigned max_offset);
+static void _mmap_shutdown();
+static unsigned _mmap_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t buflen);
+static unsigned _mmap_write_range(dm_item_t item, unsigned index, unsigned count, const void *buf, size_t buflen);
+#endif
 
 typedef struct dm_operations_t {
 	ssize_t (*write)(dm_item_t item, unsigned index, const void *buf, size_t count);
@@ -80,6 +104,9 @@ typedef struct dm_operations_t {
 	int (*initialize)(unsigned max_offset);
 	void (*shutdown)();
 	int (*wait)(px4_sem_t *sem);
+	/* range operations return the number of leading items transferred completely */
+	unsigned (*read_range)(dm_item_t item, unsigned index, unsigned count, void *buf, size_t buflen);
+	unsigned (*write_range)(dm_item_t item, unsigned index, unsigned count, const void *buf, size_t buflen);
 } dm_operations_t;
 
 static constexpr dm_operations_t dm_file_operations = {
@@ -89,6 +116,8 @@ static constexpr dm_operations_t dm_file_operations = {
 	.initialize = _file_initialize,
 	.shutdown = _file_shutdown,
 	.wait = px4_sem_wait,
+	.read_range = _file_read_range,
+	.write_range = _file_write_range,
 };
 
 static constexpr dm_operations_t dm_ram_operations = {
@@ -98,7 +127,22 @@ static constexpr dm_operations_t dm_ram_operations = {
 	.initialize = _ram_initialize,
 	.shutdown = _ram_shutdown,
 	.wait = px4_sem_wait,
+	.read_range = _ram_read_range,
+	.write_range = _ram_write_range,
+};
+
+#if defined(DATAMAN_MMAP)
+static constexpr dm_operations_t dm_mmap_operations = {
+	.write   = _mmap_write,
+	.read    = _mmap_read,
+	.clear   = _mmap_clear,
+	.initialize = _mmap_initialize,
+	.shutdown = _mmap_shutdown,
+	.wait = px4_sem_wait,
+	.read_range = _mmap_read_range,
+	.write_range = _mmap_write_range,
 };
+#endif
 
 static const dm_operations_t *g_dm_ops;
 
@@ -110,6 +154,8 @@ static struct {
 		struct {
 			uint8_t *data;
 			uint8_t *data_end;
+			size_t size;	/* length of the mapping (mmap backend) */
+			int fd;		/* mapped storage file (mmap backend) */
 		} ram;
 	};
 	bool running;
@@ -121,6 +167,7 @@ typedef enum {
 	dm_write_func = 0,
 	dm_read_func,
 	dm_clear_func,
+	dm_batch_func,
 	dm_number_of_funcs
 } dm_function_t;
 
@@ -147,6 +194,9 @@ typedef struct {
 		struct {
 			dm_item_t item;
 		} clear_params;
+		struct {
+			dm_batch_t *batch;
+		} batch_params;
 	};
 } work_q_item_t;
 
@@ -188,6 +238,53 @@ static px4_sem_t g_sys_state_mutex_fence;
 static perf_counter_t _dm_read_perf{nullptr};
 static perf_counter_t _dm_write_perf{nullptr};
 
+/* Write generation of each item type, incremented by the worker thread on every write and clear */
+static px4::atomic<uint32_t> g_item_generation[DM_KEY_NUM_KEYS];
+
+/* Read-through cache of the mission items, shared by all clients (mission manager, navigator, feasibility checks).
+ * The cache is direct mapped by item index and every entry is only valid as long as the write generation of its item
+ * type is unchanged, so an upload or any other write to a mission invalidates its entries without notifying anyone. */
+#if defined(CONFIG_DATAMAN_MISSION_CACHE_ITEMS)
+static constexpr unsigned DM_MISSION_CACHE_SIZE = CONFIG_DATAMAN_MISSION_CACHE_ITEMS; /* set per board */
+#elif defined(MEMORY_CONSTRAINED_SYSTEM)
+static constexpr unsigned DM_MISSION_CACHE_SIZE = 0;
+#elif defined(__PX4_NUTTX)
+static constexpr unsigned DM_MISSION_CACHE_SIZE = 64;
+#else
+static constexpr unsigned DM_MISSION_CACHE_SIZE = 4096;
+#endif
+
+typedef struct {
+	uint32_t generation;	/**< write generation of the item type when the entry was read */
+	unsigned index;
+	dm_item_t item;		/**< DM_KEY_NUM_KEYS if unused */
+	struct mission_item_s mission_item;
+} dm_cache_entry_t;
+
+static dm_cache_entry_t *g_mission_cache{nullptr};	/* allocated on first use */
+static px4_sem_t g_mission_cache_mutex;
+static unsigned g_mission_cache_hits;
+static unsigned g_mission_cache_misses;
+
+#if defined(DATAMAN_MMAP)
+/* Mutual exclusion on the mapped items of each type: the worker thread holds it while modifying items of the type,
+ * clients while copying them out of the mapping (dm_read() and dm_read_range() do not go through the worker thread).
+ * These are independent of the dm_lock() transaction locks. A client can still be waiting on one of them when the
+ * worker thread exits, so they are initialized once and live as long as the module. */
+static px4_sem_t g_item_access_mutex[DM_KEY_NUM_KEYS];
+static bool g_item_access_mutex_initialized{false};
+static px4::atomic<uint32_t> g_direct_reads{0};
+#endif
+
+/* I/O buffer of the range operations of the file backend, adjacent items are transferred with a single access */
+#if defined(__PX4_NUTTX)
+static constexpr size_t DM_IO_BUFFER_SIZE = 1024;
+#else
+static constexpr size_t DM_IO_BUFFER_SIZE = 16384;
+#endif
+
+static uint8_t *g_io_buffer{nullptr};
+
 /* The data manager store file handle and file name */
 static const char *default_device_path = PX4_STORAGEDIR "/dataman";
 static char *k_data_manager_device_path = nullptr;
@@ -196,6 +293,9 @@ static enum {
 	BACKEND_NONE = 0,
 	BACKEND_FILE,
 	BACKEND_RAM,
+#if defined(DATAMAN_MMAP)
+	BACKEND_MMAP,
+#endif
 	BACKEND_LAST
 } backend = BACKEND_NONE;
 
@@ -326,8 +426,8 @@ dequeue_work_item()
 	return work;
 }
 
-static int
-enqueue_work_item_and_wait_for_result(work_q_item_t *item)
+static void
+enqueue_work_item(work_q_item_t *item)
 {
 	/* put the work item at the end of the work queue */
 	lock_queue(&g_work_q);
@@ -342,6 +442,12 @@ enqueue_work_item_and_wait_for_result(work_q_item_t *item)
 
 	/* tell the work thread that work is available */
 	px4_sem_post(&g_work_queued_sema);
+}
+
+static int
+enqueue_work_item_and_wait_for_result(work_q_item_t *item)
+{
+	enqueue_work_item(item);
 
 	/* wait for the result */
 	px4_sem_wait(&item->wait_sem);
@@ -358,6 +464,95 @@ static bool is_running()
 	return dm_operations_data.running;
 }
 
+static bool
+mission_cache_applies(dm_item_t item, size_t count)
+{
+#if defined(DATAMAN_MMAP)
+
+	/* the mapping is read directly, a copy does not save anything */
+	if (backend == BACKEND_MMAP) {
+		return false;
+	}
+
+#endif
+
+	return (DM_MISSION_CACHE_SIZE > 0) && (count == sizeof(struct mission_item_s))
+	       && ((item == DM_KEY_WAYPOINTS_OFFBOARD_0) || (item == DM_KEY_WAYPOINTS_OFFBOARD_1));
+}
+
+/* Entry of the direct mapped cache holding an item index */
+static inline unsigned
+mission_cache_slot(unsigned index)
+{
+	/* never used without a cache, but must still compile with a size of 0 */
+	return index % math::max(DM_MISSION_CACHE_SIZE, 1u);
+}
+
+/* Copy a mission item from the cache if it is valid for the given write generation */
+static bool
+mission_cache_read(dm_item_t item, unsigned index, void *buf, uint32_t generation)
+{
+	bool hit = false;
+
+	px4_sem_wait(&g_mission_cache_mutex);
+
+	if (g_mission_cache) {
+		const dm_cache_entry_t &entry = g_mission_cache[mission_cache_slot(index)];
+
+		if ((entry.item == item) && (entry.index == index) && (entry.generation == generation)) {
+			memcpy(buf, &entry.mission_item, sizeof(struct mission_item_s));
+			hit = true;
+		}
+	}
+
+	if (hit) {
+		g_mission_cache_hits++;
+
+	} else {
+		g_mission_cache_misses++;
+	}
+
+	px4_sem_post(&g_mission_cache_mutex);
+
+	return hit;
+}
+
+/* Store a mission item read at the given write generation, a write in the meantime makes the entry invalid */
+static void
+mission_cache_store(dm_item_t item, unsigned index, const void *buf, uint32_t generation)
+{
+	px4_sem_wait(&g_mission_cache_mutex);
+
+	if (g_mission_cache == nullptr) {
+		g_mission_cache = (dm_cache_entry_t *)malloc(DM_MISSION_CACHE_SIZE * sizeof(dm_cache_entry_t));
+
+		if (g_mission_cache) {
+			for (unsigned i = 0; i < DM_MISSION_CACHE_SIZE; i++) {
+				g_mission_cache[i].item = DM_KEY_NUM_KEYS;
+			}
+		}
+	}
+
+	if (g_mission_cache) {
+		dm_cache_entry_t &entry = g_mission_cache[mission_cache_slot(index)];
+		entry.generation = generation;
+		entry.index = index;
+		entry.item = item;
+		memcpy(&entry.mission_item, buf, sizeof(struct mission_item_s));
+	}
+
+	px4_sem_post(&g_mission_cache_mutex);
+}
+
+/* Store an item read by the worker thread in the cache, no write can happen concurrently */
+static void
+mission_cache_fill(dm_item_t item, unsigned index, const void *buf, size_t count)
+{
+	if (mission_cache_applies(item, count)) {
+		mission_cache_store(item, index, buf, g_item_generation[item].load());
+	}
+}
+
 /* Calculate the offset in file of specific item */
 static int
 calculate_offset(dm_item_t item, unsigned index)
@@ -615,6 +810,184 @@ _file_read(dm_item_t item, unsigned index, void *buf, size_t count)
 	return buffer[0];
 }
 
+/* Read a range of items from the data manager RAM buffer, buf can be nullptr to only fill the mission item cache */
+static unsigned
+_ram_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t buflen)
+{
+	unsigned done = 0;
+
+	for (; done < count; done++) {
+		const int offset = calculate_offset(item, index + done);
+
+		if ((offset < 0) || (buflen > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE))) {
+			break;
+		}
+
+		const uint8_t *buffer = &dm_operations_data.ram.data[offset];
+
+		/* only complete items count, an empty item ends the range */
+		if ((buffer > dm_operations_data.ram.data_end) || (buffer[0] != buflen)) {
+			break;
+		}
+
+		if (buf) {
+			memcpy((uint8_t *)buf + done * buflen, buffer + DM_SECTOR_HDR_SIZE, buflen);
+		}
+
+		mission_cache_fill(item, index + done, buffer + DM_SECTOR_HDR_SIZE, buflen);
+	}
+
+	return done;
+}
+
+/* Write a range of items to the data manager RAM buffer */
+static unsigned
+_ram_write_range(dm_item_t item, unsigned index, unsigned count, const void *buf, size_t buflen)
+{
+	unsigned done = 0;
+
+	for (; done < count; done++) {
+		if (_ram_write(item, index + done, (const uint8_t *)buf + done * buflen, buflen) != (ssize_t)buflen) {
+			break;
+		}
+	}
+
+	return done;
+}
+
+/* Read a range of items from the data manager file with one access per I/O buffer, buf can be nullptr to only fill
+ * the mission item cache */
+static unsigned
+_file_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t buflen)
+{
+	if ((item >= DM_KEY_NUM_KEYS) || (buflen > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE))) {
+		return 0;
+	}
+
+	const size_t item_size = g_per_item_size[item];
+
+	/* without I/O buffer the items are read one by one */
+	unsigned char item_buffer[item_size];
+	uint8_t *io_buffer = g_io_buffer ? g_io_buffer : item_buffer;
+	const unsigned chunk_items = g_io_buffer ? (DM_IO_BUFFER_SIZE / item_size) : 1;
+
+	unsigned done = 0;
+
+	while (done < count) {
+		const int offset = calculate_offset(item, index + done);
+
+		if (offset < 0) {
+			break;
+		}
+
+		unsigned n = math::min(count - done, chunk_items);
+		n = math::min(n, g_per_item_max_index[item] - (index + done));
+
+		if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
+			if (!dm_operations_data.silence) {
+				PX4_ERR("file read lseek failed %d", errno);
+			}
+
+			break;
+		}
+
+		const ssize_t len = read(dm_operations_data.file.fd, io_buffer, n * item_size);
+
+		if (len < 0) {
+			if (!dm_operations_data.silence) {
+				PX4_ERR("file read failed %d", errno);
+			}
+
+			break;
+		}
+
+		/* only complete items count, an empty item (or the end of the file) ends the range */
+		unsigned k = 0;
+
+		for (; k < n; k++) {
+			const uint8_t *buffer = &io_buffer[k * item_size];
+
+			if (((size_t)len < k * item_size + DM_SECTOR_HDR_SIZE + buflen) || (buffer[0] != buflen)) {
+				break;
+			}
+
+			if (buf) {
+				memcpy((uint8_t *)buf + (done + k) * buflen, buffer + DM_SECTOR_HDR_SIZE, buflen);
+			}
+
+			mission_cache_fill(item, index + done + k, buffer + DM_SECTOR_HDR_SIZE, buflen);
+		}
+
+		done += k;
+
+		if (k < n) {
+			break;
+		}
+	}
+
+	return done;
+}
+
+/* Write a range of items to the data manager file with one access per I/O buffer and a single sync */
+static unsigned
+_file_write_range(dm_item_t item, unsigned index, unsigned count, const void *buf, size_t buflen)
+{
+	if ((item >= DM_KEY_NUM_KEYS) || (buflen > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE))) {
+		return 0;
+	}
+
+	const size_t item_size = g_per_item_size[item];
+
+	/* without I/O buffer the items are written one by one */
+	unsigned char item_buffer[item_size];
+	uint8_t *io_buffer = g_io_buffer ? g_io_buffer : item_buffer;
+	const unsigned chunk_items = g_io_buffer ? (DM_IO_BUFFER_SIZE / item_size) : 1;
+
+	unsigned done = 0;
+
+	while (done < count) {
+		const int offset = calculate_offset(item, index + done);
+
+		if (offset < 0) {
+			break;
+		}
+
+		unsigned n = math::min(count - done, chunk_items);
+		n = math::min(n, g_per_item_max_index[item] - (index + done));
+
+		/* Write out the data, each item prefixed with length */
+		memset(io_buffer, 0, n * item_size);
+
+		for (unsigned k = 0; k < n; k++) {
+			uint8_t *buffer = &io_buffer[k * item_size];
+			buffer[0] = buflen;
+			memcpy(buffer + DM_SECTOR_HDR_SIZE, (const uint8_t *)buf + (done + k) * buflen, buflen);
+		}
+
+		/* the unused part of the last item is not written */
+		const size_t len = (n - 1) * item_size + DM_SECTOR_HDR_SIZE + buflen;
+
+		if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
+			PX4_ERR("file write lseek failed %d", errno);
+			break;
+		}
+
+		const ssize_t ret_write = write(dm_operations_data.file.fd, io_buffer, len);
+
+		if (ret_write != (ssize_t)len) {
+			PX4_ERR("file write failed %d", errno);
+			break;
+		}
+
+		done += n;
+	}
+
+	/* Make sure data is written to physical media */
+	fsync(dm_operations_data.file.fd);
+
+	return done;
+}
+
 static int  _ram_clear(dm_item_t item)
 {
 	int i;
@@ -786,6 +1159,266 @@ _ram_shutdown()
 	dm_operations_data.running = false;
 }
 
+#if defined(DATAMAN_MMAP)
+/* Flush a byte range of the mapping to the storage file */
+static void
+mmap_sync(int offset, size_t len)
+{
+	/* msync needs a page aligned start */
+	static const long page_size = sysconf(_SC_PAGESIZE);
+	const int start = offset - (offset % page_size);
+
+	if (msync(dm_operations_data.ram.data + start, len + (offset - start), MS_SYNC) != 0) {
+		PX4_ERR("mmap sync failed %d", errno);
+	}
+}
+
+/* Store an item in the mapping: the length is cleared first and set last, so that an item is either complete or empty
+ * in the file if the process dies in between */
+static void
+mmap_store_item(uint8_t *buffer, const void *buf, size_t count)
+{
+	buffer[0] = 0;
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	buffer[1] = 0;
+	buffer[2] = 0;
+	buffer[3] = 0;
+
+	if (count > 0) {
+		memcpy(buffer + DM_SECTOR_HDR_SIZE, buf, count);
+	}
+
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	buffer[0] = count;
+}
+
+/* write to the mapped data manager file */
+static ssize_t
+_mmap_write(dm_item_t item, unsigned index, const void *buf, size_t count)
+{
+	/* Get the offset for this item */
+	const int offset = calculate_offset(item, index);
+
+	/* If item type or index out of range, return error */
+	if (offset < 0) {
+		return -1;
+	}
+
+	/* Make sure caller has not given us more data than we can handle */
+	if (count > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE)) {
+		return -E2BIG;
+	}
+
+	px4_sem_wait(&g_item_access_mutex[item]);
+	mmap_store_item(&dm_operations_data.ram.data[offset], buf, count);
+	px4_sem_post(&g_item_access_mutex[item]);
+
+	/* Make sure data is written to physical media */
+	mmap_sync(offset, DM_SECTOR_HDR_SIZE + count);
+
+	return count;
+}
+
+/* Retrieve from the mapped data manager file, called by the clients directly */
+static ssize_t
+_mmap_read(dm_item_t item, unsigned index, void *buf, size_t count)
+{
+	if (item >= DM_KEY_NUM_KEYS) {
+		return -1;
+	}
+
+	ssize_t ret = -1;
+
+	px4_sem_wait(&g_item_access_mutex[item]);
+
+	/* the mapping is gone after shutdown */
+	if (dm_operations_data.ram.data) {
+		ret = _ram_read(item, index, buf, count);
+	}
+
+	px4_sem_post(&g_item_access_mutex[item]);
+
+	return ret;
+}
+
+/* Read a range of items from the mapped data manager file, called by the clients directly */
+static unsigned
+_mmap_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t buflen)
+{
+	if (item >= DM_KEY_NUM_KEYS) {
+		return 0;
+	}
+
+	unsigned done = 0;
+
+	px4_sem_wait(&g_item_access_mutex[item]);
+
+	if (dm_operations_data.ram.data) {
+		done = _ram_read_range(item, index, count, buf, buflen);
+	}
+
+	px4_sem_post(&g_item_access_mutex[item]);
+
+	return done;
+}
+
+/* Write a range of items to the mapped data manager file with a single sync */
+static unsigned
+_mmap_write_range(dm_item_t item, unsigned index, unsigned count, const void *buf, size_t buflen)
+{
+	if ((item >= DM_KEY_NUM_KEYS) || (buflen > (g_per_item_size[item] - DM_SECTOR_HDR_SIZE))) {
+		return 0;
+	}
+
+	const int first_offset = calculate_offset(item, index);
+	unsigned done = 0;
+
+	px4_sem_wait(&g_item_access_mutex[item]);
+
+	for (; done < count; done++) {
+		const int offset = calculate_offset(item, index + done);
+
+		if (offset < 0) {
+			break;
+		}
+
+		mmap_store_item(&dm_operations_data.ram.data[offset], (const uint8_t *)buf + done * buflen, buflen);
+	}
+
+	px4_sem_post(&g_item_access_mutex[item]);
+
+	if (done > 0) {
+		mmap_sync(first_offset, done * g_per_item_size[item]);
+	}
+
+	return done;
+}
+
+static int
+_mmap_clear(dm_item_t item)
+{
+	if (item >= DM_KEY_NUM_KEYS) {
+		return -1;
+	}
+
+	const int first_offset = calculate_offset(item, 0);
+
+	if (first_offset < 0) {
+		return -1;
+	}
+
+	/* Only the items that are not empty yet are written, which keeps their pages clean and out of the sync */
+	int first_dirty = -1;
+	int last_dirty = -1;
+
+	px4_sem_wait(&g_item_access_mutex[item]);
+
+	for (unsigned i = 0; i < g_per_item_max_index[item]; i++) {
+		const int offset = first_offset + i * g_per_item_size[item];
+		uint8_t *buffer = &dm_operations_data.ram.data[offset];
+
+		if (buffer[0]) {
+			buffer[0] = 0;
+
+			if (first_dirty < 0) {
+				first_dirty = offset;
+			}
+
+			last_dirty = offset;
+		}
+	}
+
+	px4_sem_post(&g_item_access_mutex[item]);
+
+	if (first_dirty >= 0) {
+		mmap_sync(first_dirty, last_dirty - first_dirty + 1);
+	}
+
+	return 0;
+}
+
+static int
+_mmap_initialize(unsigned max_offset)
+{
+	/* The file layout is the same as the one of the file backend */
+	const int fd = open(k_data_manager_device_path, O_RDWR | O_CREAT | O_BINARY, PX4_O_MODE_666);
+
+	if (fd < 0) {
+		PX4_WARN("Could not open data manager file %s", k_data_manager_device_path);
+		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
+		return -1;
+	}
+
+	/* Check the compat item and start from an empty file if it does not match */
+	uint8_t compat_buffer[g_per_item_size[DM_KEY_COMPAT]];
+	struct dataman_compat_s compat_state;
+	bool incompat = true;
+
+	const ssize_t len = pread(fd, compat_buffer, sizeof(compat_buffer), calculate_offset(DM_KEY_COMPAT, 0));
+
+	if ((len == (ssize_t)sizeof(compat_buffer)) && (compat_buffer[0] == sizeof(compat_state))) {
+		memcpy(&compat_state, compat_buffer + DM_SECTOR_HDR_SIZE, sizeof(compat_state));
+		incompat = (compat_state.key != DM_COMPAT_KEY);
+	}
+
+	struct stat st {};
+
+	if ((incompat && (ftruncate(fd, 0) != 0)) || (fstat(fd, &st) != 0)
+	    || ((st.st_size < (off_t)max_offset) && (ftruncate(fd, max_offset) != 0))) {
+		close(fd);
+		PX4_WARN("Could not resize data manager file %s", k_data_manager_device_path);
+		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
+		return -1;
+	}
+
+	void *data = mmap(nullptr, max_offset, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if (data == MAP_FAILED) {
+		close(fd);
+		PX4_WARN("Could not map data manager file %s", k_data_manager_device_path);
+		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
+		return -1;
+	}
+
+	dm_operations_data.ram.data = (uint8_t *)data;
+	dm_operations_data.ram.data_end = &dm_operations_data.ram.data[max_offset - 1];
+	dm_operations_data.ram.size = max_offset;
+	dm_operations_data.ram.fd = fd;
+
+	/* Write current compat info */
+	compat_state.key = DM_COMPAT_KEY;
+	int ret = g_dm_ops->write(DM_KEY_COMPAT, 0, &compat_state, sizeof(compat_state));
+
+	if (ret != sizeof(compat_state)) {
+		PX4_ERR("Failed writing compat: %d", ret);
+	}
+
+	dm_operations_data.running = true;
+
+	return 0;
+}
+
+static void
+_mmap_shutdown()
+{
+	/* wait for the clients to leave the mapping */
+	for (unsigned i = 0; i < DM_KEY_NUM_KEYS; i++) {
+		px4_sem_wait(&g_item_access_mutex[i]);
+	}
+
+	msync(dm_operations_data.ram.data, dm_operations_data.ram.size, MS_SYNC);
+	munmap(dm_operations_data.ram.data, dm_operations_data.ram.size);
+	dm_operations_data.ram.data = nullptr;
+	close(dm_operations_data.ram.fd);
+	dm_operations_data.running = false;
+
+	for (unsigned i = 0; i < DM_KEY_NUM_KEYS; i++) {
+		px4_sem_post(&g_item_access_mutex[i]);
+	}
+}
+#endif
+
 /** Write to the data manager file */
 __EXPORT ssize_t
 dm_write(dm_item_t item, unsigned index, const void *buf, size_t count)
@@ -831,6 +1464,27 @@ dm_read(dm_item_t item, unsigned index, void *buf, size_t count)
 
 	perf_begin(_dm_read_perf);
 
+#if defined(DATAMAN_MMAP)
+
+	/* the mapping is read by the calling thread, without a round trip through the worker thread */
+	if (backend == BACKEND_MMAP) {
+		g_direct_reads.fetch_add(1);
+		const ssize_t ret = _mmap_read(item, index, buf, count);
+		perf_end(_dm_read_perf);
+		return ret;
+	}
+
+#endif
+
+	/* the generation has to be taken before the read, so that a concurrent write invalidates what is cached */
+	const bool cached = mission_cache_applies(item, count);
+	const uint32_t generation = cached ? g_item_generation[item].load() : 0;
+
+	if (cached && mission_cache_read(item, index, buf, generation)) {
+		perf_end(_dm_read_perf);
+		return count;
+	}
+
 	/* get a work item and queue up a read request */
 	if ((work = create_work_item()) == nullptr) {
 		PX4_ERR("dm_read create_work_item failed");
@@ -846,6 +1500,11 @@ dm_read(dm_item_t item, unsigned index, void *buf, size_t count)
 
 	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
 	ssize_t ret = (ssize_t)enqueue_work_item_and_wait_for_result(work);
+
+	if (cached && (ret == (ssize_t)count)) {
+		mission_cache_store(item, index, buf, generation);
+	}
+
 	perf_end(_dm_read_perf);
 	return ret;
 }
@@ -874,6 +1533,190 @@ dm_clear(dm_item_t item)
 	return enqueue_work_item_and_wait_for_result(work);
 }
 
+static bool
+requests_adjacent(const dm_request_t &a, const dm_request_t &b)
+{
+	if ((a.type != b.type) || (a.item != b.item) || (a.buflen != b.buflen) || (b.index != a.index + a.count)) {
+		return false;
+	}
+
+	return (a.type == DM_REQUEST_PREFETCH) || ((uint8_t *)b.buffer == (uint8_t *)a.buffer + a.count * a.buflen);
+}
+
+/* Process the requests of a batch in the worker thread, adjacent requests are merged into a single range */
+static void
+process_batch(dm_batch_t *batch)
+{
+	unsigned first = 0;
+
+	while (first < batch->num_requests) {
+		const dm_request_t &request = batch->requests[first];
+		unsigned last = first;
+		unsigned count = request.count;
+
+		while ((last + 1 < batch->num_requests) && requests_adjacent(batch->requests[last], batch->requests[last + 1])) {
+			last++;
+			count += batch->requests[last].count;
+		}
+
+		unsigned done = 0;
+
+		switch (request.type) {
+		case DM_REQUEST_READ:
+			g_func_counts[dm_read_func]++;
+			done = g_dm_ops->read_range(request.item, request.index, count, request.buffer, request.buflen);
+			break;
+
+		case DM_REQUEST_WRITE:
+			g_func_counts[dm_write_func]++;
+			done = g_dm_ops->write_range(request.item, request.index, count, request.buffer, request.buflen);
+
+			if (request.item < DM_KEY_NUM_KEYS) {
+				g_item_generation[request.item].fetch_add(1);
+			}
+
+			break;
+
+		case DM_REQUEST_PREFETCH:
+
+			/* a prefetch is only a hint: it is complete if the items that fit into the cache were read, or if the items
+			 * are not cached at all. Items beyond the cache size would only evict the first ones again. */
+			done = count;
+
+			if (mission_cache_applies(request.item, request.buflen)) {
+				const unsigned cached = math::min(count, DM_MISSION_CACHE_SIZE);
+				g_func_counts[dm_read_func]++;
+				const unsigned read = g_dm_ops->read_range(request.item, request.index, cached, nullptr, request.buflen);
+
+				if (read < cached) {
+					done = read;
+				}
+			}
+
+			break;
+		}
+
+		/* the leading items of the range are assigned to the requests in order */
+		for (unsigned i = first; i <= last; i++) {
+			batch->requests[i].result = math::min(done, batch->requests[i].count);
+			done -= batch->requests[i].result;
+		}
+
+		first = last + 1;
+	}
+}
+
+/** Submit a batch of requests */
+__EXPORT int
+dm_submit(dm_batch_t *batch)
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return -1;
+	}
+
+	/* a previous submission has to be completed with dm_wait() or dm_done() first */
+	if ((batch == nullptr) || batch->pending) {
+		return -1;
+	}
+
+	/* get a work item and queue up the batch, nobody waits for the work item itself */
+	if ((work = create_work_item()) == nullptr) {
+		PX4_ERR("dm_submit create_work_item failed");
+		return -1;
+	}
+
+	work->func = dm_batch_func;
+	work->batch_params.batch = batch;
+
+	px4_sem_init(&batch->done_sem, 1, 0);
+
+	/* batch->done_sem use case is a signal */
+
+	px4_sem_setprotocol(&batch->done_sem, SEM_PRIO_NONE);
+
+	batch->pending = true;
+
+	enqueue_work_item(work);
+	return 0;
+}
+
+/** Wait for a batch to complete */
+__EXPORT int
+dm_wait(dm_batch_t *batch)
+{
+	if (batch->pending) {
+		px4_sem_wait(&batch->done_sem);
+		px4_sem_destroy(&batch->done_sem);
+		batch->pending = false;
+	}
+
+	for (unsigned i = 0; i < batch->num_requests; i++) {
+		if (batch->requests[i].result != batch->requests[i].count) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/** Check if a batch completed */
+__EXPORT bool
+dm_done(dm_batch_t *batch)
+{
+	if (batch->pending) {
+		if (px4_sem_trywait(&batch->done_sem) != 0) {
+			return false;
+		}
+
+		px4_sem_destroy(&batch->done_sem);
+		batch->pending = false;
+	}
+
+	return true;
+}
+
+/** Read a range of items */
+__EXPORT ssize_t
+dm_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t buflen)
+{
+#if defined(DATAMAN_MMAP)
+
+	/* the mapping is read by the calling thread, without a round trip through the worker thread */
+	if (backend == BACKEND_MMAP) {
+		if (!is_running() || g_task_should_exit) {
+			return -1;
+		}
+
+		perf_begin(_dm_read_perf);
+		g_direct_reads.fetch_add(1);
+		const unsigned done = _mmap_read_range(item, index, count, buf, buflen);
+		perf_end(_dm_read_perf);
+		return done;
+	}
+
+#endif
+
+	dm_request_t request{DM_REQUEST_READ, item, index, count, buf, buflen, 0};
+
+	dm_batch_t batch{};
+	batch.requests = &request;
+	batch.num_requests = 1;
+
+	perf_begin(_dm_read_perf);
+
+	if (dm_submit(&batch) != 0) {
+		perf_end(_dm_read_perf);
+		return -1;
+	}
+
+	dm_wait(&batch);
+	perf_end(_dm_read_perf);
+	return request.result;
+}
+
 __EXPORT int
 dm_lock(dm_item_t item)
 {
@@ -949,6 +1792,13 @@ task_main(int argc, char *argv[])
 		g_dm_ops = &dm_ram_operations;
 		break;
 
+#if defined(DATAMAN_MMAP)
+
+	case BACKEND_MMAP:
+		g_dm_ops = &dm_mmap_operations;
+		break;
+#endif
+
 	default:
 		PX4_WARN("No valid backend set.");
 		return -1;
@@ -981,6 +1831,27 @@ task_main(int argc, char *argv[])
 	g_item_locks[DM_KEY_MISSION_STATE] = &g_sys_state_mutex_mission;
 	g_item_locks[DM_KEY_FENCE_POINTS] = &g_sys_state_mutex_fence;
 
+	px4_sem_init(&g_mission_cache_mutex, 1, 1);
+	g_mission_cache_hits = 0;
+	g_mission_cache_misses = 0;
+
+#if defined(DATAMAN_MMAP)
+
+	if (!g_item_access_mutex_initialized) {
+		for (unsigned i = 0; i < DM_KEY_NUM_KEYS; i++) {
+			px4_sem_init(&g_item_access_mutex[i], 1, 1);
+		}
+
+		g_item_access_mutex_initialized = true;
+	}
+
+	g_direct_reads.store(0);
+#endif
+
+	if (backend == BACKEND_FILE) {
+		g_io_buffer = (uint8_t *)malloc(DM_IO_BUFFER_SIZE);
+	}
+
 	g_task_should_exit = false;
 
 	init_q(&g_work_q);
@@ -1012,6 +1883,13 @@ task_main(int argc, char *argv[])
 		PX4_INFO("data manager RAM size is %u bytes", max_offset);
 		break;
 
+#if defined(DATAMAN_MMAP)
+
+	case BACKEND_MMAP:
+		PX4_INFO("data manager file '%s' mapped, size is %u bytes", k_data_manager_device_path, max_offset);
+		break;
+#endif
+
 	default:
 		break;
 	}
@@ -1037,6 +1915,11 @@ task_main(int argc, char *argv[])
 				g_func_counts[dm_write_func]++;
 				work->result =
 					g_dm_ops->write(work->write_params.item, work->write_params.index, work->write_params.buf, work->write_params.count);
+
+				if (work->write_params.item < DM_KEY_NUM_KEYS) {
+					g_item_generation[work->write_params.item].fetch_add(1);
+				}
+
 				break;
 
 			case dm_read_func:
@@ -1045,9 +1928,19 @@ task_main(int argc, char *argv[])
 					g_dm_ops->read(work->read_params.item, work->read_params.index, work->read_params.buf, work->read_params.count);
 				break;
 
+			case dm_batch_func:
+				g_func_counts[dm_batch_func]++;
+				process_batch(work->batch_params.batch);
+				break;
+
 			case dm_clear_func:
 				g_func_counts[dm_clear_func]++;
 				work->result = g_dm_ops->clear(work->clear_params.item);
+
+				if (work->clear_params.item < DM_KEY_NUM_KEYS) {
+					g_item_generation[work->clear_params.item].fetch_add(1);
+				}
+
 				break;
 
 			default: /* should never happen */
@@ -1055,8 +1948,21 @@ task_main(int argc, char *argv[])
 				break;
 			}
 
-			/* Inform the caller that work is done */
-			px4_sem_post(&work->wait_sem);
+			if (work->func == dm_batch_func) {
+				/* nobody waits for the work item of a batch, complete the batch itself */
+				dm_batch_t *batch = work->batch_params.batch;
+				destroy_work_item(work);
+
+				if (batch->callback) {
+					batch->callback(batch, batch->arg);
+				}
+
+				px4_sem_post(&batch->done_sem);
+
+			} else {
+				/* Inform the caller that work is done */
+				px4_sem_post(&work->wait_sem);
+			}
 		}
 
 		/* time to go???? */
@@ -1086,6 +1992,13 @@ end:
 	px4_sem_destroy(&g_sys_state_mutex_mission);
 	px4_sem_destroy(&g_sys_state_mutex_fence);
 
+	px4_sem_destroy(&g_mission_cache_mutex);
+	free(g_mission_cache);
+	g_mission_cache = nullptr;
+
+	free(g_io_buffer);
+	g_io_buffer = nullptr;
+
 	perf_free(_dm_read_perf);
 	_dm_read_perf = nullptr;
 
@@ -1129,7 +2042,21 @@ status()
 	PX4_INFO("Writes   %u", g_func_counts[dm_write_func]);
 	PX4_INFO("Reads    %u", g_func_counts[dm_read_func]);
 	PX4_INFO("Clears   %u", g_func_counts[dm_clear_func]);
+	PX4_INFO("Batches  %u", g_func_counts[dm_batch_func]);
 	PX4_INFO("Max Q lengths work %u, free %u", g_work_q.max_size, g_free_q.max_size);
+
+	if (DM_MISSION_CACHE_SIZE > 0) {
+		PX4_INFO("Mission cache hits %u, misses %u (%u entries)", g_mission_cache_hits, g_mission_cache_misses,
+			 DM_MISSION_CACHE_SIZE);
+	}
+
+#if defined(DATAMAN_MMAP)
+
+	if (backend == BACKEND_MMAP) {
+		PX4_INFO("Direct reads %u", (unsigned)g_direct_reads.load());
+	}
+
+#endif
 	perf_print_counter(_dm_read_perf);
 	perf_print_counter(_dm_write_perf);
 }
@@ -1151,6 +2078,7 @@ usage()
 Module to provide persistent storage for the rest of the system in form of a simple database through a C API.
 Multiple backends are supported:
 - a file (eg. on the SD card)
+- a memory mapping of the file (POSIX only): clients read the items directly from the mapping, writes are synced
 - RAM (this is obviously not persistent)
 
 It is used to store structured data of different types: mission waypoints, mission state and geofence polygons.
@@ -1160,6 +2088,14 @@ Each type has a specific type and a fixed maximum amount of storage items, so th
 Reading and writing a single item is always atomic. If multiple items need to be read/modified atomically, there is
 an additional lock per item type via `dm_lock`.
 
+Mission items are read through a cache shared by all clients, so that repeated reads of a mission (download,
+feasibility checks, navigation) do not go through the worker thread and the backend. Cached items are invalidated by
+any write to or clear of their item type.
+
+Besides the synchronous calls, `dm_submit` queues a batch of range requests (read, write and prefetch into the mission
+item cache) that completes through a callback or `dm_wait`/`dm_done`. Adjacent ranges are merged and transferred with
+a single backend access per I/O buffer.
+
 **DM_KEY_FENCE_POINTS** and **DM_KEY_SAFE_POINTS** items: the first data element is a `mission_stats_entry_s` struct,
 which stores the number of items for these types. These items are always updated atomically in one transaction (from
 the mavlink mission manager). During that time, navigator will try to acquire the geofence item lock, fail, and will not
@@ -1171,7 +2107,13 @@ check for geofence violations.
 	PRINT_MODULE_USAGE_COMMAND("start");
 	PRINT_MODULE_USAGE_PARAM_STRING('f', nullptr, "<file>", "Storage file", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('r', "Use RAM backend (NOT persistent)", true);
+#if defined(DATAMAN_MMAP)
+	PRINT_MODULE_USAGE_PARAM_FLAG('m', "Map the storage file into memory", true);
+#endif
 	PRINT_MODULE_USAGE_PARAM_COMMENT("The options -f and -r are mutually exclusive. If nothing is specified, a file 'dataman' is used");
+#if defined(DATAMAN_MMAP)
+	PRINT_MODULE_USAGE_PARAM_COMMENT("The option -m maps the file given with -f (or the default one)");
+#endif
 	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
 }
 
@@ -1204,10 +2146,13 @@ dataman_main(int argc, char *argv[])
 		int ch;
 		int dmoptind = 1;
 		const char *dmoptarg = nullptr;
+#if defined(DATAMAN_MMAP)
+		bool map_file = false;
+#endif
 
 		/* jump over start and look at options first */
 
-		while ((ch = px4_getopt(argc, argv, "f:r", &dmoptind, &dmoptarg)) != EOF) {
+		while ((ch = px4_getopt(argc, argv, "f:rm", &dmoptind, &dmoptarg)) != EOF) {
 			switch (ch) {
 			case 'f':
 				if (backend_check()) {
@@ -1227,6 +2172,13 @@ dataman_main(int argc, char *argv[])
 				backend = BACKEND_RAM;
 				break;
 
+#if defined(DATAMAN_MMAP)
+
+			case 'm':
+				map_file = true;
+				break;
+#endif
+
 			//no break
 			default:
 				usage();
@@ -1239,6 +2191,21 @@ dataman_main(int argc, char *argv[])
 			k_data_manager_device_path = strdup(default_device_path);
 		}
 
+#if defined(DATAMAN_MMAP)
+
+		if (map_file) {
+			if (backend != BACKEND_FILE) {
+				PX4_WARN("-m and -r are mutually exclusive");
+				backend = BACKEND_NONE;
+				usage();
+				return -1;
+			}
+
+			backend = BACKEND_MMAP;
+		}
+
+#endif
+
 		start();
 
 		if (!is_running()) {
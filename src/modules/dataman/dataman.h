@@ -39,6 +39,7 @@
 #pragma once
 
 #include <string.h>
+#include <px4_platform_common/sem.h>
 #include <navigator/navigation.h>
 #include <uORB/topics/mission.h>
 
@@ -140,6 +141,88 @@ dm_clear(
 	dm_item_t item			/* The item type to clear */
 );
 
+/** Types of the requests of an asynchronous batch */
+typedef enum {
+	DM_REQUEST_READ = 0,		/* Read items into the buffer */
+	DM_REQUEST_WRITE,		/* Write items from the buffer */
+	DM_REQUEST_PREFETCH		/* Read mission items into the mission item cache only, no buffer. Only as many items
+					 * as the cache holds are read (DATAMAN_MISSION_CACHE_ITEMS), the request is complete
+					 * if they were read. */
+} dm_request_type_t;
+
+/** Request for a range of consecutive items of one type */
+typedef struct {
+	dm_request_type_t type;
+	dm_item_t item;			/* The item type */
+	unsigned index;			/* The index of the first item */
+	unsigned count;			/* The number of consecutive items */
+	void *buffer;			/* count items of buflen bytes each, not used for DM_REQUEST_PREFETCH */
+	size_t buflen;			/* Length in bytes of a single item */
+	unsigned result;		/* Set on completion: number of leading items transferred completely
+					 * (count for a complete DM_REQUEST_PREFETCH, even if it was capped) */
+} dm_request_t;
+
+typedef struct dm_batch_s dm_batch_t;
+
+/** Completion callback of a batch, called from the data manager thread: it must not block or call the data manager */
+typedef void (*dm_batch_callback_t)(dm_batch_t *batch, void *arg);
+
+/**
+ * Batch of requests processed in order by the data manager thread. Requests of the same type and item whose index
+ * ranges and buffers are adjacent are merged and every range is transferred with as few backend accesses as possible.
+ * The batch and the buffers must stay valid until dm_wait() returned or dm_done() returned true.
+ */
+struct dm_batch_s {
+	dm_request_t *requests;
+	unsigned num_requests;
+	dm_batch_callback_t callback;	/* Optional completion callback */
+	void *arg;			/* Argument of the callback */
+
+	/* private */
+	px4_sem_t done_sem;
+	bool pending;
+};
+
+/**
+ * Submit a batch without waiting for it to complete
+ * @return 0 if the batch was queued, -1 on error (the batch does not complete)
+ */
+__EXPORT int
+dm_submit(
+	dm_batch_t *batch		/* The batch to process */
+);
+
+/**
+ * Wait for a submitted batch to complete
+ * @return 0 if all requests were transferred completely, -1 otherwise
+ */
+__EXPORT int
+dm_wait(
+	dm_batch_t *batch		/* The submitted batch */
+);
+
+/**
+ * Check if a submitted batch completed, without blocking
+ * @return true if the batch completed or was not submitted
+ */
+__EXPORT bool
+dm_done(
+	dm_batch_t *batch		/* The submitted batch */
+);
+
+/**
+ * Read a range of consecutive items (a batch with a single read request)
+ * @return number of leading items read completely, -1 on error
+ */
+__EXPORT ssize_t
+dm_read_range(
+	dm_item_t item,			/* The item type to retrieve */
+	unsigned index,			/* The index of the first item */
+	unsigned count,			/* The number of consecutive items */
+	void *buffer,			/* Pointer to caller data buffer of count items */
+	size_t buflen			/* Length in bytes of a single item */
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,6 +26,14 @@ static constexpr float _m_pi2 = 1.57079632f;
 
 using namespace estimator;
 
+/**
+ * Bank of N_MODELS 3-state yaw EKFs, each driven by its own AHRS complementary filter, combined by a
+ * Gaussian Sum Filter (GSF).
+ *
+ * The model states are stored as structure of arrays (one array element per model) so that the
+ * prediction and update steps run over all models in flat loops the compiler can vectorize or unroll.
+ */
+template <uint8_t N_MODELS>
 class EKFGSF_yaw
 {
 public:
@@ -43,10 +51,10 @@ public:
 	// get solution data for logging
 	bool getLogData(float *yaw_composite,
 			float *yaw_composite_variance,
-			float yaw[N_MODELS_EKFGSF],
-			float innov_VN[N_MODELS_EKFGSF],
-			float innov_VE[N_MODELS_EKFGSF],
-			float weight[N_MODELS_EKFGSF]) const;
+			float yaw[N_MODELS],
+			float innov_VN[N_MODELS],
+			float innov_VE[N_MODELS],
+			float weight[N_MODELS]) const;
 
 	bool isActive() const { return _ekf_gsf_vel_fuse_started; }
 	float getYaw() const { return _gsf_yaw; }
@@ -60,7 +68,7 @@ private:
 	const float _tilt_gain{0.2f};		// gain from tilt error to gyro correction for complementary filter (1/sec)
 	const float _gyro_bias_gain{0.04f};	// gain applied to integral of gyro correction for complementary filter (1/sec)
 
-	// Declarations used by the bank of N_MODELS_EKFGSF AHRS complementary filters
+	// Declarations used by the bank of N_MODELS AHRS complementary filters
 
 	Vector3f _delta_ang{};	// IMU delta angle (rad)
 	Vector3f _delta_vel{};	// IMU delta velocity (m/s)
@@ -68,14 +76,10 @@ private:
 	float _delta_vel_dt{};	// _delta_vel integration time interval (sec)
 	float _true_airspeed{};	// true airspeed used for centripetal accel compensation (m/s)
 
-	struct _ahrs_ekf_gsf_struct {
-		Dcmf R;			// matrix that rotates a vector from body to earth frame
-		Vector3f gyro_bias;	// gyro bias learned and used by the quaternion calculation
-		bool aligned;		// true when AHRS has been aligned
-		float vel_NE[2];	// NE velocity vector from last GPS measurement (m/s)
-		bool fuse_gps;		// true when GPS should be fused on that frame
-		float accel_dt;		// time step used when generating _simple_accel_FR data (sec)
-	} _ahrs_ekf_gsf[N_MODELS_EKFGSF] {};
+	struct {
+		float R[3][3][N_MODELS];	// matrix that rotates a vector from body to earth frame
+		float gyro_bias[3][N_MODELS];	// gyro bias learned and used by the quaternion calculation
+	} _ahrs_ekf_gsf{};
 
 	bool _ahrs_ekf_gsf_tilt_aligned{};	// true the initial tilt alignment has been calculated
 	float _ahrs_accel_fusion_gain{};	// gain from accel vector tilt error to rate gyro correction used by AHRS calculation
@@ -85,8 +89,8 @@ private:
 	// calculate the gain from gravity vector misalingment to tilt correction to be used by all AHRS filters
 	float ahrsCalcAccelGain() const;
 
-	// update specified AHRS rotation matrix using IMU and optionally true airspeed data
-	void ahrsPredict(const uint8_t model_index);
+	// update all AHRS rotation matrices using IMU and optionally true airspeed data
+	void ahrsPredict();
 
 	// align all AHRS roll and pitch orientations using IMU delta velocity vector
 	void ahrsAlignTilt();
@@ -94,18 +98,27 @@ private:
 	// align all AHRS yaw orientations to initial values
 	void ahrsAlignYaw();
 
-	// Efficient propagation of a delta angle in body frame applied to the body to earth frame rotation matrix
-	Matrix3f ahrsPredictRotMat(const Matrix3f &R, const Vector3f &g);
+	// Declarations used by a bank of N_MODELS EKFs
 
-	// Declarations used by a bank of N_MODELS_EKFGSF EKFs
+	struct {
+		float X[3][N_MODELS];		// Vel North (m/s),  Vel East (m/s), yaw (rad)s
 
-	struct _ekf_gsf_struct {
-		matrix::Vector3f X; 				// Vel North (m/s),  Vel East (m/s), yaw (rad)s
-		matrix::SquareMatrix<float, 3> P; 		// covariance matrix
-		matrix::SquareMatrix<float, 2> S_inverse;	// inverse of the innovation covariance matrix
-		float S_det_inverse; 				// inverse of the innovation covariance matrix determinant
-		matrix::Vector2f innov; 			// Velocity N,E innovation (m/s)
-	} _ekf_gsf[N_MODELS_EKFGSF] {};
+		// covariance matrix (upper triangle)
+		float P00[N_MODELS];
+		float P01[N_MODELS];
+		float P02[N_MODELS];
+		float P11[N_MODELS];
+		float P12[N_MODELS];
+		float P22[N_MODELS];
+
+		// inverse of the innovation covariance matrix (upper triangle)
+		float S_inverse00[N_MODELS];
+		float S_inverse01[N_MODELS];
+		float S_inverse11[N_MODELS];
+
+		float S_det_inverse[N_MODELS];	// inverse of the innovation covariance matrix determinant
+		float innov[2][N_MODELS];	// Velocity N,E innovation (m/s)
+	} _ekf_gsf{};
 
 	bool _vel_data_updated{};	// true when velocity data has been updated
 	bool _run_ekf_gsf{};		// true when operating condition is suitable for to run the GSF and EKF models and fuse velocity data
@@ -116,18 +129,18 @@ private:
 	// initialise states and covariance data for the GSF and EKF filters
 	void initialiseEKFGSF();
 
-	// predict state and covariance for the specified EKF using inertial data
-	void predictEKF(const uint8_t model_index);
+	// predict state and covariance for all EKFs using inertial data
+	void predictEKF();
 
-	// update state and covariance for the specified EKF using a NE velocity measurement
-	// return false if update failed
-	bool updateEKF(const uint8_t model_index);
+	// update state and covariance for all EKFs using a NE velocity measurement
+	// return false if the update failed for any model
+	bool updateEKF();
 
 	inline float sq(float x) const { return x * x; };
 
 	// Declarations used by the Gaussian Sum Filter (GSF) that combines the individual EKF yaw estimates
 
-	matrix::Vector<float, N_MODELS_EKFGSF> _model_weights{};
+	matrix::Vector<float, N_MODELS> _model_weights{};
 	float _gsf_yaw{}; 		// yaw estimate (rad)
 	float _gsf_yaw_variance{}; 	// variance of yaw estimate (rad^2)
 
@@ -0,0 +1,604 @@
+// Definitions of the EKFGSF_yaw members, for the translation units that instantiate the class template
+// (EKFGSF_yaw.cpp for the EKF, the unit tests for other model counts)
+
+#ifndef EKF_EKFGSF_YAW_IMPL_H
+#define EKF_EKFGSF_YAW_IMPL_H
+
+#include "EKFGSF_yaw.h"
+#include <cstdlib>
+
+template <uint8_t N_MODELS>
+EKFGSF_yaw<N_MODELS>::EKFGSF_yaw()
+{
+	// this flag must be false when we start
+	_ahrs_ekf_gsf_tilt_aligned = false;
+
+	// these objects are initialised in initialise() before being used internally, but can be reported for logging before then
+	memset(&_ahrs_ekf_gsf, 0, sizeof(_ahrs_ekf_gsf));
+	memset(&_ekf_gsf, 0, sizeof(_ekf_gsf));
+	_gsf_yaw = 0.0f;
+	_ahrs_accel.zero();
+}
+
+template <uint8_t N_MODELS>
+void EKFGSF_yaw<N_MODELS>::update(const imuSample &imu_sample,
+			bool run_EKF,			// set to true when flying or movement is suitable for yaw estimation
+			float airspeed,			// true airspeed used for centripetal accel compensation - set to 0 when not required.
+			const Vector3f &imu_gyro_bias)  // estimated rate gyro bias (rad/sec)
+{
+	// copy to class variables
+	_delta_ang = imu_sample.delta_ang;
+	_delta_vel = imu_sample.delta_vel;
+	_delta_ang_dt = imu_sample.delta_ang_dt;
+	_delta_vel_dt = imu_sample.delta_vel_dt;
+	_run_ekf_gsf = run_EKF;
+	_true_airspeed = airspeed;
+
+	// to reduce effect of vibration, filter using an LPF whose time constant is 1/10 of the AHRS tilt correction time constant
+	const float filter_coef = fminf(10.0f * _delta_vel_dt * _tilt_gain, 1.0f);
+	const Vector3f accel = _delta_vel / fmaxf(_delta_vel_dt, 0.001f);
+	_ahrs_accel = _ahrs_accel * (1.0f - filter_coef) + accel * filter_coef;
+
+	// Initialise states first time
+	if (!_ahrs_ekf_gsf_tilt_aligned) {
+		// check for excessive acceleration to reduce likelihood of large initial roll/pitch errors
+		// due to vehicle movement
+		const float accel_norm_sq = accel.norm_squared();
+		const float upper_accel_limit = CONSTANTS_ONE_G * 1.1f;
+		const float lower_accel_limit = CONSTANTS_ONE_G * 0.9f;
+		const bool ok_to_align = (accel_norm_sq > sq(lower_accel_limit)) && (accel_norm_sq < sq(upper_accel_limit));
+
+		if (ok_to_align) {
+			initialiseEKFGSF();
+			ahrsAlignTilt();
+			_ahrs_ekf_gsf_tilt_aligned = true;
+		}
+
+		return;
+	}
+
+	// calculate common values used by the AHRS complementary filter models
+	_ahrs_accel_norm = _ahrs_accel.norm();
+
+	// AHRS prediction cycle for each model - this always runs
+	_ahrs_accel_fusion_gain = ahrsCalcAccelGain();
+
+	ahrsPredict();
+
+	// we don't start running the EKF part of the algorithm until there are regular velocity observations
+	if (_ekf_gsf_vel_fuse_started) {
+		predictEKF();
+	}
+
+	// The 3-state EKF models only run when flying to avoid corrupted estimates due to operator handling and GPS interference
+	if (_run_ekf_gsf && _vel_data_updated) {
+		if (!_ekf_gsf_vel_fuse_started) {
+			initialiseEKFGSF();
+			ahrsAlignYaw();
+
+			// Initialise to gyro bias estimate from main filter because there could be a large
+			// uncorrected rate gyro bias error about the gravity vector
+			for (uint8_t axis = 0; axis < 3; axis++) {
+				for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+					_ahrs_ekf_gsf.gyro_bias[axis][model_index] = imu_gyro_bias(axis);
+				}
+			}
+
+			_ekf_gsf_vel_fuse_started = true;
+
+		} else {
+			// subsequent measurements are fused as direct state observations
+			if (updateEKF()) {
+				float total_weight = 0.0f;
+				// calculate weighting for each model assuming a normal distribution
+				const float min_weight = 1e-5f;
+				uint8_t n_weight_clips = 0;
+
+				for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+					_model_weights(model_index) = gaussianDensity(model_index) * _model_weights(model_index);
+
+					if (_model_weights(model_index) < min_weight) {
+						n_weight_clips++;
+						_model_weights(model_index) = min_weight;
+					}
+
+					total_weight += _model_weights(model_index);
+				}
+
+				// normalise the weighting function
+				if (n_weight_clips < N_MODELS) {
+					_model_weights /= total_weight;
+
+				} else {
+					// all weights have collapsed due to excessive innovation variances so reset filters
+					initialiseEKFGSF();
+				}
+			}
+		}
+
+	} else if (_ekf_gsf_vel_fuse_started && !_run_ekf_gsf) {
+		// wait to fly again
+		_ekf_gsf_vel_fuse_started = false;
+	}
+
+	// Calculate a composite yaw vector as a weighted average of the states for each model.
+	// To avoid issues with angle wrapping, the yaw state is converted to a vector with length
+	// equal to the weighting value before it is summed.
+	Vector2f yaw_vector;
+
+	for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+		yaw_vector(0) += _model_weights(model_index) * cosf(_ekf_gsf.X[2][model_index]);
+		yaw_vector(1) += _model_weights(model_index) * sinf(_ekf_gsf.X[2][model_index]);
+	}
+
+	_gsf_yaw = atan2f(yaw_vector(1), yaw_vector(0));
+
+	// calculate a composite variance for the yaw state from a weighted average of the variance for each model
+	// models with larger innovations are weighted less
+	_gsf_yaw_variance = 0.0f;
+
+	for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+		const float yaw_delta = wrap_pi(_ekf_gsf.X[2][model_index] - _gsf_yaw);
+		_gsf_yaw_variance += _model_weights(model_index) * (_ekf_gsf.P22[model_index] + yaw_delta * yaw_delta);
+	}
+
+	// prevent the same velocity data being used more than once
+	_vel_data_updated = false;
+}
+
+template <uint8_t N_MODELS>
+void EKFGSF_yaw<N_MODELS>::ahrsPredict()
+{
+	// generate attitude solution using simple complementary filter for all models
+
+	auto &R = _ahrs_ekf_gsf.R;
+	auto &gyro_bias = _ahrs_ekf_gsf.gyro_bias;
+
+	const Vector3f ang_rate_meas = _delta_ang / fmaxf(_delta_ang_dt, 0.001f);
+	const bool accel_fusion = _ahrs_accel_fusion_gain > 0.0f;
+	const bool centripetal_accel_compensation = _true_airspeed > FLT_EPSILON;
+	const float accel_norm_inv = 1.0f / _ahrs_accel_norm;
+	const float gyro_bias_gain = _gyro_bias_gain * _delta_ang_dt;
+	constexpr float gyro_bias_limit = 0.05f;
+
+	for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+		const float ang_rate0 = ang_rate_meas(0) - gyro_bias[0][model_index];
+		const float ang_rate1 = ang_rate_meas(1) - gyro_bias[1][model_index];
+		const float ang_rate2 = ang_rate_meas(2) - gyro_bias[2][model_index];
+
+		// Perform angular rate correction using accel data and reduce correction as accel magnitude moves away from 1 g (reduces drift when vehicle picked up and moved).
+		// During fixed wing flight, compensate for centripetal acceleration assuming coordinated turns and X axis forward
+		float tilt_correction0 = 0.0f;
+		float tilt_correction1 = 0.0f;
+		float tilt_correction2 = 0.0f;
+
+		if (accel_fusion) {
+			float accel0 = _ahrs_accel(0);
+			float accel1 = _ahrs_accel(1);
+			float accel2 = _ahrs_accel(2);
+
+			if (centripetal_accel_compensation) {
+				// correct measured accel for body frame centripetal acceleration with assumption X axis is aligned with the airspeed vector
+				accel1 -= _true_airspeed * ang_rate2;
+				accel2 -= - _true_airspeed * ang_rate1;
+			}
+
+			// gravity direction in body frame is the last row of the body to earth rotation matrix
+			const float gravity_bf0 = R[2][0][model_index];
+			const float gravity_bf1 = R[2][1][model_index];
+			const float gravity_bf2 = R[2][2][model_index];
+
+			tilt_correction0 = ((gravity_bf1 * accel2 - gravity_bf2 * accel1) * _ahrs_accel_fusion_gain) * accel_norm_inv;
+			tilt_correction1 = ((-gravity_bf0 * accel2 + gravity_bf2 * accel0) * _ahrs_accel_fusion_gain) * accel_norm_inv;
+			tilt_correction2 = ((gravity_bf0 * accel1 - gravity_bf1 * accel0) * _ahrs_accel_fusion_gain) * accel_norm_inv;
+		}
+
+		// Gyro bias estimation
+		const float spin_rate = sqrtf(ang_rate0 * ang_rate0 + ang_rate1 * ang_rate1 + ang_rate2 * ang_rate2);
+
+		if (spin_rate < 0.175f) {
+			gyro_bias[0][model_index] = math::constrain(gyro_bias[0][model_index] - tilt_correction0 * gyro_bias_gain,
+						    -gyro_bias_limit, gyro_bias_limit);
+			gyro_bias[1][model_index] = math::constrain(gyro_bias[1][model_index] - tilt_correction1 * gyro_bias_gain,
+						    -gyro_bias_limit, gyro_bias_limit);
+			gyro_bias[2][model_index] = math::constrain(gyro_bias[2][model_index] - tilt_correction2 * gyro_bias_gain,
+						    -gyro_bias_limit, gyro_bias_limit);
+		}
+
+		// delta angle from previous to current frame
+		const float g0 = _delta_ang(0) + (tilt_correction0 - gyro_bias[0][model_index]) * _delta_ang_dt;
+		const float g1 = _delta_ang(1) + (tilt_correction1 - gyro_bias[1][model_index]) * _delta_ang_dt;
+		const float g2 = _delta_ang(2) + (tilt_correction2 - gyro_bias[2][model_index]) * _delta_ang_dt;
+
+		// Apply delta angle to rotation matrix and renormalise rows
+		for (uint8_t r = 0; r < 3; r++) {
+			const float R0 = R[r][0][model_index];
+			const float R1 = R[r][1][model_index];
+			const float R2 = R[r][2][model_index];
+
+			float ret0 = R0 + (R1 * g2 - R2 * g1);
+			float ret1 = R1 + (R2 * g0 - R0 * g2);
+			float ret2 = R2 + (R0 * g1 - R1 * g0);
+
+			const float row_length_sq = ret0 * ret0 + ret1 * ret1 + ret2 * ret2;
+
+			if (row_length_sq > FLT_EPSILON) {
+				// Use linear approximation for inverse sqrt taking advantage of the row length being close to 1.0
+				const float row_length_inv = 1.5f - 0.5f * row_length_sq;
+				ret0 *= row_length_inv;
+				ret1 *= row_length_inv;
+				ret2 *= row_length_inv;
+			}
+
+			R[r][0][model_index] = ret0;
+			R[r][1][model_index] = ret1;
+			R[r][2][model_index] = ret2;
+		}
+	}
+}
+
+template <uint8_t N_MODELS>
+void EKFGSF_yaw<N_MODELS>::ahrsAlignTilt()
+{
+	// Rotation matrix is constructed directly from acceleration measurement and will be the same for
+	// all models so only need to calculate it once. Assumptions are:
+	// 1) Yaw angle is zero - yaw is aligned later for each model when velocity fusion commences.
+	// 2) The vehicle is not accelerating so all of the measured acceleration is due to gravity.
+
+	// Calculate earth frame Down axis unit vector rotated into body frame
+	const Vector3f down_in_bf = -_delta_vel.normalized();
+
+	// Calculate earth frame North axis unit vector rotated into body frame, orthogonal to 'down_in_bf'
+	const Vector3f i_vec_bf(1.0f, 0.0f, 0.0f);
+	Vector3f north_in_bf = i_vec_bf - down_in_bf * (i_vec_bf.dot(down_in_bf));
+	north_in_bf.normalize();
+
+	// Calculate earth frame East axis unit vector rotated into body frame, orthogonal to 'down_in_bf' and 'north_in_bf'
+	const Vector3f east_in_bf = down_in_bf % north_in_bf;
+
+	// Each column in a rotation matrix from earth frame to body frame represents the projection of the
+	// corresponding earth frame unit vector rotated into the body frame, eg 'north_in_bf' would be the first column.
+	// We need the rotation matrix from body frame to earth frame so the earth frame unit vectors rotated into body
+	// frame are copied into corresponding rows instead.
+	Dcmf R;
+	R.setRow(0, north_in_bf);
+	R.setRow(1, east_in_bf);
+	R.setRow(2, down_in_bf);
+
+	for (uint8_t r = 0; r < 3; r++) {
+		for (uint8_t c = 0; c < 3; c++) {
+			for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+				_ahrs_ekf_gsf.R[r][c][model_index] = R(r, c);
+			}
+		}
+	}
+}
+
+template <uint8_t N_MODELS>
+void EKFGSF_yaw<N_MODELS>::ahrsAlignYaw()
+{
+	// Align yaw angle for each model
+	for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+		Dcmf R;
+
+		for (uint8_t r = 0; r < 3; r++) {
+			for (uint8_t c = 0; c < 3; c++) {
+				R(r, c) = _ahrs_ekf_gsf.R[r][c][model_index];
+			}
+		}
+
+		const float yaw = wrap_pi(_ekf_gsf.X[2][model_index]);
+		R = updateYawInRotMat(yaw, R);
+
+		for (uint8_t r = 0; r < 3; r++) {
+			for (uint8_t c = 0; c < 3; c++) {
+				_ahrs_ekf_gsf.R[r][c][model_index] = R(r, c);
+			}
+		}
+	}
+}
+
+template <uint8_t N_MODELS>
+void EKFGSF_yaw<N_MODELS>::predictEKF()
+{
+	const auto &R = _ahrs_ekf_gsf.R;
+
+	float cos_yaw[N_MODELS];
+	float sin_yaw[N_MODELS];
+
+	for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+		// Calculate the yaw state using a projection onto the horizontal that avoids gimbal lock
+		// (see getEulerYaw())
+		const float psi = (fabsf(R[2][0][model_index]) < fabsf(R[2][1][model_index]))
+				  ? atan2f(R[1][0][model_index], R[0][0][model_index])
+				  : atan2f(-R[0][1][model_index], R[1][1][model_index]);
+
+		_ekf_gsf.X[2][model_index] = psi;
+		cos_yaw[model_index] = cosf(psi);
+		sin_yaw[model_index] = sinf(psi);
+	}
+
+	// Use fixed values for delta velocity and delta angle process noise variances
+	const float dvxVar = sq(_accel_noise * _delta_vel_dt); // variance of forward delta velocity - (m/s)^2
+	const float dvyVar = dvxVar; // variance of right delta velocity - (m/s)^2
+	const float dazVar = sq(_gyro_noise * _delta_ang_dt); // variance of yaw delta angle - rad^2
+
+	// constrain variances
+	const float min_var = 1e-6f;
+
+	for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+		// calculate delta velocity in a horizontal front-right frame
+		const float del_vel_N = R[0][0][model_index] * _delta_vel(0) + R[0][1][model_index] * _delta_vel(1)
+					+ R[0][2][model_index] * _delta_vel(2);
+		const float del_vel_E = R[1][0][model_index] * _delta_vel(0) + R[1][1][model_index] * _delta_vel(1)
+					+ R[1][2][model_index] * _delta_vel(2);
+		const float dvx =   del_vel_N * cos_yaw[model_index] + del_vel_E * sin_yaw[model_index];
+		const float dvy = - del_vel_N * sin_yaw[model_index] + del_vel_E * cos_yaw[model_index];
+
+		// sum delta velocities in earth frame:
+		_ekf_gsf.X[0][model_index] += del_vel_N;
+		_ekf_gsf.X[1][model_index] += del_vel_E;
+
+		// predict covariance - equations generated using EKF/python/gsf_ekf_yaw_estimator/main.py
+
+		// Local short variable name copies required for readability
+		const float P00 = _ekf_gsf.P00[model_index];
+		const float P01 = _ekf_gsf.P01[model_index];
+		const float P02 = _ekf_gsf.P02[model_index];
+		const float P11 = _ekf_gsf.P11[model_index];
+		const float P12 = _ekf_gsf.P12[model_index];
+		const float P22 = _ekf_gsf.P22[model_index];
+
+		// optimized auto generated code from SymPy script src/lib/ecl/EKF/python/ekf_derivation/main.py
+		const float S0 = cos_yaw[model_index];
+		const float S1 = ecl::powf(S0, 2);
+		const float S2 = sin_yaw[model_index];
+		const float S3 = ecl::powf(S2, 2);
+		const float S4 = S0*dvy + S2*dvx;
+		const float S5 = P02 - P22*S4;
+		const float S6 = S0*dvx - S2*dvy;
+		const float S7 = S0*S2;
+		const float S8 = P01 + S7*dvxVar - S7*dvyVar;
+		const float S9 = P12 + P22*S6;
+
+		_ekf_gsf.P00[model_index] = fmaxf(P00 - P02*S4 + S1*dvxVar + S3*dvyVar - S4*S5, min_var);
+		_ekf_gsf.P01[model_index] = -P12*S4 + S5*S6 + S8;
+		_ekf_gsf.P11[model_index] = fmaxf(P11 + P12*S6 + S1*dvyVar + S3*dvxVar + S6*S9, min_var);
+		_ekf_gsf.P02[model_index] = S5;
+		_ekf_gsf.P12[model_index] = S9;
+		_ekf_gsf.P22[model_index] = fmaxf(P22 + dazVar, min_var);
+	}
+}
+
+// Update EKF states and covariance for all models using velocity measurement
+template <uint8_t N_MODELS>
+bool EKFGSF_yaw<N_MODELS>::updateEKF()
+{
+	// set observation variance from accuracy estimate supplied by GPS and apply a sanity check minimum
+	const float velObsVar = sq(fmaxf(_vel_accuracy, 0.01f));
+
+	// constrain variances
+	const float min_var = 1e-6f;
+
+	bool update_ok = true;
+	float yaw_delta[N_MODELS];
+
+	for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+		// calculate velocity observation innovations
+		const float innov0 = _ekf_gsf.X[0][model_index] - _vel_NE(0);
+		const float innov1 = _ekf_gsf.X[1][model_index] - _vel_NE(1);
+		_ekf_gsf.innov[0][model_index] = innov0;
+		_ekf_gsf.innov[1][model_index] = innov1;
+
+		// Use temporary variables for covariance elements to reduce verbosity of auto-code expressions
+		const float P00 = _ekf_gsf.P00[model_index];
+		const float P01 = _ekf_gsf.P01[model_index];
+		const float P02 = _ekf_gsf.P02[model_index];
+		const float P11 = _ekf_gsf.P11[model_index];
+		const float P12 = _ekf_gsf.P12[model_index];
+		const float P22 = _ekf_gsf.P22[model_index];
+
+		// optimized auto generated code from SymPy script src/lib/ecl/EKF/python/ekf_derivation/main.py
+		const float t0 = ecl::powf(P01, 2);
+		const float t1 = -t0;
+		const float t2 = P00*P11 + P00*velObsVar + P11*velObsVar + t1 + ecl::powf(velObsVar, 2);
+
+		if (fabsf(t2) < 1e-6f) {
+			// skip this model, the other models are still updated
+			update_ok = false;
+			yaw_delta[model_index] = 0.f;
+			continue;
+		}
+
+		const float t3 = 1.0F/t2;
+		const float t4 = P11 + velObsVar;
+		const float t5 = P01*t3;
+		const float t6 = -t5;
+		const float t7 = P00 + velObsVar;
+		const float t8 = P00*t4 + t1;
+		const float t9 = t5*velObsVar;
+		const float t10 = P11*t7;
+		const float t11 = t1 + t10;
+		const float t12 = P01*P12;
+		const float t13 = P02*t4;
+		const float t14 = P01*P02;
+		const float t15 = P12*t7;
+		const float t16 = t0*velObsVar;
+		const float t17 = ecl::powf(t2, -2);
+		const float t18 = t4*velObsVar + t8;
+		const float t19 = t17*t18;
+		const float t20 = t17*(t16 + t7*t8);
+		const float t21 = t0 - t10;
+		const float t22 = t17*t21;
+		const float t23 = t14 - t15;
+		const float t24 = P01*t23;
+		const float t25 = t12 - t13;
+		const float t26 = t16 - t21*t4;
+		const float t27 = t17*t26;
+		const float t28 = t11 + t7*velObsVar;
+		const float t30 = t17*t28;
+		const float t31 = P01*t25;
+		const float t32 = t23*t4 + t31;
+		const float t33 = t17*t32;
+		const float t35 = t24 + t25*t7;
+		const float t36 = t17*t35;
+
+		_ekf_gsf.S_det_inverse[model_index] = t3;
+
+		const float S_inverse00 = t3*t4;
+		const float S_inverse01 = t6;
+		const float S_inverse11 = t3*t7;
+		_ekf_gsf.S_inverse00[model_index] = S_inverse00;
+		_ekf_gsf.S_inverse01[model_index] = S_inverse01;
+		_ekf_gsf.S_inverse11[model_index] = S_inverse11;
+
+		const float K00 = t3*t8;
+		const float K10 = t9;
+		const float K20 = t3*(-t12 + t13);
+		const float K01 = t9;
+		const float K11 = t11*t3;
+		const float K21 = t3*(-t14 + t15);
+
+		_ekf_gsf.P00[model_index] = fmaxf(P00 - t16*t19 - t20*t8, min_var);
+		_ekf_gsf.P01[model_index] = P01*(t18*t22 - t20*velObsVar + 1);
+		_ekf_gsf.P11[model_index] = fmaxf(P11 - t16*t30 + t22*t26, min_var);
+		_ekf_gsf.P02[model_index] = P02 + t19*t24 + t20*t25;
+		_ekf_gsf.P12[model_index] = P12 + t23*t27 + t30*t31;
+		_ekf_gsf.P22[model_index] = fmaxf(P22 - t23*t33 - t25*t36, min_var);
+
+		// test ratio = transpose(innovation) * inverse(innovation variance) * innovation = [1x2] * [2,2] * [2,1] = [1,1]
+		const float test_ratio = innov0 * (S_inverse00 * innov0 + S_inverse01 * innov1)
+					 + innov1 * (S_inverse01 * innov0 + S_inverse11 * innov1);
+
+		// Perform a chi-square innovation consistency test and calculate a compression scale factor
+		// that limits the magnitude of innovations to 5-sigma
+		// If the test ratio is greater than 25 (5 Sigma) then reduce the length of the innovation vector to clip it at 5-Sigma
+		// This protects from large measurement spikes
+		const float innov_comp_scale_factor = test_ratio > 25.f ? sqrtf(25.0f / test_ratio) : 1.f;
+
+		// Correct the state vector and capture the change in yaw angle
+		const float oldYaw = _ekf_gsf.X[2][model_index];
+
+		_ekf_gsf.X[0][model_index] -= (K00 * innov0 + K01 * innov1) * innov_comp_scale_factor;
+		_ekf_gsf.X[1][model_index] -= (K10 * innov0 + K11 * innov1) * innov_comp_scale_factor;
+		_ekf_gsf.X[2][model_index] -= (K20 * innov0 + K21 * innov1) * innov_comp_scale_factor;
+
+		yaw_delta[model_index] = _ekf_gsf.X[2][model_index] - oldYaw;
+	}
+
+	// apply the change in yaw angle to the AHRS
+	// take advantage of sparseness in the yaw rotation matrix
+	auto &R = _ahrs_ekf_gsf.R;
+
+	for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+		const float cosYaw = cosf(yaw_delta[model_index]);
+		const float sinYaw = sinf(yaw_delta[model_index]);
+
+		for (uint8_t c = 0; c < 3; c++) {
+			const float R_prev0 = R[0][c][model_index];
+			const float R_prev1 = R[1][c][model_index];
+
+			R[0][c][model_index] = R_prev0 * cosYaw - R_prev1 * sinYaw;
+			R[1][c][model_index] = R_prev0 * sinYaw + R_prev1 * cosYaw;
+		}
+	}
+
+	return update_ok;
+}
+
+template <uint8_t N_MODELS>
+void EKFGSF_yaw<N_MODELS>::initialiseEKFGSF()
+{
+	_gsf_yaw = 0.0f;
+	_ekf_gsf_vel_fuse_started = false;
+	_gsf_yaw_variance = _m_pi2 * _m_pi2;
+	_model_weights.setAll(1.0f / (float)N_MODELS);  // All filter models start with the same weight
+
+	memset(&_ekf_gsf, 0, sizeof(_ekf_gsf));
+	const float yaw_increment = 2.0f * _m_pi / (float)N_MODELS;
+
+	for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+		// evenly space initial yaw estimates in the region between +-Pi
+		_ekf_gsf.X[2][model_index] = -_m_pi + (0.5f * yaw_increment) + ((float)model_index * yaw_increment);
+
+		// take velocity states and corresponding variance from last measurement
+		_ekf_gsf.X[0][model_index] = _vel_NE(0);
+		_ekf_gsf.X[1][model_index] = _vel_NE(1);
+		_ekf_gsf.P00[model_index] = sq(_vel_accuracy);
+		_ekf_gsf.P11[model_index] = _ekf_gsf.P00[model_index];
+
+		// use half yaw interval for yaw uncertainty
+		_ekf_gsf.P22[model_index] = sq(0.5f * yaw_increment);
+	}
+}
+
+template <uint8_t N_MODELS>
+float EKFGSF_yaw<N_MODELS>::gaussianDensity(const uint8_t model_index) const
+{
+	const float innov0 = _ekf_gsf.innov[0][model_index];
+	const float innov1 = _ekf_gsf.innov[1][model_index];
+	const float S_inverse00 = _ekf_gsf.S_inverse00[model_index];
+	const float S_inverse01 = _ekf_gsf.S_inverse01[model_index];
+	const float S_inverse11 = _ekf_gsf.S_inverse11[model_index];
+
+	// calculate transpose(innovation) * inv(S) * innovation
+	const float normDist = innov0 * (S_inverse00 * innov0 + S_inverse01 * innov1)
+			       + innov1 * (S_inverse01 * innov0 + S_inverse11 * innov1);
+
+	return _m_2pi_inv * sqrtf(_ekf_gsf.S_det_inverse[model_index]) * expf(-0.5f * normDist);
+}
+
+template <uint8_t N_MODELS>
+bool EKFGSF_yaw<N_MODELS>::getLogData(float *yaw_composite, float *yaw_variance, float yaw[N_MODELS],
+				      float innov_VN[N_MODELS], float innov_VE[N_MODELS], float weight[N_MODELS]) const
+{
+	if (_ekf_gsf_vel_fuse_started) {
+		*yaw_composite = _gsf_yaw;
+		*yaw_variance = _gsf_yaw_variance;
+
+		for (uint8_t model_index = 0; model_index < N_MODELS; model_index++) {
+			yaw[model_index] = _ekf_gsf.X[2][model_index];
+			innov_VN[model_index] = _ekf_gsf.innov[0][model_index];
+			innov_VE[model_index] = _ekf_gsf.innov[1][model_index];
+			weight[model_index] = _model_weights(model_index);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+template <uint8_t N_MODELS>
+float EKFGSF_yaw<N_MODELS>::ahrsCalcAccelGain() const
+{
+	// Calculate the acceleration fusion gain using a continuous function that is unity at 1g and zero
+	// at the min and max g value. Allow for more acceleration when flying as a fixed wing vehicle using centripetal
+	// acceleration correction as higher and more sustained g will be experienced.
+	// Use a quadratic instead of linear function to prevent vibration around 1g reducing the tilt correction effectiveness.
+	// see https://www.desmos.com/calculator/dbqbxvnwfg
+
+	float attenuation = 2.f;
+	const bool centripetal_accel_compensation_enabled = (_true_airspeed > FLT_EPSILON);
+
+	if (centripetal_accel_compensation_enabled
+	    && _ahrs_accel_norm > CONSTANTS_ONE_G) {
+		attenuation = 1.f;
+	}
+
+	const float delta_accel_g = (_ahrs_accel_norm - CONSTANTS_ONE_G) / CONSTANTS_ONE_G;
+	return _tilt_gain * sq(1.f - math::min(attenuation * fabsf(delta_accel_g), 1.f));
+}
+
+template <uint8_t N_MODELS>
+void EKFGSF_yaw<N_MODELS>::setVelocity(const Vector2f &velocity, float accuracy)
+{
+	_vel_NE = velocity;
+	_vel_accuracy = accuracy;
+	_vel_data_updated = true;
+}
+
+// the model count of the EKF is instantiated once, in EKFGSF_yaw.cpp
+extern template class EKFGSF_yaw<N_MODELS_EKFGSF>;
+
+#endif // !EKF_EKFGSF_YAW_IMPL_H
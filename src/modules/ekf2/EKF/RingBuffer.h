@@ -37,17 +37,44 @@
  * Template RingBuffer.
  */
 
+#pragma once
+
 #include <inttypes.h>
 #include <cstdio>
 #include <cstring>
 
+namespace ringbuffer_detail
+{
+// storage of a RingBuffer with compile-time capacity, empty for dynamically allocated buffers
+template <typename data_type, uint8_t Capacity>
+struct Storage {
+	data_type *get() { return data; }
+	data_type data[Capacity] {};
+};
+
 template <typename data_type>
+struct Storage<data_type, 0> {
+	data_type *get() { return nullptr; }
+};
+} // namespace ringbuffer_detail
+
+/**
+ * Ring buffer of samples ordered by time, samples have to be pushed with monotonically increasing timestamps.
+ *
+ * With Capacity == 0 (default) the buffer is allocated on the heap with the size given at runtime,
+ * otherwise it uses static storage of Capacity elements and any size up to Capacity can be allocated.
+ */
+template <typename data_type, uint8_t Capacity = 0>
 class RingBuffer
 {
 public:
 	explicit RingBuffer(size_t size) { allocate(size); }
-	RingBuffer() = delete;
-	~RingBuffer() { delete[] _buffer; }
+	RingBuffer()
+	{
+		static_assert(Capacity > 0, "size required for dynamically allocated RingBuffer");
+		allocate(Capacity);
+	}
+	~RingBuffer() { free(); }
 
 	// no copy, assignment, move, move assignment
 	RingBuffer(const RingBuffer &) = delete;
@@ -66,14 +93,25 @@ public:
 			return false;
 		}
 
-		if (_buffer != nullptr) {
-			delete[] _buffer;
-		}
+		if (Capacity > 0) {
+			if (size > Capacity) {
+				return false;
+			}
 
-		_buffer = new data_type[size] {};
+			_buffer = _storage.get();
 
-		if (_buffer == nullptr) {
-			return false;
+			for (uint8_t i = 0; i < size; i++) {
+				_buffer[i] = {};
+			}
+
+		} else {
+			free();
+
+			_buffer = new data_type[size] {};
+
+			if (_buffer == nullptr) {
+				return false;
+			}
 		}
 
 		_size = size;
@@ -111,49 +149,69 @@ public:
 	uint8_t get_length() const { return _size; }
 
 	data_type &operator[](const uint8_t index) { return _buffer[index]; }
+	const data_type &operator[](const uint8_t index) const { return _buffer[index]; }
 
 	const data_type &get_newest() const { return _buffer[_head]; }
 	const data_type &get_oldest() const { return _buffer[_tail]; }
 
 	uint8_t get_oldest_index() const { return _tail; }
+	uint8_t get_newest_index() const { return _head; }
 
+	// pop the newest sample that is older than timestamp (but not by more than 0.1 s),
+	// the sample and all older samples are removed from the buffer
 	bool pop_first_older_than(const uint64_t &timestamp, data_type *sample)
 	{
-		// start looking from newest observation data
-		for (uint8_t i = 0; i < _size; i++) {
-			int index = (_head - i);
-			index = index < 0 ? _size + index : index;
+		if (_first_write) {
+			// empty
+			return false;
+		}
 
-			if (timestamp >= _buffer[index].time_us && timestamp < _buffer[index].time_us + (uint64_t)1e5) {
-				*sample = _buffer[index];
+		// the tail follows the last consumed sample, usually nothing is old enough yet
+		if (timestamp < _buffer[_tail].time_us) {
+			return false;
+		}
 
-				// Now we can set the tail to the item which
-				// comes after the one we removed since we don't
-				// want to have any older data in the buffer
-				if (index == _head) {
-					_tail = _head;
-					_first_write = true;
+		// binary search for the newest sample older than timestamp, offsets are relative to the tail
+		uint8_t older = 0;
+		uint8_t newer = ((_head >= _tail) ? (_head - _tail) : (_head + _size - _tail)) + 1;
 
-				} else {
-					_tail = (index + 1) % _size;
-				}
+		while (newer - older > 1) {
+			const uint8_t middle = (older + newer) / 2;
 
-				_buffer[index].time_us = 0;
+			if (_buffer[offsetToIndex(middle)].time_us <= timestamp) {
+				older = middle;
 
-				return true;
+			} else {
+				newer = middle;
 			}
+		}
 
-			if (index == _tail) {
-				// we have reached the tail and haven't got a
-				// match
-				return false;
-			}
+		const uint8_t index = offsetToIndex(older);
+
+		if (timestamp >= _buffer[index].time_us + (uint64_t)1e5) {
+			// too old
+			return false;
+		}
+
+		*sample = _buffer[index];
+
+		// Now we can set the tail to the item which
+		// comes after the one we removed since we don't
+		// want to have any older data in the buffer
+		if (index == _head) {
+			_tail = _head;
+			_first_write = true;
+
+		} else {
+			_tail = (index + 1) % _size;
 		}
 
-		return false;
+		_buffer[index].time_us = 0;
+
+		return true;
 	}
 
-	int get_total_size() const { return sizeof(*this) + sizeof(data_type) * _size; }
+	int get_total_size() const { return sizeof(*this) + ((Capacity > 0) ? 0 : sizeof(data_type) * _size); }
 
 	int entries() const
 	{
@@ -169,6 +227,21 @@ public:
 	}
 
 private:
+	uint8_t offsetToIndex(uint8_t offset) const
+	{
+		const int index = _tail + offset;
+		return (index < _size) ? index : index - _size;
+	}
+
+	void free()
+	{
+		if (Capacity == 0) {
+			delete[] _buffer;
+		}
+
+		_buffer = nullptr;
+	}
+
 	data_type *_buffer{nullptr};
 
 	uint8_t _head{0};
@@ -176,4 +249,6 @@ private:
 	uint8_t _size{0};
 
 	bool _first_write{true};
+
+	ringbuffer_detail::Storage<data_type, Capacity> _storage{};
 };
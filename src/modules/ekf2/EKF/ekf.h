@@ -55,6 +55,7 @@ public:
 
 	typedef matrix::Vector<float, _k_num_states> Vector24f;
 	typedef matrix::SquareMatrix<float, _k_num_states> SquareMatrix24f;
+	typedef matrix::SymmetricMatrix<float, _k_num_states> SymmetricMatrix24f;
 	typedef matrix::SquareMatrix<float, 2> Matrix2f;
 	typedef matrix::Vector<float, 4> Vector4f;
 	template<int ... Idxs>
@@ -139,25 +140,25 @@ public:
 	const Vector2f &getWindVelocity() const { return _state.wind_vel; };
 
 	// get the wind velocity var
-	Vector2f getWindVelocityVariance() const { return P.slice<2, 2>(22, 22).diag(); }
+	Vector2f getWindVelocityVariance() const { return P.slice<2>(22).diag(); }
 
 	// get the true airspeed in m/s
 	float getTrueAirspeed() const;
 
 	// get the full covariance matrix
-	const matrix::SquareMatrix<float, 24> &covariances() const { return P; }
+	matrix::SquareMatrix<float, 24> covariances() const { return P.dense(); }
 
 	// get the diagonal elements of the covariance matrix
 	matrix::Vector<float, 24> covariances_diagonal() const { return P.diag(); }
 
 	// get the orientation (quaterion) covariances
-	matrix::SquareMatrix<float, 4> orientation_covariances() const { return P.slice<4, 4>(0, 0); }
+	matrix::SquareMatrix<float, 4> orientation_covariances() const { return P.slice<4>(0); }
 
 	// get the linear velocity covariances
-	matrix::SquareMatrix<float, 3> velocity_covariances() const { return P.slice<3, 3>(4, 4); }
+	matrix::SquareMatrix<float, 3> velocity_covariances() const { return P.slice<3>(4); }
 
 	// get the position covariances
-	matrix::SquareMatrix<float, 3> position_covariances() const { return P.slice<3, 3>(7, 7); }
+	matrix::SquareMatrix<float, 3> position_covariances() const { return P.slice<3>(7); }
 
 	// ask estimator for sensor data collection decision and do any preprocessing if required, returns true if not defined
 	bool collect_gps(const gps_message &gps) override;
@@ -191,13 +192,13 @@ public:
 	// Reset all magnetometer bias states and covariances to initial alignment values.
 	void resetMagBias();
 
-	Vector3f getVelocityVariance() const { return P.slice<3, 3>(4, 4).diag(); };
+	Vector3f getVelocityVariance() const { return P.slice<3>(4).diag(); };
 
-	Vector3f getPositionVariance() const { return P.slice<3, 3>(7, 7).diag(); }
+	Vector3f getPositionVariance() const { return P.slice<3>(7).diag(); }
 
 	// return an array containing the output predictor angular, velocity and position tracking
 	// error magnitudes (rad), (m/sec), (m)
-	const Vector3f &getOutputTrackingError() const { return _output_tracking_error; }
+	const Vector3f &getOutputTrackingError() const { return _output_predictor.getOutputTrackingError(); }
 
 	// First argument returns GPS drift  metrics in the following array locations
 	// 0 : Horizontal position drift rate (m/s)
@@ -321,6 +322,13 @@ public:
 	// use the latest IMU data at the current time horizon.
 	Quatf calculate_quaternion() const;
 
+	// EKF states at the fusion time horizon tracked by the output predictor
+	OutputPredictor::FilterStates getOutputPredictorStates() const
+	{
+		return OutputPredictor::FilterStates{_imu_sample_delayed.time_us, _state.quat_nominal, _state.vel, _state.pos,
+						     _state.delta_ang_bias, _state.delta_vel_bias, _dt_imu_avg, _dt_ekf_avg};
+	}
+
 	// set minimum continuous period without GPS fail required to mark a healthy GPS status
 	void set_min_required_gps_health_time(uint32_t time_us) { _min_gps_health_time_us = time_us; }
 
@@ -338,6 +346,9 @@ public:
 
 private:
 
+	// compares the generated covariance prediction kernels
+	friend class EkfCovariancePredictionTest;
+
 	// set the internal states and status to their default value
 	void reset();
 
@@ -412,8 +423,6 @@ private:
 
 	// used by magnetometer fusion mode selection
 	Vector2f _accel_lpf_NE{};			///< Low pass filtered horizontal earth frame acceleration (m/sec**2)
-	float _yaw_delta_ef{0.0f};		///< Recent change in yaw angle measured about the earth frame D axis (rad)
-	float _yaw_rate_lpf_ef{0.0f};		///< Filtered angular rate about earth frame D axis (rad/sec)
 	bool _mag_bias_observable{false};	///< true when there is enough rotation to make magnetometer bias errors observable
 	bool _yaw_angle_observable{false};	///< true when there is enough horizontal acceleration to make yaw observable
 	uint64_t _time_yaw_started{0};		///< last system time in usec that a yaw rotation manoeuvre was detected
@@ -428,7 +437,7 @@ private:
 	bool _non_mag_yaw_aiding_running_prev{false};  ///< true when heading is being fused from other sources that are not the magnetometer (for example EV or GPS).
 	bool _is_yaw_fusion_inhibited{false};		///< true when yaw sensor use is being inhibited
 
-	SquareMatrix24f P{};	///< state covariance matrix
+	SymmetricMatrix24f P{};	///< state covariance matrix (upper triangle only)
 
 	Vector3f _delta_vel_bias_var_accum{};		///< kahan summation algorithm accumulator for delta velocity bias variance
 	Vector3f _delta_angle_bias_var_accum{};	///< kahan summation algorithm accumulator for delta angle bias variance
@@ -491,12 +500,6 @@ private:
 	bool _inhibit_flow_use{false};	///< true when use of optical flow and range finder is being inhibited
 	Vector2f _flow_compensated_XY_rad{};	///< measured delta angle of the image about the X and Y body axes after removal of body rotation (rad), RH rotation is positive
 
-	// output predictor states
-	Vector3f _delta_angle_corr{};	///< delta angle correction vector (rad)
-	Vector3f _vel_err_integ{};	///< integral of velocity tracking error (m)
-	Vector3f _pos_err_integ{};	///< integral of position tracking error (m.s)
-	Vector3f _output_tracking_error{}; ///< contains the magnitude of the angle, velocity and position track errors (rad, m/s, m)
-
 	// variables used for the GPS quality checks
 	Vector3f _gps_pos_deriv_filt{};	///< GPS NED position derivative (m/sec)
 	Vector2f _gps_velNE_filt{};	///< filtered GPS North and East velocity (m/sec)
@@ -566,12 +569,6 @@ private:
 
 	float _height_rate_lpf{0.0f};
 
-	// update the real time complementary filter states. This includes the prediction
-	// and the correction step
-	void calculateOutputStates(const imuSample &imu);
-	void applyCorrectionToVerticalOutputBuffer(float vert_vel_correction);
-	void applyCorrectionToOutputBuffer(const Vector3f &vel_correction, const Vector3f &pos_correction);
-
 	// initialise filter states of both the delayed ekf and the real time complementary filter
 	bool initialiseFilter(void);
 
@@ -584,6 +581,16 @@ private:
 	// predict ekf covariance
 	void predictCovariance();
 
+	// generated covariance prediction kernels, nextP = F * P * F' + G * Q * G' without the process noise of the
+	// stationary states. The inhibited kernel assumes that the delta velocity bias states are uncorrelated with the
+	// other IMU states and leaves their covariances unset.
+	void predictCovarianceAllStates(float dt, const Vector3f &d_ang_var, const Vector3f &d_vel_var,
+					SymmetricMatrix24f &nextP) const;
+#if !defined(CONSTRAINED_FLASH)
+	void predictCovarianceDeltaVelBiasInhibited(float dt, const Vector3f &d_ang_var, const Vector3f &d_vel_var,
+			SymmetricMatrix24f &nextP) const;
+#endif // !CONSTRAINED_FLASH
+
 	// ekf sequential fusion of magnetometer measurements
 	void fuseMag(const Vector3f &mag);
 
@@ -727,9 +734,6 @@ private:
 	// Return the magnetic declination in radians to be used by the alignment and fusion processing
 	float getMagDeclination();
 
-	// modify output filter to match the the EKF state at the fusion time horizon
-	void alignOutputFilter();
-
 	// update the rotation matrix which transforms EV navigation frame measurements into NED
 	void calcExtVisRotMat();
 
@@ -737,31 +741,6 @@ private:
 
 	Vector3f getVisionVelocityVarianceInEkfFrame() const;
 
-	// matrix vector multiplication for computing K<24,1> * H<1,24> * P<24,24>
-	// that is optimized by exploring the sparsity in H
-	template <size_t ...Idxs>
-	SquareMatrix24f computeKHP(const Vector24f &K, const SparseVector24f<Idxs...> &H) const
-	{
-		// K(HP) and (KH)P are equivalent (matrix multiplication is associative)
-		// but K(HP) is computationally much less expensive
-		Vector24f HP;
-		for (unsigned i = 0; i < H.non_zeros(); i++) {
-			const size_t row = H.index(i);
-			for (unsigned col = 0; col < _k_num_states; col++) {
-				HP(col) = HP(col) + H.atCompressedIndex(i) * P(row, col);
-			}
-		}
-
-		SquareMatrix24f KHP;
-		for (unsigned row = 0; row < _k_num_states; row++) {
-			for (unsigned col = 0; col < _k_num_states; col++) {
-				KHP(row, col) = K(row) * HP(col);
-			}
-		}
-
-		return KHP;
-	}
-
 	// measurement update with a single measurement
 	// returns true if fusion is performed
 	template <size_t ...Idxs>
@@ -774,17 +753,18 @@ private:
 		}
 
 		// apply covariance correction via P_new = (I -K*H)*P
-		// first calculate expression for KHP
-		// then calculate P - KHP
-		const SquareMatrix24f KHP = computeKHP(K, H);
+		// K(HP) and (KH)P are equivalent (matrix multiplication is associative)
+		// but K(HP) is computationally much less expensive
+		// HP is computed from the rows of P selected by the non zero elements of H only
+		const Vector24f HP = P * H;
 
-		const bool is_healthy = checkAndFixCovarianceUpdate(KHP);
+		const bool is_healthy = checkAndFixCovarianceUpdate(K.emult(HP));
 
 		if (is_healthy) {
-			// apply the covariance corrections
-			P -= KHP;
+			// apply the covariance corrections, P - KHP is kept symmetric
+			P.subtractSymmetrized(K, HP);
 
-			fixCovarianceErrors(true);
+			fixCovarianceErrors();
 
 			// apply the state corrections
 			fuse(K, innovation);
@@ -793,13 +773,31 @@ private:
 		return is_healthy;
 	}
 
+	// measurement update with a direct observation of a single state
+	// returns true if fusion is performed
+	template <size_t State>
+	bool directStateMeasurementUpdate(float innovation, float innov_var)
+	{
+		SparseVector24f<State> H;
+		H.template at<State>() = 1.f;
+
+		// calculate kalman gain K = PHS, where S = 1/innovation variance
+		const Vector24f PH = P * H;
+		Vector24f K;
+
+		for (unsigned row = 0; row < _k_num_states; row++) {
+			K(row) = PH(row) / innov_var;
+		}
+
+		return measurementUpdate(K, H, innovation);
+	}
+
 	// if the covariance correction will result in a negative variance, then
 	// the covariance matrix is unhealthy and must be corrected
-	bool checkAndFixCovarianceUpdate(const SquareMatrix24f &KHP);
+	bool checkAndFixCovarianceUpdate(const Vector24f &KHP_diag);
 
 	// limit the diagonal of the covariance matrix
-	// force symmetry when the argument is true
-	void fixCovarianceErrors(bool force_symmetry);
+	void fixCovarianceErrors();
 
 	// constrain the ekf states
 	void constrainStates();
@@ -1030,7 +1028,7 @@ private:
 	// Declarations used to control use of the EKF-GSF yaw estimator
 
 	// yaw estimator instance
-	EKFGSF_yaw _yawEstimator{};
+	EKFGSF_yaw<N_MODELS_EKFGSF> _yawEstimator{};
 
 	BaroBiasEstimator _baro_b_est{};
 
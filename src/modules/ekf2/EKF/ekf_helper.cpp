@@ -111,11 +111,7 @@ void Ekf::resetHorizontalVelocityTo(const Vector2f &new_horz_vel)
 	const Vector2f delta_horz_vel = new_horz_vel - Vector2f(_state.vel);
 	_state.vel.xy() = new_horz_vel;
 
-	for (uint8_t index = 0; index < _output_buffer.get_length(); index++) {
-		_output_buffer[index].vel.xy() += delta_horz_vel;
-	}
-
-	_output_new.vel.xy() += delta_horz_vel;
+	_output_predictor.resetHorizontalVelocity(delta_horz_vel);
 
 	_state_reset_status.velNE_change = delta_horz_vel;
 	_state_reset_status.velNE_counter++;
@@ -129,13 +125,7 @@ void Ekf::resetVerticalVelocityTo(float new_vert_vel)
 	const float delta_vert_vel = new_vert_vel - _state.vel(2);
 	_state.vel(2) = new_vert_vel;
 
-	for (uint8_t index = 0; index < _output_buffer.get_length(); index++) {
-		_output_buffer[index].vel(2) += delta_vert_vel;
-		_output_vert_buffer[index].vert_vel += delta_vert_vel;
-	}
-
-	_output_new.vel(2) += delta_vert_vel;
-	_output_vert_new.vert_vel += delta_vert_vel;
+	_output_predictor.resetVerticalVelocity(delta_vert_vel);
 
 	_state_reset_status.velD_change = delta_vert_vel;
 	_state_reset_status.velD_counter++;
@@ -200,11 +190,7 @@ void Ekf::resetHorizontalPositionTo(const Vector2f &new_horz_pos)
 	const Vector2f delta_horz_pos{new_horz_pos - Vector2f{_state.pos}};
 	_state.pos.xy() = new_horz_pos;
 
-	for (uint8_t index = 0; index < _output_buffer.get_length(); index++) {
-		_output_buffer[index].pos.xy() += delta_horz_pos;
-	}
-
-	_output_new.pos.xy() += delta_horz_pos;
+	_output_predictor.resetHorizontalPosition(delta_horz_pos);
 
 	_state_reset_status.posNE_change = delta_horz_pos;
 	_state_reset_status.posNE_counter++;
@@ -222,18 +208,8 @@ void Ekf::resetVerticalPositionTo(const float new_vert_pos)
 	_state_reset_status.posD_change = new_vert_pos - old_vert_pos;
 	_state_reset_status.posD_counter++;
 
-	// apply the change in height / height rate to our newest height / height rate estimate
-	// which have already been taken out from the output buffer
-	_output_new.pos(2) += _state_reset_status.posD_change;
-
-	// add the reset amount to the output observer buffered data
-	for (uint8_t i = 0; i < _output_buffer.get_length(); i++) {
-		_output_buffer[i].pos(2) += _state_reset_status.posD_change;
-		_output_vert_buffer[i].vert_vel_integ += _state_reset_status.posD_change;
-	}
-
-	// add the reset amount to the output observer vertical position state
-	_output_vert_new.vert_vel_integ = _state.pos(2);
+	// add the reset amount to the output observer states
+	_output_predictor.resetVerticalPosition(_state.pos(2), _state_reset_status.posD_change);
 
 	// Reset the timout timer
 	_time_last_hgt_fuse = _time_last_imu;
@@ -312,30 +288,6 @@ void Ekf::resetVerticalVelocityToZero()
 	P.uncorrelateCovarianceSetVariance<1>(6, 10.0f);
 }
 
-// align output filter states to match EKF states at the fusion time horizon
-void Ekf::alignOutputFilter()
-{
-	const outputSample &output_delayed = _output_buffer.get_oldest();
-
-	// calculate the quaternion rotation delta from the EKF to output observer states at the EKF fusion time horizon
-	Quatf q_delta{_state.quat_nominal * output_delayed.quat_nominal.inversed()};
-	q_delta.normalize();
-
-	// calculate the velocity and position deltas between the output and EKF at the EKF fusion time horizon
-	const Vector3f vel_delta = _state.vel - output_delayed.vel;
-	const Vector3f pos_delta = _state.pos - output_delayed.pos;
-
-	// loop through the output filter state history and add the deltas
-	for (uint8_t i = 0; i < _output_buffer.get_length(); i++) {
-		_output_buffer[i].quat_nominal = q_delta * _output_buffer[i].quat_nominal;
-		_output_buffer[i].quat_nominal.normalize();
-		_output_buffer[i].vel += vel_delta;
-		_output_buffer[i].pos += pos_delta;
-	}
-
-	_output_new = _output_buffer.get_newest();
-}
-
 // Do a forced re-alignment of the yaw angle to align with the horizontal velocity vector from the GPS.
 // It is used to align the yaw angle after launch or takeoff for fixed wing vehicle only.
 bool Ekf::realignYawGPS(const Vector3f &mag)
@@ -559,10 +511,10 @@ float Ekf::compensateBaroForDynamicPressure(const float baro_alt_uncompensated)
 	// calculate static pressure error = Pmeas - Ptruth
 	// model position error sensitivity as a body fixed ellipse with a different scale in the positive and
 	// negative X and Y directions. Used to correct baro data for positional errors
-	const matrix::Dcmf R_to_body(_output_new.quat_nominal.inversed());
+	const matrix::Dcmf R_to_body(_output_predictor.getQuaternion().inversed());
 
 	// Calculate airspeed in body frame
-	const Vector3f velocity_earth = _output_new.vel - _vel_imu_rel_body_ned;
+	const Vector3f velocity_earth = _output_predictor.getVelocity();
 
 	const Vector3f wind_velocity_earth(_state.wind_vel(0), _state.wind_vel(1), 0.0f);
 
@@ -866,7 +818,7 @@ void Ekf::resetAccelBias()
 	P.uncorrelateCovarianceSetVariance<3>(13, sq(_params.switch_on_accel_bias * _dt_ekf_avg));
 
 	// Set previous frame values
-	_prev_dvel_bias_var = P.slice<3, 3>(13, 13).diag();
+	_prev_dvel_bias_var = P.slice<3>(13).diag();
 }
 
 void Ekf::resetMagBias()
@@ -988,8 +940,7 @@ void Ekf::fuse(const Vector24f &K, float innovation)
 
 void Ekf::uncorrelateQuatFromOtherStates()
 {
-	P.slice<_k_num_states - 4, 4>(4, 0) = 0.f;
-	P.slice<4, _k_num_states - 4>(0, 4) = 0.f;
+	P.uncorrelateCovarianceBlock<4>(0);
 }
 
 // return true if we are totally reliant on inertial dead-reckoning for position
@@ -1064,7 +1015,7 @@ Vector3f Ekf::calcRotVecVariances()
 		rot_var_vec(1) = t14*(P(0,0)*t14+P(2,0)*t3*t11*2.0f)+t3*t11*(P(0,2)*t14+P(2,2)*t3*t11*2.0f)*2.0f;
 		rot_var_vec(2) = t17*(P(0,0)*t17+P(3,0)*t3*t11*2.0f)+t3*t11*(P(0,3)*t17+P(3,3)*t3*t11*2.0f)*2.0f;
 	} else {
-		rot_var_vec = 4.0f * P.slice<3,3>(1,1).diag();
+		rot_var_vec = 4.0f * P.slice<3>(1).diag();
 	}
 
 	return rot_var_vec;
@@ -1146,21 +1097,16 @@ void Ekf::initialiseQuatCovariances(Vector3f &rot_vec_var)
 
 
 		// Update the quaternion internal covariances using auto-code generated using matlab symbolic toolbox
+		// only the upper triangle is set, the covariance matrix is symmetric by construction
 		P(0,0) = rot_vec_var(0)*t2*t9*t10*0.25f+rot_vec_var(1)*t4*t9*t10*0.25f+rot_vec_var(2)*t5*t9*t10*0.25f;
 		P(0,1) = t22;
 		P(0,2) = t35+rotX*rot_vec_var(0)*t3*t11*(t15-rotX*rotY*t10*t12*0.5f)*0.5f-rotY*rot_vec_var(1)*t3*t11*t30*0.5f;
 		P(0,3) = rotX*rot_vec_var(0)*t3*t11*(t16-rotX*rotZ*t10*t12*0.5f)*0.5f+rotY*rot_vec_var(1)*t3*t11*(t17-rotY*rotZ*t10*t12*0.5f)*0.5f-rotZ*rot_vec_var(2)*t3*t11*t33*0.5f;
-		P(1,0) = t22;
 		P(1,1) = rot_vec_var(0)*(t19*t19)+rot_vec_var(1)*(t24*t24)+rot_vec_var(2)*(t26*t26);
 		P(1,2) = rot_vec_var(2)*(t16-t25)*(t17-rotY*rotZ*t10*t12*0.5f)-rot_vec_var(0)*t19*t28-rot_vec_var(1)*t28*t30;
 		P(1,3) = rot_vec_var(1)*(t15-t23)*(t17-rotY*rotZ*t10*t12*0.5f)-rot_vec_var(0)*t19*t31-rot_vec_var(2)*t31*t33;
-		P(2,0) = t35-rotY*rot_vec_var(1)*t3*t11*t30*0.5f+rotX*rot_vec_var(0)*t3*t11*(t15-t23)*0.5f;
-		P(2,1) = rot_vec_var(2)*(t16-t25)*(t17-t36)-rot_vec_var(0)*t19*t28-rot_vec_var(1)*t28*t30;
 		P(2,2) = rot_vec_var(1)*(t30*t30)+rot_vec_var(0)*(t37*t37)+rot_vec_var(2)*(t38*t38);
 		P(2,3) = t42;
-		P(3,0) = rotZ*rot_vec_var(2)*t3*t11*t33*(-0.5f)+rotX*rot_vec_var(0)*t3*t11*(t16-t25)*0.5f+rotY*rot_vec_var(1)*t3*t11*(t17-t36)*0.5f;
-		P(3,1) = rot_vec_var(1)*(t15-t23)*(t17-t36)-rot_vec_var(0)*t19*t31-rot_vec_var(2)*t31*t33;
-		P(3,2) = t42;
 		P(3,3) = rot_vec_var(2)*(t33*t33)+rot_vec_var(0)*(t43*t43)+rot_vec_var(1)*(t44*t44);
 
 	} else {
@@ -1471,6 +1417,7 @@ void Ekf::increaseQuatYawErrVariance(float yaw_variance)
 
 	// Add covariances for additonal yaw uncertainty to existing covariances.
 	// This assumes that the additional yaw error is uncorrrelated to existing errors
+	// Only the upper triangle is updated, the covariance matrix is symmetric by construction
 	P(0,0) += yaw_variance*sq(SQ[2]);
 	P(0,1) += yaw_variance*SQ[1]*SQ[2];
 	P(1,1) += yaw_variance*sq(SQ[1]);
@@ -1481,12 +1428,6 @@ void Ekf::increaseQuatYawErrVariance(float yaw_variance)
 	P(1,3) -= yaw_variance*SQ[1]*SQ[3];
 	P(2,3) -= yaw_variance*SQ[0]*SQ[3];
 	P(3,3) += yaw_variance*sq(SQ[3]);
-	P(1,0) += yaw_variance*SQ[1]*SQ[2];
-	P(2,0) += yaw_variance*SQ[0]*SQ[2];
-	P(2,1) += yaw_variance*SQ[0]*SQ[1];
-	P(3,0) -= yaw_variance*SQ[2]*SQ[3];
-	P(3,1) -= yaw_variance*SQ[1]*SQ[3];
-	P(3,2) -= yaw_variance*SQ[0]*SQ[3];
 }
 
 // save covariance data for re-use when auto-switching between heading and 3-axis fusion
@@ -1498,7 +1439,7 @@ void Ekf::saveMagCovData()
 	_saved_mag_bf_variance(2) = P(21, 21);
 
 	// save the NE axis covariance sub-matrix
-	_saved_mag_ef_ne_covmat = P.slice<2, 2>(16, 16);
+	_saved_mag_ef_ne_covmat = P.slice<2>(16);
 
 	// save variance for the D earth axis
 	_saved_mag_ef_d_variance = P(18, 18);
@@ -1512,7 +1453,7 @@ void Ekf::loadMagCovData()
 	P(21, 21) = _saved_mag_bf_variance(2);
 
 	// re-instate the NE axis covariance sub-matrix
-	P.slice<2, 2>(16, 16) = _saved_mag_ef_ne_covmat;
+	P.setSlice<2>(16, _saved_mag_ef_ne_covmat);
 
 	// re-instate the D earth axis variance
 	P(18, 18) = _saved_mag_ef_d_variance;
@@ -1708,14 +1649,7 @@ void Ekf::resetQuatStateYaw(float yaw, float yaw_variance, bool update_buffer)
 
 	// add the reset amount to the output observer buffered data
 	if (update_buffer) {
-		for (uint8_t i = 0; i < _output_buffer.get_length(); i++) {
-			_output_buffer[i].quat_nominal = _state_reset_status.quat_change * _output_buffer[i].quat_nominal;
-		}
-
-		// apply the change in attitude quaternion to our newest quaternion estimate
-		// which was already taken out from the output buffer
-		_output_new.quat_nominal = _state_reset_status.quat_change * _output_new.quat_nominal;
-
+		_output_predictor.resetQuaternion(_state_reset_status.quat_change);
 	}
 
 	// capture the reset event
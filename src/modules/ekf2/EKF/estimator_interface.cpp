@@ -59,6 +59,18 @@ EstimatorInterface::~EstimatorInterface()
 
 // Accumulate imu data and store to buffer at desired rate
 void EstimatorInterface::setIMUData(const imuSample &imu_sample)
+{
+	// accumulate and down-sample imu data and push to the buffer when new downsampled data becomes available
+	if (_imu_down_sampler.update(imu_sample)) {
+		const imuSample imu_down_sampled{_imu_down_sampler.getDownSampledImuAndTriggerReset()};
+		setIMUData(imu_sample, &imu_down_sampled);
+
+	} else {
+		setIMUData(imu_sample, nullptr);
+	}
+}
+
+void EstimatorInterface::setIMUData(const imuSample &imu_sample, const imuSample *imu_down_sampled)
 {
 	// TODO: resolve misplaced responsibility
 	if (!_initialised) {
@@ -75,12 +87,11 @@ void EstimatorInterface::setIMUData(const imuSample &imu_sample)
 
 	_newest_high_rate_imu_sample = imu_sample;
 
-	_imu_updated = _imu_down_sampler.update(imu_sample);
+	_imu_updated = (imu_down_sampled != nullptr);
 
-	// accumulate and down-sample imu data and push to the buffer when new downsampled data becomes available
 	if (_imu_updated) {
 
-		_imu_buffer.push(_imu_down_sampler.getDownSampledImuAndTriggerReset());
+		_imu_buffer.push(*imu_down_sampled);
 
 		// get the oldest data from the buffer
 		_imu_sample_delayed = _imu_buffer.get_oldest();
@@ -484,8 +495,7 @@ bool EstimatorInterface::initialise_interface(uint64_t timestamp)
 
 	ECL_DEBUG("EKF max time delay %.1f ms, OBS length %d\n", (double)ekf_delay_ms, _obs_buffer_length);
 
-	if (!_imu_buffer.allocate(_imu_buffer_length) || !_output_buffer.allocate(_imu_buffer_length)
-	    || !_output_vert_buffer.allocate(_imu_buffer_length)) {
+	if (!_imu_buffer.allocate(_imu_buffer_length) || !_output_predictor.allocate(_imu_buffer_length)) {
 
 		printBufferAllocationFailed("IMU and output");
 		return false;
@@ -587,6 +597,5 @@ void EstimatorInterface::print_status()
 		printf("drag buffer: %d/%d (%d Bytes)\n", _drag_buffer->entries(), _drag_buffer->get_length(), _drag_buffer->get_total_size());
 	}
 
-	printf("output buffer: %d/%d (%d Bytes)\n", _output_buffer.entries(), _output_buffer.get_length(), _output_buffer.get_total_size());
-	printf("output vert buffer: %d/%d (%d Bytes)\n", _output_vert_buffer.entries(), _output_vert_buffer.get_length(), _output_vert_buffer.get_total_size());
+	_output_predictor.print_status();
 }
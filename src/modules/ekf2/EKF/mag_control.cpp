@@ -251,7 +251,7 @@ void Ekf::checkYawAngleObservability()
 void Ekf::checkMagBiasObservability()
 {
 	// check if there is enough yaw rotation to make the mag bias states observable
-	if (!_mag_bias_observable && (fabsf(_yaw_rate_lpf_ef) > _params.mag_yaw_rate_gate)) {
+	if (!_mag_bias_observable && (fabsf(_output_predictor.getYawRateLpfEf()) > _params.mag_yaw_rate_gate)) {
 		// initial yaw motion is detected
 		_mag_bias_observable = true;
 
@@ -259,10 +259,10 @@ void Ekf::checkMagBiasObservability()
 		// require sustained yaw motion of 50% the initial yaw rate threshold
 		const float yaw_dt = 1e-6f * (float)(_imu_sample_delayed.time_us - _time_yaw_started);
 		const float min_yaw_change_req =  0.5f * _params.mag_yaw_rate_gate * yaw_dt;
-		_mag_bias_observable = fabsf(_yaw_delta_ef) > min_yaw_change_req;
+		_mag_bias_observable = fabsf(_output_predictor.getYawDeltaEf()) > min_yaw_change_req;
 	}
 
-	_yaw_delta_ef = 0.0f;
+	_output_predictor.resetYawDeltaEf();
 	_time_yaw_started = _imu_sample_delayed.time_us;
 }
 
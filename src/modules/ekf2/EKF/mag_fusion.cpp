@@ -602,17 +602,19 @@ bool Ekf::updateQuaternion(const float innovation, const float variance, const f
 			   const Vector4f &yaw_jacobian)
 {
 	// Calculate innovation variance and Kalman gains, taking advantage of the fact that only the first 4 elements in H are non zero
+	SparseVector24f<0,1,2,3> Hfusion;
+	Hfusion.at<0>() = yaw_jacobian(0);
+	Hfusion.at<1>() = yaw_jacobian(1);
+	Hfusion.at<2>() = yaw_jacobian(2);
+	Hfusion.at<3>() = yaw_jacobian(3);
+
+	const Vector24f PH = P * Hfusion;
+
 	// calculate the innovation variance
 	_heading_innov_var = variance;
 
 	for (unsigned row = 0; row <= 3; row++) {
-		float tmp = 0.0f;
-
-		for (uint8_t col = 0; col <= 3; col++) {
-			tmp += P(row, col) * yaw_jacobian(col);
-		}
-
-		_heading_innov_var += yaw_jacobian(row) * tmp;
+		_heading_innov_var += yaw_jacobian(row) * PH(row);
 	}
 
 	float heading_innov_var_inv;
@@ -638,20 +640,12 @@ bool Ekf::updateQuaternion(const float innovation, const float variance, const f
 	Vector24f Kfusion;
 
 	for (uint8_t row = 0; row <= 15; row++) {
-		for (uint8_t col = 0; col <= 3; col++) {
-			Kfusion(row) += P(row, col) * yaw_jacobian(col);
-		}
-
-		Kfusion(row) *= heading_innov_var_inv;
+		Kfusion(row) = PH(row) * heading_innov_var_inv;
 	}
 
 	if (_control_status.flags.wind) {
 		for (uint8_t row = 22; row <= 23; row++) {
-			for (uint8_t col = 0; col <= 3; col++) {
-				Kfusion(row) += P(row, col) * yaw_jacobian(col);
-			}
-
-			Kfusion(row) *= heading_innov_var_inv;
+			Kfusion(row) = PH(row) * heading_innov_var_inv;
 		}
 	}
 
@@ -688,45 +682,11 @@ bool Ekf::updateQuaternion(const float innovation, const float variance, const f
 		_heading_innov = innovation;
 	}
 
-	// apply covariance correction via P_new = (I -K*H)*P
-	// first calculate expression for KHP
-	// then calculate P - KHP
-	SquareMatrix24f KHP;
-	float KH[4];
-
-	for (unsigned row = 0; row < _k_num_states; row++) {
-
-		KH[0] = Kfusion(row) * yaw_jacobian(0);
-		KH[1] = Kfusion(row) * yaw_jacobian(1);
-		KH[2] = Kfusion(row) * yaw_jacobian(2);
-		KH[3] = Kfusion(row) * yaw_jacobian(3);
-
-		for (unsigned column = 0; column < _k_num_states; column++) {
-			float tmp = KH[0] * P(0, column);
-			tmp += KH[1] * P(1, column);
-			tmp += KH[2] * P(2, column);
-			tmp += KH[3] * P(3, column);
-			KHP(row, column) = tmp;
-		}
-	}
-
-	const bool healthy = checkAndFixCovarianceUpdate(KHP);
+	const bool healthy = measurementUpdate(Kfusion, Hfusion, _heading_innov);
 
 	_fault_status.flags.bad_hdg = !healthy;
 
-	if (healthy) {
-		// apply the covariance corrections
-		P -= KHP;
-
-		fixCovarianceErrors(true);
-
-		// apply the state corrections
-		fuse(Kfusion, _heading_innov);
-
-		return true;
-	}
-
-	return false;
+	return healthy;
 }
 
 void Ekf::fuseHeading(float measured_hdg, float obs_var)
@@ -0,0 +1,411 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "output_predictor.hpp"
+
+#include <lib/geo/geo.h>
+#include <mathlib/mathlib.h>
+
+#include "utils.hpp"
+
+bool OutputPredictor::allocate(uint8_t size)
+{
+	return _output_buffer.allocate(size) && _output_vert_buffer.allocate(size);
+}
+
+void OutputPredictor::reset()
+{
+	// TODO: who resets the output buffer content?
+	_output_new.vel.setZero();
+	_output_new.pos.setZero();
+	_output_new.quat_nominal.setIdentity();
+
+	_delta_angle_corr.setZero();
+}
+
+void OutputPredictor::alignOutputFilter(const FilterStates &states)
+{
+	const outputSample &output_delayed = _output_buffer[findOutputIndex(states.time_us)];
+
+	// calculate the quaternion rotation delta from the EKF to output observer states at the EKF fusion time horizon
+	Quatf q_delta{states.quat_nominal * output_delayed.quat_nominal.inversed()};
+	q_delta.normalize();
+
+	// calculate the velocity and position deltas between the output and EKF at the EKF fusion time horizon
+	const Vector3f vel_delta = states.vel - output_delayed.vel;
+	const Vector3f pos_delta = states.pos - output_delayed.pos;
+
+	// loop through the output filter state history and add the deltas
+	for (uint8_t i = 0; i < _output_buffer.get_length(); i++) {
+		_output_buffer[i].quat_nominal = q_delta * _output_buffer[i].quat_nominal;
+		_output_buffer[i].quat_nominal.normalize();
+		_output_buffer[i].vel += vel_delta;
+		_output_buffer[i].pos += pos_delta;
+	}
+
+	_output_new = _output_buffer.get_newest();
+}
+
+/*
+ * Implement a strapdown INS algorithm using the latest IMU data at the current time horizon.
+ * Buffer the INS states and calculate the difference with the EKF states at the delayed fusion time horizon.
+ * Calculate delta angle, delta velocity and velocity corrections from the differences and apply them at the
+ * current time horizon so that the INS states track the EKF states at the delayed fusion time horizon.
+ * The inspiration for using a complementary filter to correct for time delays in the EKF
+ * is based on the work by A Khosravian:
+ * “Recursive Attitude Estimation in the Presence of Multi-rate and Multi-delay Vector Measurements”
+ * A Khosravian, J Trumpf, R Mahony, T Hamel, Australian National University
+*/
+void OutputPredictor::calculateOutputStates(const imuSample &imu, const FilterStates &states)
+{
+	// Use full rate IMU data at the current time horizon
+
+	// correct delta angles for bias offsets
+	const float dt_scale_correction = states.dt_imu_avg / states.dt_ekf_avg;
+
+	// Apply corrections to the delta angle required to track the quaternion states at the EKF fusion time horizon
+	const Vector3f delta_angle(imu.delta_ang - states.delta_ang_bias * dt_scale_correction + _delta_angle_corr);
+
+	// calculate a yaw change about the earth frame vertical
+	const float spin_del_ang_D = delta_angle.dot(Vector3f(_R_to_earth_now.row(2)));
+	_yaw_delta_ef += spin_del_ang_D;
+
+	// Calculate filtered yaw rate to be used by the magnetometer fusion type selection logic
+	// Note fixed coefficients are used to save operations. The exact time constant is not important.
+	_yaw_rate_lpf_ef = 0.95f * _yaw_rate_lpf_ef + 0.05f * spin_del_ang_D / imu.delta_ang_dt;
+
+
+	_output_new.time_us = imu.time_us;
+	_output_vert_new.time_us = imu.time_us;
+
+	const Quatf dq(AxisAnglef{delta_angle});
+
+	// rotate the previous INS quaternion by the delta quaternions
+	_output_new.quat_nominal = _output_new.quat_nominal * dq;
+
+	// the quaternions must always be normalised after modification
+	_output_new.quat_nominal.normalize();
+
+	// calculate the rotation matrix from body to earth frame
+	_R_to_earth_now = Dcmf(_output_new.quat_nominal);
+
+	// correct delta velocity for bias offsets
+	const Vector3f delta_vel_body{imu.delta_vel - states.delta_vel_bias * dt_scale_correction};
+
+	// rotate the delta velocity to earth frame
+	Vector3f delta_vel_earth{_R_to_earth_now * delta_vel_body};
+
+	// correct for measured acceleration due to gravity
+	delta_vel_earth(2) += CONSTANTS_ONE_G * imu.delta_vel_dt;
+
+	// calculate the earth frame velocity derivatives
+	if (imu.delta_vel_dt > 1e-4f) {
+		_vel_deriv = delta_vel_earth * (1.0f / imu.delta_vel_dt);
+	}
+
+	// save the previous velocity so we can use trapezoidal integration
+	const Vector3f vel_last(_output_new.vel);
+
+	// increment the INS velocity states by the measurement plus corrections
+	// do the same for vertical state used by alternative correction algorithm
+	_output_new.vel += delta_vel_earth;
+	_output_vert_new.vert_vel += delta_vel_earth(2);
+
+	// use trapezoidal integration to calculate the INS position states
+	// do the same for vertical state used by alternative correction algorithm
+	const Vector3f delta_pos_NED = (_output_new.vel + vel_last) * (imu.delta_vel_dt * 0.5f);
+	_output_new.pos += delta_pos_NED;
+	_output_vert_new.vert_vel_integ += delta_pos_NED(2);
+
+	// accumulate the time for each update
+	_output_vert_new.dt += imu.delta_vel_dt;
+
+	// correct velocity for IMU offset
+	if (imu.delta_ang_dt > 1e-4f) {
+		// calculate the average angular rate across the last IMU update
+		const Vector3f ang_rate = imu.delta_ang * (1.0f / imu.delta_ang_dt);
+
+		// calculate the velocity of the IMU relative to the body origin
+		const Vector3f vel_imu_rel_body = ang_rate % _imu_pos_body;
+
+		// rotate the relative velocity into earth frame
+		_vel_imu_rel_body_ned = _R_to_earth_now * vel_imu_rel_body;
+	}
+}
+
+void OutputPredictor::storeOutputStates()
+{
+	// store the INS states in a ring buffer with the same length and time coordinates as the IMU data buffer
+	_output_buffer.push(_output_new);
+	_output_vert_buffer.push(_output_vert_new);
+}
+
+void OutputPredictor::correctOutputStates(const FilterStates &states)
+{
+	// get the INS state data at the EKF fusion time horizon, both buffers are always pushed together
+	const uint8_t delayed_index = findOutputIndex(states.time_us);
+	const outputSample &output_delayed = _output_buffer[delayed_index];
+	const outputVert &output_vert_delayed = _output_vert_buffer[delayed_index];
+
+	// calculate the quaternion delta between the INS and EKF quaternions at the EKF fusion time horizon
+	const Quatf q_error((states.quat_nominal.inversed() * output_delayed.quat_nominal).normalized());
+
+	// convert the quaternion delta to a delta angle
+	const float scalar = (q_error(0) >= 0.0f) ? -2.f : 2.f;
+
+	const Vector3f delta_ang_error{scalar * q_error(1), scalar * q_error(2), scalar * q_error(3)};
+
+	// calculate a gain that provides tight tracking of the estimator attitude states and
+	// adjust for changes in time delay to maintain consistent damping ratio of ~0.7
+	const float time_delay = fmaxf((_output_new.time_us - states.time_us) * 1e-6f, states.dt_imu_avg);
+	const float att_gain = 0.5f * states.dt_imu_avg / time_delay;
+
+	// calculate a corrrection to the delta angle
+	// that will cause the INS to track the EKF quaternions
+	_delta_angle_corr = delta_ang_error * att_gain;
+	_output_tracking_error(0) = delta_ang_error.norm();
+
+	/*
+	 * Loop through the output filter state history and apply the corrections to the velocity and position states.
+	 * This method is too expensive to use for the attitude states due to the quaternion operations required
+	 * but because it eliminates the time delay in the 'correction loop' it allows higher tracking gains
+	 * to be used and reduces tracking error relative to EKF states.
+	 */
+
+	// Complementary filter gains
+	const float vel_gain = states.dt_ekf_avg / math::constrain(_vel_tau, states.dt_ekf_avg, 10.0f);
+	const float pos_gain = states.dt_ekf_avg / math::constrain(_pos_tau, states.dt_ekf_avg, 10.0f);
+
+	// calculate down velocity and position tracking errors
+	const float vert_vel_err = (states.vel(2) - output_vert_delayed.vert_vel);
+	const float vert_vel_integ_err = (states.pos(2) - output_vert_delayed.vert_vel_integ);
+
+	// calculate a velocity correction that will be applied to the output state history
+	// using a PD feedback tuned to a 5% overshoot
+	const float vert_vel_correction = vert_vel_integ_err * pos_gain + vert_vel_err * vel_gain * 1.1f;
+
+	applyCorrectionToVerticalOutputBuffer(vert_vel_correction);
+
+	// calculate velocity and position tracking errors
+	const Vector3f vel_err(states.vel - output_delayed.vel);
+	const Vector3f pos_err(states.pos - output_delayed.pos);
+
+	_output_tracking_error(1) = vel_err.norm();
+	_output_tracking_error(2) = pos_err.norm();
+
+	// calculate a velocity correction that will be applied to the output state history
+	_vel_err_integ += vel_err;
+	const Vector3f vel_correction = vel_err * vel_gain + _vel_err_integ * sq(vel_gain) * 0.1f;
+
+	// calculate a position correction that will be applied to the output state history
+	_pos_err_integ += pos_err;
+	const Vector3f pos_correction = pos_err * pos_gain + _pos_err_integ * sq(pos_gain) * 0.1f;
+
+	applyCorrectionToOutputBuffer(vel_correction, pos_correction);
+}
+
+/*
+* Calculate a correction to be applied to vert_vel that casues vert_vel_integ to track the EKF
+* down position state at the fusion time horizon using an alternative algorithm to what
+* is used for the vel and pos state tracking. The algorithm applies a correction to the vert_vel
+* state history and propagates vert_vel_integ forward in time using the corrected vert_vel history.
+* This provides an alternative vertical velocity output that is closer to the first derivative
+* of the position but does degrade tracking relative to the EKF state.
+*/
+void OutputPredictor::applyCorrectionToVerticalOutputBuffer(float vert_vel_correction)
+{
+	// loop through the vertical output filter state history starting at the oldest and apply the corrections to the
+	// vert_vel states and propagate vert_vel_integ forward using the corrected vert_vel
+	uint8_t index = _output_vert_buffer.get_oldest_index();
+
+	const uint8_t size = _output_vert_buffer.get_length();
+
+	for (uint8_t counter = 0; counter < (size - 1); counter++) {
+		const uint8_t index_next = (index + 1) % size;
+		outputVert &current_state = _output_vert_buffer[index];
+		outputVert &next_state = _output_vert_buffer[index_next];
+
+		// correct the velocity
+		if (counter == 0) {
+			current_state.vert_vel += vert_vel_correction;
+		}
+
+		next_state.vert_vel += vert_vel_correction;
+
+		// position is propagated forward using the corrected velocity and a trapezoidal integrator
+		next_state.vert_vel_integ = current_state.vert_vel_integ + (current_state.vert_vel + next_state.vert_vel) * 0.5f * next_state.dt;
+
+		// advance the index
+		index = (index + 1) % size;
+	}
+
+	// update output state to corrected values
+	_output_vert_new = _output_vert_buffer.get_newest();
+
+	// reset time delta to zero for the next accumulation of full rate IMU data
+	_output_vert_new.dt = 0.0f;
+}
+
+/*
+* Calculate corrections to be applied to vel and pos output state history.
+* The vel and pos state history are corrected individually so they track the EKF states at
+* the fusion time horizon. This option provides the most accurate tracking of EKF states.
+*/
+void OutputPredictor::applyCorrectionToOutputBuffer(const Vector3f &vel_correction, const Vector3f &pos_correction)
+{
+	// loop through the output filter state history and apply the corrections to the velocity and position states
+	for (uint8_t index = 0; index < _output_buffer.get_length(); index++) {
+		// a constant velocity correction is applied
+		_output_buffer[index].vel += vel_correction;
+
+		// a constant position correction is applied
+		_output_buffer[index].pos += pos_correction;
+	}
+
+	// update output state to corrected values
+	_output_new = _output_buffer.get_newest();
+}
+
+uint8_t OutputPredictor::findOutputIndex(uint64_t time_us) const
+{
+	// the history is ordered by time, with the EKF running on the same IMU data the oldest sample is the
+	// one at the fusion time horizon and the search stops at the first step
+	const uint8_t size = _output_buffer.get_length();
+	const uint8_t newest_index = _output_buffer.get_newest_index();
+	uint8_t index = _output_buffer.get_oldest_index();
+
+	while (index != newest_index) {
+		const uint8_t index_next = (index + 1) % size;
+
+		if (_output_buffer[index_next].time_us > time_us) {
+			break;
+		}
+
+		index = index_next;
+	}
+
+	return index;
+}
+
+/*
+ * Predict the previous quaternion output state forward using the latest IMU delta angle data.
+*/
+Quatf OutputPredictor::calculateQuaternion(const imuSample &imu, const FilterStates &states) const
+{
+	// Correct delta angle data for bias errors using bias state estimates from the EKF and also apply
+	// corrections required to track the EKF quaternion states
+	const Vector3f delta_angle{imu.delta_ang - states.delta_ang_bias * (states.dt_imu_avg / states.dt_ekf_avg) + _delta_angle_corr};
+
+	// increment the quaternions using the corrected delta angle vector
+	// the quaternions must always be normalised after modification
+	return Quatf{_output_new.quat_nominal * AxisAnglef{delta_angle}}.unit();
+}
+
+void OutputPredictor::resetQuaternion(const Quatf &quat_change)
+{
+	// add the reset amount to the output observer buffered data
+	for (uint8_t i = 0; i < _output_buffer.get_length(); i++) {
+		_output_buffer[i].quat_nominal = quat_change * _output_buffer[i].quat_nominal;
+	}
+
+	// apply the change in attitude quaternion to our newest quaternion estimate
+	// which was already taken out from the output buffer
+	_output_new.quat_nominal = quat_change * _output_new.quat_nominal;
+
+	_reset_totals.quat_change = (quat_change * _reset_totals.quat_change).normalized();
+	_reset_totals.quat_counter++;
+}
+
+void OutputPredictor::resetHorizontalVelocity(const Vector2f &delta_horz_vel)
+{
+	for (uint8_t index = 0; index < _output_buffer.get_length(); index++) {
+		_output_buffer[index].vel.xy() += delta_horz_vel;
+	}
+
+	_output_new.vel.xy() += delta_horz_vel;
+
+	_reset_totals.velNE_change += delta_horz_vel;
+	_reset_totals.velNE_counter++;
+}
+
+void OutputPredictor::resetVerticalVelocity(float delta_vert_vel)
+{
+	for (uint8_t index = 0; index < _output_buffer.get_length(); index++) {
+		_output_buffer[index].vel(2) += delta_vert_vel;
+		_output_vert_buffer[index].vert_vel += delta_vert_vel;
+	}
+
+	_output_new.vel(2) += delta_vert_vel;
+	_output_vert_new.vert_vel += delta_vert_vel;
+
+	_reset_totals.velD_change += delta_vert_vel;
+	_reset_totals.velD_counter++;
+}
+
+void OutputPredictor::resetHorizontalPosition(const Vector2f &delta_horz_pos)
+{
+	for (uint8_t index = 0; index < _output_buffer.get_length(); index++) {
+		_output_buffer[index].pos.xy() += delta_horz_pos;
+	}
+
+	_output_new.pos.xy() += delta_horz_pos;
+
+	_reset_totals.posNE_change += delta_horz_pos;
+	_reset_totals.posNE_counter++;
+}
+
+void OutputPredictor::resetVerticalPosition(float new_vert_pos, float delta_vert_pos)
+{
+	// apply the change in height / height rate to our newest height / height rate estimate
+	// which have already been taken out from the output buffer
+	_output_new.pos(2) += delta_vert_pos;
+
+	// add the reset amount to the output observer buffered data
+	for (uint8_t i = 0; i < _output_buffer.get_length(); i++) {
+		_output_buffer[i].pos(2) += delta_vert_pos;
+		_output_vert_buffer[i].vert_vel_integ += delta_vert_pos;
+	}
+
+	// add the reset amount to the output observer vertical position state
+	_output_vert_new.vert_vel_integ = new_vert_pos;
+
+	_reset_totals.posD_change += delta_vert_pos;
+	_reset_totals.posD_counter++;
+}
+
+void OutputPredictor::print_status() const
+{
+	printf("output buffer: %d/%d (%d Bytes)\n", _output_buffer.entries(), _output_buffer.get_length(), _output_buffer.get_total_size());
+	printf("output vert buffer: %d/%d (%d Bytes)\n", _output_vert_buffer.entries(), _output_vert_buffer.get_length(), _output_vert_buffer.get_total_size());
+}
@@ -0,0 +1,186 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file output_predictor.hpp
+ * Output predictor (complementary filter) propagating the EKF states from the delayed fusion time
+ * horizon to the current time using the latest IMU data.
+ *
+ * The predictor only needs the EKF states at the delayed fusion time horizon (see FilterStates) and
+ * the resets applied to them, so it can be run by the EKF itself or by a separate consumer of the
+ * IMU data that receives these from the EKF.
+ */
+
+#ifndef EKF_OUTPUT_PREDICTOR_HPP
+#define EKF_OUTPUT_PREDICTOR_HPP
+
+#include <matrix/math.hpp>
+
+#include "common.h"
+#include "RingBuffer.h"
+
+using namespace estimator;
+
+class OutputPredictor
+{
+public:
+	OutputPredictor() = default;
+	~OutputPredictor() = default;
+
+	// EKF states at the delayed fusion time horizon tracked by the output predictor
+	struct FilterStates {
+		uint64_t time_us{0};		///< timestamp of the delayed fusion time horizon (uSec)
+		Quatf quat_nominal{};		///< quaternion defining the rotation from body to earth frame
+		Vector3f vel{};			///< NED velocity in earth frame (m/sec)
+		Vector3f pos{};			///< NED position in earth frame (m)
+		Vector3f delta_ang_bias{};	///< delta angle bias estimate (rad)
+		Vector3f delta_vel_bias{};	///< delta velocity bias estimate (m/sec)
+		float dt_imu_avg{0.f};		///< average IMU update period (sec)
+		float dt_ekf_avg{0.f};		///< average EKF update period (sec)
+	};
+
+	// accumulated resets applied to the output states, allows another output predictor tracking
+	// the same EKF to apply the resets it has missed
+	struct ResetTotals {
+		Quatf quat_change{};		///< product of all quaternion reset changes
+		Vector2f velNE_change{};	///< sum of all horizontal velocity reset changes (m/sec)
+		float velD_change{0.f};		///< sum of all vertical velocity reset changes (m/sec)
+		Vector2f posNE_change{};	///< sum of all horizontal position reset changes (m)
+		float posD_change{0.f};		///< sum of all vertical position reset changes (m)
+		uint32_t quat_counter{0};
+		uint32_t velNE_counter{0};
+		uint32_t velD_counter{0};
+		uint32_t posNE_counter{0};
+		uint32_t posD_counter{0};
+	};
+
+	bool allocate(uint8_t size);
+	uint8_t get_length() const { return _output_buffer.get_length(); }
+
+	void reset();
+
+	void set_imu_offset(const Vector3f &imu_pos_body) { _imu_pos_body = imu_pos_body; }
+	void set_vel_correction_tc(float tau) { _vel_tau = tau; }
+	void set_pos_correction_tc(float tau) { _pos_tau = tau; }
+
+	// align the output state history to match the EKF states at the fusion time horizon
+	void alignOutputFilter(const FilterStates &states);
+
+	// propagate the output states to the time of a (full rate) IMU sample
+	void calculateOutputStates(const imuSample &imu, const FilterStates &states);
+
+	// store the output states in the history, must be called at the same time the down-sampled IMU data
+	// used by the EKF is buffered so that the history has the same time coordinates as the EKF
+	void storeOutputStates();
+
+	// correct the output state history so that it tracks the EKF states at the fusion time horizon
+	void correctOutputStates(const FilterStates &states);
+
+	// predict the quaternion output state forward using an IMU sample without updating the output states
+	Quatf calculateQuaternion(const imuSample &imu, const FilterStates &states) const;
+
+	// apply EKF state resets to the output states
+	void resetQuaternion(const Quatf &quat_change);
+	void resetHorizontalVelocity(const Vector2f &delta_horz_vel);
+	void resetVerticalVelocity(float delta_vert_vel);
+	void resetHorizontalPosition(const Vector2f &delta_horz_pos);
+	void resetVerticalPosition(float new_vert_pos, float delta_vert_pos);
+
+	const ResetTotals &getResetTotals() const { return _reset_totals; }
+
+	uint64_t get_time_us() const { return _output_new.time_us; }
+
+	const Quatf &getQuaternion() const { return _output_new.quat_nominal; }
+
+	// get the velocity of the body frame origin in local NED earth frame
+	Vector3f getVelocity() const { return _output_new.vel - _vel_imu_rel_body_ned; }
+
+	// get the velocity derivative in earth frame
+	const Vector3f &getVelocityDerivative() const { return _vel_deriv; }
+
+	// get the derivative of the vertical position of the body frame origin in local NED earth frame
+	float getVerticalPositionDerivative() const { return _output_vert_new.vert_vel - _vel_imu_rel_body_ned(2); }
+
+	// get the position of the body frame origin in local earth frame
+	Vector3f getPosition() const
+	{
+		// rotate the position of the IMU relative to the boy origin into earth frame
+		const Vector3f pos_offset_earth = _R_to_earth_now * _imu_pos_body;
+		// subtract from the EKF position (which is at the IMU) to get position at the body origin
+		return _output_new.pos - pos_offset_earth;
+	}
+
+	// magnitude of the angle, velocity and position tracking errors (rad, m/s, m)
+	const Vector3f &getOutputTrackingError() const { return _output_tracking_error; }
+
+	// yaw change and filtered yaw rate about the earth frame D axis, used by the mag fusion type selection logic
+	float getYawDeltaEf() const { return _yaw_delta_ef; }
+	float getYawRateLpfEf() const { return _yaw_rate_lpf_ef; }
+	void resetYawDeltaEf() { _yaw_delta_ef = 0.f; }
+
+	void print_status() const;
+
+private:
+	void applyCorrectionToVerticalOutputBuffer(float vert_vel_correction);
+	void applyCorrectionToOutputBuffer(const Vector3f &vel_correction, const Vector3f &pos_correction);
+
+	// index of the newest stored output state not newer than time_us, the oldest if there is none
+	uint8_t findOutputIndex(uint64_t time_us) const;
+
+	RingBuffer<outputSample> _output_buffer{12};
+	RingBuffer<outputVert> _output_vert_buffer{12};
+
+	outputSample _output_new{};		///< filter output on the non-delayed time horizon
+	outputVert _output_vert_new{};		///< vertical filter output on the non-delayed time horizon
+	Matrix3f _R_to_earth_now{};		///< rotation matrix from body to earth frame at current time
+	Vector3f _vel_imu_rel_body_ned{};	///< velocity of IMU relative to body origin in NED earth frame
+	Vector3f _vel_deriv{};			///< velocity derivative at the IMU in NED earth frame (m/s/s)
+
+	Vector3f _delta_angle_corr{};		///< delta angle correction vector (rad)
+	Vector3f _vel_err_integ{};		///< integral of velocity tracking error (m)
+	Vector3f _pos_err_integ{};		///< integral of position tracking error (m.s)
+	Vector3f _output_tracking_error{};	///< contains the magnitude of the angle, velocity and position track errors (rad, m/s, m)
+
+	float _yaw_delta_ef{0.0f};		///< Recent change in yaw angle measured about the earth frame D axis (rad)
+	float _yaw_rate_lpf_ef{0.0f};		///< Filtered angular rate about earth frame D axis (rad/sec)
+
+	ResetTotals _reset_totals{};
+
+	// parameters
+	Vector3f _imu_pos_body{};		///< xyz position of IMU in body frame (m)
+	float _vel_tau{0.25f};			///< velocity state correction time constant (1/sec)
+	float _pos_tau{0.25f};			///< position state correction time constant (1/sec)
+};
+
+#endif // !EKF_OUTPUT_PREDICTOR_HPP
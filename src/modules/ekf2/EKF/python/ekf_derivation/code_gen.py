@@ -27,7 +27,7 @@ class CodeGenerator:
         write_string = write_string + "\n\n"
         self.file.write(write_string)
 
-    def write_matrix(self, matrix, variable_name, is_symmetric=False, pre_bracket="(", post_bracket=")"):
+    def write_matrix(self, matrix, variable_name, is_symmetric=False, pre_bracket="(", post_bracket=")", skip_zeros=False):
         write_string = ""
 
         if matrix.shape[0] * matrix.shape[1] == 1:
@@ -39,6 +39,8 @@ class CodeGenerator:
         else:
             for j in range(0, matrix.shape[1]):
                 for i in range(0, matrix.shape[0]):
+                    if skip_zeros and matrix[i,j] == 0:
+                        continue
                     if j >= i or not is_symmetric:
                         write_string = write_string + variable_name + pre_bracket + str(i) + "," + str(j) + post_bracket + " = " + self.get_ccode(matrix[i,j]) + ";\n"
 
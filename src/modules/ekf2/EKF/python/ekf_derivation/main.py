@@ -414,6 +414,48 @@ def beta_observation(P,state,R_to_body,vx,vy,vz,wx,wy):
 
     return
 
+# Specialise the covariance prediction for states that are inhibited at runtime. The covariances
+# between the inhibited states and the states in uncorrelated_states are zero, the corresponding terms
+# are removed from the common subexpressions of the full prediction and unused subexpressions are dropped.
+# The rows and columns of the inhibited states are not predicted and are left for the runtime to set.
+def covariance_prediction_inhibited_states(P, P_new_simple, inhibited_states, uncorrelated_states, file_name, description):
+    zero_cov = {}
+    for i in inhibited_states:
+        for j in uncorrelated_states:
+            if i != j:
+                zero_cov[P[i,j]] = 0
+
+    subexpressions = []
+    for (symbol, expression) in P_new_simple[0]:
+        expression = expression.xreplace(zero_cov)
+        if expression == 0:
+            zero_cov[symbol] = 0
+        else:
+            subexpressions.append((symbol, expression))
+
+    P_new = Matrix(P_new_simple[1]).xreplace(zero_cov)
+
+    for i in inhibited_states:
+        for j in uncorrelated_states:
+            P_new[min(i, j), max(i, j)] = 0
+
+    # only keep the subexpressions which are used by the remaining covariance equations
+    used_symbols = set()
+    for expression in P_new:
+        used_symbols |= expression.free_symbols
+
+    used_subexpressions = []
+    for (symbol, expression) in reversed(subexpressions):
+        if symbol in used_symbols:
+            used_symbols |= expression.free_symbols
+            used_subexpressions.insert(0, (symbol, expression))
+
+    cov_code_generator = CodeGenerator(file_name)
+    cov_code_generator.print_string("Equations for covariance matrix prediction with " + description + ", without process noise!")
+    cov_code_generator.write_subexpressions(used_subexpressions)
+    cov_code_generator.write_matrix(P_new, "nextP", True, "(", ")", True)
+    cov_code_generator.close()
+
 # yaw estimator prediction and observation code
 def yaw_estimator():
     dt = symbols("dt", real=True)  # dt (sec)
@@ -611,6 +653,11 @@ def generate_code():
 
     cov_code_generator.close()
 
+    # The delta velocity bias states are inhibited by keeping them uncorrelated with the other IMU states,
+    # their covariances with the magnetic field and wind states are retained
+    print('Writing covariance propagation with inhibited delta velocity bias states to file ...')
+    covariance_prediction_inhibited_states(P, P_new_simple, range(13, 16), range(16), "./generated/covariance_generated_dvel_bias_inhibited.cpp", "inhibited delta velocity bias states")
+
     # derive autocode for observation methods
     print('Generating heading observation code ...')
     yaw_observation(P,state,R_to_earth)
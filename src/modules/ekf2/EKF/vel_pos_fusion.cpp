@@ -167,50 +167,42 @@ bool Ekf::fuseVerticalPosition(const float innov, const float innov_gate, const
 // Helper function that fuses a single velocity or position measurement
 bool Ekf::fuseVelPosHeight(const float innov, const float innov_var, const int obs_index)
 {
-	Vector24f Kfusion;  // Kalman gain vector for any single observation - sequential fusion is used.
-	const unsigned state_index = obs_index + 4;  // we start with vx and this is the 4. state
+	// the observation Jacobian is a single unit element, pick the state at compile time
+	// so that only the corresponding row of P is used
+	bool healthy = false;
 
-	// calculate kalman gain K = PHS, where S = 1/innovation variance
-	for (int row = 0; row < _k_num_states; row++) {
-		Kfusion(row) = P(row, state_index) / innov_var;
-	}
+	switch (obs_index) {
+	case 0:
+		healthy = directStateMeasurementUpdate<4>(innov, innov_var);
+		break;
 
-	SquareMatrix24f KHP;
+	case 1:
+		healthy = directStateMeasurementUpdate<5>(innov, innov_var);
+		break;
 
-	for (unsigned row = 0; row < _k_num_states; row++) {
-		for (unsigned column = 0; column < _k_num_states; column++) {
-			KHP(row, column) = Kfusion(row) * P(state_index, column);
-		}
-	}
+	case 2:
+		healthy = directStateMeasurementUpdate<6>(innov, innov_var);
+		break;
 
-	// if the covariance correction will result in a negative variance, then
-	// the covariance matrix is unhealthy and must be corrected
-	bool healthy = true;
+	case 3:
+		healthy = directStateMeasurementUpdate<7>(innov, innov_var);
+		break;
 
-	for (int i = 0; i < _k_num_states; i++) {
-		if (P(i, i) < KHP(i, i)) {
-			// zero rows and columns
-			P.uncorrelateCovarianceSetVariance<1>(i, 0.0f);
+	case 4:
+		healthy = directStateMeasurementUpdate<8>(innov, innov_var);
+		break;
 
-			healthy = false;
-		}
+	case 5:
+		healthy = directStateMeasurementUpdate<9>(innov, innov_var);
+		break;
+
+	default:
+		return false;
 	}
 
 	setVelPosStatus(obs_index, healthy);
 
-	if (healthy) {
-		// apply the covariance corrections
-		P -= KHP;
-
-		fixCovarianceErrors(true);
-
-		// apply the state corrections
-		fuse(Kfusion, innov);
-
-		return true;
-	}
-
-	return false;
+	return healthy;
 }
 
 void Ekf::setVelPosStatus(const int index, const bool healthy)
@@ -43,6 +43,7 @@ pthread_mutex_t ekf2_module_mutex = PTHREAD_MUTEX_INITIALIZER;
 static px4::atomic<EKF2 *> _objects[EKF2_MAX_INSTANCES] {};
 #if !defined(CONSTRAINED_FLASH)
 static px4::atomic<EKF2Selector *> _ekf2_selector {nullptr};
+static px4::atomic<EKF2ImuPreprocessor *> _ekf2_imu_preprocessors[EKF2::MAX_NUM_IMUS] {};
 #endif // !CONSTRAINED_FLASH
 
 EKF2::EKF2(bool multi_mode, const px4::wq_config_t &config, bool replay_mode):
@@ -177,6 +178,14 @@ EKF2::EKF2(bool multi_mode, const px4::wq_config_t &config, bool replay_mode):
 	_estimator_states_pub.advertise();
 	_estimator_status_flags_pub.advertise();
 	_estimator_status_pub.advertise();
+
+	// The output predictor on its own work item needs the same IMU down-sampling as the EKF, which is decided here,
+	// before the first IMU sample, so that no down-sampled interval is lost. Multi-EKF instances get the shared
+	// down-sampler of their IMU in multi_init().
+	if (_param_ekf2_op_async.get() && !_replay_mode && !_multi_mode) {
+		_imu_preprocessor = new EKF2ImuPreprocessor();
+		_imu_preprocessor_owned = (_imu_preprocessor != nullptr);
+	}
 }
 
 EKF2::~EKF2()
@@ -192,10 +201,18 @@ EKF2::~EKF2()
 	perf_free(_msg_missed_magnetometer_perf);
 	perf_free(_msg_missed_odometry_perf);
 	perf_free(_msg_missed_optical_flow_perf);
+
+	delete _output_predictor;
+
+	if (_imu_preprocessor_owned) {
+		delete _imu_preprocessor;
+	}
 }
 
-bool EKF2::multi_init(int imu, int mag)
+bool EKF2::multi_init(int imu, int mag, EKF2ImuPreprocessor *imu_preprocessor)
 {
+	_imu_preprocessor = imu_preprocessor;
+
 	// advertise all topics to ensure consistent uORB instance numbering
 	_ekf2_timestamps_pub.advertise();
 	_estimator_baro_bias_pub.advertise();
@@ -257,6 +274,10 @@ int EKF2::print_status()
 	perf_print_counter(_msg_missed_odometry_perf);
 	perf_print_counter(_msg_missed_optical_flow_perf);
 
+	if (_output_predictor) {
+		_output_predictor->print_status();
+	}
+
 #if defined(DEBUG_BUILD)
 	_ekf.print_status();
 #endif // DEBUG_BUILD
@@ -270,6 +291,10 @@ void EKF2::Run()
 		_sensor_combined_sub.unregisterCallback();
 		_vehicle_imu_sub.unregisterCallback();
 
+		if (_output_predictor) {
+			_output_predictor->stop();
+		}
+
 		return;
 	}
 
@@ -336,6 +361,11 @@ void EKF2::Run()
 			ScheduleDelayed(10_ms);
 			return;
 		}
+
+		if (_param_ekf2_op_async.get() && (_imu_preprocessor != nullptr) && !_replay_mode
+		    && (_output_predictor == nullptr)) {
+			StartOutputPredictor();
+		}
 	}
 
 	if (_vehicle_command_sub.updated()) {
@@ -502,8 +532,28 @@ void EKF2::Run()
 		const hrt_abstime now = imu_sample_new.time_us;
 
 		// push imu data into estimator
-		_ekf.setIMUData(imu_sample_new);
-		PublishAttitude(now); // publish attitude immediately (uses quaternion from output predictor)
+		if (_imu_preprocessor) {
+			// down-sampling shared with all instances using this IMU
+			imuSample imu_down_sampled;
+
+			const unsigned imu_generation = _multi_mode ? _vehicle_imu_sub.get_last_generation()
+							: _sensor_combined_sub.get_last_generation();
+
+			if (_imu_preprocessor->update(imu_sample_new, imu_generation, _params->filter_update_interval_us, imu_down_sampled)) {
+
+				_ekf.setIMUData(imu_sample_new, &imu_down_sampled);
+
+			} else {
+				_ekf.setIMUData(imu_sample_new, nullptr);
+			}
+
+		} else {
+			_ekf.setIMUData(imu_sample_new);
+		}
+
+		if (_output_predictor == nullptr) {
+			PublishAttitude(now); // publish attitude immediately (uses quaternion from output predictor)
+		}
 
 		// integrate time to monitor time slippage
 		if (_start_time_us > 0) {
@@ -591,6 +641,11 @@ void EKF2::Run()
 		if (_ekf.update()) {
 			perf_set_elapsed(_ecl_ekf_update_full_perf, hrt_elapsed_time(&ekf_update_start));
 
+			if (_output_predictor) {
+				// attitude is published by the output predictor work item
+				_output_predictor->updateFilterStates(_ekf);
+			}
+
 			PublishLocalPosition(now);
 			PublishOdometry(now, imu_sample_new);
 			PublishGlobalPosition(now);
@@ -626,12 +681,33 @@ void EKF2::Run()
 
 		// publish ekf2_timestamps
 		_ekf2_timestamps_pub.publish(ekf2_timestamps);
+
+		if (!_replay_mode) {
+			const hrt_abstime latency_us = hrt_elapsed_time(&imu_sample_new.time_us);
+			_latency_sum_us += latency_us;
+			_latency_count++;
+			_latency_max_us = math::max(_latency_max_us, static_cast<uint32_t>(latency_us));
+		}
 	}
 
 	// re-schedule as backup timeout
 	ScheduleDelayed(100_ms);
 }
 
+void EKF2::StartOutputPredictor()
+{
+	// shares the IMU down-sampling the EKF has been using from the start
+	_output_predictor = new EKF2OutputPredictor(_multi_mode, _attitude_pub);
+
+	if ((_output_predictor == nullptr)
+	    || !_output_predictor->init(_vehicle_imu_sub.get_instance(), _imu_preprocessor, _params->filter_update_interval_us)) {
+
+		PX4_ERR("%d - output predictor start failed", _instance);
+		delete _output_predictor;
+		_output_predictor = nullptr;
+	}
+}
+
 void EKF2::PublishAttitude(const hrt_abstime &timestamp)
 {
 	if (_ekf.attitude_valid()) {
@@ -1228,6 +1304,15 @@ void EKF2::PublishStatus(const hrt_abstime &timestamp)
 
 	status.time_slip = _last_time_slip_us * 1e-6f;
 
+	if (_latency_count > 0) {
+		status.latency_us = _latency_sum_us / _latency_count;
+		status.latency_max_us = _latency_max_us;
+
+		_latency_sum_us = 0;
+		_latency_count = 0;
+		_latency_max_us = 0;
+	}
+
 	status.pre_flt_fail_innov_heading = _preflt_checker.hasHeadingFailed();
 	status.pre_flt_fail_innov_vel_horiz = _preflt_checker.hasHorizVelFailed();
 	status.pre_flt_fail_innov_vel_vert = _preflt_checker.hasVertVelFailed();
@@ -2082,6 +2167,18 @@ int EKF2::task_spawn(int argc, char *argv[])
 
 		bool ekf2_instance_created[MAX_NUM_IMUS][MAX_NUM_MAGS] {}; // IMUs * mags
 
+		// free the preprocessor of an IMU again if its instance failed to start and no other instance uses it
+		auto release_imu_preprocessor = [&ekf2_instance_created](uint8_t imu) {
+			for (bool created : ekf2_instance_created[imu]) {
+				if (created) {
+					return;
+				}
+			}
+
+			delete _ekf2_imu_preprocessors[imu].load();
+			_ekf2_imu_preprocessors[imu].store(nullptr);
+		};
+
 		while ((multi_instances_allocated < multi_instances)
 		       && (vehicle_status_sub.get().arming_state != vehicle_status_s::ARMING_STATE_ARMED)
 		       && ((hrt_elapsed_time(&time_started) < 30_s)
@@ -2101,9 +2198,21 @@ int EKF2::task_spawn(int argc, char *argv[])
 					if ((vehicle_mag_sub.advertised() || mag == 0) && (vehicle_imu_sub.advertised())) {
 
 						if (!ekf2_instance_created[imu][mag]) {
-							EKF2 *ekf2_inst = new EKF2(true, px4::ins_instance_to_wq(imu), false);
+							if (_ekf2_imu_preprocessors[imu].load() == nullptr) {
+								_ekf2_imu_preprocessors[imu].store(new EKF2ImuPreprocessor());
+							}
 
-							if (ekf2_inst && ekf2_inst->multi_init(imu, mag)) {
+#if defined(__PX4_NUTTX)
+							// all instances using the same IMU run sequentially on the IMU's work queue
+							const px4::wq_config_t &wq_config = px4::ins_instance_to_wq(imu);
+#else
+							// one work queue per instance, the threads are spread across all available cores
+							const px4::wq_config_t &wq_config = px4::ins_instance_to_wq(multi_instances_allocated);
+#endif // __PX4_NUTTX
+
+							EKF2 *ekf2_inst = new EKF2(true, wq_config, false);
+
+							if (ekf2_inst && ekf2_inst->multi_init(imu, mag, _ekf2_imu_preprocessors[imu].load())) {
 								int actual_instance = ekf2_inst->instance(); // match uORB instance numbering
 
 								if ((actual_instance >= 0) && (_objects[actual_instance].load() == nullptr)) {
@@ -2121,11 +2230,13 @@ int EKF2::task_spawn(int argc, char *argv[])
 								} else {
 									PX4_ERR("instance numbering problem instance: %d", actual_instance);
 									delete ekf2_inst;
+									release_imu_preprocessor(imu);
 									break;
 								}
 
 							} else {
 								PX4_ERR("alloc and init failed imu: %" PRIu8 " mag:%" PRIu8, imu, mag);
+								release_imu_preprocessor(imu);
 								px4_usleep(100000);
 								break;
 							}
@@ -2240,6 +2351,13 @@ extern "C" __EXPORT int ekf2_main(int argc, char *argv[])
 			if (_ekf2_selector.load()) {
 				_ekf2_selector.load()->PrintStatus();
 			}
+
+			for (int i = 0; i < EKF2::MAX_NUM_IMUS; i++) {
+				if (_ekf2_imu_preprocessors[i].load()) {
+					PX4_INFO_RAW("IMU %d shared down-sampling, ", i);
+					_ekf2_imu_preprocessors[i].load()->print_status();
+				}
+			}
 #endif // !CONSTRAINED_FLASH
 
 			for (int i = 0; i < EKF2_MAX_INSTANCES; i++) {
@@ -2304,6 +2422,13 @@ extern "C" __EXPORT int ekf2_main(int argc, char *argv[])
 				}
 			}
 
+#if !defined(CONSTRAINED_FLASH)
+			for (auto &imu_preprocessor : _ekf2_imu_preprocessors) {
+				delete imu_preprocessor.load();
+				imu_preprocessor.store(nullptr);
+			}
+#endif // !CONSTRAINED_FLASH
+
 			if (!was_running) {
 				PX4_WARN("not running");
 			}
@@ -44,6 +44,8 @@
 #include "EKF/ekf.h"
 #include "Utility/PreFlightChecker.hpp"
 
+#include "EKF2ImuPreprocessor.hpp"
+#include "EKF2OutputPredictor.hpp"
 #include "EKF2Selector.hpp"
 
 #include <float.h>
@@ -124,17 +126,19 @@ public:
 	static bool trylock_module() { return (pthread_mutex_trylock(&ekf2_module_mutex) == 0); }
 	static void unlock_module() { pthread_mutex_unlock(&ekf2_module_mutex); }
 
-	bool multi_init(int imu, int mag);
+	bool multi_init(int imu, int mag, EKF2ImuPreprocessor *imu_preprocessor);
 
 	int instance() const { return _instance; }
 
-private:
-
 	static constexpr uint8_t MAX_NUM_IMUS = 4;
 	static constexpr uint8_t MAX_NUM_MAGS = 4;
 
+private:
+
 	void Run() override;
 
+	void StartOutputPredictor();
+
 	void PublishAttitude(const hrt_abstime &timestamp);
 	void PublishBaroBias(const hrt_abstime &timestamp);
 	void PublishEventFlags(const hrt_abstime &timestamp);
@@ -186,6 +190,16 @@ private:
 	uint64_t _start_time_us = 0;		///< system time at EKF start (uSec)
 	int64_t _last_time_slip_us = 0;		///< Last time slip (uSec)
 
+	// latency monitoring (IMU sample to end of processing), reset on every estimator_status publication
+	uint64_t _latency_sum_us{0};
+	uint32_t _latency_count{0};
+	uint32_t _latency_max_us{0};
+
+	EKF2ImuPreprocessor *_imu_preprocessor{nullptr};	///< IMU down-sampling shared with other instances or the output predictor
+	bool _imu_preprocessor_owned{false};
+
+	EKF2OutputPredictor *_output_predictor{nullptr};	///< optional output predictor on its own work item (EKF2_OP_ASYNC)
+
 	perf_counter_t _ecl_ekf_update_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": ECL update")};
 	perf_counter_t _ecl_ekf_update_full_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": ECL full update")};
 	perf_counter_t _msg_missed_imu_perf{perf_alloc(PC_COUNT, MODULE_NAME": IMU message missed")};
@@ -543,7 +557,9 @@ private:
 
 		// Used by EKF-GSF experimental yaw estimator
 		(ParamExtFloat<px4::params::EKF2_GSF_TAS>)
-		_param_ekf2_gsf_tas_default	///< default value of true airspeed assumed during fixed wing operation
+		_param_ekf2_gsf_tas_default,	///< default value of true airspeed assumed during fixed wing operation
+
+		(ParamBool<px4::params::EKF2_OP_ASYNC>) _param_ekf2_op_async
 
 	)
 };
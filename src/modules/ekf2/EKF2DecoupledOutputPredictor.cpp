@@ -0,0 +1,157 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "EKF2DecoupledOutputPredictor.hpp"
+
+bool EKF2DecoupledOutputPredictor::init(EKF2ImuPreprocessor *imu_preprocessor, int32_t filter_update_interval_us)
+{
+	_imu_preprocessor = imu_preprocessor;
+	_filter_update_interval_us = filter_update_interval_us;
+
+	return _imu_preprocessor != nullptr;
+}
+
+void EKF2DecoupledOutputPredictor::updateFilterStates(Ekf &ekf)
+{
+	FilterUpdate &update = _filter_update_handoff.back();
+
+	const parameters &params = *ekf.getParamHandle();
+
+	update.states = ekf.getOutputPredictorStates();
+	update.resets = ekf.output_predictor().getResetTotals();
+	update.imu_pos_body = params.imu_pos_body;
+	update.vel_tau = params.vel_Tau;
+	update.pos_tau = params.pos_Tau;
+	update.filter_update_interval_us = params.filter_update_interval_us;
+	update.buffer_length = ekf.output_predictor().get_length();
+	update.attitude_valid = ekf.control_status_flags().tilt_align;
+	ekf.get_quat_reset(update.delta_q_reset, &update.quat_reset_counter);
+
+	_filter_update_handoff.publish();
+}
+
+bool EKF2DecoupledOutputPredictor::applyFilterUpdate()
+{
+	// latest EKF states, older updates that have not been used yet are replaced
+	if (!_filter_update_handoff.update()) {
+		return false;
+	}
+
+	const FilterUpdate &update = _filter_update_handoff.front();
+
+	const uint8_t buffer_length = math::min(update.buffer_length + BUFFER_LENGTH_MARGIN, (int)UINT8_MAX);
+
+	if (buffer_length != _output_predictor.get_length()) {
+		// history lost, start again
+		_output_predictor.allocate(buffer_length);
+		_aligned = false;
+	}
+
+	if (_aligned) {
+		applyResets(update);
+	}
+
+	_states = update.states;
+	_resets_applied = update.resets;
+
+	_output_predictor.set_imu_offset(update.imu_pos_body);
+	_output_predictor.set_vel_correction_tc(update.vel_tau);
+	_output_predictor.set_pos_correction_tc(update.pos_tau);
+	_filter_update_interval_us = update.filter_update_interval_us;
+
+	_attitude_valid = update.attitude_valid;
+	memcpy(_delta_q_reset, update.delta_q_reset, sizeof(_delta_q_reset));
+	_quat_reset_counter = update.quat_reset_counter;
+
+	_correction_pending = true;
+	return true;
+}
+
+bool EKF2DecoupledOutputPredictor::updateImu(const imuSample &imu, unsigned generation)
+{
+	// down-sampling shared with the EKF, usually done here first as the output predictor has the higher priority
+	imuSample imu_down_sampled;
+	const bool imu_down_sampled_updated = _imu_preprocessor->update(imu, generation, _filter_update_interval_us,
+					      imu_down_sampled);
+
+	// nothing to predict before the first EKF update
+	if (_states.time_us == 0) {
+		return false;
+	}
+
+	_output_predictor.calculateOutputStates(imu, _states);
+
+	// store and correct the output states with the same timing as the EKF down-sampled IMU data
+	if (imu_down_sampled_updated) {
+		_output_predictor.storeOutputStates();
+
+		if (!_aligned) {
+			_output_predictor.alignOutputFilter(_states);
+			_aligned = true;
+			_correction_pending = false;
+
+		} else if (_correction_pending) {
+			_output_predictor.correctOutputStates(_states);
+			_correction_pending = false;
+		}
+	}
+
+	return _aligned;
+}
+
+void EKF2DecoupledOutputPredictor::applyResets(const FilterUpdate &update)
+{
+	// apply the resets the EKF applied to its own output predictor since the last update
+	const OutputPredictor::ResetTotals &resets = update.resets;
+
+	if (resets.quat_counter != _resets_applied.quat_counter) {
+		_output_predictor.resetQuaternion((resets.quat_change * _resets_applied.quat_change.inversed()).normalized());
+	}
+
+	if (resets.velNE_counter != _resets_applied.velNE_counter) {
+		_output_predictor.resetHorizontalVelocity(resets.velNE_change - _resets_applied.velNE_change);
+	}
+
+	if (resets.velD_counter != _resets_applied.velD_counter) {
+		_output_predictor.resetVerticalVelocity(resets.velD_change - _resets_applied.velD_change);
+	}
+
+	if (resets.posNE_counter != _resets_applied.posNE_counter) {
+		_output_predictor.resetHorizontalPosition(resets.posNE_change - _resets_applied.posNE_change);
+	}
+
+	if (resets.posD_counter != _resets_applied.posD_counter) {
+		_output_predictor.resetVerticalPosition(update.states.pos(2), resets.posD_change - _resets_applied.posD_change);
+	}
+}
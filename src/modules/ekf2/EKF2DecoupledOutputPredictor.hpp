@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file EKF2DecoupledOutputPredictor.hpp
+ * Output predictor of an EKF2 instance decoupled from the EKF update.
+ *
+ * The predictor runs on every IMU sample with the EKF states at the fusion time horizon handed over
+ * without locking after every EKF update (triple buffer, only the latest update is kept), they are
+ * used for the output predictor correction at the next down-sampled IMU sample.
+ *
+ * The IMU down-sampling is shared with the EKF (see EKF2ImuPreprocessor) so that the output state
+ * history is stored at exactly the same times as the down-sampled IMU data of the EKF.
+ */
+
+#ifndef EKF2_DECOUPLED_OUTPUT_PREDICTOR_HPP
+#define EKF2_DECOUPLED_OUTPUT_PREDICTOR_HPP
+
+#include "EKF/ekf.h"
+#include "EKF/output_predictor.hpp"
+
+#include "EKF2ImuPreprocessor.hpp"
+#include "EKF2TripleBuffer.hpp"
+
+class EKF2DecoupledOutputPredictor
+{
+public:
+	EKF2DecoupledOutputPredictor() = default;
+	~EKF2DecoupledOutputPredictor() = default;
+
+	bool init(EKF2ImuPreprocessor *imu_preprocessor, int32_t filter_update_interval_us);
+
+	/**
+	 * Hand the EKF states over to the output predictor, called by the EKF owner after every EKF update.
+	 */
+	void updateFilterStates(Ekf &ekf);
+
+	/**
+	 * Take the latest EKF states handed over, called by the output predictor owner before every IMU sample.
+	 *
+	 * @return true if new EKF states were taken
+	 */
+	bool applyFilterUpdate();
+
+	/**
+	 * Propagate the output states to the time of an IMU sample.
+	 *
+	 * @param imu high rate imu sample
+	 * @param generation uORB generation of the message the sample was taken from, shared with the EKF
+	 * @return true if the output states are aligned with the EKF and valid
+	 */
+	bool updateImu(const imuSample &imu, unsigned generation);
+
+	const OutputPredictor &output_predictor() const { return _output_predictor; }
+
+	bool attitude_valid() const { return _attitude_valid && PX4_ISFINITE(_output_predictor.getQuaternion()(0)); }
+	bool aligned() const { return _aligned; }
+
+	void get_quat_reset(float delta_quat[4], uint8_t *counter) const
+	{
+		memcpy(delta_quat, _delta_q_reset, sizeof(_delta_q_reset));
+		*counter = _quat_reset_counter;
+	}
+
+private:
+	// data handed over from the EKF owner after every EKF update
+	struct FilterUpdate {
+		OutputPredictor::FilterStates states{};
+		OutputPredictor::ResetTotals resets{};	///< resets applied to the output predictor of the EKF
+		Vector3f imu_pos_body{};
+		float vel_tau{0.25f};
+		float pos_tau{0.25f};
+		int32_t filter_update_interval_us{10000};
+		uint8_t buffer_length{0};		///< output buffer length of the EKF
+		bool attitude_valid{false};		///< tilt alignment complete
+		float delta_q_reset[4] {};		///< latest quaternion reset (published with the attitude)
+		uint8_t quat_reset_counter{0};
+	};
+
+	void applyResets(const FilterUpdate &update);
+
+	// the output predictor runs ahead of the EKF by the time the EKF update takes, keep a few
+	// more samples than the EKF to still find the state at the fusion time horizon
+	static constexpr uint8_t BUFFER_LENGTH_MARGIN = 4;
+
+	TripleBuffer<FilterUpdate> _filter_update_handoff{};
+
+	EKF2ImuPreprocessor *_imu_preprocessor{nullptr};
+	int32_t _filter_update_interval_us{10000};
+
+	OutputPredictor _output_predictor{};
+	OutputPredictor::FilterStates _states{};
+	OutputPredictor::ResetTotals _resets_applied{};
+
+	float _delta_q_reset[4] {};
+	uint8_t _quat_reset_counter{0};
+
+	bool _attitude_valid{false};
+	bool _aligned{false};
+	bool _correction_pending{false};
+};
+
+#endif // !EKF2_DECOUPLED_OUTPUT_PREDICTOR_HPP
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "EKF2ImuPreprocessor.hpp"
+
+#include <containers/LockGuard.hpp>
+#include <px4_platform_common/log.h>
+
+EKF2ImuPreprocessor::EKF2ImuPreprocessor()
+{
+	pthread_mutex_init(&_mutex, nullptr);
+}
+
+EKF2ImuPreprocessor::~EKF2ImuPreprocessor()
+{
+	pthread_mutex_destroy(&_mutex);
+}
+
+bool EKF2ImuPreprocessor::update(const imuSample &imu_sample, unsigned generation, int32_t target_dt_us,
+				 imuSample &imu_down_sampled)
+{
+	LockGuard lg{_mutex};
+
+	// already processed for another instance
+	for (const auto &entry : _history) {
+		if (entry.valid && (entry.generation == generation)) {
+			if (entry.updated) {
+				imu_down_sampled = entry.imu;
+			}
+
+			_shared_count++;
+			return entry.updated;
+		}
+	}
+
+	if ((_sample_count > 0) && (static_cast<int>(generation - _last_generation) <= 0)) {
+		// older than anything in the history, the data has already been consumed
+		_dropped_count++;
+
+		// at most one warning per second, all drops are counted in the status
+		if ((_dropped_count == 1) || (imu_sample.time_us >= _last_drop_warning_us + 1000000)) {
+			PX4_WARN("IMU sample dropped, generation %u not newer than %u (%" PRIu32 " dropped)",
+				 generation, _last_generation, _dropped_count);
+			_last_drop_warning_us = imu_sample.time_us;
+		}
+
+		return false;
+	}
+
+	_target_dt_us = target_dt_us;
+
+	DownSampledImu &entry = _history[_history_index];
+	_history_index = (_history_index + 1) % HISTORY_SIZE;
+
+	entry.generation = generation;
+	entry.updated = _imu_down_sampler.update(imu_sample);
+	entry.valid = true;
+
+	if (entry.updated) {
+		entry.imu = _imu_down_sampler.getDownSampledImuAndTriggerReset();
+		imu_down_sampled = entry.imu;
+	}
+
+	_last_generation = generation;
+	_sample_count++;
+
+	return entry.updated;
+}
+
+void EKF2ImuPreprocessor::print_status()
+{
+	LockGuard lg{_mutex};
+
+	PX4_INFO_RAW("samples: %" PRIu32 ", shared: %" PRIu32 ", dropped: %" PRIu32 "\n",
+		     _sample_count, _shared_count, _dropped_count);
+}
@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file EKF2ImuPreprocessor.hpp
+ * IMU down-sampling shared by all multi-EKF instances using the same vehicle_imu instance.
+ *
+ * The first instance to process a vehicle_imu message runs the down-sampler, the result is
+ * stored by message generation so that the other instances using the same IMU (running on
+ * other work queues) receive the same down-sampled data without repeating the work.
+ */
+
+#ifndef EKF2_IMU_PREPROCESSOR_HPP
+#define EKF2_IMU_PREPROCESSOR_HPP
+
+#include "EKF/common.h"
+#include "EKF/imu_down_sampler.hpp"
+
+#include <pthread.h>
+
+class EKF2ImuPreprocessor
+{
+public:
+	EKF2ImuPreprocessor();
+	~EKF2ImuPreprocessor();
+
+	/**
+	 * Down-sample a vehicle_imu sample once for all instances.
+	 *
+	 * @param imu_sample high rate imu sample
+	 * @param generation uORB generation of the vehicle_imu message the sample was taken from
+	 * @param target_dt_us filter update interval (EKF2_PREDICT_US)
+	 * @param imu_down_sampled set to the down-sampled imu data if available
+	 * @return true if new down-sampled data is available
+	 */
+	bool update(const imuSample &imu_sample, unsigned generation, int32_t target_dt_us, imuSample &imu_down_sampled);
+
+	void print_status();
+
+private:
+	// must cover the maximum lag between the first and the last instance processing the same message
+	static constexpr int HISTORY_SIZE = 8;
+
+	struct DownSampledImu {
+		imuSample imu{};
+		unsigned generation{0};
+		bool updated{false};
+		bool valid{false};
+	};
+
+	pthread_mutex_t _mutex{};
+
+	int32_t _target_dt_us{10000};
+	ImuDownSampler _imu_down_sampler{_target_dt_us};
+
+	DownSampledImu _history[HISTORY_SIZE] {};
+	int _history_index{0};
+
+	unsigned _last_generation{0};
+
+	uint32_t _sample_count{0};
+	uint32_t _shared_count{0};
+	uint32_t _dropped_count{0};
+	uint64_t _last_drop_warning_us{0};
+};
+
+#endif // !EKF2_IMU_PREPROCESSOR_HPP
@@ -0,0 +1,158 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "EKF2OutputPredictor.hpp"
+
+#include <drivers/drv_hrt.h>
+#include <px4_platform_common/log.h>
+
+// The output predictors of all instances share nav_and_controllers, the queue of the attitude and position
+// controllers consuming their output. It is above the INS queues running the EKF fusion, so the attitude
+// is published before the controllers run, and a predictor cycle is short (~0.5 us per IMU sample on a host).
+EKF2OutputPredictor::EKF2OutputPredictor(bool multi_mode, uORB::PublicationMulti<vehicle_attitude_s> &attitude_pub) :
+	WorkItem("ekf2_output_predictor", px4::wq_configurations::nav_and_controllers),
+	_multi_mode(multi_mode),
+	_attitude_pub(attitude_pub)
+{
+}
+
+EKF2OutputPredictor::~EKF2OutputPredictor()
+{
+	perf_free(_cycle_perf);
+	perf_free(_latency_perf);
+	perf_free(_filter_update_perf);
+}
+
+bool EKF2OutputPredictor::init(int imu_instance, EKF2ImuPreprocessor *imu_preprocessor,
+			       int32_t filter_update_interval_us)
+{
+	if (!_output_predictor.init(imu_preprocessor, filter_update_interval_us)) {
+		return false;
+	}
+
+	if (_multi_mode) {
+		return _vehicle_imu_sub.ChangeInstance(imu_instance) && _vehicle_imu_sub.registerCallback();
+	}
+
+	return _sensor_combined_sub.registerCallback();
+}
+
+void EKF2OutputPredictor::stop()
+{
+	_sensor_combined_sub.unregisterCallback();
+	_vehicle_imu_sub.unregisterCallback();
+}
+
+void EKF2OutputPredictor::Run()
+{
+	perf_begin(_cycle_perf);
+
+	imuSample imu{};
+	bool imu_updated = false;
+	unsigned generation = 0;
+
+	if (_multi_mode) {
+		vehicle_imu_s vehicle_imu;
+
+		if (_vehicle_imu_sub.update(&vehicle_imu)) {
+			imu.time_us = vehicle_imu.timestamp_sample;
+			imu.delta_ang_dt = vehicle_imu.delta_angle_dt * 1.e-6f;
+			imu.delta_ang = Vector3f{vehicle_imu.delta_angle};
+			imu.delta_vel_dt = vehicle_imu.delta_velocity_dt * 1.e-6f;
+			imu.delta_vel = Vector3f{vehicle_imu.delta_velocity};
+
+			if (vehicle_imu.delta_velocity_clipping > 0) {
+				imu.delta_vel_clipping[0] = vehicle_imu.delta_velocity_clipping & vehicle_imu_s::CLIPPING_X;
+				imu.delta_vel_clipping[1] = vehicle_imu.delta_velocity_clipping & vehicle_imu_s::CLIPPING_Y;
+				imu.delta_vel_clipping[2] = vehicle_imu.delta_velocity_clipping & vehicle_imu_s::CLIPPING_Z;
+			}
+
+			imu_updated = true;
+			generation = _vehicle_imu_sub.get_last_generation();
+		}
+
+	} else {
+		sensor_combined_s sensor_combined;
+
+		if (_sensor_combined_sub.update(&sensor_combined)) {
+			imu.time_us = sensor_combined.timestamp;
+			imu.delta_ang_dt = sensor_combined.gyro_integral_dt * 1.e-6f;
+			imu.delta_ang = Vector3f{sensor_combined.gyro_rad} * imu.delta_ang_dt;
+			imu.delta_vel_dt = sensor_combined.accelerometer_integral_dt * 1.e-6f;
+			imu.delta_vel = Vector3f{sensor_combined.accelerometer_m_s2} * imu.delta_vel_dt;
+
+			if (sensor_combined.accelerometer_clipping > 0) {
+				imu.delta_vel_clipping[0] = sensor_combined.accelerometer_clipping & sensor_combined_s::CLIPPING_X;
+				imu.delta_vel_clipping[1] = sensor_combined.accelerometer_clipping & sensor_combined_s::CLIPPING_Y;
+				imu.delta_vel_clipping[2] = sensor_combined.accelerometer_clipping & sensor_combined_s::CLIPPING_Z;
+			}
+
+			imu_updated = true;
+			generation = _sensor_combined_sub.get_last_generation();
+		}
+	}
+
+	if (_output_predictor.applyFilterUpdate()) {
+		perf_count(_filter_update_perf);
+	}
+
+	if (imu_updated && _output_predictor.updateImu(imu, generation)) {
+		publishAttitude(imu);
+	}
+
+	perf_end(_cycle_perf);
+}
+
+void EKF2OutputPredictor::publishAttitude(const imuSample &imu)
+{
+	if (_output_predictor.attitude_valid()) {
+		vehicle_attitude_s att;
+		att.timestamp_sample = imu.time_us;
+		_output_predictor.output_predictor().getQuaternion().copyTo(att.q);
+
+		_output_predictor.get_quat_reset(att.delta_q_reset, &att.quat_reset_counter);
+		att.timestamp = hrt_absolute_time();
+		_attitude_pub.publish(att);
+
+		perf_set_elapsed(_latency_perf, att.timestamp - imu.time_us);
+	}
+}
+
+void EKF2OutputPredictor::print_status()
+{
+	PX4_INFO_RAW("output predictor on work queue, aligned: %d\n", _output_predictor.aligned());
+	perf_print_counter(_cycle_perf);
+	perf_print_counter(_latency_perf);
+	perf_print_counter(_filter_update_perf);
+}
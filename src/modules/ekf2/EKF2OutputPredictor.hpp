@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file EKF2OutputPredictor.hpp
+ * Output predictor of an EKF2 instance running on its own high priority work item.
+ *
+ * The work item runs the output predictor (see EKF2DecoupledOutputPredictor) on every IMU sample and
+ * publishes the attitude immediately, so the IMU to attitude latency does not depend on the cost of the
+ * EKF fusion running on the estimator work queue.
+ */
+
+#ifndef EKF2_OUTPUT_PREDICTOR_HPP
+#define EKF2_OUTPUT_PREDICTOR_HPP
+
+#include "EKF2DecoupledOutputPredictor.hpp"
+
+#include <lib/perf/perf_counter.h>
+#include <px4_platform_common/px4_work_queue/WorkItem.hpp>
+#include <uORB/PublicationMulti.hpp>
+#include <uORB/SubscriptionCallback.hpp>
+#include <uORB/topics/sensor_combined.h>
+#include <uORB/topics/vehicle_attitude.h>
+#include <uORB/topics/vehicle_imu.h>
+
+class EKF2OutputPredictor : public px4::WorkItem
+{
+public:
+	EKF2OutputPredictor(bool multi_mode, uORB::PublicationMulti<vehicle_attitude_s> &attitude_pub);
+	~EKF2OutputPredictor() override;
+
+	bool init(int imu_instance, EKF2ImuPreprocessor *imu_preprocessor, int32_t filter_update_interval_us);
+	void stop();
+
+	/**
+	 * Hand the EKF states over to the output predictor, called by the EKF2 instance after every EKF update.
+	 */
+	void updateFilterStates(Ekf &ekf) { _output_predictor.updateFilterStates(ekf); }
+
+	void print_status();
+
+private:
+	void Run() override;
+
+	void publishAttitude(const imuSample &imu);
+
+	const bool _multi_mode;
+
+	uORB::SubscriptionCallbackWorkItem _sensor_combined_sub{this, ORB_ID(sensor_combined)};
+	uORB::SubscriptionCallbackWorkItem _vehicle_imu_sub{this, ORB_ID(vehicle_imu)};
+
+	uORB::PublicationMulti<vehicle_attitude_s> &_attitude_pub;
+
+	EKF2DecoupledOutputPredictor _output_predictor{};
+
+	perf_counter_t _cycle_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": output predictor cycle")};
+	perf_counter_t _latency_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": output predictor IMU to attitude latency")};
+	perf_counter_t _filter_update_perf{perf_alloc(PC_COUNT, MODULE_NAME": output predictor filter update")};
+};
+
+#endif // !EKF2_OUTPUT_PREDICTOR_HPP
@@ -269,6 +269,13 @@ bool EKF2Selector::UpdateErrorScores()
 			_instance[i].baro_device_id = status.baro_device_id;
 			_instance[i].mag_device_id = status.mag_device_id;
 
+			_instance[i].time_slip = status.time_slip;
+
+			if (status.latency_us > 0) {
+				_instance[i].latency_us = status.latency_us;
+				_instance[i].latency_max_us = math::max(_instance[i].latency_max_us, status.latency_max_us);
+			}
+
 			if ((i + 1) > _available_instances) {
 				_available_instances = i + 1;
 				updated = true;
@@ -825,6 +832,11 @@ void EKF2Selector::PublishEstimatorSelectorStatus()
 		selector_status.combined_test_ratio[i] = _instance[i].combined_test_ratio;
 		selector_status.relative_test_ratio[i] = _instance[i].relative_test_ratio;
 		selector_status.healthy[i] = _instance[i].healthy.get_state();
+		selector_status.latency_us[i] = _instance[i].latency_us;
+		selector_status.latency_max_us[i] = _instance[i].latency_max_us;
+		selector_status.time_slip[i] = _instance[i].time_slip;
+
+		_instance[i].latency_max_us = 0;
 	}
 
 	for (int i = 0; i < IMU_STATUS_SIZE; i++) {
@@ -848,10 +860,12 @@ void EKF2Selector::PrintStatus()
 	for (int i = 0; i < _available_instances; i++) {
 		const EstimatorInstance &inst = _instance[i];
 
-		PX4_INFO("%" PRIu8 ": ACC: %" PRIu32 ", GYRO: %" PRIu32 ", MAG: %" PRIu32 ", %s, test ratio: %.7f (%.5f) %s",
+		PX4_INFO("%" PRIu8 ": ACC: %" PRIu32 ", GYRO: %" PRIu32 ", MAG: %" PRIu32 ", %s, test ratio: %.7f (%.5f), latency: %" PRIu32
+			 " us (max %" PRIu32 " us), time slip: %.4f s %s",
 			 inst.instance, inst.accel_device_id, inst.gyro_device_id, inst.mag_device_id,
 			 inst.healthy.get_state() ? "healthy" : "unhealthy",
 			 (double)inst.combined_test_ratio, (double)inst.relative_test_ratio,
+			 inst.latency_us, inst.latency_max_us, (double)inst.time_slip,
 			 (_selected_instance == i) ? "*" : "");
 	}
 }
@@ -132,6 +132,11 @@ private:
 		float combined_test_ratio{NAN};
 		float relative_test_ratio{NAN};
 
+		float time_slip{0.f};
+
+		uint32_t latency_us{0};
+		uint32_t latency_max_us{0}; // since last estimator_selector_status publication
+
 		systemlib::Hysteresis healthy{false};
 
 		bool warning{false};
@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file EKF2TripleBuffer.hpp
+ * Lock-free handoff of the latest value from a single producer to a single consumer.
+ *
+ * The producer fills the back slot and publishes it, the consumer takes the latest published slot.
+ * Neither side ever waits for the other, values published before the consumer took the latest one
+ * are dropped.
+ */
+
+#ifndef EKF2_TRIPLE_BUFFER_HPP
+#define EKF2_TRIPLE_BUFFER_HPP
+
+#include <px4_platform_common/atomic.h>
+
+template <typename T>
+class TripleBuffer
+{
+public:
+	// producer: fill the back slot, then publish it
+	T &back() { return _slots[_back]; }
+
+	void publish()
+	{
+		uint8_t middle = _middle.load();
+
+		while (!_middle.compare_exchange(&middle, _back | UPDATED)) {}
+
+		_back = middle & INDEX_MASK;
+	}
+
+	// consumer: returns true and makes the latest published value available in front()
+	// if a new value was published since the last call
+	bool update()
+	{
+		uint8_t middle = _middle.load();
+
+		if ((middle & UPDATED) == 0) {
+			return false;
+		}
+
+		while (!_middle.compare_exchange(&middle, _front)) {}
+
+		_front = middle & INDEX_MASK;
+		return true;
+	}
+
+	const T &front() const { return _slots[_front]; }
+
+private:
+	static constexpr uint8_t UPDATED = 0x80;
+	static constexpr uint8_t INDEX_MASK = 0x03;
+
+	T _slots[3] {};
+
+	px4::atomic<uint8_t> _middle{1};	///< index of the slot exchanged between producer and consumer
+	uint8_t _back{0};			///< producer only
+	uint8_t _front{2};			///< consumer only
+};
+
+#endif // !EKF2_TRIPLE_BUFFER_HPP
@@ -1391,3 +1391,16 @@ PARAM_DEFINE_INT32(EKF2_SYNT_MAG_Z, 0);
  * @decimal 1
  */
 PARAM_DEFINE_FLOAT(EKF2_GSF_TAS, 15.0f);
+
+/**
+ * Run the output predictor on a separate work queue
+ *
+ * If enabled, the output predictor that propagates the EKF states to the current time runs on every IMU sample on its own
+ * high priority work item and publishes the vehicle attitude, so the attitude latency does not depend on the time the EKF
+ * fusion takes. The EKF states are handed over to it after every EKF update. Not used in replay.
+ *
+ * @group EKF2
+ * @boolean
+ * @reboot_required true
+ */
+PARAM_DEFINE_INT32(EKF2_OP_ASYNC, 0);
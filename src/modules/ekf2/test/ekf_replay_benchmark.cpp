@@ -0,0 +1,522 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * Offline EKF replay benchmark
+ *
+ * Streams a replay data file (CSV format of replay_data/, a ULog can be converted with
+ * sensor_simulator/convertULogToSensorData.py) through the EKF as fast as possible and reports
+ * the throughput, a histogram of the time per Ekf::update() and the divergence of the
+ * estimator output from a reference run (e.g. change_indication/).
+ *
+ * Returns a non-zero exit code if the output diverges from the reference, if repeated
+ * runs are not bit identical or if the replay is slower than the minimum real time factor.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "EKF/ekf.h"
+#include "sensor_simulator/sensor_simulator.h"
+#include "sensor_simulator/ekf_wrapper.h"
+
+namespace
+{
+
+static constexpr uint32_t LOG_INTERVAL_US = 100000; // 10 Hz, same as the change indication logs
+static constexpr int NUM_COLUMNS = 1 + 2 * 24; // timestamp, states, variances
+
+// Allowed divergence from the reference, relative to the largest reference value of each column. The output does not
+// reproduce the reference exactly across toolchains: with FMA contraction (ARM, x86 -mfma) the accelerometer bias
+// states of iris_gps move by up to 1.3% of their range, everything else by less than 0.2%.
+static constexpr double DEFAULT_TOLERANCE = 0.025;
+
+// update time histogram bucket upper limits (nanoseconds), the last bucket is unbounded
+static constexpr uint32_t HISTOGRAM_LIMITS_NS[] {500, 1000, 2000, 4000, 8000, 16000, 32000, 64000, 128000, 256000};
+static constexpr int HISTOGRAM_SIZE = sizeof(HISTOGRAM_LIMITS_NS) / sizeof(HISTOGRAM_LIMITS_NS[0]) + 1;
+
+struct Options {
+	std::string replay_file;
+	std::string reference_file;
+	std::string output_file;
+	float duration_s{0.f};        // 0: whole replay file
+	float gps_innov_gate{0.f};    // 0: default
+	int mag_fusion_type{-1};      // -1: default
+	bool inhibit_accel_bias{false};
+	int reference_digits{3};      // significant digits of the reference, the change indication logs have 3
+	double tolerance{DEFAULT_TOLERANCE};
+	double min_real_time_factor{0.};
+	int runs{1};
+};
+
+using Row = std::vector<double>;
+
+struct RunResult {
+	std::vector<Row> log;
+	std::vector<uint32_t> update_time_ns;
+	uint64_t filter_updates{0};
+	double wall_time_s{0.};
+	double replay_time_s{0.};
+};
+
+void printUsage()
+{
+	printf("usage: ekf2_replay_benchmark -i <replay.csv> [-r <reference.csv>] [-o <output.csv>]\n"
+	       "                             [-d <duration s>] [-n <runs>] [-t <tolerance>] [-g <gps gate>]\n"
+	       "                             [-m <mag type>] [-a <0|1>] [-p <digits>] [-s <real time factor>]\n"
+	       "  -i  replay data (replay_data/ CSV format)\n"
+	       "  -r  reference EKF output (change_indication/ CSV format) to compute the divergence\n"
+	       "  -o  write the EKF output (change_indication/ CSV format, full precision)\n"
+	       "  -d  replay duration in seconds (default: whole file)\n"
+	       "  -n  number of runs (default: 1), all runs must be bit identical\n"
+	       "  -t  maximum divergence from the reference, relative to the largest reference value of each column (default: 0.025)\n"
+	       "  -p  significant digits of the reference, the output is rounded to it before comparing (default: 3, 0: off)\n"
+	       "  -s  minimum real time factor of the fastest run (default: 0, no limit)\n"
+	       "  -g  GPS velocity and position innovation gate (default: parameter default)\n"
+	       "  -m  magnetometer fusion type, MAG_FUSE_TYPE_* (default: parameter default)\n"
+	       "  -a  1: inhibit the accelerometer bias states (default: 0)\n");
+}
+
+bool parseArguments(int argc, char *argv[], Options &options)
+{
+	for (int i = 1; i < argc; i++) {
+		if ((i + 1 >= argc) || (argv[i][0] != '-') || (strlen(argv[i]) != 2)) {
+			return false;
+		}
+
+		const char *value = argv[++i];
+
+		switch (argv[i - 1][1]) {
+		case 'i': options.replay_file = value; break;
+
+		case 'r': options.reference_file = value; break;
+
+		case 'o': options.output_file = value; break;
+
+		case 'd': options.duration_s = strtof(value, nullptr); break;
+
+		case 'n': options.runs = std::max(atoi(value), 1); break;
+
+		case 't': options.tolerance = strtod(value, nullptr); break;
+
+		case 'g': options.gps_innov_gate = strtof(value, nullptr); break;
+
+		case 'm': options.mag_fusion_type = atoi(value); break;
+
+		case 'a': options.inhibit_accel_bias = (atoi(value) != 0); break;
+
+		case 'p': options.reference_digits = std::max(atoi(value), 0); break;
+
+		case 's': options.min_real_time_factor = strtod(value, nullptr); break;
+
+		default: return false;
+		}
+	}
+
+	return !options.replay_file.empty();
+}
+
+Row logRow(const Ekf &ekf)
+{
+	Row row;
+	row.reserve(NUM_COLUMNS);
+	row.push_back(static_cast<double>(ekf.get_imu_sample_delayed().time_us));
+
+	const matrix::Vector<float, 24> state = ekf.getStateAtFusionHorizonAsVector();
+	const matrix::Vector<float, 24> variance = ekf.covariances_diagonal();
+
+	for (int i = 0; i < 24; i++) {
+		row.push_back(static_cast<double>(state(i)));
+	}
+
+	for (int i = 0; i < 24; i++) {
+		row.push_back(static_cast<double>(variance(i)));
+	}
+
+	return row;
+}
+
+RunResult runReplay(const Options &options)
+{
+	std::shared_ptr<Ekf> ekf = std::make_shared<Ekf>();
+	SensorSimulator sensor_simulator(ekf);
+	EkfWrapper ekf_wrapper(ekf);
+
+	sensor_simulator.loadSensorDataFromFile(options.replay_file);
+
+	// same setup as the replay tests (test_EKF_withReplayData.cpp)
+	sensor_simulator.startGps();
+	ekf_wrapper.enableGpsFusion();
+
+	if (options.gps_innov_gate > 0.f) {
+		ekf->getParamHandle()->gps_vel_innov_gate = options.gps_innov_gate;
+		ekf->getParamHandle()->gps_pos_innov_gate = options.gps_innov_gate;
+	}
+
+	if (options.mag_fusion_type >= 0) {
+		ekf->getParamHandle()->mag_fusion_type = options.mag_fusion_type;
+	}
+
+	if (options.inhibit_accel_bias) {
+		ekf->getParamHandle()->fusion_mode |= MASK_INHIBIT_ACC_BIAS;
+	}
+
+	RunResult result;
+
+	sensor_simulator.setEkfUpdateFunction([&ekf, &result]() {
+		const auto start = std::chrono::steady_clock::now();
+		const bool updated = ekf->update();
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+
+		result.update_time_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+		if (updated) {
+			result.filter_updates++;
+		}
+
+		return updated;
+	});
+
+	// a given duration is replayed completely like in the replay tests, the last samples are held past the end of
+	// the data, otherwise the replay stops at the last sample
+	const uint64_t end_time_us = (options.duration_s > 0.f) ? static_cast<uint64_t>(options.duration_s * 1e6f + 0.5f)
+				     : sensor_simulator.getReplayEndTime();
+	const size_t rows = end_time_us / LOG_INTERVAL_US;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	while (result.log.size() < rows) {
+		sensor_simulator.runReplayMicroseconds(LOG_INTERVAL_US);
+		result.log.push_back(logRow(*ekf));
+	}
+
+	result.wall_time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.replay_time_s = sensor_simulator.getTime() * 1e-6;
+
+	return result;
+}
+
+bool loadLog(const std::string &file_name, std::vector<Row> &log)
+{
+	std::ifstream file(file_name);
+
+	if (!file) {
+		return false;
+	}
+
+	std::string line;
+	getline(file, line); // header
+
+	while (getline(file, line)) {
+		if (line.empty()) {
+			continue;
+		}
+
+		Row row;
+		std::stringstream ss(line);
+		std::string value;
+
+		while (getline(ss, value, ',')) {
+			row.push_back(strtod(value.c_str(), nullptr));
+		}
+
+		log.push_back(row);
+	}
+
+	return true;
+}
+
+void writeLog(const std::string &file_name, const std::vector<Row> &log)
+{
+	std::ofstream file(file_name);
+	file << "Timestamp";
+
+	for (int i = 0; i < 24; i++) {
+		file << ",state[" << i << "]";
+	}
+
+	for (int i = 0; i < 24; i++) {
+		file << ",variance[" << i << "]";
+	}
+
+	file << std::endl << std::setprecision(9);
+
+	for (const Row &row : log) {
+		file << static_cast<uint64_t>(row[0]);
+
+		for (size_t i = 1; i < row.size(); i++) {
+			file << "," << row[i];
+		}
+
+		file << std::endl;
+	}
+}
+
+std::string columnName(int column)
+{
+	if (column == 0) {
+		return "Timestamp";
+
+	} else if (column <= 24) {
+		return "state[" + std::to_string(column - 1) + "]";
+	}
+
+	return "variance[" + std::to_string(column - 25) + "]";
+}
+
+// value rounded to the precision the reference was written with (std::setprecision(digits))
+double roundToDigits(double value, int digits)
+{
+	if ((digits <= 0) || !std::isfinite(value)) {
+		return value;
+	}
+
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.*g", digits, value);
+	return strtod(buffer, nullptr);
+}
+
+// maximum difference of each column relative to the largest absolute reference value of that column
+bool printDivergence(const std::vector<Row> &log, const std::vector<Row> &reference, int digits, double tolerance)
+{
+	const size_t rows = log.size();
+
+	if (rows == 0) {
+		printf("divergence: no data to compare\n");
+		return false;
+	}
+
+	// a missing or an additional row fails, the replay and the reference have to cover the same time
+	if (log.size() != reference.size()) {
+		printf("divergence: %zu rows, reference %zu rows: FAIL\n", log.size(), reference.size());
+		return false;
+	}
+
+	bool pass = true;
+
+	double scale[NUM_COLUMNS] {};
+	double divergence[NUM_COLUMNS] {};
+
+	for (size_t row = 0; row < rows; row++) {
+		if (reference[row].size() != NUM_COLUMNS) {
+			printf("divergence: reference row %zu has %zu columns, expected %d\n", row, reference[row].size(), NUM_COLUMNS);
+			return false;
+		}
+
+		if (static_cast<uint64_t>(log[row][0]) != static_cast<uint64_t>(reference[row][0])) {
+			printf("divergence: timestamp mismatch at row %zu: %.0f, reference %.0f\n", row, log[row][0], reference[row][0]);
+			return false;
+		}
+
+		for (int column = 1; column < NUM_COLUMNS; column++) {
+			scale[column] = std::max(scale[column], std::fabs(reference[row][column]));
+		}
+	}
+
+	int worst_column = 1;
+
+	for (size_t row = 0; row < rows; row++) {
+		for (int column = 1; column < NUM_COLUMNS; column++) {
+			const double error = std::fabs(roundToDigits(log[row][column], digits) - reference[row][column]);
+
+			if (!std::isfinite(log[row][column])) {
+				divergence[column] = INFINITY;
+
+			} else if (scale[column] > 0.) {
+				divergence[column] = std::max(divergence[column], error / scale[column]);
+
+			} else {
+				divergence[column] = std::max(divergence[column], error);
+			}
+
+			if (divergence[column] > divergence[worst_column]) {
+				worst_column = column;
+			}
+		}
+	}
+
+	int diverged_columns = 0;
+
+	for (int column = 1; column < NUM_COLUMNS; column++) {
+		if (!(divergence[column] <= tolerance)) {
+			printf("  %-12s %.3e\n", columnName(column).c_str(), divergence[column]);
+			diverged_columns++;
+			pass = false;
+		}
+	}
+
+	printf("divergence: max %.3e (%s), %d of %d columns above %.1e: %s\n", divergence[worst_column],
+	       columnName(worst_column).c_str(), diverged_columns, NUM_COLUMNS - 1, tolerance, pass ? "PASS" : "FAIL");
+
+	return pass;
+}
+
+// returns the real time factor of the fastest run
+double printTiming(const std::vector<RunResult> &results)
+{
+	std::vector<uint32_t> update_time_ns;
+	uint64_t histogram[HISTOGRAM_SIZE] {};
+	double min_wall_time_s = INFINITY;
+	double update_time_sum_s = 0.;
+
+	for (const RunResult &result : results) {
+		update_time_ns.insert(update_time_ns.end(), result.update_time_ns.begin(), result.update_time_ns.end());
+		min_wall_time_s = std::min(min_wall_time_s, result.wall_time_s);
+	}
+
+	if (update_time_ns.empty()) {
+		printf("no EKF updates\n");
+		return 0.;
+	}
+
+	for (uint32_t t : update_time_ns) {
+		int bucket = 0;
+
+		while ((bucket < HISTOGRAM_SIZE - 1) && (t >= HISTOGRAM_LIMITS_NS[bucket])) {
+			bucket++;
+		}
+
+		histogram[bucket]++;
+		update_time_sum_s += t * 1e-9;
+	}
+
+	std::sort(update_time_ns.begin(), update_time_ns.end());
+
+	const RunResult &first = results.front();
+	const size_t samples = first.update_time_ns.size();
+	const auto percentile = [&update_time_ns](double p) {
+		return update_time_ns[static_cast<size_t>(p * (update_time_ns.size() - 1))] * 1e-3;
+	};
+
+	printf("replayed %.1f s, %zu IMU samples (%" PRIu64 " filter updates) per run, %zu runs\n",
+	       first.replay_time_s, samples, first.filter_updates, results.size());
+	printf("throughput: %.0f samples/s (%.0fx real time), EKF update only: %.0f samples/s\n",
+	       samples / min_wall_time_s, first.replay_time_s / min_wall_time_s,
+	       update_time_ns.size() / update_time_sum_s);
+	printf("update time [us]: min %.2f, mean %.2f, p50 %.2f, p99 %.2f, p99.9 %.2f, max %.2f\n",
+	       percentile(0.), update_time_sum_s * 1e6 / update_time_ns.size(),
+	       percentile(0.5), percentile(0.99), percentile(0.999), percentile(1.));
+
+	for (int bucket = 0; bucket < HISTOGRAM_SIZE; bucket++) {
+		const double fraction = static_cast<double>(histogram[bucket]) / update_time_ns.size();
+
+		if (bucket < HISTOGRAM_SIZE - 1) {
+			printf("  < %7.1f us: ", HISTOGRAM_LIMITS_NS[bucket] * 1e-3);
+
+		} else {
+			printf("  >=%7.1f us: ", HISTOGRAM_LIMITS_NS[bucket - 1] * 1e-3);
+		}
+
+		printf("%9" PRIu64 " %6.2f%% %s\n", histogram[bucket], fraction * 100.,
+		       std::string(static_cast<size_t>(fraction * 50.), '#').c_str());
+	}
+
+	return first.replay_time_s / min_wall_time_s;
+}
+
+bool identical(const std::vector<Row> &a, const std::vector<Row> &b)
+{
+	if (a.size() != b.size()) {
+		return false;
+	}
+
+	for (size_t row = 0; row < a.size(); row++) {
+		if (memcmp(a[row].data(), b[row].data(), sizeof(double) * NUM_COLUMNS) != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	Options options;
+
+	if (!parseArguments(argc, argv, options)) {
+		printUsage();
+		return 2;
+	}
+
+	std::vector<Row> reference;
+
+	if (!options.reference_file.empty() && !loadLog(options.reference_file, reference)) {
+		printf("failed to load reference %s\n", options.reference_file.c_str());
+		return 2;
+	}
+
+	std::vector<RunResult> results;
+
+	for (int run = 0; run < options.runs; run++) {
+		results.push_back(runReplay(options));
+	}
+
+	const double real_time_factor = printTiming(results);
+
+	bool pass = true;
+
+	if (real_time_factor < options.min_real_time_factor) {
+		printf("real time factor %.0f below the minimum %.0f: FAIL\n", real_time_factor, options.min_real_time_factor);
+		pass = false;
+	}
+
+	for (size_t run = 1; run < results.size(); run++) {
+		if (!identical(results[run].log, results.front().log)) {
+			printf("run %zu differs from run 0, replay not deterministic: FAIL\n", run);
+			pass = false;
+		}
+	}
+
+	if (!options.output_file.empty()) {
+		writeLog(options.output_file, results.front().log);
+	}
+
+	if (!reference.empty()) {
+		pass = printDivergence(results.front().log, reference, options.reference_digits, options.tolerance) && pass;
+	}
+
+	return pass ? 0 : 1;
+}
@@ -16,14 +16,14 @@ Imu::~Imu()
 void Imu::send(uint64_t time)
 {
 	const float dt = float((time - _time_last_data_sent) * 1.e-6f);
-	imuSample imu_sample{};
-	imu_sample.time_us = time;
-	imu_sample.delta_ang_dt = dt;
-	imu_sample.delta_ang = _gyro_data * imu_sample.delta_ang_dt;
-	imu_sample.delta_vel_dt = dt;
-	imu_sample.delta_vel = _accel_data * imu_sample.delta_vel_dt;
-
-	_ekf->setIMUData(imu_sample);
+	_imu_sample = {};
+	_imu_sample.time_us = time;
+	_imu_sample.delta_ang_dt = dt;
+	_imu_sample.delta_ang = _gyro_data * _imu_sample.delta_ang_dt;
+	_imu_sample.delta_vel_dt = dt;
+	_imu_sample.delta_vel = _accel_data * _imu_sample.delta_vel_dt;
+
+	_ekf->setIMUData(_imu_sample);
 }
 
 void Imu::setData(const Vector3f &accel, const Vector3f &gyro)
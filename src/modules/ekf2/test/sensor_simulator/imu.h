@@ -55,6 +55,9 @@ public:
 	void setAccelData(const Vector3f &accel);
 	void setGyroData(const Vector3f &gyro);
 
+	// last sample sent to the EKF
+	const imuSample &getLastSample() const { return _imu_sample; }
+
 	bool moving()
 	{
 		return ((fabsf(_accel_data.norm() - CONSTANTS_ONE_G) > 0.01f) || (_gyro_data.norm() > 0.01f));
@@ -63,6 +66,7 @@ public:
 private:
 	Vector3f _accel_data;
 	Vector3f _gyro_data;
+	imuSample _imu_sample{};
 
 	void send(uint64_t time) override;
 
@@ -158,7 +158,7 @@ void SensorSimulator::runMicroseconds(uint32_t duration)
 			}
 
 			// Update at IMU rate
-			_ekf->update();
+			updateEkf();
 		}
 	}
 }
@@ -201,7 +201,7 @@ void SensorSimulator::runReplayMicroseconds(uint32_t duration)
 				_ekf->set_vehicle_at_rest(false);
 			}
 
-			_ekf->update();
+			updateEkf();
 		}
 	}
 }
@@ -328,7 +328,7 @@ void SensorSimulator::runTrajectoryMicroseconds(uint32_t duration)
 				_ekf->set_vehicle_at_rest(false);
 			}
 
-			_ekf->update();
+			updateEkf();
 		}
 	}
 }
@@ -44,6 +44,7 @@
 #define EKF_SENSOR_SIMULATOR_H
 
 #include <memory>
+#include <functional>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -118,6 +119,12 @@ public:
 
 	void loadSensorDataFromFile(std::string filename);
 
+	// timestamp of the last sample in the loaded replay data
+	uint64_t getReplayEndTime() const { return _replay_data.empty() ? 0 : _replay_data.back().timestamp; }
+
+	// replaces the direct call of Ekf::update(), e.g. to measure the time of every update
+	void setEkfUpdateFunction(std::function<bool()> ekf_update) { _ekf_update = ekf_update; }
+
 	Airspeed    _airspeed;
 	Baro        _baro;
 	Flow        _flow;
@@ -137,8 +144,10 @@ private:
 	void setSensorDataFromTrajectory();
 	void startBasicSensor();
 	void updateSensors();
+	bool updateEkf() { return _ekf_update ? _ekf_update() : _ekf->update(); }
 
 	std::shared_ptr<Ekf> _ekf{nullptr};
+	std::function<bool()> _ekf_update{};
 
 	std::vector<sensor_info> _replay_data{};
 
@@ -0,0 +1,136 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * Compares the output predictor decoupled from the EKF update (EKF2_OP_ASYNC) with the output predictor
+ * run by the EKF itself
+ */
+
+#include <gtest/gtest.h>
+#include <math.h>
+#include <memory>
+#include "EKF/ekf.h"
+#include "EKF2DecoupledOutputPredictor.hpp"
+#include "sensor_simulator/sensor_simulator.h"
+#include "sensor_simulator/ekf_wrapper.h"
+
+class EKF2DecoupledOutputPredictorTest : public ::testing::Test
+{
+public:
+	EKF2DecoupledOutputPredictorTest(): ::testing::Test(),
+		_ekf{std::make_shared<Ekf>()},
+		_sensor_simulator(_ekf),
+		_ekf_wrapper(_ekf) {};
+
+	void SetUp() override
+	{
+		_sensor_simulator.loadSensorDataFromFile(TEST_DATA_PATH"/replay_data/iris_gps.csv");
+		_sensor_simulator.startGps();
+		_ekf_wrapper.enableGpsFusion();
+
+		ASSERT_TRUE(_output_predictor.init(&_imu_preprocessor, _ekf->getParamHandle()->filter_update_interval_us));
+
+		_sensor_simulator.setEkfUpdateFunction([this]() { return update(); });
+	}
+
+	static uint32_t resetCount(const OutputPredictor::ResetTotals &resets)
+	{
+		return resets.quat_counter + resets.velNE_counter + resets.velD_counter + resets.posNE_counter + resets.posD_counter;
+	}
+
+	// one IMU sample with the order of the work items: the output predictor runs first with the EKF states
+	// handed over after the previous EKF update, then the EKF update hands the new states over
+	bool update()
+	{
+		_output_predictor.applyFilterUpdate();
+		const bool output_valid = _output_predictor.updateImu(_sensor_simulator._imu.getLastSample(), ++_generation);
+
+		const uint32_t reset_count = resetCount(_ekf->output_predictor().getResetTotals());
+		const bool updated = _ekf->update();
+
+		if (updated) {
+			_output_predictor.updateFilterStates(*_ekf);
+		}
+
+		if (resetCount(_ekf->output_predictor().getResetTotals()) != reset_count) {
+			// the decoupled output predictor applies the reset with the next IMU sample
+			_reset_samples++;
+
+		} else if (output_valid && _ekf->attitude_valid()) {
+			const OutputPredictor &output = _output_predictor.output_predictor();
+
+			EXPECT_EQ(output.get_time_us(), _ekf->output_predictor().get_time_us());
+
+			const Quatf q_error = _ekf->getQuaternion().inversed() * output.getQuaternion();
+			_max_angle_error = fmaxf(_max_angle_error, AxisAnglef(q_error.canonical()).angle());
+			_max_vel_error = fmaxf(_max_vel_error, (output.getVelocity() - _ekf->getVelocity()).norm());
+			_max_pos_error = fmaxf(_max_pos_error, (output.getPosition() - _ekf->getPosition()).norm());
+			_compared_samples++;
+		}
+
+		return updated;
+	}
+
+	std::shared_ptr<Ekf> _ekf;
+	SensorSimulator _sensor_simulator;
+	EkfWrapper _ekf_wrapper;
+
+	EKF2ImuPreprocessor _imu_preprocessor{};
+	EKF2DecoupledOutputPredictor _output_predictor{};
+	unsigned _generation{0};
+
+	unsigned _reset_samples{0};
+	unsigned _compared_samples{0};
+	float _max_angle_error{0.f};
+	float _max_vel_error{0.f};
+	float _max_pos_error{0.f};
+};
+
+TEST_F(EKF2DecoupledOutputPredictorTest, matchesEkfOutputPredictor)
+{
+	// WHEN: replaying alignment, takeoff and flight with GPS
+	_sensor_simulator.runReplaySeconds(34.f);
+
+	// THEN: the EKF state resets happened during the replay
+	const OutputPredictor::ResetTotals &resets = _ekf->output_predictor().getResetTotals();
+	EXPECT_GT(resets.quat_counter, 0u);
+	EXPECT_GT(resets.posNE_counter, 0u);
+	EXPECT_GT(_reset_samples, 0u);
+
+	// AND: the decoupled output predictor, corrected one EKF update later, tracks the EKF output predictor
+	// on every other IMU sample
+	EXPECT_GT(_compared_samples, 5000u);
+	EXPECT_LT(_max_angle_error, 1e-3f);
+	EXPECT_LT(_max_vel_error, 0.01f);
+	EXPECT_LT(_max_pos_error, 0.02f);
+}
@@ -0,0 +1,191 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * Test the lock-free single producer, single consumer handoff of the output predictor
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+#include "EKF2TripleBuffer.hpp"
+
+// each field written separately so that a torn read shows as differing fields
+struct Counters {
+	uint32_t value[16];
+
+	void set(uint32_t v)
+	{
+		for (auto &field : value) {
+			field = v;
+		}
+	}
+
+	bool consistent() const
+	{
+		for (const auto &field : value) {
+			if (field != value[0]) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+TEST(TripleBufferTest, nothingBeforeFirstPublish)
+{
+	TripleBuffer<Counters> buffer{};
+
+	EXPECT_FALSE(buffer.update());
+}
+
+TEST(TripleBufferTest, eachPublishReadOnce)
+{
+	TripleBuffer<Counters> buffer{};
+
+	for (uint32_t i = 1; i <= 10; i++) {
+		buffer.back().set(i);
+		buffer.publish();
+
+		ASSERT_TRUE(buffer.update());
+		EXPECT_EQ(buffer.front().value[0], i);
+
+		// THEN: the same value is not delivered twice, but stays readable
+		EXPECT_FALSE(buffer.update());
+		EXPECT_EQ(buffer.front().value[0], i);
+	}
+}
+
+TEST(TripleBufferTest, latestPublishWins)
+{
+	TripleBuffer<Counters> buffer{};
+
+	// WHEN: several values are published before the consumer reads
+	for (uint32_t i = 1; i <= 5; i++) {
+		buffer.back().set(i);
+		buffer.publish();
+	}
+
+	// THEN: only the latest one is delivered
+	ASSERT_TRUE(buffer.update());
+	EXPECT_EQ(buffer.front().value[0], 5u);
+	EXPECT_FALSE(buffer.update());
+
+	// AND: the producer keeps writing to a slot the consumer does not read
+	buffer.back().set(6);
+	EXPECT_EQ(buffer.front().value[0], 5u);
+	EXPECT_FALSE(buffer.update());
+
+	buffer.publish();
+	ASSERT_TRUE(buffer.update());
+	EXPECT_EQ(buffer.front().value[0], 6u);
+}
+
+TEST(TripleBufferTest, concurrentWriterNoTornOrStaleReads)
+{
+	static constexpr uint32_t MIN_VALUES = 20000;
+	static constexpr uint32_t MIN_READS = 1000;
+
+	TripleBuffer<Counters> buffer{};
+	std::atomic<uint32_t> reads{0};
+	std::atomic<uint32_t> last_published{0};
+	std::atomic<bool> finished{false};
+
+	// the writer keeps going until the reader has read enough values while it was writing,
+	// and yields half way through every value to let the reader in while a slot is half written
+	std::thread writer([&]() {
+		uint32_t value = 0;
+
+		while ((value < MIN_VALUES) || (reads.load() < MIN_READS)) {
+			value++;
+
+			Counters &counters = buffer.back();
+
+			for (int i = 0; i < 8; i++) {
+				counters.value[i] = value;
+			}
+
+			std::this_thread::yield();
+
+			for (int i = 8; i < 16; i++) {
+				counters.value[i] = value;
+			}
+
+			buffer.publish();
+		}
+
+		last_published.store(value);
+		finished.store(true);
+	});
+
+	uint32_t last = 0;
+	uint32_t failures = 0;
+
+	for (;;) {
+		// nothing can be published after the writer finished, read until there is nothing left
+		const bool writer_finished = finished.load();
+
+		if (buffer.update()) {
+			const Counters &counters = buffer.front();
+
+			// THEN: every value read is complete and newer than the previous one
+			if (!counters.consistent() || (counters.value[0] <= last)) {
+				failures++;
+			}
+
+			last = counters.value[0];
+			reads++;
+
+		} else if (writer_finished) {
+			break;
+
+		} else {
+			std::this_thread::yield();
+		}
+
+		// AND: reading the same value again while the writer continues does not change it
+		if (!buffer.front().consistent() || (buffer.front().value[0] != last)) {
+			failures++;
+		}
+	}
+
+	writer.join();
+
+	EXPECT_EQ(failures, 0u);
+	EXPECT_GE(reads.load(), MIN_READS);
+
+	// AND: the last value published is not lost
+	EXPECT_EQ(last, last_published.load());
+}
@@ -0,0 +1,106 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 ECL Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * Test the EKF-GSF yaw estimator bank with different numbers of models
+ */
+
+#include <gtest/gtest.h>
+#include <math.h>
+#include "EKF/EKFGSF_yaw_impl.h"
+
+// the EKF library only instantiates N_MODELS_EKFGSF
+template class EKFGSF_yaw<3>;
+template class EKFGSF_yaw<7>;
+
+template <typename T>
+class EKFGSFYawTest : public ::testing::Test
+{
+public:
+	// Level flight on a small circle with a constant heading, the horizontal acceleration makes the yaw observable.
+	// The acceleration rotates faster than the AHRS tilt correction, which keeps the tilt (and yaw) error small.
+	// Returns the yaw error at the end of the run.
+	static float run(T &gsf, float yaw_true, float duration_s)
+	{
+		const float dt = 0.004f;
+		const float speed = 1.5f;
+		const float turn_rate = 2.f;
+		const Dcmf R_to_earth{Eulerf{0.f, 0.f, yaw_true}};
+
+		imuSample imu{};
+		imu.delta_ang_dt = dt;
+		imu.delta_vel_dt = dt;
+
+		for (int i = 0; i * dt < duration_s; i++) {
+			const float t = i * dt;
+			const Vector3f vel_earth{-speed * sinf(turn_rate * t), speed * cosf(turn_rate * t), 0.f};
+			const Vector3f accel_earth{-speed * turn_rate * cosf(turn_rate * t), -speed * turn_rate * sinf(turn_rate * t), 0.f};
+			const Vector3f specific_force_earth = accel_earth - Vector3f{0.f, 0.f, CONSTANTS_ONE_G};
+
+			imu.time_us = i * 4000;
+			imu.delta_vel = R_to_earth.transpose() * specific_force_earth * dt;
+
+			// 5 Hz velocity measurements
+			if (i % 50 == 0) {
+				gsf.setVelocity(Vector2f{vel_earth(0), vel_earth(1)}, 0.5f);
+			}
+
+			gsf.update(imu, true, 0.f, Vector3f{});
+		}
+
+		return wrap_pi(gsf.getYaw() - yaw_true);
+	}
+};
+
+typedef ::testing::Types<EKFGSF_yaw<3>, EKFGSF_yaw<N_MODELS_EKFGSF>, EKFGSF_yaw<7>> ModelCounts;
+TYPED_TEST_SUITE(EKFGSFYawTest, ModelCounts);
+
+TYPED_TEST(EKFGSFYawTest, inactiveBeforeVelocity)
+{
+	TypeParam gsf{};
+	EXPECT_FALSE(gsf.isActive());
+	EXPECT_FLOAT_EQ(gsf.getYaw(), 0.f);
+}
+
+TYPED_TEST(EKFGSFYawTest, convergence)
+{
+	for (float yaw_true : {-2.5f, 0.3f, 2.f}) {
+		TypeParam gsf{};
+		const float yaw_error = TestFixture::run(gsf, yaw_true, 30.f);
+
+		EXPECT_TRUE(gsf.isActive());
+		EXPECT_LT(fabsf(yaw_error), 0.15f) << "yaw " << yaw_true;
+		EXPECT_LT(gsf.getYawVar(), 0.2f * 0.2f) << "yaw " << yaw_true;
+	}
+}
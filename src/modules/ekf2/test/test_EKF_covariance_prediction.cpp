@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * Compares the covariance prediction kernel for inhibited delta velocity bias states with the full kernel
+ */
+
+#include <gtest/gtest.h>
+#include <math.h>
+#include <memory>
+#include "EKF/ekf.h"
+#include "sensor_simulator/sensor_simulator.h"
+#include "sensor_simulator/ekf_wrapper.h"
+
+class EkfCovariancePredictionTest : public ::testing::Test
+{
+public:
+	EkfCovariancePredictionTest(): ::testing::Test(),
+		_ekf{std::make_shared<Ekf>()},
+		_sensor_simulator(_ekf),
+		_ekf_wrapper(_ekf) {};
+
+	void SetUp() override
+	{
+		_ekf->getParamHandle()->fusion_mode |= MASK_INHIBIT_ACC_BIAS;
+
+		_sensor_simulator.loadSensorDataFromFile(TEST_DATA_PATH"/replay_data/iris_gps.csv");
+		_sensor_simulator.startGps();
+		_ekf_wrapper.enableGpsFusion();
+	}
+
+	bool deltaVelBiasInhibited() const
+	{
+		return _ekf->_accel_bias_inhibit[0] && _ekf->_accel_bias_inhibit[1] && _ekf->_accel_bias_inhibit[2];
+	}
+
+	// both kernels from the current state, with IMU noise variances of the order of the default ones
+	void predict(Ekf::SymmetricMatrix24f &full, Ekf::SymmetricMatrix24f &inhibited) const
+	{
+		const float dt = _ekf->_dt_ekf_avg;
+		const Vector3f d_ang_var(sq(dt * 0.015f), sq(dt * 0.016f), sq(dt * 0.017f));
+		const Vector3f d_vel_var(sq(dt * 0.35f), sq(dt * 0.36f), sq(dt * 0.37f));
+
+		_ekf->predictCovarianceAllStates(dt, d_ang_var, d_vel_var, full);
+		_ekf->predictCovarianceDeltaVelBiasInhibited(dt, d_ang_var, d_vel_var, inhibited);
+	}
+
+	const Ekf::SymmetricMatrix24f &P() const { return _ekf->P; }
+
+	std::shared_ptr<Ekf> _ekf;
+	SensorSimulator _sensor_simulator;
+	EkfWrapper _ekf_wrapper;
+};
+
+#if !defined(CONSTRAINED_FLASH)
+TEST_F(EkfCovariancePredictionTest, inhibitedKernelMatchesFullKernel)
+{
+	// compare at 1 Hz over the whole replay: alignment, takeoff and flight
+	for (int i = 0; i < 34; i++) {
+		_sensor_simulator.runReplaySeconds(1.f);
+
+		// GIVEN: all delta velocity bias states inhibited
+		ASSERT_TRUE(deltaVelBiasInhibited());
+
+		// AND: their covariances with the other IMU states and with each other zeroed
+		for (int row = 0; row <= 15; row++) {
+			for (int col = 13; col <= 15; col++) {
+				if (row != col) {
+					EXPECT_EQ(P()(row, col), 0.f) << "P(" << row << ", " << col << ") at " << i << " s";
+				}
+			}
+		}
+
+		// WHEN: the covariance is predicted by both kernels from the same state
+		Ekf::SymmetricMatrix24f full;
+		Ekf::SymmetricMatrix24f inhibited;
+		predict(full, inhibited);
+
+		// THEN: the upper triangle matches, except for the rounding of the different expression trees
+		for (int row = 0; row < 24; row++) {
+			for (int col = row; col < 24; col++) {
+				const float expected = full(row, col);
+				const float tolerance = 1e-5f * fabsf(expected) + 1e-12f;
+				EXPECT_NEAR(inhibited(row, col), expected, tolerance) << "nextP(" << row << ", " << col << ") at " << i << " s";
+			}
+		}
+
+		// AND: both leave the rows and columns of the bias states unset within the IMU block
+		for (int row = 0; row <= 15; row++) {
+			for (int col = 13; col <= 15; col++) {
+				EXPECT_EQ(full(row, col), 0.f);
+				EXPECT_EQ(inhibited(row, col), 0.f);
+			}
+		}
+	}
+}
+#endif // !CONSTRAINED_FLASH
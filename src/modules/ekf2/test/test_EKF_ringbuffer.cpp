@@ -158,3 +158,90 @@ TEST_F(EkfRingBufferTest, reallocateBuffer)
 	EXPECT_EQ(3, _buffer->get_length());
 
 }
+
+TEST_F(EkfRingBufferTest, popNewestOlderSample)
+{
+	ASSERT_EQ(true, _buffer->allocate(5));
+	_buffer->push(_x);
+	_buffer->push(_y);
+	_buffer->push(_z);
+
+	// GIVEN: buffer with samples 1 s apart
+	sample pop = {};
+
+	// WHEN: asking for a time between two samples, the older one is more than 0.1 s old
+	// THEN: no sample should be returned and nothing removed
+	EXPECT_EQ(false, _buffer->pop_first_older_than(_y.time_us + 500000, &pop));
+	EXPECT_EQ(3, _buffer->entries());
+
+	// WHEN: asking for a time just after the middle sample
+	// THEN: the middle sample is returned and the older sample dropped
+	EXPECT_EQ(true, _buffer->pop_first_older_than(_y.time_us + 50000, &pop));
+	EXPECT_EQ(_y.time_us, pop.time_us);
+	EXPECT_EQ(_z.time_us, _buffer->get_oldest().time_us);
+
+	// WHEN: asking again for the same time
+	// THEN: nothing should be returned as the remaining sample is newer
+	EXPECT_EQ(false, _buffer->pop_first_older_than(_y.time_us + 50000, &pop));
+	EXPECT_EQ(true, _buffer->pop_first_older_than(_z.time_us, &pop));
+	EXPECT_EQ(_z.time_us, pop.time_us);
+
+	// THEN: the buffer is empty
+	EXPECT_EQ(false, _buffer->pop_first_older_than(_z.time_us, &pop));
+}
+
+TEST_F(EkfRingBufferTest, popAfterWrapAround)
+{
+	ASSERT_EQ(true, _buffer->allocate(4));
+
+	// GIVEN: a buffer that has been overwritten several times
+	sample s = {};
+
+	for (int i = 1; i <= 10; i++) {
+		s.time_us = i * 10000;
+		_buffer->push(s);
+	}
+
+	// THEN: only the newest samples are kept and they can be popped at any position
+	sample pop = {};
+	EXPECT_EQ(false, _buffer->pop_first_older_than(65000, &pop));
+	EXPECT_EQ(true, _buffer->pop_first_older_than(85000, &pop));
+	EXPECT_EQ(80000u, pop.time_us);
+	EXPECT_EQ(90000u, _buffer->get_oldest().time_us);
+
+	for (int i = 11; i <= 13; i++) {
+		s.time_us = i * 10000;
+		_buffer->push(s);
+	}
+
+	EXPECT_EQ(true, _buffer->pop_first_older_than(120000, &pop));
+	EXPECT_EQ(120000u, pop.time_us);
+	EXPECT_EQ(true, _buffer->pop_first_older_than(200000, &pop));
+	EXPECT_EQ(130000u, pop.time_us);
+}
+
+TEST(EkfRingBufferStaticTest, compileTimeCapacity)
+{
+	// GIVEN: a buffer with static storage
+	RingBuffer<sample, 6> buffer;
+	EXPECT_EQ(6, buffer.get_length());
+
+	// THEN: it can be resized up to its capacity
+	EXPECT_EQ(true, buffer.allocate(4));
+	EXPECT_EQ(4, buffer.get_length());
+	EXPECT_EQ(false, buffer.allocate(7));
+	EXPECT_EQ(4, buffer.get_length());
+
+	sample s = {};
+
+	for (int i = 1; i <= 5; i++) {
+		s.time_us = i * 10000;
+		buffer.push(s);
+	}
+
+	sample pop = {};
+	EXPECT_EQ(20000u, buffer.get_oldest().time_us);
+	EXPECT_EQ(true, buffer.pop_first_older_than(35000, &pop));
+	EXPECT_EQ(30000u, pop.time_us);
+	EXPECT_EQ(40000u, buffer.get_oldest().time_us);
+}
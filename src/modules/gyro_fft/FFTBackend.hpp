@@ -0,0 +1,132 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file FFTBackend.hpp
+ *
+ * Selects the FFT implementation used by GyroFFT. Every backend computes the
+ * Hanning windowed real FFT of an int16 gyro buffer and returns the first
+ * length/2 bins as interleaved float [real[0], imag[0], real[1], imag[1], ...].
+ * The spectrum buffer doubles as working memory of the transform. The absolute
+ * scaling of the spectrum is backend specific.
+ */
+
+#pragma once
+
+#include <math.h>
+
+#if defined(GYRO_FFT_BACKEND_FLOAT)
+# include "FFTBackendFloat.hpp"
+using FFTBackend = FFTBackendFloat;
+#else
+# include "FFTBackendCMSIS.hpp"
+using FFTBackend = FFTBackendCMSIS;
+#endif
+
+namespace gyro_fft
+{
+
+// helper function used for frequency estimation
+static inline float tau(float x)
+{
+	// tau(x) = 1/4 * log(3x^2 + 6x + 1) – sqrt(6)/24 * log((x + 1 – sqrt(2/3))  /  (x + 1 + sqrt(2/3)))
+	float p1 = logf(3.f * powf(x, 2.f) + 6.f * x + 1.f);
+	float part1 = x + 1.f - sqrtf(2.f / 3.f);
+	float part2 = x + 1.f + sqrtf(2.f / 3.f);
+	float p2 = logf(part1 / part2);
+	return (0.25f * p1 - sqrtf(6.f) / 24.f * p2);
+}
+
+/**
+ * Interpolated peak location (in bins) around bin_index of an interleaved complex spectrum.
+ * bin_index - 1 and bin_index + 1 must be valid bins.
+ */
+static inline float EstimatePeakFrequencyBin(const float spectrum[], int bin_index)
+{
+	if (bin_index >= 1) {
+		// find peak location using Quinn's Second Estimator (2020-06-14: http://dspguru.com/dsp/howtos/how-to-interpolate-fft-peak/)
+		const int peak_index = 2 * bin_index;
+		float real[3] { spectrum[peak_index - 2],     spectrum[peak_index],     spectrum[peak_index + 2]     };
+		float imag[3] { spectrum[peak_index - 2 + 1], spectrum[peak_index + 1], spectrum[peak_index + 2 + 1] };
+
+		static constexpr int k = 1;
+
+		const float divider = (real[k] * real[k] + imag[k] * imag[k]);
+
+		// ap = (X[k + 1].r * X[k].r + X[k+1].i * X[k].i) / (X[k].r * X[k].r + X[k].i * X[k].i)
+		float ap = (real[k + 1] * real[k] + imag[k + 1] * imag[k]) / divider;
+
+		// dp = -ap / (1 – ap)
+		float dp = -ap  / (1.f - ap);
+
+		// am = (X[k - 1].r * X[k].r + X[k – 1].i * X[k].i) / (X[k].r * X[k].r + X[k].i * X[k].i)
+		float am = (real[k - 1] * real[k] + imag[k - 1] * imag[k]) / divider;
+
+		// dm = am / (1 – am)
+		float dm = am / (1.f - am);
+
+		// d = (dp + dm) / 2 + tau(dp * dp) – tau(dm * dm)
+		float d = (dp + dm) / 2.f + tau(dp * dp) - tau(dm * dm);
+
+		// k’ = k + d
+		return bin_index + d;
+	}
+
+	return NAN;
+}
+
+/**
+ * Interpolated peak location (in bins) around bin_index of a power spectrum without phase, e.g. a Welch average.
+ * bin_index - 1 and bin_index + 1 must be valid bins.
+ */
+static inline float EstimatePeakFrequencyBinPower(const float power[], int bin_index)
+{
+	if (bin_index >= 1) {
+		// three point interpolation on the magnitudes for the Hanning window main lobe (error below 0.001 bins)
+		// d = 2 (|X[k + 1]| - |X[k - 1]|) / (|X[k - 1]| + 2 |X[k]| + |X[k + 1]|)
+		const float magnitude_m = sqrtf(power[bin_index - 1]);
+		const float magnitude_k = sqrtf(power[bin_index]);
+		const float magnitude_p = sqrtf(power[bin_index + 1]);
+
+		const float divider = magnitude_m + 2.f * magnitude_k + magnitude_p;
+
+		if (divider > 0.f) {
+			return bin_index + 2.f * (magnitude_p - magnitude_m) / divider;
+		}
+	}
+
+	return NAN;
+}
+
+} // namespace gyro_fft
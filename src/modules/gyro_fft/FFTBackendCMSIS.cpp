@@ -0,0 +1,166 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "FFTBackendCMSIS.hpp"
+
+#include <math.h>
+#include <px4_platform_common/defines.h>
+
+#include "arm_const_structs.h"
+
+FFTBackendCMSIS::~FFTBackendCMSIS()
+{
+	free();
+}
+
+void FFTBackendCMSIS::free()
+{
+	delete[] _hanning_window;
+	delete[] _fft_input_buffer;
+
+	_hanning_window = nullptr;
+	_fft_input_buffer = nullptr;
+
+	_length = 0;
+}
+
+bool FFTBackendCMSIS::supported(int length)
+{
+	switch (length) {
+	case 256:
+	case 512:
+	case 1024:
+	case 4096:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+bool FFTBackendCMSIS::init(int length)
+{
+	free();
+
+	// arm_rfft_init_q15(&_rfft_q15, length, 0, 1) manually inlined to save flash
+	_rfft_q15.pTwiddleAReal = (q15_t *) realCoefAQ15;
+	_rfft_q15.pTwiddleBReal = (q15_t *) realCoefBQ15;
+	_rfft_q15.ifftFlagR = 0;
+	_rfft_q15.bitReverseFlagR = 1;
+
+	switch (length) {
+	// case 128:
+	// 	_rfft_q15.fftLenReal = 128;
+	// 	_rfft_q15.twidCoefRModifier = 64U;
+	// 	_rfft_q15.pCfft = &arm_cfft_sR_q15_len64;
+	// 	break;
+
+	case 256:
+		_rfft_q15.fftLenReal = 256;
+		_rfft_q15.twidCoefRModifier = 32U;
+		_rfft_q15.pCfft = &arm_cfft_sR_q15_len128;
+		break;
+
+	case 512:
+		_rfft_q15.fftLenReal = 512;
+		_rfft_q15.twidCoefRModifier = 16U;
+		_rfft_q15.pCfft = &arm_cfft_sR_q15_len256;
+		break;
+
+	case 1024:
+		_rfft_q15.fftLenReal = 1024;
+		_rfft_q15.twidCoefRModifier = 8U;
+		_rfft_q15.pCfft = &arm_cfft_sR_q15_len512;
+		break;
+
+	// case 2048:
+	// 	_rfft_q15.fftLenReal = 2048;
+	// 	_rfft_q15.twidCoefRModifier = 4U;
+	// 	_rfft_q15.pCfft = &arm_cfft_sR_q15_len1024;
+	// 	break;
+
+	case 4096:
+		_rfft_q15.fftLenReal = 4096;
+		_rfft_q15.twidCoefRModifier = 2U;
+		_rfft_q15.pCfft = &arm_cfft_sR_q15_len2048;
+		break;
+
+	// case 8192:
+	// 	_rfft_q15.fftLenReal = 8192;
+	// 	_rfft_q15.twidCoefRModifier = 1U;
+	// 	_rfft_q15.pCfft = &arm_cfft_sR_q15_len4096;
+	// 	break;
+
+	default:
+		return false;
+	}
+
+	_hanning_window = new q15_t[length];
+	_fft_input_buffer = new q15_t[length];
+
+	if (!_hanning_window || !_fft_input_buffer) {
+		free();
+		return false;
+	}
+
+	_length = length;
+
+	// init Hanning window
+	for (int n = 0; n < _length; n++) {
+		const float hanning_value = 0.5f * (1.f - cosf(2.f * M_PI_F * n / (_length - 1)));
+		arm_float_to_q15(&hanning_value, &_hanning_window[n], 1);
+	}
+
+	return true;
+}
+
+void FFTBackendCMSIS::transform(const int16_t input[], float spectrum[])
+{
+	for (int n = 0; n < _length; n++) {
+		// convert int16_t -> q15_t (scaling isn't relevant)
+		_fft_input_buffer[n] = input[n] / 2;
+	}
+
+	arm_mult_q15(_fft_input_buffer, _hanning_window, _fft_input_buffer, _length);
+
+	// the q15 output (length * 2 values) fits into the spectrum buffer
+	q15_t *fft_output_buffer = reinterpret_cast<q15_t *>(spectrum);
+	arm_rfft_q15(&_rfft_q15, _fft_input_buffer, fft_output_buffer);
+
+	// first length/2 complex bins, converted in place from the back: float n overwrites q15 values 2n and 2n + 1,
+	// which are not needed anymore
+	for (int n = _length - 1; n >= 0; n--) {
+		spectrum[n] = fft_output_buffer[n];
+	}
+}
@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file FFTBackendCMSIS.hpp
+ *
+ * Fixed point (q15) real FFT using CMSIS-DSP, used on microcontrollers.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "arm_math.h"
+
+class FFTBackendCMSIS
+{
+public:
+	FFTBackendCMSIS() = default;
+	~FFTBackendCMSIS();
+
+	FFTBackendCMSIS(const FFTBackendCMSIS &) = delete;
+	FFTBackendCMSIS &operator=(const FFTBackendCMSIS &) = delete;
+
+	static const char *name() { return "CMSIS q15"; }
+
+	static bool supported(int length);
+
+	/**
+	 * Allocate buffers and initialize the window for the given FFT length.
+	 * @return false if the length isn't supported or allocation failed
+	 */
+	bool init(int length);
+
+	int length() const { return _length; }
+
+	/**
+	 * Windowed real FFT of length() samples.
+	 * @param input  length() raw int16 samples
+	 * @param spectrum  length() floats, length()/2 interleaved complex bins
+	 */
+	void transform(const int16_t input[], float spectrum[]);
+
+private:
+	void free();
+
+	arm_rfft_instance_q15 _rfft_q15{};
+
+	q15_t *_hanning_window{nullptr};
+	q15_t *_fft_input_buffer{nullptr};
+
+	int _length{0};
+};
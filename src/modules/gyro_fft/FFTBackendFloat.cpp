@@ -0,0 +1,395 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "FFTBackendFloat.hpp"
+
+#include <math.h>
+#include <px4_platform_common/defines.h>
+
+#if defined(__SSE__)
+# include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+namespace
+{
+
+// 4 wide float vector, SSE, NEON or plain C fallback (all loads/stores unaligned)
+#if defined(__SSE__)
+struct float4 {
+	__m128 v;
+};
+
+inline float4 load4(const float *p) { return {_mm_loadu_ps(p)}; }
+inline void store4(float *p, const float4 &a) { _mm_storeu_ps(p, a.v); }
+inline float4 set4(float x) { return {_mm_set1_ps(x)}; }
+inline float4 operator+(const float4 &a, const float4 &b) { return {_mm_add_ps(a.v, b.v)}; }
+inline float4 operator-(const float4 &a, const float4 &b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline float4 operator*(const float4 &a, const float4 &b) { return {_mm_mul_ps(a.v, b.v)}; }
+
+inline void transpose4(float4 &a, float4 &b, float4 &c, float4 &d)
+{
+	_MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+}
+
+#elif defined(__ARM_NEON)
+struct float4 {
+	float32x4_t v;
+};
+
+inline float4 load4(const float *p) { return {vld1q_f32(p)}; }
+inline void store4(float *p, const float4 &a) { vst1q_f32(p, a.v); }
+inline float4 set4(float x) { return {vdupq_n_f32(x)}; }
+inline float4 operator+(const float4 &a, const float4 &b) { return {vaddq_f32(a.v, b.v)}; }
+inline float4 operator-(const float4 &a, const float4 &b) { return {vsubq_f32(a.v, b.v)}; }
+inline float4 operator*(const float4 &a, const float4 &b) { return {vmulq_f32(a.v, b.v)}; }
+
+inline void transpose4(float4 &a, float4 &b, float4 &c, float4 &d)
+{
+	const float32x4x2_t ab = vtrnq_f32(a.v, b.v); // [a0 b0 a2 b2], [a1 b1 a3 b3]
+	const float32x4x2_t cd = vtrnq_f32(c.v, d.v); // [c0 d0 c2 d2], [c1 d1 c3 d3]
+	a.v = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+	b.v = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+	c.v = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+	d.v = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#else
+struct float4 {
+	float v[4];
+};
+
+inline float4 load4(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store4(float *p, const float4 &a) { for (int i = 0; i < 4; i++) { p[i] = a.v[i]; } }
+inline float4 set4(float x) { return {{x, x, x, x}}; }
+inline float4 operator+(const float4 &a, const float4 &b)
+{
+	return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+}
+
+inline float4 operator-(const float4 &a, const float4 &b)
+{
+	return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+}
+
+inline float4 operator*(const float4 &a, const float4 &b)
+{
+	return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+}
+
+inline void transpose4(float4 &a, float4 &b, float4 &c, float4 &d)
+{
+	const float4 a0 = a;
+	const float4 b0 = b;
+	const float4 c0 = c;
+	const float4 d0 = d;
+	a = {{a0.v[0], b0.v[0], c0.v[0], d0.v[0]}};
+	b = {{a0.v[1], b0.v[1], c0.v[1], d0.v[1]}};
+	c = {{a0.v[2], b0.v[2], c0.v[2], d0.v[2]}};
+	d = {{a0.v[3], b0.v[3], c0.v[3], d0.v[3]}};
+}
+#endif
+
+struct complex4 {
+	float4 re;
+	float4 im;
+};
+
+inline complex4 load(const float *re, const float *im, int i) { return {load4(&re[i]), load4(&im[i])}; }
+inline void store(float *re, float *im, int i, const complex4 &a) { store4(&re[i], a.re); store4(&im[i], a.im); }
+
+inline complex4 mul(const complex4 &a, const float4 &wr, const float4 &wi)
+{
+	return {a.re * wr - a.im * wi, a.re * wi + a.im * wr};
+}
+
+/**
+ * Radix-4 decimation in frequency butterfly, w = exp(-j 2 pi p / n)
+ *  y0 = (a + c) + (b + d)
+ *  y1 = ((a - c) - j (b - d)) * w
+ *  y2 = ((a + c) - (b + d)) * w^2
+ *  y3 = ((a - c) + j (b - d)) * w^3
+ */
+inline void butterfly4(const complex4 &a, const complex4 &b, const complex4 &c, const complex4 &d,
+		       const float4 w[6], complex4 &y0, complex4 &y1, complex4 &y2, complex4 &y3)
+{
+	const complex4 apc{a.re + c.re, a.im + c.im};
+	const complex4 amc{a.re - c.re, a.im - c.im};
+	const complex4 bpd{b.re + d.re, b.im + d.im};
+	const complex4 bmd{b.re - d.re, b.im - d.im};
+
+	y0 = {apc.re + bpd.re, apc.im + bpd.im};
+	y1 = mul({amc.re + bmd.im, amc.im - bmd.re}, w[0], w[1]);
+	y2 = mul({apc.re - bpd.re, apc.im - bpd.im}, w[2], w[3]);
+	y3 = mul({amc.re - bmd.im, amc.im + bmd.re}, w[4], w[5]);
+}
+
+} // namespace
+
+FFTBackendFloat::~FFTBackendFloat()
+{
+	free();
+}
+
+void FFTBackendFloat::free()
+{
+	delete[] _hanning_window;
+	delete[] _re;
+	delete[] _im;
+	delete[] _twiddles;
+	delete[] _split_cos;
+	delete[] _split_sin;
+
+	_hanning_window = nullptr;
+	_re = nullptr;
+	_im = nullptr;
+	_twiddles = nullptr;
+	_split_cos = nullptr;
+	_split_sin = nullptr;
+
+	_length = 0;
+}
+
+bool FFTBackendFloat::supported(int length)
+{
+	return (length >= 64) && (length <= 16384) && ((length & (length - 1)) == 0);
+}
+
+bool FFTBackendFloat::init(int length)
+{
+	free();
+
+	if (!supported(length)) {
+		return false;
+	}
+
+	const int M = length / 2; // complex FFT length
+
+	int twiddles_size = 0;
+	int passes = 0;
+	int stage_length = M;
+
+	for (; stage_length >= 4; stage_length /= 4) {
+		twiddles_size += 6 * (stage_length / 4);
+		passes++;
+	}
+
+	// final radix-2 stage for odd powers of two
+	if (stage_length == 2) {
+		passes++;
+	}
+
+	_hanning_window = new float[length];
+	_re = new float[M];
+	_im = new float[M];
+	_twiddles = new float[twiddles_size];
+	_split_cos = new float[M];
+	_split_sin = new float[M];
+
+	if (!_hanning_window || !_re || !_im || !_twiddles || !_split_cos || !_split_sin) {
+		free();
+		return false;
+	}
+
+	_length = length;
+	_odd_passes = (passes % 2) == 1;
+
+	// init Hanning window
+	for (int n = 0; n < _length; n++) {
+		_hanning_window[n] = 0.5f * (1.f - cosf(2.f * M_PI_F * n / (_length - 1)));
+	}
+
+	// radix-4 stage twiddles
+	float *tw = _twiddles;
+
+	for (int n = M; n >= 4; n /= 4) {
+		const int n1 = n / 4;
+
+		for (int p = 0; p < n1; p++) {
+			for (int k = 1; k <= 3; k++) {
+				const double theta = 2.0 * M_PI * k * p / n;
+				tw[(2 * k - 2) * n1 + p] = static_cast<float>(cos(theta));
+				tw[(2 * k - 1) * n1 + p] = static_cast<float>(-sin(theta));
+			}
+		}
+
+		tw += 6 * n1;
+	}
+
+	// real split twiddles
+	for (int k = 0; k < M; k++) {
+		const double theta = 2.0 * M_PI * k / _length;
+		_split_cos[k] = static_cast<float>(cos(theta));
+		_split_sin[k] = static_cast<float>(sin(theta));
+	}
+
+	return true;
+}
+
+void FFTBackendFloat::fft(float *x_re, float *x_im, float *y_re, float *y_im)
+{
+	const int M = _length / 2;
+
+	const float *tw = _twiddles;
+
+	int n = M;
+	int s = 1;
+
+	// radix-4 Stockham stages (self sorting, no bit reversal)
+	//  y[q + s (4p + k)] = butterfly(x[q + s (p + k n/4)]), p = 0 .. n/4 - 1, q = 0 .. s - 1
+	while (n >= 4) {
+		const int n1 = n / 4;
+
+		if (s == 1) {
+			// first stage: vectorize over p, the twiddles vary per lane
+			for (int p = 0; p < n1; p += 4) {
+				const float4 w[6] {
+					load4(&tw[0 * n1 + p]), load4(&tw[1 * n1 + p]),
+					load4(&tw[2 * n1 + p]), load4(&tw[3 * n1 + p]),
+					load4(&tw[4 * n1 + p]), load4(&tw[5 * n1 + p]),
+				};
+
+				complex4 y0, y1, y2, y3;
+				butterfly4(load(x_re, x_im, p), load(x_re, x_im, p + n1),
+					   load(x_re, x_im, p + 2 * n1), load(x_re, x_im, p + 3 * n1),
+					   w, y0, y1, y2, y3);
+
+				// [y0 y1 y2 y3] x 4 lanes -> y[4p .. 4p + 15]
+				transpose4(y0.re, y1.re, y2.re, y3.re);
+				transpose4(y0.im, y1.im, y2.im, y3.im);
+				store(y_re, y_im, 4 * p, y0);
+				store(y_re, y_im, 4 * p + 4, y1);
+				store(y_re, y_im, 4 * p + 8, y2);
+				store(y_re, y_im, 4 * p + 12, y3);
+			}
+
+		} else {
+			// later stages: vectorize over q, one twiddle per p
+			for (int p = 0; p < n1; p++) {
+				const float4 w[6] {
+					set4(tw[0 * n1 + p]), set4(tw[1 * n1 + p]),
+					set4(tw[2 * n1 + p]), set4(tw[3 * n1 + p]),
+					set4(tw[4 * n1 + p]), set4(tw[5 * n1 + p]),
+				};
+
+				for (int q = 0; q < s; q += 4) {
+					complex4 y0, y1, y2, y3;
+					butterfly4(load(x_re, x_im, q + s * p),
+						   load(x_re, x_im, q + s * (p + n1)),
+						   load(x_re, x_im, q + s * (p + 2 * n1)),
+						   load(x_re, x_im, q + s * (p + 3 * n1)),
+						   w, y0, y1, y2, y3);
+
+					store(y_re, y_im, q + s * (4 * p), y0);
+					store(y_re, y_im, q + s * (4 * p + 1), y1);
+					store(y_re, y_im, q + s * (4 * p + 2), y2);
+					store(y_re, y_im, q + s * (4 * p + 3), y3);
+				}
+			}
+		}
+
+		tw += 6 * n1;
+		n = n1;
+		s *= 4;
+
+		float *tmp_re = x_re;
+		float *tmp_im = x_im;
+		x_re = y_re;
+		x_im = y_im;
+		y_re = tmp_re;
+		y_im = tmp_im;
+	}
+
+	if (n == 2) {
+		// final radix-2 stage for odd powers of two (twiddle is 1)
+		for (int q = 0; q < s; q += 4) {
+			const complex4 a = load(x_re, x_im, q);
+			const complex4 b = load(x_re, x_im, q + s);
+			store(y_re, y_im, q, {a.re + b.re, a.im + b.im});
+			store(y_re, y_im, q + s, {a.re - b.re, a.im - b.im});
+		}
+	}
+}
+
+void FFTBackendFloat::transform(const int16_t input[], float spectrum[])
+{
+	const int M = _length / 2;
+
+	// the spectrum is only written by the split, until then it is the FFT work buffer
+	float *work_re = &spectrum[0];
+	float *work_im = &spectrum[M];
+
+	// pack windowed real samples as z[k] = x[2k] + j x[2k + 1], the passes alternate so that the result ends up in _re/_im
+	float *z_re = _odd_passes ? work_re : _re;
+	float *z_im = _odd_passes ? work_im : _im;
+
+	for (int k = 0; k < M; k++) {
+		z_re[k] = _hanning_window[2 * k] * input[2 * k];
+		z_im[k] = _hanning_window[2 * k + 1] * input[2 * k + 1];
+	}
+
+	if (_odd_passes) {
+		fft(work_re, work_im, _re, _im);
+
+	} else {
+		fft(_re, _im, work_re, work_im);
+	}
+
+	const float *Z_re = _re;
+	const float *Z_im = _im;
+
+	// split into the spectrum of the real sequence
+	//  Fe = (Z[k] + conj(Z[M - k])) / 2, Fo = (Z[k] - conj(Z[M - k])) / 2j
+	//  X[k] = Fe + exp(-j 2 pi k / N) Fo
+	for (int k = 0; k < M; k++) {
+		const int k_mirror = (k == 0) ? 0 : M - k;
+
+		const float ar = Z_re[k];
+		const float ai = Z_im[k];
+		const float br = Z_re[k_mirror];
+		const float bi = Z_im[k_mirror];
+
+		const float fe_re = 0.5f * (ar + br);
+		const float fe_im = 0.5f * (ai - bi);
+		const float fo_re = 0.5f * (ai + bi);
+		const float fo_im = -0.5f * (ar - br);
+
+		const float c = _split_cos[k];
+		const float s = _split_sin[k];
+
+		spectrum[2 * k]     = fe_re + c * fo_re + s * fo_im;
+		spectrum[2 * k + 1] = fe_im + c * fo_im - s * fo_re;
+	}
+}
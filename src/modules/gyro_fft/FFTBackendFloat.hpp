@@ -0,0 +1,100 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file FFTBackendFloat.hpp
+ *
+ * Single precision real FFT for application processors (POSIX). The real
+ * input is packed into a complex sequence of half the length, transformed with
+ * a radix-4 Stockham FFT (SSE/NEON vectorized where available) and split into
+ * the real spectrum afterwards. The spectrum output buffer doubles as the
+ * Stockham work buffer, so only the half length complex input is allocated.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class FFTBackendFloat
+{
+public:
+	FFTBackendFloat() = default;
+	~FFTBackendFloat();
+
+	FFTBackendFloat(const FFTBackendFloat &) = delete;
+	FFTBackendFloat &operator=(const FFTBackendFloat &) = delete;
+
+	static const char *name() { return "float32"; }
+
+	/** power of two between 64 and 16384 */
+	static bool supported(int length);
+
+	/**
+	 * Allocate buffers, twiddle tables and the window for the given FFT length.
+	 * @return false if the length isn't supported or allocation failed
+	 */
+	bool init(int length);
+
+	int length() const { return _length; }
+
+	/**
+	 * Windowed real FFT of length() samples.
+	 * @param input  length() raw int16 samples
+	 * @param spectrum  length() floats, length()/2 interleaved complex bins
+	 */
+	void transform(const int16_t input[], float spectrum[]);
+
+private:
+	void free();
+
+	/** complex FFT (length/2 points) ping-ponging between x and y, the result ends up in _re/_im */
+	void fft(float *x_re, float *x_im, float *y_re, float *y_im);
+
+	float *_hanning_window{nullptr};
+
+	// complex input and result (structure of arrays)
+	float *_re{nullptr};
+	float *_im{nullptr};
+
+	// per radix-4 stage twiddles [w1 re, w1 im, w2 re, w2 im, w3 re, w3 im] x n/4
+	float *_twiddles{nullptr};
+
+	// real split twiddles cos/sin(2 pi k / length), k = 0 .. length/2 - 1
+	float *_split_cos{nullptr};
+	float *_split_sin{nullptr};
+
+	int _length{0};
+
+	bool _odd_passes{false}; // odd number of FFT passes, the input is packed into the work buffer
+};
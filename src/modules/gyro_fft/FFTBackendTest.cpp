@@ -0,0 +1,264 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * Accuracy and CPU time of the gyro FFT backends on synthetic gyro data.
+ * Run this test only using make tests TESTFILTER=FFTBackend
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <px4_platform_common/defines.h>
+
+#include "FFTBackend.hpp"
+#include "FFTBackendCMSIS.hpp"
+#include "FFTBackendFloat.hpp"
+
+static constexpr float SAMPLE_RATE_HZ = 8000.f;
+static constexpr int MAX_LENGTH = 4096;
+
+// synthetic raw gyro: two motor noise peaks, a slow rotation and white noise, scaled like a 2000 dps gyro
+static void generate_gyro(int16_t data[], int length, float f1, float f2, unsigned seed)
+{
+	srand(seed);
+
+	for (int n = 0; n < length; n++) {
+		const float t = n / SAMPLE_RATE_HZ;
+		const float noise = (float)rand() / (float)RAND_MAX - 0.5f;
+		const float rate = 0.3f * sinf(2.f * M_PI_F * 2.f * t)
+				   + 0.05f * sinf(2.f * M_PI_F * f1 * t)
+				   + 0.02f * sinf(2.f * M_PI_F * f2 * t + 0.3f)
+				   + 0.01f * noise;
+		data[n] = (int16_t)roundf(rate * 1000.f); // rad/s -> raw
+	}
+}
+
+// largest bin within [fmin, fmax], refined with the Quinn estimator
+template<typename Backend>
+static float find_peak(Backend &backend, const int16_t data[], float fmin, float fmax)
+{
+	static float spectrum[MAX_LENGTH];
+	backend.transform(data, spectrum);
+
+	const int length = backend.length();
+	const float resolution_hz = SAMPLE_RATE_HZ / length;
+
+	float largest = 0.f;
+	int largest_index = 0;
+
+	for (int bin = 1; bin < length / 2 - 1; bin++) {
+		const float freq_hz = bin * resolution_hz;
+		const float real = spectrum[2 * bin];
+		const float imag = spectrum[2 * bin + 1];
+		const float magnitude = sqrtf(real * real + imag * imag);
+
+		if ((magnitude > largest) && (freq_hz >= fmin) && (freq_hz <= fmax)) {
+			largest = magnitude;
+			largest_index = bin;
+		}
+	}
+
+	return resolution_hz * gyro_fft::EstimatePeakFrequencyBin(spectrum, largest_index);
+}
+
+template<typename Backend>
+static double time_transform_us(Backend &backend, const int16_t data[])
+{
+	static float spectrum[MAX_LENGTH];
+	static constexpr int RUNS = 200;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < RUNS; i++) {
+		backend.transform(data, spectrum);
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::micro>(end - start).count() / RUNS;
+}
+
+TEST(FFTBackendTest, supportedLengths)
+{
+	EXPECT_FALSE(FFTBackendFloat::supported(0));
+	EXPECT_FALSE(FFTBackendFloat::supported(32));
+	EXPECT_FALSE(FFTBackendFloat::supported(1000));
+	EXPECT_TRUE(FFTBackendFloat::supported(64));
+	EXPECT_TRUE(FFTBackendFloat::supported(2048));
+	EXPECT_TRUE(FFTBackendFloat::supported(16384));
+
+	EXPECT_TRUE(FFTBackendCMSIS::supported(256));
+	EXPECT_FALSE(FFTBackendCMSIS::supported(2048));
+
+	FFTBackendFloat backend;
+	EXPECT_FALSE(backend.init(1000));
+	EXPECT_EQ(backend.length(), 0);
+	EXPECT_TRUE(backend.init(256));
+	EXPECT_EQ(backend.length(), 256);
+}
+
+TEST(FFTBackendTest, floatMatchesDFT)
+{
+	static int16_t data[MAX_LENGTH];
+	static float spectrum[MAX_LENGTH];
+
+	// even and odd powers of two exercise the final radix-2 stage
+	for (int length : {64, 128, 256, 512, 1024, 2048}) {
+		FFTBackendFloat backend;
+		ASSERT_TRUE(backend.init(length));
+
+		generate_gyro(data, length, 170.f, 333.f, length);
+		backend.transform(data, spectrum);
+
+		double max_magnitude = 0.0;
+		double max_error = 0.0;
+
+		for (int k = 0; k < length / 2; k++) {
+			double re = 0.0;
+			double im = 0.0;
+
+			for (int n = 0; n < length; n++) {
+				const double window = 0.5 * (1.0 - cos(2.0 * M_PI * n / (length - 1)));
+				const double theta = 2.0 * M_PI * k * n / length;
+				re += window * data[n] * cos(theta);
+				im -= window * data[n] * sin(theta);
+			}
+
+			max_magnitude = fmax(max_magnitude, sqrt(re * re + im * im));
+			max_error = fmax(max_error, fabs(re - (double)spectrum[2 * k]));
+			max_error = fmax(max_error, fabs(im - (double)spectrum[2 * k + 1]));
+		}
+
+		EXPECT_LT(max_error, 1e-5 * max_magnitude) << "length " << length;
+	}
+}
+
+TEST(FFTBackendTest, peakAccuracy)
+{
+	static int16_t data[MAX_LENGTH];
+
+	for (int length : {256, 512, 1024, 4096}) {
+		FFTBackendFloat backend_float;
+		FFTBackendCMSIS backend_cmsis;
+		ASSERT_TRUE(backend_float.init(length));
+		ASSERT_TRUE(backend_cmsis.init(length));
+
+		const float resolution_hz = SAMPLE_RATE_HZ / length;
+
+		float error_float = 0.f;
+		float error_cmsis = 0.f;
+		int count = 0;
+
+		for (float f1 = 100.f; f1 < 600.f; f1 += 37.3f) {
+			generate_gyro(data, length, f1, 2.f * f1, count);
+
+			error_float = fmaxf(error_float, fabsf(find_peak(backend_float, data, 50.f, 700.f) - f1));
+			error_cmsis = fmaxf(error_cmsis, fabsf(find_peak(backend_cmsis, data, 50.f, 700.f) - f1));
+			count++;
+		}
+
+		printf("length %4d (%6.2f Hz bins): max peak error float32 %.3f Hz, CMSIS q15 %.3f Hz\n",
+		       length, (double)resolution_hz, (double)error_float, (double)error_cmsis);
+
+		EXPECT_LT(error_float, 0.25f * resolution_hz) << "length " << length;
+		EXPECT_LT(error_cmsis, 0.5f * resolution_hz) << "length " << length;
+	}
+}
+
+TEST(FFTBackendTest, peakAccuracyWelch)
+{
+	static constexpr int WINDOWS = 4;
+	static int16_t data[MAX_LENGTH];
+	static float spectrum[MAX_LENGTH];
+	static float power_average[MAX_LENGTH / 2];
+
+	for (int length : {256, 512, 1024, 4096}) {
+		FFTBackendFloat backend;
+		ASSERT_TRUE(backend.init(length));
+
+		const float resolution_hz = SAMPLE_RATE_HZ / length;
+		float error = 0.f;
+
+		for (float f1 = 100.f; f1 < 600.f; f1 += 37.3f) {
+			// average the power spectra of windows with different noise
+			for (int window = 0; window < WINDOWS; window++) {
+				generate_gyro(data, length, f1, 2.f * f1, window);
+				backend.transform(data, spectrum);
+
+				for (int bin = 0; bin < length / 2; bin++) {
+					const float power = spectrum[2 * bin] * spectrum[2 * bin] + spectrum[2 * bin + 1] * spectrum[2 * bin + 1];
+					power_average[bin] = (window == 0) ? power : power_average[bin] + (power - power_average[bin]) / (window + 1);
+				}
+			}
+
+			float largest = 0.f;
+			int largest_index = 0;
+
+			for (int bin = 1; bin < length / 2 - 1; bin++) {
+				const float freq_hz = bin * resolution_hz;
+
+				if ((power_average[bin] > largest) && (freq_hz >= 50.f) && (freq_hz <= 700.f)) {
+					largest = power_average[bin];
+					largest_index = bin;
+				}
+			}
+
+			const float peak_hz = resolution_hz * gyro_fft::EstimatePeakFrequencyBinPower(power_average, largest_index);
+			error = fmaxf(error, fabsf(peak_hz - f1));
+		}
+
+		EXPECT_LT(error, 0.1f * resolution_hz) << "length " << length;
+	}
+}
+
+TEST(FFTBackendTest, benchmark)
+{
+	static int16_t data[MAX_LENGTH];
+	generate_gyro(data, MAX_LENGTH, 170.f, 333.f, 1);
+
+	printf("backend in use: %s\n", FFTBackend::name());
+
+	for (int length : {256, 512, 1024, 4096}) {
+		FFTBackendFloat backend_float;
+		FFTBackendCMSIS backend_cmsis;
+		ASSERT_TRUE(backend_float.init(length));
+		ASSERT_TRUE(backend_cmsis.init(length));
+
+		printf("length %4d: float32 %8.2f us, CMSIS q15 %8.2f us\n", length,
+		       time_transform_us(backend_float, data), time_transform_us(backend_cmsis, data));
+	}
+}
@@ -60,92 +60,68 @@ GyroFFT::~GyroFFT()
 	perf_free(_gyro_generation_gap_perf);
 	perf_free(_gyro_fifo_generation_gap_perf);
 
+	FreeBuffers();
+}
+
+bool GyroFFT::AllocateBuffers(int N, bool averaging)
+{
+	_gyro_data_buffer_x = new int16_t[N];
+	_gyro_data_buffer_y = new int16_t[N];
+	_gyro_data_buffer_z = new int16_t[N];
+	_fft_output_buffer = new float[N];
+	_peak_magnitudes_all = new float[N / 2];
+
+	if (averaging) {
+		_power_spectrum_average = new float[3 * N / 2];
+	}
+
+	return (_gyro_data_buffer_x && _gyro_data_buffer_y && _gyro_data_buffer_z
+		&& _fft_output_buffer
+		&& _peak_magnitudes_all
+		&& (_power_spectrum_average || !averaging));
+}
+
+void GyroFFT::FreeBuffers()
+{
 	delete[] _gyro_data_buffer_x;
 	delete[] _gyro_data_buffer_y;
 	delete[] _gyro_data_buffer_z;
-	delete[] _hanning_window;
-	delete[] _fft_input_buffer;
-	delete[] _fft_outupt_buffer;
+	delete[] _fft_output_buffer;
 	delete[] _peak_magnitudes_all;
+	delete[] _power_spectrum_average;
+
+	_gyro_data_buffer_x = nullptr;
+	_gyro_data_buffer_y = nullptr;
+	_gyro_data_buffer_z = nullptr;
+	_fft_output_buffer = nullptr;
+	_peak_magnitudes_all = nullptr;
+	_power_spectrum_average = nullptr;
+}
+
+void GyroFFT::ResetBuffers()
+{
+	for (int axis = 0; axis < 3; axis++) {
+		_fft_buffer_index[axis] = 0;
+		_power_spectrum_count[axis] = 0;
+	}
 }
 
 bool GyroFFT::init()
 {
-	bool buffers_allocated = false;
-
-	// arm_rfft_init_q15(&_rfft_q15, _imu_gyro_fft_len, 0, 1) manually inlined to save flash
-	_rfft_q15.pTwiddleAReal = (q15_t *) realCoefAQ15;
-	_rfft_q15.pTwiddleBReal = (q15_t *) realCoefBQ15;
-	_rfft_q15.ifftFlagR = 0;
-	_rfft_q15.bitReverseFlagR = 1;
-
-	switch (_param_imu_gyro_fft_len.get()) {
-	// case 128:
-	// 	buffers_allocated = AllocateBuffers<128>();
-	// 	_rfft_q15.fftLenReal = 128;
-	// 	_rfft_q15.twidCoefRModifier = 64U;
-	// 	_rfft_q15.pCfft = &arm_cfft_sR_q15_len64;
-	// 	break;
-
-	case 256:
-		buffers_allocated = AllocateBuffers<256>();
-		_rfft_q15.fftLenReal = 256;
-		_rfft_q15.twidCoefRModifier = 32U;
-		_rfft_q15.pCfft = &arm_cfft_sR_q15_len128;
-		break;
-
-	case 512:
-		buffers_allocated = AllocateBuffers<512>();
-		_rfft_q15.fftLenReal = 512;
-		_rfft_q15.twidCoefRModifier = 16U;
-		_rfft_q15.pCfft = &arm_cfft_sR_q15_len256;
-		break;
-
-	case 1024:
-		buffers_allocated = AllocateBuffers<1024>();
-		_rfft_q15.fftLenReal = 1024;
-		_rfft_q15.twidCoefRModifier = 8U;
-		_rfft_q15.pCfft = &arm_cfft_sR_q15_len512;
-		break;
-
-	// case 2048:
-	// 	buffers_allocated = AllocateBuffers<2048>();
-	// 	_rfft_q15.fftLenReal = 2048;
-	// 	_rfft_q15.twidCoefRModifier = 4U;
-	// 	_rfft_q15.pCfft = &arm_cfft_sR_q15_len1024;
-	// 	break;
-
-	case 4096:
-		buffers_allocated = AllocateBuffers<4096>();
-		_rfft_q15.fftLenReal = 4096;
-		_rfft_q15.twidCoefRModifier = 2U;
-		_rfft_q15.pCfft = &arm_cfft_sR_q15_len2048;
-		break;
-
-	// case 8192:
-	// 	buffers_allocated = AllocateBuffers<8192>();
-	// 	_rfft_q15.fftLenReal = 8192;
-	// 	_rfft_q15.twidCoefRModifier = 1U;
-	// 	_rfft_q15.pCfft = &arm_cfft_sR_q15_len4096;
-	// 	break;
-
-	default:
+	if (!FFTBackend::supported(_param_imu_gyro_fft_len.get())) {
 		// otherwise default to 256
 		PX4_ERR("Invalid IMU_GYRO_FFT_LEN=%" PRId32 ", resetting", _param_imu_gyro_fft_len.get());
-		buffers_allocated = AllocateBuffers<256>();
 		_param_imu_gyro_fft_len.set(256);
 		_param_imu_gyro_fft_len.commit();
-		break;
 	}
 
-	if (buffers_allocated) {
-		_imu_gyro_fft_len = _param_imu_gyro_fft_len.get();
+	_imu_gyro_fft_len = _param_imu_gyro_fft_len.get();
 
-		// init Hanning window
-		for (int n = 0; n < _imu_gyro_fft_len; n++) {
-			const float hanning_value = 0.5f * (1.f - cosf(2.f * M_PI_F * n / (_imu_gyro_fft_len - 1)));
-			arm_float_to_q15(&hanning_value, &_hanning_window[n], 1);
-		}
+	// hop between windows: 50%, 75% or 87.5% overlap
+	const int32_t overlap = math::constrain(_param_imu_gyro_fft_ovl.get(), (int32_t)0, (int32_t)2);
+	_imu_gyro_fft_hop = _imu_gyro_fft_len >> (overlap + 1);
+
+	if (AllocateBuffers(_imu_gyro_fft_len, _param_imu_gyro_fft_avg.get() > 1) && _fft.init(_imu_gyro_fft_len)) {
 
 		if (!SensorSelectionUpdate(true)) {
 			ScheduleDelayed(500_ms);
@@ -155,12 +131,7 @@ bool GyroFFT::init()
 	}
 
 	PX4_ERR("failed to allocate buffers");
-	delete[] _gyro_data_buffer_x;
-	delete[] _gyro_data_buffer_y;
-	delete[] _gyro_data_buffer_z;
-	delete[] _hanning_window;
-	delete[] _fft_input_buffer;
-	delete[] _fft_outupt_buffer;
+	FreeBuffers();
 
 	return false;
 }
@@ -255,50 +226,6 @@ void GyroFFT::VehicleIMUStatusUpdate(bool force)
 	}
 }
 
-// helper function used for frequency estimation
-static inline float tau(float x)
-{
-	// tau(x) = 1/4 * log(3x^2 + 6x + 1) – sqrt(6)/24 * log((x + 1 – sqrt(2/3))  /  (x + 1 + sqrt(2/3)))
-	float p1 = logf(3.f * powf(x, 2.f) + 6.f * x + 1.f);
-	float part1 = x + 1.f - sqrtf(2.f / 3.f);
-	float part2 = x + 1.f + sqrtf(2.f / 3.f);
-	float p2 = logf(part1 / part2);
-	return (0.25f * p1 - sqrtf(6.f) / 24.f * p2);
-}
-
-float GyroFFT::EstimatePeakFrequencyBin(q15_t fft[], int peak_index)
-{
-	if (peak_index >= 2) {
-		// find peak location using Quinn's Second Estimator (2020-06-14: http://dspguru.com/dsp/howtos/how-to-interpolate-fft-peak/)
-		float real[3] { (float)fft[peak_index - 2], (float)fft[peak_index], (float)fft[peak_index + 2]     };
-		float imag[3] { (float)fft[peak_index - 2 + 1], (float)fft[peak_index + 1], (float)fft[peak_index + 2 + 1] };
-
-		static constexpr int k = 1;
-
-		const float divider = (real[k] * real[k] + imag[k] * imag[k]);
-
-		// ap = (X[k + 1].r * X[k].r + X[k+1].i * X[k].i) / (X[k].r * X[k].r + X[k].i * X[k].i)
-		float ap = (real[k + 1] * real[k] + imag[k + 1] * imag[k]) / divider;
-
-		// dp = -ap / (1 – ap)
-		float dp = -ap  / (1.f - ap);
-
-		// am = (X[k - 1].r * X[k].r + X[k – 1].i * X[k].i) / (X[k].r * X[k].r + X[k].i * X[k].i)
-		float am = (real[k - 1] * real[k] + imag[k - 1] * imag[k]) / divider;
-
-		// dm = am / (1 – am)
-		float dm = am / (1.f - am);
-
-		// d = (dp + dm) / 2 + tau(dp * dp) – tau(dm * dm)
-		float d = (dp + dm) / 2.f + tau(dp * dp) - tau(dm * dm);
-
-		// k’ = k + d
-		return peak_index + 2.f * d;
-	}
-
-	return NAN;
-}
-
 void GyroFFT::Run()
 {
 	if (should_exit()) {
@@ -336,9 +263,7 @@ void GyroFFT::Run()
 		while (_sensor_gyro_fifo_sub.update(&sensor_gyro_fifo)) {
 			if (_sensor_gyro_fifo_sub.get_last_generation() != _gyro_last_generation + 1) {
 				// force reset if we've missed a sample
-				_fft_buffer_index[0] = 0;
-				_fft_buffer_index[1] = 0;
-				_fft_buffer_index[2] = 0;
+				ResetBuffers();
 
 				perf_count(_gyro_fifo_generation_gap_perf);
 			}
@@ -347,9 +272,7 @@ void GyroFFT::Run()
 
 			if (fabsf(sensor_gyro_fifo.scale - _fifo_last_scale) > FLT_EPSILON) {
 				// force reset if scale has changed
-				_fft_buffer_index[0] = 0;
-				_fft_buffer_index[1] = 0;
-				_fft_buffer_index[2] = 0;
+				ResetBuffers();
 
 				_fifo_last_scale = sensor_gyro_fifo.scale;
 			}
@@ -365,9 +288,7 @@ void GyroFFT::Run()
 		while (_sensor_gyro_sub.update(&sensor_gyro)) {
 			if (_sensor_gyro_sub.get_last_generation() != _gyro_last_generation + 1) {
 				// force reset if we've missed a sample
-				_fft_buffer_index[0] = 0;
-				_fft_buffer_index[1] = 0;
-				_fft_buffer_index[2] = 0;
+				ResetBuffers();
 
 				perf_count(_gyro_generation_gap_perf);
 			}
@@ -394,15 +315,14 @@ void GyroFFT::Run()
 
 void GyroFFT::Update(const hrt_abstime &timestamp_sample, int16_t *input[], uint8_t N)
 {
-	q15_t *gyro_data_buffer[] {_gyro_data_buffer_x, _gyro_data_buffer_y, _gyro_data_buffer_z};
+	int16_t *gyro_data_buffer[] {_gyro_data_buffer_x, _gyro_data_buffer_y, _gyro_data_buffer_z};
 
 	for (int axis = 0; axis < 3; axis++) {
 		int &buffer_index = _fft_buffer_index[axis];
 
 		for (int n = 0; n < N; n++) {
 			if (buffer_index < _imu_gyro_fft_len) {
-				// convert int16_t -> q15_t (scaling isn't relevant)
-				gyro_data_buffer[axis][buffer_index] = input[axis][n] / 2;
+				gyro_data_buffer[axis][buffer_index] = input[axis][n];
 				buffer_index++;
 			}
 
@@ -410,18 +330,18 @@ void GyroFFT::Update(const hrt_abstime &timestamp_sample, int16_t *input[], uint
 			if ((buffer_index >= _imu_gyro_fft_len) && !_fft_updated) {
 				perf_begin(_fft_perf);
 
-				arm_mult_q15(gyro_data_buffer[axis], _hanning_window, _fft_input_buffer, _imu_gyro_fft_len);
-				arm_rfft_q15(&_rfft_q15, _fft_input_buffer, _fft_outupt_buffer);
+				_fft.transform(gyro_data_buffer[axis], _fft_output_buffer);
 
 				_fft_updated = true;
 
-				FindPeaks(timestamp_sample, axis, _fft_outupt_buffer);
+				FindPeaks(timestamp_sample, axis, _fft_output_buffer);
 
 				// reset
-				// shift buffer (3/4 overlap)
-				const int overlap_start = _imu_gyro_fft_len / 4;
-				memmove(&gyro_data_buffer[axis][0], &gyro_data_buffer[axis][overlap_start], sizeof(q15_t) * overlap_start * 3);
-				buffer_index = overlap_start * 3;
+				// shift buffer (overlap)
+				const int overlap_length = _imu_gyro_fft_len - _imu_gyro_fft_hop;
+				memmove(&gyro_data_buffer[axis][0], &gyro_data_buffer[axis][_imu_gyro_fft_hop],
+					sizeof(gyro_data_buffer[axis][0]) * overlap_length);
+				buffer_index = overlap_length;
 
 				perf_end(_fft_perf);
 			}
@@ -429,22 +349,56 @@ void GyroFFT::Update(const hrt_abstime &timestamp_sample, int16_t *input[], uint
 	}
 }
 
-void GyroFFT::FindPeaks(const hrt_abstime &timestamp_sample, int axis, q15_t *fft_outupt_buffer)
+void GyroFFT::FindPeaks(const hrt_abstime &timestamp_sample, int axis, const float *spectrum)
 {
 	const float resolution_hz = _gyro_sample_rate_hz / _imu_gyro_fft_len;
 
+	// number of usable bins, the last one is skipped so that every peak has a right neighbour for the estimator
+	const int num_bins = _imu_gyro_fft_len / 2 - 1;
+
+	// Welch averaging of the power spectra: cumulative average over the first
+	// IMU_GYRO_FFT_AVG windows, exponential moving average afterwards
+	float *power_average = nullptr;
+	float alpha = 1.f;
+
+	if (_power_spectrum_average) {
+		power_average = &_power_spectrum_average[axis * _imu_gyro_fft_len / 2];
+
+		if (_power_spectrum_count[axis] < _param_imu_gyro_fft_avg.get()) {
+			_power_spectrum_count[axis]++;
+		}
+
+		alpha = 1.f / _power_spectrum_count[axis];
+	}
+
 	// sum total energy across all used buckets for SNR
 	float bin_mag_sum = 0;
 
 	// FFT output buffer is ordered [real[0], imag[0], real[1], imag[1], real[2], imag[2] ... real[(N/2)-1], imag[(N/2)-1]
-	for (uint16_t fft_index = 2; fft_index < _imu_gyro_fft_len; fft_index += 2) {
+	// the average also covers the last bin, it is the right neighbour for the peak estimator
+	for (int bin_index = 1; bin_index <= num_bins; bin_index++) {
+
+		const float real = spectrum[2 * bin_index];
+		const float imag = spectrum[2 * bin_index + 1];
+
+		float power = real * real + imag * imag;
 
-		const float real = fft_outupt_buffer[fft_index];
-		const float imag = fft_outupt_buffer[fft_index + 1];
+		if (power_average) {
+			if (_power_spectrum_count[axis] > 1) {
+				power_average[bin_index] += alpha * (power - power_average[bin_index]);
 
-		const float fft_magnitude = sqrtf(real * real + imag * imag);
+			} else {
+				power_average[bin_index] = power;
+			}
+
+			power = power_average[bin_index];
+		}
+
+		if (bin_index == num_bins) {
+			break;
+		}
 
-		int bin_index = fft_index / 2;
+		const float fft_magnitude = sqrtf(power);
 
 		_peak_magnitudes_all[bin_index] = fft_magnitude;
 		bin_mag_sum += fft_magnitude;
@@ -460,7 +414,7 @@ void GyroFFT::FindPeaks(const hrt_abstime &timestamp_sample, int axis, q15_t *ff
 		float largest_peak = 0;
 		int largest_peak_index = 0;
 
-		for (int bin_index = 1; bin_index < _imu_gyro_fft_len; bin_index++) {
+		for (int bin_index = 1; bin_index < num_bins; bin_index++) {
 
 			const float freq_hz = bin_index * resolution_hz;
 
@@ -504,7 +458,10 @@ void GyroFFT::FindPeaks(const hrt_abstime &timestamp_sample, int axis, q15_t *ff
 	for (int peak_new = 0; peak_new < MAX_NUM_PEAKS; peak_new++) {
 		if (raw_peak_index[peak_new] > 0) {
 
-			const float adjusted_bin = 0.5f * EstimatePeakFrequencyBin(fft_outupt_buffer, 2 * raw_peak_index[peak_new]);
+			// with averaging the peak is interpolated on the averaged spectrum it was found in
+			const float adjusted_bin = power_average
+						   ? gyro_fft::EstimatePeakFrequencyBinPower(power_average, raw_peak_index[peak_new])
+						   : gyro_fft::EstimatePeakFrequencyBin(spectrum, raw_peak_index[peak_new]);
 
 			if (PX4_ISFINITE(adjusted_bin)) {
 				const float freq_adjusted = resolution_hz * adjusted_bin;
@@ -703,6 +660,8 @@ int GyroFFT::task_spawn(int argc, char *argv[])
 int GyroFFT::print_status()
 {
 	PX4_INFO("gyro sample rate: %.3f Hz", (double)_gyro_sample_rate_hz);
+	PX4_INFO("FFT backend: %s, length: %" PRId32 ", hop: %" PRId32 ", averaging: %" PRId32,
+		 FFTBackend::name(), _imu_gyro_fft_len, _imu_gyro_fft_hop, _param_imu_gyro_fft_avg.get());
 	perf_print_counter(_cycle_perf);
 	perf_print_counter(_cycle_interval_perf);
 	perf_print_counter(_fft_perf);
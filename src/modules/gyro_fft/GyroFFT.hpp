@@ -53,8 +53,7 @@
 #include <uORB/topics/sensor_selection.h>
 #include <uORB/topics/vehicle_imu_status.h>
 
-#include "arm_math.h"
-#include "arm_const_structs.h"
+#include "FFTBackend.hpp"
 
 using namespace time_literals;
 
@@ -85,8 +84,7 @@ private:
 			sensor_gyro_fft_s::peak_frequencies_x[0]);
 
 	void Run() override;
-	inline void FindPeaks(const hrt_abstime &timestamp_sample, int axis, q15_t *fft_outupt_buffer);
-	inline float EstimatePeakFrequencyBin(q15_t fft[], int peak_index);
+	inline void FindPeaks(const hrt_abstime &timestamp_sample, int axis, const float *spectrum);
 	inline void Publish();
 	bool SensorSelectionUpdate(bool force = false);
 	void Update(const hrt_abstime &timestamp_sample, int16_t *input[], uint8_t N);
@@ -94,23 +92,9 @@ private:
 				 float peak_snr[MAX_NUM_PEAKS], int num_peaks_found);
 	void VehicleIMUStatusUpdate(bool force = false);
 
-	template<size_t N>
-	bool AllocateBuffers()
-	{
-		_gyro_data_buffer_x = new q15_t[N];
-		_gyro_data_buffer_y = new q15_t[N];
-		_gyro_data_buffer_z = new q15_t[N];
-		_hanning_window = new q15_t[N];
-		_fft_input_buffer = new q15_t[N];
-		_fft_outupt_buffer = new q15_t[N * 2];
-
-		_peak_magnitudes_all = new float[N];
-
-		return (_gyro_data_buffer_x && _gyro_data_buffer_y && _gyro_data_buffer_z
-			&& _hanning_window
-			&& _fft_input_buffer
-			&& _fft_outupt_buffer);
-	}
+	bool AllocateBuffers(int N, bool averaging);
+	void FreeBuffers();
+	void ResetBuffers();
 
 	uORB::Publication<sensor_gyro_fft_s> _sensor_gyro_fft_pub{ORB_ID(sensor_gyro_fft)};
 
@@ -132,17 +116,19 @@ private:
 
 	bool _gyro_fifo{false};
 
-	arm_rfft_instance_q15 _rfft_q15;
+	FFTBackend _fft{};
 
-	q15_t *_gyro_data_buffer_x{nullptr};
-	q15_t *_gyro_data_buffer_y{nullptr};
-	q15_t *_gyro_data_buffer_z{nullptr};
-	q15_t *_hanning_window{nullptr};
-	q15_t *_fft_input_buffer{nullptr};
-	q15_t *_fft_outupt_buffer{nullptr};
+	int16_t *_gyro_data_buffer_x{nullptr};
+	int16_t *_gyro_data_buffer_y{nullptr};
+	int16_t *_gyro_data_buffer_z{nullptr};
+	float *_fft_output_buffer{nullptr};
 
 	float *_peak_magnitudes_all{nullptr};
 
+	// Welch averaged power spectrum per axis (only allocated if IMU_GYRO_FFT_AVG > 1)
+	float *_power_spectrum_average{nullptr};
+	int _power_spectrum_count[3] {};
+
 	float _gyro_sample_rate_hz{8000}; // 8 kHz default
 
 	float _fifo_last_scale{0};
@@ -158,6 +144,7 @@ private:
 	hrt_abstime _last_update[3][MAX_NUM_PEAKS] {};
 
 	int32_t _imu_gyro_fft_len{256};
+	int32_t _imu_gyro_fft_hop{64}; // samples between consecutive windows
 
 	bool _fft_updated{false};
 	bool _publish{false};
@@ -166,7 +153,9 @@ private:
 		(ParamInt<px4::params::IMU_GYRO_FFT_LEN>) _param_imu_gyro_fft_len,
 		(ParamFloat<px4::params::IMU_GYRO_FFT_MIN>) _param_imu_gyro_fft_min,
 		(ParamFloat<px4::params::IMU_GYRO_FFT_MAX>) _param_imu_gyro_fft_max,
-		(ParamFloat<px4::params::IMU_GYRO_FFT_SNR>) _param_imu_gyro_fft_snr
+		(ParamFloat<px4::params::IMU_GYRO_FFT_SNR>) _param_imu_gyro_fft_snr,
+		(ParamInt<px4::params::IMU_GYRO_FFT_OVL>) _param_imu_gyro_fft_ovl,
+		(ParamInt<px4::params::IMU_GYRO_FFT_AVG>) _param_imu_gyro_fft_avg
 	)
 };
 
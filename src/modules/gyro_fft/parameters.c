@@ -83,3 +83,32 @@ PARAM_DEFINE_INT32(IMU_GYRO_FFT_LEN, 512);
 * @group Sensors
 */
 PARAM_DEFINE_FLOAT(IMU_GYRO_FFT_SNR, 10.f);
+
+/**
+* IMU gyro FFT window overlap.
+*
+* Overlap between consecutive FFT windows. A larger overlap updates
+* the peak estimates more often at the cost of more FFTs per second.
+*
+* @value 0 50%
+* @value 1 75%
+* @value 2 87.5%
+* @reboot_required true
+* @group Sensors
+*/
+PARAM_DEFINE_INT32(IMU_GYRO_FFT_OVL, 1);
+
+/**
+* IMU gyro FFT spectrum averaging.
+*
+* Number of overlapping windows whose power spectra are averaged
+* (Welch's method) before searching for peaks. The peak frequencies are
+* interpolated on the averaged spectrum. Averaging lowers the noise floor
+* at the cost of a slower response. 1 disables averaging.
+*
+* @min 1
+* @max 8
+* @reboot_required true
+* @group Sensors
+*/
+PARAM_DEFINE_INT32(IMU_GYRO_FFT_AVG, 1);
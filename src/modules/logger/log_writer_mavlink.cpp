@@ -47,7 +47,6 @@ namespace logger
 
 LogWriterMavlink::LogWriterMavlink()
 {
-	_ulog_stream_data.length = 0;
 }
 
 bool LogWriterMavlink::init()
@@ -57,31 +56,28 @@ bool LogWriterMavlink::init()
 
 LogWriterMavlink::~LogWriterMavlink()
 {
-	if (_ulog_stream_ack_sub >= 0) {
-		orb_unsubscribe(_ulog_stream_ack_sub);
-	}
 }
 
 void LogWriterMavlink::start_log()
 {
-	if (_ulog_stream_ack_sub == -1) {
-		_ulog_stream_ack_sub = orb_subscribe(ORB_ID(ulog_stream_ack));
-	}
+	if (_buffer == nullptr) {
+		_buffer = ULogStreamBuffer::create();
 
-	// make sure we don't get any stale ack's by doing an orb_copy
-	ulog_stream_ack_s ack;
-	orb_copy(ORB_ID(ulog_stream_ack), _ulog_stream_ack_sub, &ack);
+		if (_buffer == nullptr) {
+			PX4_ERR("alloc failed");
+			return;
+		}
+	}
 
-	_ulog_stream_data.msg_sequence = 0;
-	_ulog_stream_data.length = 0;
-	_ulog_stream_data.first_message_offset = 0;
+	// drop any data of a previous log
+	_buffer->reset();
 
 	_is_started = true;
 }
 
 void LogWriterMavlink::stop_log()
 {
-	_ulog_stream_data.length = 0;
+	// the data committed so far is still sent by mavlink
 	_is_started = false;
 }
 
@@ -91,24 +87,28 @@ int LogWriterMavlink::write_message(void *ptr, size_t size)
 		return 0;
 	}
 
-	const uint8_t data_len = (uint8_t)sizeof(_ulog_stream_data.data);
+	const uint8_t data_len = (uint8_t)ULogStreamBuffer::DATA_LEN;
 	uint8_t *ptr_data = (uint8_t *)ptr;
 
-	if (_ulog_stream_data.first_message_offset == 255) {
-		_ulog_stream_data.first_message_offset = _ulog_stream_data.length;
+	ULogStreamBuffer::Chunk *chunk = &_buffer->write_chunk();
+
+	if (chunk->first_message_offset == ULogStreamBuffer::NO_MESSAGE_START) {
+		chunk->first_message_offset = chunk->length;
 	}
 
 	while (size > 0) {
-		size_t send_len = math::min((size_t)data_len - _ulog_stream_data.length, size);
-		memcpy(_ulog_stream_data.data + _ulog_stream_data.length, ptr_data, send_len);
-		_ulog_stream_data.length += send_len;
+		size_t send_len = math::min((size_t)data_len - chunk->length, size);
+		memcpy(chunk->data + chunk->length, ptr_data, send_len);
+		chunk->length += send_len;
 		ptr_data += send_len;
 		size -= send_len;
 
-		if (_ulog_stream_data.length >= data_len) {
+		if (chunk->length >= data_len) {
 			if (publish_message()) {
 				return -2;
 			}
+
+			chunk = &_buffer->write_chunk();
 		}
 	}
 
@@ -118,7 +118,7 @@ int LogWriterMavlink::write_message(void *ptr, size_t size)
 void LogWriterMavlink::set_need_reliable_transfer(bool need_reliable)
 {
 	if (!need_reliable && _need_reliable_transfer) {
-		if (_ulog_stream_data.length > 0) {
+		if (is_started() && _buffer->write_chunk().length > 0) {
 			// make sure to send previous data using reliable transfer
 			publish_message();
 		}
@@ -129,59 +129,33 @@ void LogWriterMavlink::set_need_reliable_transfer(bool need_reliable)
 
 int LogWriterMavlink::publish_message()
 {
-	_ulog_stream_data.timestamp = hrt_absolute_time();
-	_ulog_stream_data.flags = 0;
-
-	if (_need_reliable_transfer) {
-		_ulog_stream_data.flags = _ulog_stream_data.FLAGS_NEED_ACK;
+	if (_buffer->commit(_need_reliable_transfer)) {
+		return 0;
 	}
 
-	_ulog_stream_pub.publish(_ulog_stream_data);
-
-	if (_need_reliable_transfer) {
-		// we need to wait for an ack. Note that this blocks the main logger thread, so if a file logging
-		// is already running, it will miss samples.
-		px4_pollfd_struct_t fds[1];
-		fds[0].fd = _ulog_stream_ack_sub;
-		fds[0].events = POLLIN;
-		bool got_ack = false;
-		const int timeout_ms = ulog_stream_ack_s::ACK_TIMEOUT * ulog_stream_ack_s::ACK_MAX_TRIES;
-
-		hrt_abstime started = hrt_absolute_time();
-
-		do {
-			int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), timeout_ms);
-
-			if (ret <= 0) {
-				break;
-			}
-
-			if (fds[0].revents & POLLIN) {
-				ulog_stream_ack_s ack;
-				orb_copy(ORB_ID(ulog_stream_ack), _ulog_stream_ack_sub, &ack);
+	if (!_need_reliable_transfer) {
+		// mavlink cannot keep up, drop the data (the receiver detects the gap in the sequence)
+		_buffer->drop();
+		return 0;
+	}
 
-				if (ack.msg_sequence == _ulog_stream_data.msg_sequence) {
-					got_ack = true;
-				}
+	// wait until mavlink got the acks for enough chunks to free space. Note that this blocks
+	// the main logger thread, so if a file logging is already running, it will miss samples.
+	const hrt_abstime started = hrt_absolute_time();
+	const hrt_abstime timeout = ULogStreamBuffer::ACK_TIMEOUT_MS * ULogStreamBuffer::ACK_MAX_TRIES * 1000;
 
-			} else {
-				break;
-			}
-		} while (!got_ack && hrt_elapsed_time(&started) / 1000 < timeout_ms);
+	do {
+		px4_usleep(ULogStreamBuffer::ACK_TIMEOUT_MS * 1000 / 10);
 
-		if (!got_ack) {
-			PX4_ERR("Ack timeout. Stopping mavlink log");
-			stop_log();
-			return -2;
+		if (_buffer->commit(true)) {
+			PX4_DEBUG("waited %i ms for space", (int)(hrt_elapsed_time(&started) / 1000));
+			return 0;
 		}
+	} while (hrt_elapsed_time(&started) < timeout);
 
-		PX4_DEBUG("got ack in %i ms", (int)(hrt_elapsed_time(&started) / 1000));
-	}
-
-	_ulog_stream_data.msg_sequence++;
-	_ulog_stream_data.length = 0;
-	_ulog_stream_data.first_message_offset = 255;
-	return 0;
+	PX4_ERR("Ack timeout. Stopping mavlink log");
+	stop_log();
+	return -2;
 }
 
 }
@@ -34,9 +34,7 @@
 #pragma once
 
 #include <stdint.h>
-#include <uORB/Publication.hpp>
-#include <uORB/topics/ulog_stream.h>
-#include <uORB/topics/ulog_stream_ack.h>
+#include <lib/ulog_stream/ULogStreamBuffer.hpp>
 
 namespace px4
 {
@@ -45,7 +43,7 @@ namespace logger
 
 /**
  * @class LogWriterMavlink
- * Writes logging data to uORB, and then sent via mavlink
+ * Writes logging data into the ULogStreamBuffer, from where it is sent via mavlink
  */
 class LogWriterMavlink
 {
@@ -73,12 +71,10 @@ public:
 
 private:
 
-	/** publish message, wait for ack if needed & reset message */
+	/** pass the current chunk to mavlink, wait for space in the buffer if needed */
 	int publish_message();
 
-	ulog_stream_s _ulog_stream_data{};
-	uORB::Publication<ulog_stream_s> _ulog_stream_pub{ORB_ID(ulog_stream)};
-	int _ulog_stream_ack_sub{-1};
+	ULogStreamBuffer *_buffer{nullptr};
 	bool _need_reliable_transfer{false};
 	bool _is_started{false};
 };
@@ -0,0 +1,243 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "mavlink_rate_limiter.h"
+
+using Priority = MavlinkBandwidthShaper::Priority;
+
+static constexpr hrt_abstime loop_interval = 10 * 1000;
+
+TEST(MavlinkBandwidthShaper, PriorityUnderSaturation)
+{
+	MavlinkBandwidthShaper shaper;
+	shaper.set_rate(1000.f);
+
+	unsigned sent[MavlinkBandwidthShaper::PRIORITY_COUNT] {};
+	unsigned critical_attempts = 0;
+
+	// 10 s at 100 Hz, the LOW and NORMAL demand alone is 7 times the link rate
+	for (hrt_abstime t = 1; t <= 10 * 1000 * 1000; t += loop_interval) {
+		shaper.update(t);
+
+		if ((t / loop_interval) % 10 == 0) {
+			critical_attempts++;
+			EXPECT_TRUE(shaper.check(Priority::CRITICAL, 20));
+			shaper.consume(Priority::CRITICAL, 20);
+			sent[(int)Priority::CRITICAL] += 20;
+		}
+
+		if (shaper.check(Priority::NORMAL, 20)) {
+			shaper.consume(Priority::NORMAL, 20);
+			sent[(int)Priority::NORMAL] += 20;
+		}
+
+		if (shaper.check(Priority::LOW, 50)) {
+			shaper.consume(Priority::LOW, 50);
+			sent[(int)Priority::LOW] += 50;
+		}
+	}
+
+	EXPECT_EQ(sent[(int)Priority::CRITICAL], critical_attempts * 20);
+
+	// the total stays within the link rate (plus the initial bucket)
+	const unsigned total = sent[0] + sent[1] + sent[2] + sent[3];
+	EXPECT_LE(total, 10 * 1000 + shaper.get_bucket_size());
+	EXPECT_GE(total, 9 * 1000);
+
+	// NORMAL gets the bandwidth LOW is held back for
+	EXPECT_GT(sent[(int)Priority::NORMAL], sent[(int)Priority::LOW]);
+	EXPECT_GT(shaper.get_deferred_count(Priority::LOW), shaper.get_deferred_count(Priority::NORMAL));
+	EXPECT_EQ(shaper.get_deferred_count(Priority::CRITICAL), 0u);
+
+	// the held back classes are slowed down, LOW the most
+	EXPECT_FLOAT_EQ(shaper.get_class_mult(Priority::CRITICAL), 1.f);
+	EXPECT_LT(shaper.get_class_mult(Priority::NORMAL), 1.f);
+	EXPECT_LE(shaper.get_class_mult(Priority::LOW), shaper.get_class_mult(Priority::NORMAL));
+
+	// measured throughput
+	EXPECT_NEAR(shaper.get_class_rate(Priority::CRITICAL), 200.f, 40.f);
+}
+
+TEST(MavlinkBandwidthShaper, CriticalOverdraft)
+{
+	MavlinkBandwidthShaper shaper;
+	shaper.set_rate(1000.f);
+	shaper.update(1);
+
+	for (int i = 0; i < 100; i++) {
+		EXPECT_TRUE(shaper.check(Priority::CRITICAL, 100));
+		shaper.consume(Priority::CRITICAL, 100);
+	}
+
+	// overdrawn by at most one bucket
+	EXPECT_FLOAT_EQ(shaper.get_tokens(), -shaper.get_bucket_size());
+	EXPECT_TRUE(shaper.check(Priority::HIGH, 100));
+	EXPECT_FALSE(shaper.check(Priority::NORMAL, 10));
+	EXPECT_FALSE(shaper.check(Priority::LOW, 10));
+
+	// NORMAL resumes once the bucket is refilled above its reserve
+	shaper.update(1 + 2 * 1000 * 1000);
+	EXPECT_TRUE(shaper.check(Priority::NORMAL, 10));
+	EXPECT_TRUE(shaper.check(Priority::LOW, 10));
+}
+
+TEST(MavlinkBandwidthShaper, BulkIsLowest)
+{
+	MavlinkBandwidthShaper shaper;
+	shaper.set_rate(1000.f);
+	shaper.update(1);
+
+	// a full minimum size bucket fits one FTP message (254 + 12 bytes)
+	EXPECT_FLOAT_EQ(shaper.get_bucket_size(), MavlinkBandwidthShaper::MIN_BUCKET_SIZE);
+	EXPECT_TRUE(shaper.check(Priority::BULK, 266));
+
+	// between the BULK and the LOW reserve only BULK is held back
+	shaper.consume(Priority::NORMAL, 0.45f * shaper.get_bucket_size());
+	EXPECT_FALSE(shaper.check(Priority::BULK, 10));
+	EXPECT_TRUE(shaper.check(Priority::LOW, 10));
+	EXPECT_TRUE(shaper.check(Priority::NORMAL, 10));
+	EXPECT_EQ(shaper.get_deferred_count(Priority::BULK), 1u);
+	EXPECT_EQ(shaper.get_deferred_count(Priority::LOW), 0u);
+}
+
+TEST(MavlinkBandwidthShaper, BulkYieldsToStreams)
+{
+	MavlinkBandwidthShaper shaper;
+	shaper.set_rate(10000.f);
+
+	static constexpr unsigned normal_size = 60;	// 6000 B/s of telemetry at 100 Hz
+	static constexpr unsigned low_size = 20;	// 2000 B/s of high rate streams
+	static constexpr unsigned bulk_size = 267;	// a LOGGING_DATA message
+
+	unsigned normal_sent = 0;
+	unsigned low_sent = 0;
+	unsigned bulk_sent = 0;
+	unsigned loops = 0;
+
+	// 10 s at 100 Hz, ULog streaming sends as many chunks per loop as it is allowed to
+	for (hrt_abstime t = 1; t <= 10 * 1000 * 1000; t += loop_interval) {
+		shaper.update(t);
+		loops++;
+
+		if (shaper.check(Priority::NORMAL, normal_size)) {
+			shaper.consume(Priority::NORMAL, normal_size);
+			normal_sent += normal_size;
+		}
+
+		if (shaper.check(Priority::LOW, low_size)) {
+			shaper.consume(Priority::LOW, low_size);
+			low_sent += low_size;
+		}
+
+		for (int i = 0; (i < 10) && shaper.check(Priority::BULK, bulk_size); i++) {
+			shaper.consume(Priority::BULK, bulk_size);
+			bulk_sent += bulk_size;
+		}
+	}
+
+	// the streams are not held back by the bulk data
+	EXPECT_EQ(normal_sent, loops * normal_size);
+	EXPECT_EQ(low_sent, loops * low_size);
+	EXPECT_EQ(shaper.get_deferred_count(Priority::NORMAL), 0u);
+	EXPECT_EQ(shaper.get_deferred_count(Priority::LOW), 0u);
+
+	// the bulk data gets what is left of the link
+	EXPECT_GT(shaper.get_deferred_count(Priority::BULK), 0u);
+	EXPECT_LE(normal_sent + low_sent + bulk_sent, 10 * 10000 + shaper.get_bucket_size());
+	EXPECT_GE(bulk_sent, 10 * 10000 * 0.15f);
+}
+
+TEST(MavlinkBandwidthShaper, HeadroomAdaption)
+{
+	MavlinkBandwidthShaper shaper;
+	shaper.set_rate(1000.f);
+
+	hrt_abstime t = 1;
+	shaper.update(t);
+
+	// congested transmit path
+	for (int i = 0; i < 50; i++) {
+		t += MavlinkBandwidthShaper::ADAPT_INTERVAL;
+		shaper.set_headroom(0.1f);
+		shaper.update(t);
+	}
+
+	EXPECT_FLOAT_EQ(shaper.get_link_mult(), MavlinkBandwidthShaper::MIN_MULT);
+	EXPECT_FLOAT_EQ(shaper.get_rate(), 1000.f * MavlinkBandwidthShaper::MIN_MULT);
+
+	// a single low value within an adaption interval counts
+	t += MavlinkBandwidthShaper::ADAPT_INTERVAL;
+	shaper.set_headroom(0.3f);
+	shaper.set_headroom(0.9f);
+	shaper.update(t);
+	EXPECT_FLOAT_EQ(shaper.get_link_mult(), MavlinkBandwidthShaper::MIN_MULT);
+
+	// spare room, recovers
+	for (int i = 0; i < 200; i++) {
+		t += MavlinkBandwidthShaper::ADAPT_INTERVAL;
+		shaper.set_headroom(0.9f);
+		shaper.update(t);
+	}
+
+	EXPECT_FLOAT_EQ(shaper.get_link_mult(), 1.f);
+}
+
+TEST(MavlinkBandwidthShaper, ClassMultRecovery)
+{
+	MavlinkBandwidthShaper shaper;
+	shaper.set_rate(1000.f);
+
+	hrt_abstime t = 1;
+	shaper.update(t);
+
+	shaper.consume(Priority::HIGH, 2000);
+	EXPECT_FALSE(shaper.check(Priority::LOW, 100));
+
+	t += MavlinkBandwidthShaper::ADAPT_INTERVAL;
+	EXPECT_TRUE(shaper.update(t));
+	EXPECT_FLOAT_EQ(shaper.get_class_mult(Priority::LOW), 0.9f);
+	EXPECT_FLOAT_EQ(shaper.get_class_mult(Priority::NORMAL), 1.f);
+
+	// no more deferrals
+	bool changed = true;
+
+	for (int i = 0; (i < 100) && changed; i++) {
+		t += MavlinkBandwidthShaper::ADAPT_INTERVAL;
+		changed = shaper.update(t);
+	}
+
+	EXPECT_FALSE(changed);
+	EXPECT_FLOAT_EQ(shaper.get_class_mult(Priority::LOW), 1.f);
+}
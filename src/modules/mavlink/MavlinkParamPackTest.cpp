@@ -0,0 +1,226 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include "mavlink_param_pack.h"
+
+#include <parameters/param.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <map>
+#include <vector>
+
+class MavlinkParamPackTest : public ::testing::Test
+{
+public:
+	struct Value {
+		uint8_t type;
+		int32_t i;
+		float f;
+	};
+
+	void SetUp() override
+	{
+		param_control_autosave(false);
+		param_reset_all();
+
+		// make sure the parameters are used
+		_param_dist = param_find("CP_DIST");
+		_param_delay = param_find("CP_DELAY");
+	}
+
+	// write the pack file with the given query and decode it
+	bool pack(const char *query, MavlinkParamPack::Header &header, std::map<std::string, Value> &params)
+	{
+		FILE *file = tmpfile();
+
+		if (file == nullptr) {
+			return false;
+		}
+
+		const int fd = fileno(file);
+		EXPECT_EQ(MavlinkParamPack::write(fd, query), 0);
+
+		std::vector<uint8_t> data(lseek(fd, 0, SEEK_END));
+		lseek(fd, 0, SEEK_SET);
+		EXPECT_EQ(read(fd, data.data(), data.size()), (ssize_t)data.size());
+		fclose(file);
+
+		if (data.size() < sizeof(header)) {
+			return false;
+		}
+
+		memcpy(&header, data.data(), sizeof(header));
+
+		size_t pos = sizeof(header);
+		std::string name;
+
+		for (int n = 0; n < header.num_params; n++) {
+			if (pos + 2 > data.size()) {
+				return false;
+			}
+
+			Value value{};
+			value.type = data[pos] & 0xf;
+			const unsigned common_len = data[pos + 1] >> 4;
+			const unsigned suffix_len = (data[pos + 1] & 0xf) + 1;
+			pos += 2;
+
+			name = name.substr(0, common_len) + std::string((const char *)&data[pos], suffix_len);
+			pos += suffix_len;
+
+			switch (value.type) {
+			case MavlinkParamPack::kTypeInt8:
+				value.i = (int8_t)data[pos];
+				pos += 1;
+				break;
+
+			case MavlinkParamPack::kTypeInt16: {
+					int16_t value16;
+					memcpy(&value16, &data[pos], sizeof(value16));
+					value.i = value16;
+					pos += 2;
+				}
+				break;
+
+			case MavlinkParamPack::kTypeInt32:
+				memcpy(&value.i, &data[pos], sizeof(value.i));
+				pos += 4;
+				break;
+
+			case MavlinkParamPack::kTypeFloat:
+				memcpy(&value.f, &data[pos], sizeof(value.f));
+				pos += 4;
+				break;
+
+			default:
+				return false;
+			}
+
+			params[name] = value;
+		}
+
+		return pos == data.size();
+	}
+
+	param_t _param_dist{PARAM_INVALID};
+	param_t _param_delay{PARAM_INVALID};
+};
+
+TEST_F(MavlinkParamPackTest, FullDownload)
+{
+	// WHEN: we get all parameters
+	MavlinkParamPack::Header header{};
+	std::map<std::string, Value> params;
+	ASSERT_TRUE(pack(nullptr, header, params));
+
+	// THEN: the header matches the parameters
+	EXPECT_EQ(header.magic, MavlinkParamPack::kMagic);
+	EXPECT_EQ(header.flags, 0);
+	EXPECT_EQ(header.num_params, param_count_used());
+	EXPECT_EQ(header.total_params, param_count_used());
+	EXPECT_EQ(header.hash, param_hash_check());
+	EXPECT_EQ(header.epoch, MavlinkParamPack::epoch());
+	EXPECT_EQ(header.version, param_get_version());
+	EXPECT_EQ(params.size(), param_count_used());
+
+	// AND: all values are the same
+	for (unsigned i = 0; i < param_count_used(); i++) {
+		const param_t param = param_for_used_index(i);
+		auto it = params.find(param_name(param));
+		ASSERT_NE(it, params.end()) << param_name(param);
+
+		if (param_type(param) == PARAM_TYPE_FLOAT) {
+			float value;
+			param_get(param, &value);
+			EXPECT_EQ(it->second.type, MavlinkParamPack::kTypeFloat);
+			EXPECT_EQ(memcmp(&it->second.f, &value, sizeof(value)), 0) << param_name(param);
+
+		} else {
+			int32_t value;
+			param_get(param, &value);
+			EXPECT_NE(it->second.type, MavlinkParamPack::kTypeFloat);
+			EXPECT_EQ(it->second.i, value) << param_name(param);
+		}
+	}
+}
+
+TEST_F(MavlinkParamPackTest, DeltaDownload)
+{
+	// GIVEN: a full download
+	MavlinkParamPack::Header header{};
+	std::map<std::string, Value> params;
+	ASSERT_TRUE(pack(nullptr, header, params));
+
+	char query[64];
+	snprintf(query, sizeof(query), "epoch=%u&since=%u", (unsigned)header.epoch, (unsigned)header.version);
+
+	// WHEN: nothing changed
+	MavlinkParamPack::Header delta_header{};
+	std::map<std::string, Value> delta;
+	ASSERT_TRUE(pack(query, delta_header, delta));
+
+	// THEN: the delta is empty
+	EXPECT_EQ(delta_header.flags, MavlinkParamPack::kFlagDelta);
+	EXPECT_EQ(delta_header.num_params, 0);
+	EXPECT_EQ(delta_header.total_params, param_count_used());
+	EXPECT_EQ(delta_header.hash, header.hash);
+
+	// WHEN: a parameter changed
+	float value = 42.f;
+	param_set_no_notification(_param_dist, &value);
+	delta.clear();
+	ASSERT_TRUE(pack(query, delta_header, delta));
+
+	// THEN: only that one is in the delta, with the new hash
+	ASSERT_EQ(delta.size(), 1u);
+	EXPECT_EQ(delta.begin()->first, "CP_DIST");
+	EXPECT_FLOAT_EQ(delta.begin()->second.f, 42.f);
+	EXPECT_EQ(delta_header.hash, param_hash_check());
+	EXPECT_NE(delta_header.hash, header.hash);
+
+	// WHEN: the epoch is wrong
+	snprintf(query, sizeof(query), "epoch=%u&since=%u", (unsigned)header.epoch + 2, (unsigned)header.version);
+	delta.clear();
+	ASSERT_TRUE(pack(query, delta_header, delta));
+
+	// THEN: we get everything
+	EXPECT_EQ(delta_header.flags, 0);
+	EXPECT_EQ(delta.size(), param_count_used());
+}
@@ -0,0 +1,308 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file MavlinkReceiverDispatchTest.cpp
+ * Tests of the lookup of the message handlers by msgid, with a mock table and with the table of the receiver.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mavlink_receiver.h"
+
+#include <vector>
+
+namespace
+{
+
+struct MockHandler {
+	uint32_t msgid;
+	int handler;
+};
+
+// the handlers of a msgid in the order they are called
+template<typename Dispatch>
+std::vector<uint8_t> dispatched(const Dispatch &dispatch, uint32_t msgid)
+{
+	std::vector<uint8_t> indices;
+	dispatch.for_each_handler(msgid, [&indices](uint8_t index) { indices.push_back(index); });
+	return indices;
+}
+
+} // namespace
+
+TEST(MavlinkMessageDispatch, MockTable)
+{
+	// GIVEN: a table with a msgid that has several handlers, and ids above the directly indexed range
+	static constexpr uint32_t kLargeId = 12900;
+	const MockHandler table[] {
+		{76, 1},
+		{11, 2},
+		{76, 3},
+		{kLargeId, 4},
+		{511, 5},
+		{kLargeId, 6},
+		{76, 7},
+	};
+
+	MavlinkMessageDispatch<MockHandler, 8> dispatch;
+
+	// THEN: nothing is dispatched before the table is set
+	EXPECT_TRUE(dispatched(dispatch, 76).empty());
+
+	// WHEN: the table is set
+	ASSERT_TRUE(dispatch.init(table, sizeof(table) / sizeof(table[0])));
+
+	// THEN: every msgid reaches all of its handlers in the order of the table, and only those
+	EXPECT_EQ(dispatched(dispatch, 76), (std::vector<uint8_t> {0, 2, 6}));
+	EXPECT_EQ(dispatched(dispatch, 11), (std::vector<uint8_t> {1}));
+	EXPECT_EQ(dispatched(dispatch, 511), (std::vector<uint8_t> {4}));
+	EXPECT_EQ(dispatched(dispatch, kLargeId), (std::vector<uint8_t> {3, 5}));
+
+	EXPECT_TRUE(dispatched(dispatch, 0).empty());
+	EXPECT_TRUE(dispatched(dispatch, 12).empty());
+	EXPECT_TRUE(dispatched(dispatch, 512).empty());
+	EXPECT_TRUE(dispatched(dispatch, kLargeId + 1).empty());
+
+	// WHEN: a table with more handlers than the dispatch has room for is set
+	MavlinkMessageDispatch<MockHandler, 4> small;
+
+	// THEN: it is refused, and no handler is dispatched
+	EXPECT_FALSE(small.init(table, sizeof(table) / sizeof(table[0])));
+	EXPECT_TRUE(dispatched(small, 76).empty());
+	EXPECT_TRUE(dispatched(small, kLargeId).empty());
+}
+
+class MavlinkReceiverDispatchTest : public ::testing::Test
+{
+public:
+	using Handle = void (MavlinkReceiver::*)(mavlink_message_t *msg);
+
+	struct Expected {
+		uint32_t msgid;
+		Handle handle;
+	};
+
+	void SetUp() override
+	{
+		ASSERT_TRUE(_dispatch.init(MavlinkReceiver::_message_handlers, MavlinkReceiver::NUM_MESSAGE_HANDLERS));
+	}
+
+	// the handlers of every msgid, as they were called by the switch statements before the table
+	static std::vector<Expected> expectedHandlers()
+	{
+		return {
+			{MAVLINK_MSG_ID_COMMAND_LONG, &MavlinkReceiver::handle_message_command_long},
+			{MAVLINK_MSG_ID_COMMAND_INT, &MavlinkReceiver::handle_message_command_int},
+			{MAVLINK_MSG_ID_COMMAND_ACK, &MavlinkReceiver::handle_message_command_ack},
+			{MAVLINK_MSG_ID_OPTICAL_FLOW_RAD, &MavlinkReceiver::handle_message_optical_flow_rad},
+			{MAVLINK_MSG_ID_PING, &MavlinkReceiver::handle_message_ping},
+			{MAVLINK_MSG_ID_SET_MODE, &MavlinkReceiver::handle_message_set_mode},
+			{MAVLINK_MSG_ID_ATT_POS_MOCAP, &MavlinkReceiver::handle_message_att_pos_mocap},
+			{MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, &MavlinkReceiver::handle_message_set_position_target_local_ned},
+			{MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT, &MavlinkReceiver::handle_message_set_position_target_global_int},
+			{MAVLINK_MSG_ID_SET_ATTITUDE_TARGET, &MavlinkReceiver::handle_message_set_attitude_target},
+			{MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET, &MavlinkReceiver::handle_message_set_actuator_control_target},
+			{MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE, &MavlinkReceiver::handle_message_vision_position_estimate},
+			{MAVLINK_MSG_ID_ODOMETRY, &MavlinkReceiver::handle_message_odometry},
+			{MAVLINK_MSG_ID_SET_GPS_GLOBAL_ORIGIN, &MavlinkReceiver::handle_message_set_gps_global_origin},
+			{MAVLINK_MSG_ID_RADIO_STATUS, &MavlinkReceiver::handle_message_radio_status},
+			{MAVLINK_MSG_ID_MANUAL_CONTROL, &MavlinkReceiver::handle_message_manual_control},
+			{MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE, &MavlinkReceiver::handle_message_rc_channels_override},
+			{MAVLINK_MSG_ID_HEARTBEAT, &MavlinkReceiver::handle_message_heartbeat},
+			{MAVLINK_MSG_ID_DISTANCE_SENSOR, &MavlinkReceiver::handle_message_distance_sensor},
+			{MAVLINK_MSG_ID_FOLLOW_TARGET, &MavlinkReceiver::handle_message_follow_target},
+			{MAVLINK_MSG_ID_LANDING_TARGET, &MavlinkReceiver::handle_message_landing_target},
+			{MAVLINK_MSG_ID_CELLULAR_STATUS, &MavlinkReceiver::handle_message_cellular_status},
+			{MAVLINK_MSG_ID_ADSB_VEHICLE, &MavlinkReceiver::handle_message_adsb_vehicle},
+			{MAVLINK_MSG_ID_UTM_GLOBAL_POSITION, &MavlinkReceiver::handle_message_utm_global_position},
+			{MAVLINK_MSG_ID_COLLISION, &MavlinkReceiver::handle_message_collision},
+			{MAVLINK_MSG_ID_GPS_RTCM_DATA, &MavlinkReceiver::handle_message_gps_rtcm_data},
+			{MAVLINK_MSG_ID_BATTERY_STATUS, &MavlinkReceiver::handle_message_battery_status},
+			{MAVLINK_MSG_ID_SERIAL_CONTROL, &MavlinkReceiver::handle_message_serial_control},
+			{MAVLINK_MSG_ID_LOGGING_ACK, &MavlinkReceiver::handle_message_logging_ack},
+			{MAVLINK_MSG_ID_PLAY_TUNE, &MavlinkReceiver::handle_message_play_tune},
+			{MAVLINK_MSG_ID_PLAY_TUNE_V2, &MavlinkReceiver::handle_message_play_tune_v2},
+			{MAVLINK_MSG_ID_OBSTACLE_DISTANCE, &MavlinkReceiver::handle_message_obstacle_distance},
+			{MAVLINK_MSG_ID_TUNNEL, &MavlinkReceiver::handle_message_tunnel},
+			{MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_BEZIER, &MavlinkReceiver::handle_message_trajectory_representation_bezier},
+			{MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_WAYPOINTS, &MavlinkReceiver::handle_message_trajectory_representation_waypoints},
+			{MAVLINK_MSG_ID_ONBOARD_COMPUTER_STATUS, &MavlinkReceiver::handle_message_onboard_computer_status},
+			{MAVLINK_MSG_ID_GENERATOR_STATUS, &MavlinkReceiver::handle_message_generator_status},
+			{MAVLINK_MSG_ID_STATUSTEXT, &MavlinkReceiver::handle_message_statustext},
+#if !defined(CONSTRAINED_FLASH)
+			{MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, &MavlinkReceiver::handle_message_named_value_float},
+			{MAVLINK_MSG_ID_DEBUG, &MavlinkReceiver::handle_message_debug},
+			{MAVLINK_MSG_ID_DEBUG_VECT, &MavlinkReceiver::handle_message_debug_vect},
+			{MAVLINK_MSG_ID_DEBUG_FLOAT_ARRAY, &MavlinkReceiver::handle_message_debug_float_array},
+#endif // !CONSTRAINED_FLASH
+			{MAVLINK_MSG_ID_GIMBAL_MANAGER_SET_ATTITUDE, &MavlinkReceiver::handle_message_gimbal_manager_set_attitude},
+			{MAVLINK_MSG_ID_GIMBAL_MANAGER_SET_MANUAL_CONTROL, &MavlinkReceiver::handle_message_gimbal_manager_set_manual_control},
+			{MAVLINK_MSG_ID_GIMBAL_DEVICE_INFORMATION, &MavlinkReceiver::handle_message_gimbal_device_information},
+			{MAVLINK_MSG_ID_REQUEST_EVENT, &MavlinkReceiver::handle_message_request_event},
+			{MAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS, &MavlinkReceiver::handle_message_gimbal_device_attitude_status},
+
+			{MAVLINK_MSG_ID_HIL_SENSOR, &MavlinkReceiver::handle_message_hil_sensor},
+			{MAVLINK_MSG_ID_HIL_STATE_QUATERNION, &MavlinkReceiver::handle_message_hil_state_quaternion},
+			{MAVLINK_MSG_ID_HIL_OPTICAL_FLOW, &MavlinkReceiver::handle_message_hil_optical_flow},
+			{MAVLINK_MSG_ID_HIL_GPS, &MavlinkReceiver::handle_message_hil_gps},
+
+			// the messages the components handle in their own handle_message()
+			{MAVLINK_MSG_ID_MISSION_ACK, &MavlinkReceiver::handle_message_mission},
+			{MAVLINK_MSG_ID_MISSION_SET_CURRENT, &MavlinkReceiver::handle_message_mission},
+			{MAVLINK_MSG_ID_MISSION_REQUEST_LIST, &MavlinkReceiver::handle_message_mission},
+			{MAVLINK_MSG_ID_MISSION_REQUEST, &MavlinkReceiver::handle_message_mission},
+			{MAVLINK_MSG_ID_MISSION_REQUEST_INT, &MavlinkReceiver::handle_message_mission},
+			{MAVLINK_MSG_ID_MISSION_COUNT, &MavlinkReceiver::handle_message_mission},
+			{MAVLINK_MSG_ID_MISSION_ITEM, &MavlinkReceiver::handle_message_mission},
+			{MAVLINK_MSG_ID_MISSION_ITEM_INT, &MavlinkReceiver::handle_message_mission},
+			{MAVLINK_MSG_ID_MISSION_CLEAR_ALL, &MavlinkReceiver::handle_message_mission},
+
+			{MAVLINK_MSG_ID_PARAM_REQUEST_LIST, &MavlinkReceiver::handle_message_param},
+			{MAVLINK_MSG_ID_PARAM_SET, &MavlinkReceiver::handle_message_param},
+			{MAVLINK_MSG_ID_PARAM_REQUEST_READ, &MavlinkReceiver::handle_message_param},
+			{MAVLINK_MSG_ID_PARAM_MAP_RC, &MavlinkReceiver::handle_message_param},
+
+			{MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, &MavlinkReceiver::handle_message_file_transfer_protocol},
+
+			{MAVLINK_MSG_ID_LOG_REQUEST_LIST, &MavlinkReceiver::handle_message_log},
+			{MAVLINK_MSG_ID_LOG_REQUEST_DATA, &MavlinkReceiver::handle_message_log},
+			{MAVLINK_MSG_ID_LOG_ERASE, &MavlinkReceiver::handle_message_log},
+			{MAVLINK_MSG_ID_LOG_REQUEST_END, &MavlinkReceiver::handle_message_log},
+
+			{MAVLINK_MSG_ID_TIMESYNC, &MavlinkReceiver::handle_message_timesync},
+			{MAVLINK_MSG_ID_SYSTEM_TIME, &MavlinkReceiver::handle_message_timesync},
+		};
+	}
+
+	// the handlers a message with msgid is dispatched to
+	std::vector<Handle> dispatchedHandlers(uint32_t msgid) const
+	{
+		std::vector<Handle> handles;
+
+		for (uint8_t index : dispatched(_dispatch, msgid)) {
+			handles.push_back(MavlinkReceiver::_message_handlers[index].handle);
+		}
+
+		return handles;
+	}
+
+	// number of handlers that accept a message with msgid from sysid
+	unsigned acceptingHandlers(uint32_t msgid, uint8_t sysid, bool hil_enabled, bool use_hil_gps) const
+	{
+		mavlink_message_t msg{};
+		msg.msgid = msgid;
+		msg.sysid = sysid;
+
+		unsigned count = 0;
+
+		for (uint8_t index : dispatched(_dispatch, msgid)) {
+			count += MavlinkReceiver::message_accepted(MavlinkReceiver::_message_handlers[index].filter, msg,
+					hil_enabled, use_hil_gps) ? 1 : 0;
+		}
+
+		return count;
+	}
+
+	static size_t numHandlers() { return MavlinkReceiver::NUM_MESSAGE_HANDLERS; }
+
+	static bool isHil(uint32_t msgid)
+	{
+		return (msgid == MAVLINK_MSG_ID_HIL_SENSOR) || (msgid == MAVLINK_MSG_ID_HIL_STATE_QUATERNION)
+		       || (msgid == MAVLINK_MSG_ID_HIL_OPTICAL_FLOW) || (msgid == MAVLINK_MSG_ID_HIL_GPS);
+	}
+
+	MavlinkMessageDispatch<MavlinkReceiver::MessageHandler, MavlinkReceiver::MAX_MESSAGE_HANDLERS> _dispatch;
+};
+
+TEST_F(MavlinkReceiverDispatchTest, EveryMsgidReachesItsHandler)
+{
+	const std::vector<Expected> expected = expectedHandlers();
+
+	// WHEN: a message of any id in the directly indexed range, or one of the expected ones, is dispatched
+	std::vector<uint32_t> msgids;
+
+	for (uint32_t msgid = 0; msgid < MavlinkMessageDispatch<MockHandler, 1>::DIRECT_SIZE; msgid++) {
+		msgids.push_back(msgid);
+	}
+
+	for (const Expected &e : expected) {
+		msgids.push_back(e.msgid);
+	}
+
+	for (uint32_t msgid : msgids) {
+		std::vector<Handle> expected_handles;
+
+		for (const Expected &e : expected) {
+			if (e.msgid == msgid) {
+				expected_handles.push_back(e.handle);
+			}
+		}
+
+		// THEN: it reaches exactly the handler it reached before the table, or none
+		EXPECT_TRUE(dispatchedHandlers(msgid) == expected_handles) << "msgid " << msgid;
+	}
+
+	// AND: the table has no other entries
+	EXPECT_EQ(numHandlers(), expected.size());
+}
+
+TEST_F(MavlinkReceiverDispatchTest, HilMessagesRejectedWhenHilIsOff)
+{
+	const uint8_t own_sysid = mavlink_system.sysid;
+	const uint8_t other_sysid = own_sysid + 1;
+
+	for (const Expected &e : expectedHandlers()) {
+		if (isHil(e.msgid)) {
+			// GIVEN: HIL off
+			// THEN: HIL messages are rejected, from any system
+			EXPECT_EQ(acceptingHandlers(e.msgid, own_sysid, false, false), 0u) << "msgid " << e.msgid;
+			EXPECT_EQ(acceptingHandlers(e.msgid, other_sysid, false, false), 0u) << "msgid " << e.msgid;
+
+			// GIVEN: HIL on
+			// THEN: they are accepted
+			EXPECT_EQ(acceptingHandlers(e.msgid, other_sysid, true, false), 1u) << "msgid " << e.msgid;
+
+			// GIVEN: HIL off, but use_hil_gps set
+			// THEN: only HIL_GPS from our own system is accepted
+			const unsigned expected_hil_gps = (e.msgid == MAVLINK_MSG_ID_HIL_GPS) ? 1 : 0;
+			EXPECT_EQ(acceptingHandlers(e.msgid, own_sysid, false, true), expected_hil_gps) << "msgid " << e.msgid;
+			EXPECT_EQ(acceptingHandlers(e.msgid, other_sysid, false, true), 0u) << "msgid " << e.msgid;
+
+		} else {
+			// THEN: all other messages are accepted whatever the HIL mode
+			EXPECT_GE(acceptingHandlers(e.msgid, other_sysid, false, false), 1u) << "msgid " << e.msgid;
+			EXPECT_GE(acceptingHandlers(e.msgid, other_sysid, true, true), 1u) << "msgid " << e.msgid;
+		}
+	}
+}
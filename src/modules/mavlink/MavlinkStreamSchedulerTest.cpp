@@ -0,0 +1,290 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * Compares the stream scheduler with polling all streams on the default stream
+ * sets of the onboard and config modes, and records the CPU time of both
+ * (see the XML output of the test, --gtest_output=xml).
+ */
+
+#include <gtest/gtest.h>
+
+#include "mavlink_main.h"
+#include "mavlink_stream_scheduler.h"
+
+#include <vector>
+
+namespace
+{
+
+struct StreamConfig {
+	const char *name;
+	float rate;	///< Hz, -1 for unlimited rate (event driven)
+};
+
+// as configured by Mavlink::configure_streams_to_default()
+const StreamConfig onboard_streams[] {
+	{"TIMESYNC", 10.0f},
+	{"CAMERA_TRIGGER", -1.f},
+	{"HIGHRES_IMU", 50.0f},
+	{"LOCAL_POSITION_NED", 30.0f},
+	{"ATTITUDE", 100.0f},
+	{"ALTITUDE", 10.0f},
+	{"DISTANCE_SENSOR", 10.0f},
+	{"ESC_INFO", 10.0f},
+	{"ESC_STATUS", 10.0f},
+	{"MOUNT_ORIENTATION", 10.0f},
+	{"OBSTACLE_DISTANCE", 10.0f},
+	{"ODOMETRY", 30.0f},
+	{"ACTUATOR_CONTROL_TARGET0", 10.0f},
+	{"ADSB_VEHICLE", -1.f},
+	{"ATTITUDE_QUATERNION", 50.0f},
+	{"ATTITUDE_TARGET", 10.0f},
+	{"BATTERY_STATUS", 0.5f},
+	{"CAMERA_IMAGE_CAPTURED", -1.f},
+	{"COLLISION", -1.f},
+	{"EFI_STATUS", 2.0f},
+	{"ESTIMATOR_STATUS", 1.0f},
+	{"EXTENDED_SYS_STATE", 5.0f},
+	{"GIMBAL_DEVICE_ATTITUDE_STATUS", 1.0f},
+	{"GIMBAL_DEVICE_SET_ATTITUDE", 5.0f},
+	{"GIMBAL_MANAGER_STATUS", 0.5f},
+	{"GLOBAL_POSITION_INT", 50.0f},
+	{"GPS2_RAW", -1.f},
+	{"GPS_GLOBAL_ORIGIN", 1.0f},
+	{"GPS_RAW_INT", -1.f},
+	{"GPS_STATUS", 1.0f},
+	{"HOME_POSITION", 0.5f},
+	{"HYGROMETER_SENSOR", 1.0f},
+	{"NAV_CONTROLLER_OUTPUT", 10.0f},
+	{"OPTICAL_FLOW_RAD", 10.0f},
+	{"ORBIT_EXECUTION_STATUS", 5.0f},
+	{"PING", 1.0f},
+	{"POSITION_TARGET_GLOBAL_INT", 10.0f},
+	{"POSITION_TARGET_LOCAL_NED", 10.0f},
+	{"RAW_RPM", 5.0f},
+	{"RC_CHANNELS", 20.0f},
+	{"SERVO_OUTPUT_RAW_0", 10.0f},
+	{"SYS_STATUS", 5.0f},
+	{"SYSTEM_TIME", 1.0f},
+	{"TRAJECTORY_REPRESENTATION_WAYPOINTS", 5.0f},
+	{"UTM_GLOBAL_POSITION", 1.0f},
+	{"VFR_HUD", 10.0f},
+	{"VIBRATION", 0.5f},
+	{"WIND_COV", 10.0f},
+	{"DEBUG", 10.0f},
+	{"DEBUG_FLOAT_ARRAY", 10.0f},
+	{"DEBUG_VECT", 10.0f},
+	{"NAMED_VALUE_FLOAT", 10.0f},
+	{"LINK_NODE_STATUS", 1.0f},
+};
+
+const StreamConfig config_streams[] {
+	{"TIMESYNC", 10.0f},
+	{"CAMERA_TRIGGER", -1.f},
+	{"LOCAL_POSITION_NED", 30.0f},
+	{"DISTANCE_SENSOR", 10.0f},
+	{"MOUNT_ORIENTATION", 10.0f},
+	{"ODOMETRY", 30.0f},
+	{"ACTUATOR_CONTROL_TARGET0", 30.0f},
+	{"ADSB_VEHICLE", -1.f},
+	{"ALTITUDE", 10.0f},
+	{"ATTITUDE", 50.0f},
+	{"ATTITUDE_QUATERNION", 50.0f},
+	{"ATTITUDE_TARGET", 8.0f},
+	{"BATTERY_STATUS", 0.5f},
+	{"CAMERA_IMAGE_CAPTURED", -1.f},
+	{"COLLISION", -1.f},
+	{"EFI_STATUS", 10.0f},
+	{"ESC_INFO", 10.0f},
+	{"ESC_STATUS", 10.0f},
+	{"ESTIMATOR_STATUS", 5.0f},
+	{"EXTENDED_SYS_STATE", 2.0f},
+	{"GLOBAL_POSITION_INT", 10.0f},
+	{"GPS2_RAW", -1.f},
+	{"GPS_GLOBAL_ORIGIN", 1.0f},
+	{"GPS_RAW_INT", -1.f},
+	{"GPS_STATUS", 1.0f},
+	{"HIGHRES_IMU", 50.0f},
+	{"HOME_POSITION", 0.5f},
+	{"HYGROMETER_SENSOR", 1.0f},
+	{"MAG_CAL_REPORT", 1.0f},
+	{"MANUAL_CONTROL", 5.0f},
+	{"NAV_CONTROLLER_OUTPUT", 10.0f},
+	{"OPTICAL_FLOW_RAD", 10.0f},
+	{"ORBIT_EXECUTION_STATUS", 5.0f},
+	{"PING", 1.0f},
+	{"POSITION_TARGET_GLOBAL_INT", 10.0f},
+	{"RAW_RPM", 5.0f},
+	{"RC_CHANNELS", 10.0f},
+	{"SCALED_IMU", 25.0f},
+	{"SCALED_IMU2", 25.0f},
+	{"SCALED_IMU3", 25.0f},
+	{"SERVO_OUTPUT_RAW_0", 20.0f},
+	{"SERVO_OUTPUT_RAW_1", 20.0f},
+	{"SYS_STATUS", 1.0f},
+	{"SYSTEM_TIME", 1.0f},
+	{"UTM_GLOBAL_POSITION", 1.0f},
+	{"VFR_HUD", 20.0f},
+	{"VIBRATION", 2.5f},
+	{"WIND_COV", 10.0f},
+	{"DEBUG", 50.0f},
+	{"DEBUG_FLOAT_ARRAY", 50.0f},
+	{"DEBUG_VECT", 50.0f},
+	{"NAMED_VALUE_FLOAT", 50.0f},
+	{"LINK_NODE_STATUS", 1.0f},
+};
+
+// stands in for the uORB check of a real stream, event driven streams rarely have data
+class TestStream : public MavlinkStream
+{
+public:
+	TestStream(Mavlink *mavlink, const char *name, uint16_t id, bool event) :
+		MavlinkStream(mavlink), _name(name), _id(id), _event(event) {}
+
+	const char *get_name() const override { return _name; }
+	uint16_t get_id() override { return _id; }
+	unsigned get_size() override { return 30; }
+
+	unsigned sent() const { return _sent; }
+
+private:
+	bool send() override
+	{
+		if (_event && (++_checks % 100 != 0)) {
+			return false;
+		}
+
+		_sent++;
+		return true;
+	}
+
+	const char *const _name;
+	const uint16_t _id;
+	const bool _event;
+	unsigned _checks{0};
+	unsigned _sent{0};
+};
+
+struct RunResult {
+	std::vector<unsigned> sent;
+	hrt_abstime elapsed_us;
+	float updates_per_loop;
+};
+
+template <size_t N>
+RunResult run(const StreamConfig (&config)[N], bool scheduler)
+{
+	Mavlink mavlink;
+	MavlinkStreamScheduler stream_scheduler;
+	List<MavlinkStream *> streams;
+
+	for (size_t i = 0; i < N; i++) {
+		TestStream *stream = new TestStream(&mavlink, config[i].name, i + 1, config[i].rate < 0.f);
+		stream->set_interval((config[i].rate < 0.f) ? -1 : (int)(1e6f / config[i].rate));
+		streams.add(stream);
+	}
+
+	// 60 s of main loop iterations, simulated time ahead of the clock the first messages are sent with
+	const unsigned loop_delay = mavlink.get_main_loop_delay();
+	const unsigned iterations = 60 * 1000 * 1000 / loop_delay;
+	hrt_abstime t = hrt_absolute_time() + 1000 * 1000;
+	uint64_t loops = 0;
+	uint64_t updates = 0;
+
+	const hrt_abstime start = hrt_absolute_time();
+
+	for (unsigned i = 0; i < iterations; i++) {
+		t += loop_delay;
+
+		if (scheduler) {
+			stream_scheduler.update(streams, t, 1.f);
+
+		} else {
+			for (const auto &stream : streams) {
+				stream->update(t);
+				updates++;
+			}
+
+			loops++;
+		}
+	}
+
+	RunResult result{};
+	result.elapsed_us = hrt_elapsed_time(&start);
+	result.updates_per_loop = scheduler ? stream_scheduler.get_updates_per_loop() : (float)updates / loops;
+
+	for (const auto &stream : streams) {
+		result.sent.push_back(static_cast<TestStream *>(stream)->sent());
+	}
+
+	streams.clear();
+	return result;
+}
+
+template <size_t N>
+void compare(const char *mode, const StreamConfig (&config)[N])
+{
+	const RunResult polling = run(config, false);
+	const RunResult scheduled = run(config, true);
+
+	ASSERT_EQ(polling.sent.size(), N);
+	ASSERT_EQ(scheduled.sent.size(), N);
+
+	// THEN: every stream sends as many messages as with polling, up to one more or less
+	// depending on the phase of the first message
+	for (size_t i = 0; i < N; i++) {
+		EXPECT_NEAR(scheduled.sent[i], polling.sent[i], 1) << config[i].name;
+	}
+
+	// AND: a main loop iteration only visits the streams that are due
+	EXPECT_FLOAT_EQ(polling.updates_per_loop, N);
+	EXPECT_LT(scheduled.updates_per_loop, 0.25f * N);
+
+	const std::string prefix{mode};
+	::testing::Test::RecordProperty(prefix + "_polling_us", (int)polling.elapsed_us);
+	::testing::Test::RecordProperty(prefix + "_scheduler_us", (int)scheduled.elapsed_us);
+}
+
+} // namespace
+
+TEST(MavlinkStreamScheduler, OnboardSameMessagesAsPolling)
+{
+	compare("onboard", onboard_streams);
+}
+
+TEST(MavlinkStreamScheduler, ConfigSameMessagesAsPolling)
+{
+	compare("config", config_streams);
+}
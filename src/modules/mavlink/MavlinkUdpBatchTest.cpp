@@ -0,0 +1,306 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file MavlinkUdpBatchTest.cpp
+ * Tests of the batched UDP transmission and reception, over sockets on the loopback interface.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mavlink_udp_batch.h"
+
+#if defined(MAVLINK_UDP_BATCH)
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+class MavlinkUdpBatchTest : public ::testing::Test
+{
+public:
+	void SetUp() override
+	{
+		_sender = openSocket();
+		_receiver = openSocket();
+		ASSERT_GE(_sender, 0);
+		ASSERT_GE(_receiver, 0);
+
+		socklen_t len = sizeof(_receiver_addr);
+		ASSERT_EQ(getsockname(_receiver, (sockaddr *)&_receiver_addr, &len), 0);
+
+		len = sizeof(_sender_addr);
+		ASSERT_EQ(getsockname(_sender, (sockaddr *)&_sender_addr, &len), 0);
+	}
+
+	void TearDown() override
+	{
+		close(_sender);
+		close(_receiver);
+	}
+
+	// a non blocking socket bound to an ephemeral loopback port
+	static int openSocket()
+	{
+		const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+
+		if ((fd < 0) || (bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0)) {
+			return -1;
+		}
+
+		return fd;
+	}
+
+	// queue a packet of len bytes, each one set to value
+	static bool queuePacket(MavlinkUdpTxBatch &batch, uint8_t value, size_t len, hrt_abstime now = 0)
+	{
+		uint8_t buf[MavlinkUdpTxBatch::PACKET_LEN_MAX + 1];
+		memset(buf, value, sizeof(buf));
+		const bool appended = batch.append(buf, len);
+		return batch.finish_packet(now) && appended;
+	}
+
+	// the next datagram waiting on the receiver socket, or -1 if there is none
+	ssize_t receiveDatagram(uint8_t *buf, size_t len)
+	{
+		return recv(_receiver, buf, len, MSG_DONTWAIT);
+	}
+
+	int _sender{-1};
+	int _receiver{-1};
+	sockaddr_in _sender_addr{};
+	sockaddr_in _receiver_addr{};
+};
+
+TEST_F(MavlinkUdpBatchTest, FillAssemblesPacketsFromSeveralAppends)
+{
+	MavlinkUdpTxBatch batch;
+	EXPECT_TRUE(batch.empty());
+
+	// GIVEN: a packet assembled from a header and a payload, like send_bytes() does
+	const uint8_t header[] {0xfd, 0x09};
+	const uint8_t payload[] {1, 2, 3, 4, 5};
+	EXPECT_TRUE(batch.append(header, sizeof(header)));
+	EXPECT_TRUE(batch.append(payload, sizeof(payload)));
+	EXPECT_TRUE(batch.finish_packet(0));
+
+	// AND: an empty packet and one that is longer than a slot, which are both dropped
+	EXPECT_FALSE(batch.finish_packet(0));
+	EXPECT_FALSE(queuePacket(batch, 0x11, MavlinkUdpTxBatch::PACKET_LEN_MAX + 1));
+
+	// AND: the next packet fills its slot exactly, the dropped one does not leave anything behind
+	EXPECT_TRUE(queuePacket(batch, 0x22, MavlinkUdpTxBatch::PACKET_LEN_MAX));
+	EXPECT_FALSE(batch.empty());
+
+	// WHEN: the batch is flushed
+	const MavlinkUdpTxBatch::Result result = batch.flush(_sender, _receiver_addr, nullptr);
+
+	// THEN: the two valid packets are sent as one datagram each, with a single system call
+	EXPECT_EQ(result.packets_sent, 2u);
+	EXPECT_EQ(result.bytes_sent, sizeof(header) + sizeof(payload) + MavlinkUdpTxBatch::PACKET_LEN_MAX);
+	EXPECT_EQ(result.packets_failed, 0u);
+	EXPECT_EQ(result.broadcast_errno, 0);
+	EXPECT_EQ(batch.get_syscall_count(), 1u);
+	EXPECT_EQ(batch.get_datagram_count(), 2u);
+	EXPECT_TRUE(batch.empty());
+
+	uint8_t buf[MavlinkUdpRxBatch::DATAGRAM_LEN_MAX];
+	ASSERT_EQ(receiveDatagram(buf, sizeof(buf)), (ssize_t)(sizeof(header) + sizeof(payload)));
+	EXPECT_EQ(memcmp(buf, header, sizeof(header)), 0);
+	EXPECT_EQ(memcmp(buf + sizeof(header), payload, sizeof(payload)), 0);
+
+	ASSERT_EQ(receiveDatagram(buf, sizeof(buf)), (ssize_t)MavlinkUdpTxBatch::PACKET_LEN_MAX);
+	EXPECT_EQ(buf[0], 0x22);
+	EXPECT_EQ(buf[MavlinkUdpTxBatch::PACKET_LEN_MAX - 1], 0x22);
+
+	EXPECT_LT(receiveDatagram(buf, sizeof(buf)), 0);
+
+	// AND: flushing an empty batch does not make a system call
+	batch.flush(_sender, _receiver_addr, nullptr);
+	EXPECT_EQ(batch.get_syscall_count(), 1u);
+}
+
+TEST_F(MavlinkUdpBatchTest, FlushRequiredWhenFull)
+{
+	MavlinkUdpTxBatch batch;
+
+	// GIVEN: a batch filled within the flush timeout
+	for (size_t i = 0; i < MavlinkUdpTxBatch::MAX_PACKETS; i++) {
+		EXPECT_FALSE(batch.flush_required(0));
+		EXPECT_TRUE(queuePacket(batch, i, 10));
+	}
+
+	// THEN: a flush is required, and further packets are dropped until then
+	EXPECT_TRUE(batch.full());
+	EXPECT_TRUE(batch.flush_required(0));
+	EXPECT_FALSE(queuePacket(batch, 0xff, 10));
+
+	// WHEN: it is flushed
+	const MavlinkUdpTxBatch::Result result = batch.flush(_sender, _receiver_addr, nullptr);
+
+	// THEN: all packets are sent in order with a single system call, and the batch takes packets again
+	EXPECT_EQ(result.packets_sent, (unsigned)MavlinkUdpTxBatch::MAX_PACKETS);
+	EXPECT_EQ(batch.get_syscall_count(), 1u);
+	EXPECT_FALSE(batch.flush_required(0));
+	EXPECT_TRUE(queuePacket(batch, 0, 10));
+
+	for (size_t i = 0; i < MavlinkUdpTxBatch::MAX_PACKETS; i++) {
+		uint8_t buf[16];
+		ASSERT_EQ(receiveDatagram(buf, sizeof(buf)), 10);
+		EXPECT_EQ(buf[0], i);
+	}
+}
+
+TEST_F(MavlinkUdpBatchTest, FlushRequiredAfterTimeout)
+{
+	MavlinkUdpTxBatch batch;
+	const hrt_abstime start = 1_s;
+
+	// GIVEN: an empty batch, which never needs a flush
+	EXPECT_FALSE(batch.flush_required(start + 1_s));
+
+	// WHEN: packets are queued one after the other
+	EXPECT_TRUE(queuePacket(batch, 1, 10, start));
+	EXPECT_TRUE(queuePacket(batch, 2, 10, start + MavlinkUdpTxBatch::MAX_DELAY_US - 1));
+
+	// THEN: the timeout runs from the first one
+	EXPECT_FALSE(batch.flush_required(start + MavlinkUdpTxBatch::MAX_DELAY_US - 1));
+	EXPECT_TRUE(batch.flush_required(start + MavlinkUdpTxBatch::MAX_DELAY_US));
+
+	// WHEN: the batch is flushed and a packet is queued later on
+	EXPECT_EQ(batch.flush(_sender, _receiver_addr, nullptr).packets_sent, 2u);
+	const hrt_abstime later = start + 10 * MavlinkUdpTxBatch::MAX_DELAY_US;
+	EXPECT_TRUE(queuePacket(batch, 3, 10, later));
+
+	// THEN: the timeout starts again with that packet
+	EXPECT_FALSE(batch.flush_required(later + MavlinkUdpTxBatch::MAX_DELAY_US - 1));
+	EXPECT_TRUE(batch.flush_required(later + MavlinkUdpTxBatch::MAX_DELAY_US));
+}
+
+TEST_F(MavlinkUdpBatchTest, PartialSendSkipsFailedDatagrams)
+{
+	MavlinkUdpTxBatch batch;
+	static constexpr unsigned kPackets = 3;
+
+	// GIVEN: a broadcast address the socket is not allowed to send to (no SO_BROADCAST)
+	sockaddr_in broadcast{};
+	broadcast.sin_family = AF_INET;
+	broadcast.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+	broadcast.sin_port = _receiver_addr.sin_port;
+
+	for (unsigned i = 0; i < kPackets; i++) {
+		EXPECT_TRUE(queuePacket(batch, i, 20));
+	}
+
+	// WHEN: the batch is sent to the partner and to the broadcast address
+	const MavlinkUdpTxBatch::Result result = batch.flush(_sender, _receiver_addr, &broadcast);
+
+	// THEN: sendmmsg() returns after the partner datagrams, every broadcast datagram fails on its own and is skipped
+	EXPECT_EQ(result.packets_sent, kPackets);
+	EXPECT_EQ(result.bytes_sent, kPackets * 20);
+	EXPECT_EQ(result.packets_failed, 0u);
+	EXPECT_EQ(result.broadcast_errno, EACCES);
+	EXPECT_EQ(batch.get_syscall_count(), 1 + kPackets);
+	EXPECT_EQ(batch.get_datagram_count(), 2 * kPackets);
+
+	for (unsigned i = 0; i < kPackets; i++) {
+		uint8_t buf[32];
+		ASSERT_EQ(receiveDatagram(buf, sizeof(buf)), 20);
+		EXPECT_EQ(buf[0], i);
+	}
+
+	// WHEN: the partner address is the one that fails
+	for (unsigned i = 0; i < kPackets; i++) {
+		EXPECT_TRUE(queuePacket(batch, 10 + i, 20));
+	}
+
+	const MavlinkUdpTxBatch::Result failed = batch.flush(_sender, broadcast, &_receiver_addr);
+
+	// THEN: its packets are counted as failed, and the datagrams to the other address are still sent
+	EXPECT_EQ(failed.packets_sent, 0u);
+	EXPECT_EQ(failed.packets_failed, kPackets);
+	EXPECT_EQ(failed.bytes_failed, kPackets * 20);
+	EXPECT_EQ(failed.broadcast_errno, 0);
+
+	for (unsigned i = 0; i < kPackets; i++) {
+		uint8_t buf[32];
+		ASSERT_EQ(receiveDatagram(buf, sizeof(buf)), 20);
+		EXPECT_EQ(buf[0], 10 + i);
+	}
+}
+
+TEST_F(MavlinkUdpBatchTest, ReceiveSplitsIntoBatches)
+{
+	MavlinkUdpRxBatch batch;
+	static constexpr int kDatagrams = MavlinkUdpRxBatch::MAX_DATAGRAMS + 3;
+
+	// GIVEN: nothing pending
+	EXPECT_EQ(batch.receive(_receiver), 0);
+
+	// AND: more datagrams pending than fit into one batch, all with a different length
+	for (int i = 0; i < kDatagrams; i++) {
+		uint8_t buf[64];
+		memset(buf, i, sizeof(buf));
+		ASSERT_EQ(sendto(_sender, buf, i + 1, 0, (const sockaddr *)&_receiver_addr, sizeof(_receiver_addr)), i + 1);
+	}
+
+	// WHEN: they are received
+	// THEN: a full batch comes first, then the rest, then nothing, each with a single system call
+	int received = 0;
+
+	for (int expected : {MavlinkUdpRxBatch::MAX_DATAGRAMS, kDatagrams - MavlinkUdpRxBatch::MAX_DATAGRAMS, 0}) {
+		const int count = batch.receive(_receiver);
+		ASSERT_EQ(count, expected);
+
+		// AND: every datagram keeps its own length, contents and source, in the order they were sent
+		for (int i = 0; i < count; i++, received++) {
+			ASSERT_EQ(batch.length(i), (size_t)(received + 1));
+			EXPECT_EQ(batch.data(i)[0], received);
+			EXPECT_EQ(batch.data(i)[received], received);
+			EXPECT_EQ(batch.source(i).sin_port, _sender_addr.sin_port);
+			EXPECT_EQ(batch.source(i).sin_addr.s_addr, _sender_addr.sin_addr.s_addr);
+		}
+	}
+
+	EXPECT_EQ(received, kDatagrams);
+	EXPECT_EQ(batch.get_syscall_count(), 4u);
+	EXPECT_EQ(batch.get_datagram_count(), (unsigned)kDatagrams);
+}
+
+#endif // MAVLINK_UDP_BATCH
@@ -55,6 +55,11 @@
 #define MAVLINK_GET_CHANNEL_BUFFER mavlink_get_channel_buffer
 #define MAVLINK_GET_CHANNEL_STATUS mavlink_get_channel_status
 
+/* UDP transport, also needed by mavlink_receiver.h which is included before mavlink_main.h */
+#if defined(CONFIG_NET) || defined(__PX4_POSIX)
+# define MAVLINK_UDP
+#endif
+
 #if !defined(CONSTRAINED_MEMORY)
 # define MAVLINK_COMM_NUM_BUFFERS 6
 # define MAVLINK_COMM_4 static_cast<mavlink_channel_t>(4)
@@ -47,6 +47,7 @@
 
 #ifndef MAVLINK_FTP_UNIT_TEST
 #include "mavlink_main.h"
+#include "mavlink_param_pack.h"
 #else
 #include <mavlink.h>
 #endif
@@ -64,6 +65,10 @@ MavlinkFTP::MavlinkFTP(Mavlink *mavlink) :
 
 MavlinkFTP::~MavlinkFTP()
 {
+	if (_session_info.fd >= 0) {
+		_closeSession();
+	}
+
 	delete[] _work_buffer1;
 	delete[] _work_buffer2;
 }
@@ -503,8 +508,26 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 		return kErrNoSessionsAvailable;
 	}
 
-	strncpy(_work_buffer1, _root_dir, _work_buffer1_len);
-	strncpy(_work_buffer1 + _root_dir_len, _data_as_cstring(payload), _work_buffer1_len - _root_dir_len);
+	const char *path = _data_as_cstring(payload);
+
+#ifndef MAVLINK_FTP_UNIT_TEST
+
+	if ((oflag == O_RDONLY) && (strncmp(path, MavlinkParamPack::kFileName, sizeof(MavlinkParamPack::kFileName) - 1) == 0)) {
+		// virtual file with the packed parameters: write it to a temporary file and open that instead
+		ErrorCode error_code = _writeParamPack(strchr(path, '?'));
+
+		if (error_code != kErrNone) {
+			return error_code;
+		}
+
+		strncpy(_work_buffer1, _param_pack_tmp_file, _work_buffer1_len);
+
+	} else
+#endif /* MAVLINK_FTP_UNIT_TEST */
+	{
+		strncpy(_work_buffer1, _root_dir, _work_buffer1_len);
+		strncpy(_work_buffer1 + _root_dir_len, path, _work_buffer1_len - _root_dir_len);
+	}
 
 	PX4_DEBUG("FTP: open '%s'", _work_buffer1);
 
@@ -540,6 +563,7 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 	_session_info.fd = fd;
 	_session_info.file_size = fileSize;
 	_session_info.stream_download = false;
+	_read_ahead_length = 0;
 
 	payload->session = 0;
 	payload->size = sizeof(uint32_t);
@@ -548,6 +572,35 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 	return kErrNone;
 }
 
+#ifndef MAVLINK_FTP_UNIT_TEST
+MavlinkFTP::ErrorCode
+MavlinkFTP::_writeParamPack(const char *query)
+{
+	// one file per instance, so that writing it does not truncate a file another instance is sending
+	snprintf(_param_pack_tmp_file, sizeof(_param_pack_tmp_file), PX4_STORAGEDIR "/.param%d.pck",
+		 _mavlink->get_instance_id());
+
+	int fd = ::open(_param_pack_tmp_file, O_CREAT | O_TRUNC | O_WRONLY, PX4_O_MODE_666);
+
+	if (fd < 0) {
+		_our_errno = errno;
+		PX4_ERR("open failed: %s", strerror(_our_errno));
+		return kErrFailErrno;
+	}
+
+	int ret = MavlinkParamPack::write(fd, query ? query + 1 : nullptr);
+	::close(fd);
+
+	if (ret != 0) {
+		_our_errno = -ret;
+		PX4_ERR("param pack failed: %s", strerror(_our_errno));
+		return kErrFailErrno;
+	}
+
+	return kErrNone;
+}
+#endif /* MAVLINK_FTP_UNIT_TEST */
+
 /// @brief Responds to a Read command
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workRead(PayloadHeader *payload)
@@ -564,19 +617,11 @@ MavlinkFTP::_workRead(PayloadHeader *payload)
 		return kErrEOF;
 	}
 
-	PX4_DEBUG("lseek with offset: %d", payload->offset);
-
-	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-		_our_errno = errno;
-		PX4_ERR("seek fail: %s", strerror(_our_errno));
-		return kErrFailErrno;
-	}
-
-	int bytes_read = ::read(_session_info.fd, &payload->data[0], payload->size);
+	// this is also how the GCS re-requests data it missed during a burst
+	int bytes_read = _readSessionFile(payload->offset, &payload->data[0], payload->size);
 
 	if (bytes_read < 0) {
 		// Negative return indicates error other than eof
-		_our_errno = errno;
 		PX4_ERR("read fail %d, %s", bytes_read, strerror(_our_errno));
 		return kErrFailErrno;
 	}
@@ -603,6 +648,10 @@ MavlinkFTP::_workBurst(PayloadHeader *payload, uint8_t target_system_id, uint8_t
 	_session_info.stream_seq_number = payload->seq_number + 1;
 	_session_info.stream_target_system_id = target_system_id;
 	_session_info.stream_target_component_id = target_component_id;
+#ifndef MAVLINK_FTP_UNIT_TEST
+	_burst_window = _mavlink->get_ftp_burst_window();
+#endif
+	_session_info.stream_window = (_burst_window > 0) ? _burst_window : UINT32_MAX;
 
 	return kErrNone;
 }
@@ -797,9 +846,7 @@ MavlinkFTP::_workTerminate(PayloadHeader *payload)
 	}
 
 	PX4_DEBUG("work terminate: close");
-	::close(_session_info.fd);
-	_session_info.fd = -1;
-	_session_info.stream_download = false;
+	_closeSession();
 
 	payload->size = 0;
 
@@ -813,9 +860,7 @@ MavlinkFTP::_workReset(PayloadHeader *payload)
 	PX4_DEBUG("work reset: close");
 
 	if (_session_info.fd != -1) {
-		::close(_session_info.fd);
-		_session_info.fd = -1;
-		_session_info.stream_download = false;
+		_closeSession();
 	}
 
 	payload->size = 0;
@@ -1044,11 +1089,9 @@ void MavlinkFTP::send()
 		}
 
 	} else if (_session_info.fd != -1) {
-		// close session without activity
-		if (hrt_elapsed_time(&_last_work_buffer_access) > 10_s) {
-			::close(_session_info.fd);
-			_session_info.fd = -1;
-			_session_info.stream_download = false;
+		// close session without activity. Only GCS requests count as activity, a running burst does not.
+		if (hrt_elapsed_time(&_last_work_buffer_access) > kSessionTimeout) {
+			_closeSession();
 			_last_reply_valid = false;
 			PX4_WARN("Session was closed without activity");
 		}
@@ -1064,7 +1107,8 @@ void MavlinkFTP::send()
 	unsigned max_bytes_to_send = _mavlink->get_free_tx_buf();
 	PX4_DEBUG("MavlinkFTP::send max_bytes_to_send(%u) get_free_tx_buf(%u)", max_bytes_to_send, _mavlink->get_free_tx_buf());
 
-	if (max_bytes_to_send < get_size()) {
+	if ((max_bytes_to_send < get_size())
+	    || !_mavlink->tx_allowed(MavlinkBandwidthShaper::Priority::BULK, get_size())) {
 		return;
 	}
 
@@ -1098,20 +1142,17 @@ void MavlinkFTP::send()
 		}
 
 		if (error_code == kErrNone) {
-			if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-				error_code = kErrFailErrno;
-				PX4_WARN("stream download: seek fail");
-			}
-		}
-
-		if (error_code == kErrNone) {
-			int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+			int bytes_read = _readSessionFile(payload->offset, &payload->data[0], kMaxDataLength);
 
 			if (bytes_read < 0) {
 				// Negative return indicates error other than eof
 				error_code = kErrFailErrno;
 				PX4_WARN("stream download: read fail");
 
+			} else if (bytes_read == 0) {
+				// the file was truncated after it was opened
+				error_code = kErrEOF;
+
 			} else {
 				payload->size = bytes_read;
 				_session_info.stream_offset += bytes_read;
@@ -1132,24 +1173,27 @@ void MavlinkFTP::send()
 
 			_session_info.stream_download = false;
 
+		} else if (_session_info.stream_chunk_transmitted >= _session_info.stream_window
+			   || hrt_elapsed_time(&_last_work_buffer_access) > kSessionTimeout / 2) {
+			// end of the burst window: the GCS re-requests what it missed and continues with the next burst.
+			// The burst is also completed early on a slow link, so that the GCS reply keeps the session alive.
+			payload->burst_complete = true;
+			_session_info.stream_download = false;
+			_session_info.stream_chunk_transmitted = 0;
+
 		} else {
+			payload->burst_complete = false;
+			more_data = true;
+
 #ifndef MAVLINK_FTP_UNIT_TEST
 
-			if (max_bytes_to_send < (get_size() * 2)) {
+			if ((max_bytes_to_send < (get_size() * 2))
+			    || !_mavlink->tx_allowed(MavlinkBandwidthShaper::Priority::BULK, get_size())) {
+				// transmit buffer full or the bandwidth is used by other messages: pause the burst,
+				// it continues with the next call
 				more_data = false;
 
-				/* perform transfers in 35K chunks - this is determined empirical */
-				if (_session_info.stream_chunk_transmitted > 35000) {
-					payload->burst_complete = true;
-					_session_info.stream_download = false;
-					_session_info.stream_chunk_transmitted = 0;
-				}
-
 			} else {
-#endif
-				more_data = true;
-				payload->burst_complete = false;
-#ifndef MAVLINK_FTP_UNIT_TEST
 				max_bytes_to_send -= get_size();
 			}
 
@@ -1163,6 +1207,70 @@ void MavlinkFTP::send()
 	} while (more_data);
 }
 
+int MavlinkFTP::_readSessionFile(uint32_t offset, uint8_t *data, unsigned length)
+{
+	if (offset >= _session_info.file_size) {
+		return 0;
+	}
+
+	if (length > _session_info.file_size - offset) {
+		length = _session_info.file_size - offset;
+	}
+
+	if (_read_ahead_buffer == nullptr) {
+		_read_ahead_buffer = new uint8_t[_read_ahead_buffer_len];
+		_read_ahead_length = 0;
+
+		if (_read_ahead_buffer == nullptr) {
+			_our_errno = ENOMEM;
+			return -1;
+		}
+	}
+
+	const uint32_t read_ahead_end = _read_ahead_offset + _read_ahead_length;
+	unsigned copied = 0;
+
+	if (offset >= _read_ahead_offset && offset < read_ahead_end) {
+		// the data is already in the buffer, e.g. a re-request of a packet the GCS missed during a burst
+		copied = (length < read_ahead_end - offset) ? length : read_ahead_end - offset;
+		memcpy(data, _read_ahead_buffer + (offset - _read_ahead_offset), copied);
+	}
+
+	if (copied < length) {
+		// refill the buffer with what follows. The file may have been truncated since it was opened,
+		// in which case fewer bytes than expected are returned.
+		const uint32_t refill_offset = offset + copied;
+		_read_ahead_length = 0;
+
+		int bytes_read = ::pread(_session_info.fd, _read_ahead_buffer, _read_ahead_buffer_len, refill_offset);
+
+		if (bytes_read < 0) {
+			_our_errno = errno;
+			return (copied > 0) ? (int)copied : -1;
+		}
+
+		_read_ahead_offset = refill_offset;
+		_read_ahead_length = bytes_read;
+
+		const unsigned remaining = (length - copied < (unsigned)bytes_read) ? length - copied : bytes_read;
+		memcpy(data + copied, _read_ahead_buffer, remaining);
+		copied += remaining;
+	}
+
+	return copied;
+}
+
+void MavlinkFTP::_closeSession()
+{
+	::close(_session_info.fd);
+	_session_info.fd = -1;
+	_session_info.stream_download = false;
+
+	delete[] _read_ahead_buffer;
+	_read_ahead_buffer = nullptr;
+	_read_ahead_length = 0;
+}
+
 bool MavlinkFTP::_validatePathIsWritable(const char *path)
 {
 #ifdef __PX4_NUTTX
@@ -151,12 +151,25 @@ private:
 	ErrorCode	_workRename(PayloadHeader *payload);
 	ErrorCode	_workCalcFileCRC32(PayloadHeader *payload);
 
+	/// write the packed parameters (MavlinkParamPack) to _param_pack_tmp_file
+	ErrorCode	_writeParamPack(const char *query);
+
 	uint8_t _getServerSystemId(void);
 	uint8_t _getServerComponentId(void);
 	uint8_t _getServerChannel(void);
 
 	bool _validatePathIsWritable(const char *path);
 
+	/**
+	 * Read data of the open session file through the read-ahead buffer, so that downloads do not need a read
+	 * for every message. The file is not mapped into memory, as it may be truncated while it is read.
+	 * @return number of bytes read (0 at EOF), or -1 on error (_our_errno is set)
+	 */
+	int _readSessionFile(uint32_t offset, uint8_t *data, unsigned length);
+
+	/// close the session file and free the resources used for reading it
+	void _closeSession();
+
 	/**
 	 * make sure that the working buffers _work_buffer* are allocated
 	 * @return true if buffers exist, false if allocation failed
@@ -179,6 +192,7 @@ private:
 		uint8_t		stream_target_system_id;
 		uint8_t         stream_target_component_id;
 		unsigned	stream_chunk_transmitted;
+		uint32_t	stream_window;		///< number of bytes sent before the burst is completed
 	};
 	struct SessionInfo _session_info {};	///< Session info, fd=-1 for no active session
 
@@ -198,6 +212,23 @@ private:
 	static constexpr int _work_buffer2_len = 256;
 	hrt_abstime _last_work_buffer_access{0}; ///< timestamp when the buffers were last accessed
 
+	static constexpr hrt_abstime kSessionTimeout = 10 * 1000 * 1000; ///< close a session without GCS requests [us]
+
+	/* read-ahead buffer for the session file, allocated on the first read */
+	uint8_t *_read_ahead_buffer{nullptr};
+#if defined(__PX4_NUTTX)
+	static constexpr int _read_ahead_buffer_len = 1024;
+#else
+	static constexpr int _read_ahead_buffer_len = 16384;
+#endif
+	uint32_t _read_ahead_offset{0};	///< file offset of the read-ahead buffer contents
+	int _read_ahead_length{0};	///< number of valid bytes in the read-ahead buffer
+
+	/// Number of bytes sent in a burst before it is completed (the GCS then requests missing data and the next burst).
+	/// The burst is paused, not completed, if the transmit buffer is full.
+	static constexpr uint32_t kDefaultBurstWindow = 256 * 1024;
+	uint32_t _burst_window{kDefaultBurstWindow};
+
 	// prepend a root directory to each file/dir access to avoid enumerating the full FS tree (e.g. on Linux).
 	// Note that requests can still fall outside of the root dir by using ../..
 #ifdef MAVLINK_FTP_UNIT_TEST
@@ -207,6 +238,10 @@ private:
 #endif
 	static constexpr const int _root_dir_len = sizeof(_root_dir) - 1;
 
+#ifndef MAVLINK_FTP_UNIT_TEST
+	char _param_pack_tmp_file[sizeof(PX4_STORAGEDIR "/.param00.pck")] {};
+#endif
+
 	bool _last_reply_valid = false;
 	uint8_t _last_reply[MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN - MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN
 								      + sizeof(PayloadHeader) + sizeof(uint32_t)];
@@ -131,7 +131,9 @@ MavlinkLogHandler::send()
 	//-- Log Data
 	while (_current_status == LogHandlerState::SendingData
 	       && _mavlink->get_free_tx_buf() > MAVLINK_MSG_ID_LOG_DATA_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES
-	       && count < MAX_BYTES_SEND) {
+	       && count < MAX_BYTES_SEND
+	       && _mavlink->tx_allowed(MavlinkBandwidthShaper::Priority::BULK,
+				       MAVLINK_MSG_ID_LOG_DATA_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES)) {
 		count += _log_send_data();
 	}
 }
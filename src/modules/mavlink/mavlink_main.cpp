@@ -738,18 +738,83 @@ void Mavlink::send_start(int length)
 		count_txerrbytes(length);
 
 		_tstatus.tx_buffer_overruns++;
+		_bandwidth_shaper.set_headroom(0.f);
 
 		// prevent writes
 		_tx_buffer_low = true;
 
 	} else {
 		_tx_buffer_low = false;
+
+		// only the main and the receiver thread set the priority, everything else is protocol traffic
+		MavlinkBandwidthShaper::Priority priority = MavlinkBandwidthShaper::Priority::HIGH;
+
+		if (pthread_equal(pthread_self(), _main_thread)) {
+			priority = _tx_priority;
+
+		} else if (pthread_equal(pthread_self(), _receiver.get_thread())) {
+			priority = _receiver_tx_priority;
+		}
+
+		_bandwidth_shaper.consume(priority, length);
+	}
+}
+
+bool Mavlink::tx_allowed(MavlinkBandwidthShaper::Priority priority, unsigned bytes)
+{
+	// the receiver thread checks as well
+	pthread_mutex_lock(&_send_mutex);
+	const bool allowed = _bandwidth_shaper.check(priority, bytes);
+	pthread_mutex_unlock(&_send_mutex);
+
+	return allowed;
+}
+
+void Mavlink::set_tx_priority(MavlinkBandwidthShaper::Priority priority)
+{
+	if (pthread_equal(pthread_self(), _main_thread)) {
+		_tx_priority = priority;
+
+	} else if (pthread_equal(pthread_self(), _receiver.get_thread())) {
+		_receiver_tx_priority = priority;
+	}
+}
+
+void Mavlink::set_data_rate(int rate)
+{
+	if (rate > 0) {
+		pthread_mutex_lock(&_send_mutex);
+		_datarate = rate;
+		_bandwidth_shaper.set_rate(_datarate);
+		pthread_mutex_unlock(&_send_mutex);
 	}
 }
 
 void Mavlink::send_finish()
 {
-	if (_tx_buffer_low || (_buf_fill == 0)) {
+	if (_tx_buffer_low) {
+		pthread_mutex_unlock(&_send_mutex);
+		return;
+	}
+
+#if defined(MAVLINK_UDP_BATCH)
+
+	if (get_protocol() == Protocol::UDP) {
+		// queue the packet, it is sent with the others of this loop iteration on send_flush(), or earlier if the batch is
+		// full or has been waiting too long, e.g. for replies sent from the receiver thread
+		const hrt_abstime now = hrt_absolute_time();
+
+		if (_udp_tx_batch.finish_packet(now) && _udp_tx_batch.flush_required(now)) {
+			udp_batch_flush();
+		}
+
+		pthread_mutex_unlock(&_send_mutex);
+		return;
+	}
+
+#endif // MAVLINK_UDP_BATCH
+
+	if (_buf_fill == 0) {
 		pthread_mutex_unlock(&_send_mutex);
 		return;
 	}
@@ -775,26 +840,18 @@ void Mavlink::send_finish()
 
 # endif // CONFIG_NET
 
-		if ((_mode != MAVLINK_MODE_ONBOARD) && broadcast_enabled() &&
-		    (!get_client_source_initialized() || !is_gcs_connected())) {
-
-			if (!_broadcast_address_found) {
-				find_broadcast_address();
-			}
-
-			if (_broadcast_address_found && _buf_fill > 0) {
+		if (udp_broadcast_required() && _buf_fill > 0) {
 
-				int bret = sendto(_socket_fd, _buf, _buf_fill, 0, (struct sockaddr *)&_bcast_addr, sizeof(_bcast_addr));
-
-				if (bret <= 0) {
-					if (!_broadcast_failed_warned) {
-						PX4_ERR("sending broadcast failed, errno: %d: %s", errno, strerror(errno));
-						_broadcast_failed_warned = true;
-					}
+			int bret = sendto(_socket_fd, _buf, _buf_fill, 0, (struct sockaddr *)&_bcast_addr, sizeof(_bcast_addr));
 
-				} else {
-					_broadcast_failed_warned = false;
+			if (bret <= 0) {
+				if (!_broadcast_failed_warned) {
+					PX4_ERR("sending broadcast failed, errno: %d: %s", errno, strerror(errno));
+					_broadcast_failed_warned = true;
 				}
+
+			} else {
+				_broadcast_failed_warned = false;
 			}
 		}
 	}
@@ -808,6 +865,7 @@ void Mavlink::send_finish()
 
 	} else {
 		count_txerrbytes(_buf_fill);
+		_bandwidth_shaper.set_headroom(0.f);
 	}
 
 	_buf_fill = 0;
@@ -818,6 +876,19 @@ void Mavlink::send_finish()
 void Mavlink::send_bytes(const uint8_t *buf, unsigned packet_len)
 {
 	if (!_tx_buffer_low) {
+#if defined(MAVLINK_UDP_BATCH)
+
+		if (get_protocol() == Protocol::UDP) {
+			// assemble the packet directly in its batch slot
+			if (!_udp_tx_batch.append(buf, packet_len)) {
+				perf_count(_send_byte_error_perf);
+			}
+
+			return;
+		}
+
+#endif // MAVLINK_UDP_BATCH
+
 		if (_buf_fill + packet_len < sizeof(_buf)) {
 			memcpy(&_buf[_buf_fill], buf, packet_len);
 			_buf_fill += packet_len;
@@ -828,7 +899,71 @@ void Mavlink::send_bytes(const uint8_t *buf, unsigned packet_len)
 	}
 }
 
+void Mavlink::send_flush()
+{
+#if defined(MAVLINK_UDP_BATCH)
+
+	if (get_protocol() == Protocol::UDP) {
+		pthread_mutex_lock(&_send_mutex);
+		udp_batch_flush();
+		pthread_mutex_unlock(&_send_mutex);
+	}
+
+#endif // MAVLINK_UDP_BATCH
+}
+
 #ifdef MAVLINK_UDP
+bool Mavlink::udp_broadcast_required()
+{
+	if ((_mode != MAVLINK_MODE_ONBOARD) && broadcast_enabled() &&
+	    (!get_client_source_initialized() || !is_gcs_connected())) {
+
+		if (!_broadcast_address_found) {
+			find_broadcast_address();
+		}
+
+		return _broadcast_address_found;
+	}
+
+	return false;
+}
+
+# if defined(MAVLINK_UDP_BATCH)
+void Mavlink::udp_batch_flush()
+{
+	if (_udp_tx_batch.empty()) {
+		return;
+	}
+
+	static_assert(MAVLINK_MAX_PACKET_LEN <= MavlinkUdpTxBatch::PACKET_LEN_MAX, "UDP batch slots too small");
+
+	const bool broadcast = udp_broadcast_required();
+	const MavlinkUdpTxBatch::Result result = _udp_tx_batch.flush(_socket_fd, _src_addr,
+			broadcast ? &_bcast_addr : nullptr);
+
+	if (result.broadcast_errno != 0) {
+		if (!_broadcast_failed_warned) {
+			PX4_ERR("sending broadcast failed, errno: %d: %s", result.broadcast_errno, strerror(result.broadcast_errno));
+			_broadcast_failed_warned = true;
+		}
+
+	} else if (broadcast) {
+		_broadcast_failed_warned = false;
+	}
+
+	if (result.packets_sent > 0) {
+		_tstatus.tx_message_count += result.packets_sent;
+		count_txbytes(result.bytes_sent);
+		_last_write_success_time = _last_write_try_time;
+	}
+
+	if (result.packets_failed > 0) {
+		count_txerrbytes(result.bytes_failed);
+		_bandwidth_shaper.set_headroom(0.f);
+	}
+}
+# endif // MAVLINK_UDP_BATCH
+
 void Mavlink::find_broadcast_address()
 {
 	struct ifconf ifconf;
@@ -1160,6 +1295,7 @@ Mavlink::configure_stream(const char *stream_name, const float rate)
 			} else {
 				/* delete stream */
 				_streams.deleteNode(stream);
+				_stream_scheduler.invalidate();
 				return OK; // must finish with loop after node is deleted
 			}
 
@@ -1367,19 +1503,27 @@ Mavlink::close_shell()
 void
 Mavlink::update_rate_mult()
 {
-	float const_rate = 0.0f;
-	float rate = 0.0f;
+	/* scale down rates if their theoretical bandwidth is exceeding the link bandwidth,
+	 * the stream bandwidth rarely changes and is only summed up at 10 Hz instead of polling all streams */
+	if (hrt_elapsed_time(&_stream_bandwidth_timestamp) >= 100_ms) {
+		_stream_bandwidth_timestamp = hrt_absolute_time();
+		_stream_bandwidth_const_rate = 0.0f;
+		_stream_bandwidth = 0.0f;
 
-	/* scale down rates if their theoretical bandwidth is exceeding the link bandwidth */
-	for (const auto &stream : _streams) {
-		if (stream->const_rate()) {
-			const_rate += (stream->get_interval() > 0) ? stream->get_size_avg() * 1000000.0f / stream->get_interval() : 0;
+		for (const auto &stream : _streams) {
+			if (stream->const_rate()) {
+				_stream_bandwidth_const_rate += (stream->get_interval() > 0) ? stream->get_size_avg() * 1000000.0f /
+								stream->get_interval() : 0;
 
-		} else {
-			rate += (stream->get_interval() > 0) ? stream->get_size_avg() * 1000000.0f / stream->get_interval() : 0;
+			} else {
+				_stream_bandwidth += (stream->get_interval() > 0) ? stream->get_size_avg() * 1000000.0f / stream->get_interval() : 0;
+			}
 		}
 	}
 
+	const float const_rate = _stream_bandwidth_const_rate;
+	const float rate = _stream_bandwidth;
+
 	float mavlink_ulog_streaming_rate_inv = 1.0f;
 
 	if (_mavlink_ulog) {
@@ -1405,18 +1549,17 @@ Mavlink::update_rate_mult()
 
 	} else if (_radio_status_available) {
 
-		// check for RADIO_STATUS timeout and reset
+		// check for RADIO_STATUS timeout and reset, the RADIO_STATUS back-off itself is applied once, to the link
+		// rate of the bandwidth shaper (see update_bandwidth_shaper()), which stretches the stream intervals through
+		// the class rate multipliers
 		if (hrt_elapsed_time(&_rstatus.timestamp) > (_param_mav_radio_timeout.get() * 1_s)) {
 			_radio_status_available = false;
 			log_radio_timeout = true;
 
 			if (_use_software_mav_throttling) {
 				_radio_status_critical = false;
-				_radio_status_mult = 1.0f;
 			}
 		}
-
-		hardware_mult *= _radio_status_mult;
 	}
 
 	pthread_mutex_unlock(&_radio_status_mutex);
@@ -1433,32 +1576,55 @@ Mavlink::update_rate_mult()
 }
 
 void
-Mavlink::update_radio_status(const radio_status_s &radio_status)
+Mavlink::update_bandwidth_shaper(const hrt_abstime &t)
 {
+	float headroom = 1.f;
+
+#if defined(__PX4_NUTTX)
+
+	if (get_protocol() == Protocol::SERIAL) {
+		// the largest free space seen is taken as the size of the TX buffer
+		const unsigned buf_free = get_free_tx_buf();
+		_tx_buf_size = math::max(_tx_buf_size, buf_free);
+
+		if (_tx_buf_size > 0) {
+			headroom = (float)buf_free / _tx_buf_size;
+		}
+	}
+
+#endif // __PX4_NUTTX
+
 	pthread_mutex_lock(&_radio_status_mutex);
-	_rstatus = radio_status;
-	_radio_status_available = true;
 
-	if (_use_software_mav_throttling) {
+	// every RADIO_STATUS is taken into account once, this is the only place the RADIO_STATUS back-off is applied
+	if (_radio_status_available && (_rstatus.timestamp != _radio_status_shaper_timestamp)) {
+		_radio_status_shaper_timestamp = _rstatus.timestamp;
+		headroom = fminf(headroom, _rstatus.txbuf / 100.f);
+	}
 
-		/* check hardware limits */
-		_radio_status_critical = (radio_status.txbuf < RADIO_BUFFER_LOW_PERCENTAGE);
+	pthread_mutex_unlock(&_radio_status_mutex);
 
-		if (radio_status.txbuf < RADIO_BUFFER_CRITICAL_LOW_PERCENTAGE) {
-			/* this indicates link congestion, reduce rate by 20% */
-			_radio_status_mult *= 0.80f;
+	// the receiver thread consumes tokens as well
+	pthread_mutex_lock(&_send_mutex);
+	_bandwidth_shaper.set_headroom(headroom);
+	const bool class_mult_changed = _bandwidth_shaper.update(t);
+	pthread_mutex_unlock(&_send_mutex);
 
-		} else if (radio_status.txbuf < RADIO_BUFFER_LOW_PERCENTAGE) {
-			/* this indicates link congestion, reduce rate by 2.5% */
-			_radio_status_mult *= 0.975f;
+	if (class_mult_changed) {
+		invalidate_stream_schedule();
+	}
+}
 
-		} else if (radio_status.txbuf > RADIO_BUFFER_HALF_PERCENTAGE) {
-			/* this indicates spare bandwidth, increase by 2.5% */
-			_radio_status_mult *= 1.025f;
-		}
+void
+Mavlink::update_radio_status(const radio_status_s &radio_status)
+{
+	pthread_mutex_lock(&_radio_status_mutex);
+	_rstatus = radio_status;
+	_radio_status_available = true;
 
-		/* Constrain radio status multiplier between 1% and 100% to allow recovery */
-		_radio_status_mult = math::constrain(_radio_status_mult, 0.01f, 1.0f);
+	if (_use_software_mav_throttling) {
+		/* check hardware limits, the rate is reduced by the bandwidth shaper */
+		_radio_status_critical = (radio_status.txbuf < RADIO_BUFFER_LOW_PERCENTAGE);
 	}
 
 	pthread_mutex_unlock(&_radio_status_mutex);
@@ -2209,6 +2375,9 @@ Mavlink::task_main(int argc, char *argv[])
 		_main_loop_delay = MAVLINK_MAX_INTERVAL;
 	}
 
+	_bandwidth_shaper.set_rate(_datarate);
+	_main_thread = pthread_self();
+
 	/* open the UART device after setting the instance, as it might block */
 	if (get_protocol() == Protocol::SERIAL) {
 		_uart_fd = mavlink_open_uart(_baudrate, _device_name, _flow_control);
@@ -2258,6 +2427,7 @@ Mavlink::task_main(int argc, char *argv[])
 		const hrt_abstime t = hrt_absolute_time();
 
 		update_rate_mult();
+		update_bandwidth_shaper(t);
 
 		// check for parameter updates
 		if (_parameter_update_sub.updated()) {
@@ -2357,6 +2527,8 @@ Mavlink::task_main(int argc, char *argv[])
 		if (_vehicle_command_ack_sub.updated()) {
 			static constexpr size_t COMMAND_ACK_TOTAL_LEN = MAVLINK_MSG_ID_COMMAND_ACK_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 
+			set_tx_priority(MavlinkBandwidthShaper::Priority::CRITICAL);
+
 			while ((get_free_tx_buf() >= COMMAND_ACK_TOTAL_LEN) && _vehicle_command_ack_sub.updated()) {
 				vehicle_command_ack_s command_ack;
 				const unsigned last_generation = _vehicle_command_ack_sub.get_last_generation();
@@ -2392,6 +2564,8 @@ Mavlink::task_main(int argc, char *argv[])
 					}
 				}
 			}
+
+			set_tx_priority(MavlinkBandwidthShaper::Priority::HIGH);
 		}
 
 		// For legacy gimbals using the mavlink gimbal v1 protocol, we need to send out commands.
@@ -2433,11 +2607,11 @@ Mavlink::task_main(int argc, char *argv[])
 
 		check_requested_subscriptions();
 
-		/* update streams */
-		for (const auto &stream : _streams) {
-			stream->update(t);
+		/* update streams that are due */
+		_stream_scheduler.update(_streams, t, _rate_mult);
 
-			if (!_first_heartbeat_sent) {
+		if (!_first_heartbeat_sent) {
+			for (const auto &stream : _streams) {
 				if (_mode == MAVLINK_MODE_IRIDIUM) {
 					if (stream->get_id() == MAVLINK_MSG_ID_HIGH_LATENCY2) {
 						_first_heartbeat_sent = stream->first_message_sent();
@@ -2462,7 +2636,9 @@ Mavlink::task_main(int argc, char *argv[])
 					_mavlink_ulog->start_ack_received();
 				}
 
-				int ret = _mavlink_ulog->handle_update(get_channel());
+				set_tx_priority(MavlinkBandwidthShaper::Priority::BULK);
+				int ret = _mavlink_ulog->handle_update(this);
+				set_tx_priority(MavlinkBandwidthShaper::Priority::HIGH);
 
 				if (ret < 0) { //abort the streaming on error
 					if (ret != -1) {
@@ -2551,6 +2727,9 @@ Mavlink::task_main(int argc, char *argv[])
 			}
 		}
 
+		// send the packets queued in this iteration
+		send_flush();
+
 		/* update TX/RX rates*/
 		if (t > _bytes_timestamp + 1_s) {
 			if (_bytes_timestamp != 0) {
@@ -2901,6 +3080,18 @@ Mavlink::display_status()
 	printf("\t  tx rate max: %i B/s\n", _datarate);
 	printf("\t  rx: %.1f B/s\n", (double)_tstatus.rx_rate_avg);
 	printf("\t  rx loss: %.1f%%\n", (double)_tstatus.rx_message_lost_rate);
+	printf("\tbandwidth shaper: %.1f B/s (link mult %.3f), tokens %.0f of %.0f B\n",
+	       (double)_bandwidth_shaper.get_rate(), (double)_bandwidth_shaper.get_link_mult(),
+	       (double)_bandwidth_shaper.get_tokens(), (double)_bandwidth_shaper.get_bucket_size());
+
+	for (int i = 0; i < MavlinkBandwidthShaper::PRIORITY_COUNT; i++) {
+		const MavlinkBandwidthShaper::Priority priority = static_cast<MavlinkBandwidthShaper::Priority>(i);
+		printf("\t  %-8s tx: %.1f B/s, rate mult: %.3f, deferred: %" PRIu32 "\n",
+		       MavlinkBandwidthShaper::priority_str(priority),
+		       (double)_bandwidth_shaper.get_class_rate(priority),
+		       (double)_bandwidth_shaper.get_class_mult(priority),
+		       _bandwidth_shaper.get_deferred_count(priority));
+	}
 
 #if !defined(CONSTRAINED_FLASH)
 	_receiver.print_detailed_rx_stats();
@@ -2937,6 +3128,15 @@ Mavlink::display_status()
 		}
 
 #endif
+#if defined(MAVLINK_UDP_BATCH)
+		{
+			const MavlinkUdpRxBatch &rx_batch = _receiver.get_udp_rx_batch();
+
+			printf("\tdatagrams per syscall: tx %.2f (sendmmsg), rx %.2f (recvmmsg)\n",
+			       (double)_udp_tx_batch.get_datagram_count() / math::max(_udp_tx_batch.get_syscall_count(), 1u),
+			       (double)rx_batch.get_datagram_count() / math::max(rx_batch.get_syscall_count(), 1u));
+		}
+#endif // MAVLINK_UDP_BATCH
 		break;
 #endif // MAVLINK_UDP
 
@@ -2958,9 +3158,10 @@ Mavlink::display_status()
 void
 Mavlink::display_status_streams()
 {
-	printf("\t%-20s%-16s %s\n", "Name", "Rate Config (current) [Hz]", "Message Size (if active) [B]");
+	printf("\tstreams updated per iteration: %.2f of %u, schedule rebuilds: %u\n",
+	       (double)_stream_scheduler.get_updates_per_loop(), (unsigned)_streams.size(), _stream_scheduler.get_rebuild_count());
 
-	const float rate_mult = _rate_mult;
+	printf("\t%-20s%-16s %-12s %s\n", "Name", "Rate Config (current) [Hz]", "Send [us]", "Message Size (if active) [B]");
 
 	for (const auto &stream : _streams) {
 		const int interval = stream->get_interval();
@@ -2974,11 +3175,11 @@ Mavlink::display_status_streams()
 			float rate = 1000000.0f / (float)interval;
 			// Note that the actual current rate can be lower if the associated uORB topic updates at a
 			// lower rate.
-			float rate_current = stream->const_rate() ? rate : rate * rate_mult;
+			float rate_current = stream->const_rate() ? rate : rate * get_rate_mult(stream->get_priority());
 			snprintf(rate_str, sizeof(rate_str), "%6.2f (%.3f)", (double)rate, (double)rate_current);
 		}
 
-		printf("\t%-30s%-16s", stream->get_name(), rate_str);
+		printf("\t%-30s%-16s %9.1f", stream->get_name(), rate_str, (double)stream->get_send_time_avg());
 
 		if (size > 0) {
 			printf(" %3u\n", size);
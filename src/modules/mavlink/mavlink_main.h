@@ -81,8 +81,11 @@
 #include "mavlink_command_sender.h"
 #include "mavlink_events.h"
 #include "mavlink_messages.h"
+#include "mavlink_rate_limiter.h"
 #include "mavlink_receiver.h"
 #include "mavlink_shell.h"
+#include "mavlink_stream_scheduler.h"
+#include "mavlink_udp_batch.h"
 #include "mavlink_ulog.h"
 
 #define DEFAULT_BAUD_RATE       57600
@@ -90,10 +93,9 @@
 
 #define HASH_PARAM              "_HASH_CHECK"
 
-#if defined(CONFIG_NET) || defined(__PX4_POSIX)
-# define MAVLINK_UDP
+#if defined(MAVLINK_UDP)
 # define DEFAULT_REMOTE_PORT_UDP 14550 ///< GCS port per MAVLink spec
-#endif // CONFIG_NET || __PX4_POSIX
+#endif // MAVLINK_UDP
 
 enum class Protocol {
 	SERIAL = 0,
@@ -338,6 +340,12 @@ public:
 	 */
 	void             	send_finish();
 
+	/**
+	 * Send the packets queued since the last call. This is only required for batched
+	 * UDP, every thread sending on the link calls it at the end of its loop iteration.
+	 */
+	void			send_flush();
+
 	/**
 	 * Resend message as is, don't change sequence number and CRC.
 	 */
@@ -404,8 +412,31 @@ public:
 
 	List<MavlinkStream *> &get_streams() { return _streams; }
 
+	/**
+	 * Rebuild the stream schedule, required after any change of the stream intervals or last sent times
+	 */
+	void			invalidate_stream_schedule() { _stream_scheduler.invalidate(); }
+
 	float			get_rate_mult() const { return _rate_mult; }
 
+	/**
+	 * @return rate multiplier of the streams of a priority class, the product of the stream bandwidth and TX error
+	 * scaling and of the class multiplier of the bandwidth shaper. RADIO_STATUS is only taken into account by the
+	 * bandwidth shaper.
+	 */
+	float			get_rate_mult(MavlinkBandwidthShaper::Priority priority) const { return _rate_mult * _bandwidth_shaper.get_class_mult(priority); }
+
+	/**
+	 * @return true if the bandwidth shaper allows to send a message of the priority class and size now
+	 */
+	bool			tx_allowed(MavlinkBandwidthShaper::Priority priority, unsigned bytes);
+
+	/**
+	 * Set the priority class the messages sent from the calling thread are accounted to,
+	 * only the main and the receiver thread can set it (messages of other threads are HIGH)
+	 */
+	void			set_tx_priority(MavlinkBandwidthShaper::Priority priority);
+
 	float			get_baudrate() { return _baudrate; }
 
 	/* Functions for waiting to start transmission until message received. */
@@ -474,7 +505,7 @@ public:
 	bool			is_usb_uart() { return _is_usb_uart; }
 
 	int			get_data_rate()		{ return _datarate; }
-	void			set_data_rate(int rate) { if (rate > 0) { _datarate = rate; } }
+	void			set_data_rate(int rate);
 
 	unsigned		get_main_loop_delay() const { return _main_loop_delay; }
 
@@ -495,6 +526,7 @@ public:
 
 	const events::SendProtocol &get_events_protocol() const { return _events; };
 	bool ftp_enabled() const { return _ftp_on; }
+	uint32_t get_ftp_burst_window() const { return _param_mav_ftp_burst.get() * 1024; }
 
 	bool hash_check_enabled() const { return _param_mav_hash_chk_en.get(); }
 	bool forward_heartbeats_enabled() const { return _param_mav_hb_forw_en.get(); }
@@ -566,6 +598,7 @@ private:
 	unsigned		_main_loop_delay{1000};	/**< mainloop delay, depends on data rate */
 
 	List<MavlinkStream *>		_streams;
+	MavlinkStreamScheduler		_stream_scheduler{};
 
 	MavlinkShell		*_mavlink_shell{nullptr};
 	MavlinkULog		*_mavlink_ulog{nullptr};
@@ -586,9 +619,21 @@ private:
 	int			_datarate{1000};		///< data rate for normal streams (attitude, position, etc.)
 	float			_rate_mult{1.0f};
 
+	hrt_abstime		_stream_bandwidth_timestamp{0};
+	float			_stream_bandwidth_const_rate{0.0f};	/**< bandwidth of the constant rate streams [B/s] */
+	float			_stream_bandwidth{0.0f};		/**< bandwidth of all other streams [B/s] */
+
 	bool			_radio_status_available{false};
 	bool			_radio_status_critical{false};
-	float			_radio_status_mult{1.0f};
+	hrt_abstime		_radio_status_shaper_timestamp{0};	///< last RADIO_STATUS passed to the bandwidth shaper
+
+	MavlinkBandwidthShaper	_bandwidth_shaper{};
+	MavlinkBandwidthShaper::Priority _tx_priority{MavlinkBandwidthShaper::Priority::HIGH};
+	MavlinkBandwidthShaper::Priority _receiver_tx_priority{MavlinkBandwidthShaper::Priority::HIGH};
+	pthread_t		_main_thread{};			///< thread of task_main()
+#if defined(__PX4_NUTTX)
+	unsigned		_tx_buf_size{0};		///< largest free TX buffer space seen
+#endif // __PX4_NUTTX
 
 	/**
 	 * If the queue index is not at 0, the queue sending
@@ -630,6 +675,10 @@ private:
 
 	unsigned short		_network_port{14556};
 	unsigned short		_remote_port{DEFAULT_REMOTE_PORT_UDP};
+
+# if defined(MAVLINK_UDP_BATCH)
+	MavlinkUdpTxBatch	_udp_tx_batch;		///< packets queued until send_flush(), protected by _send_mutex
+# endif // MAVLINK_UDP_BATCH
 #endif // MAVLINK_UDP
 
 	uint8_t			_buf[MAVLINK_MAX_PACKET_LEN] {};
@@ -673,6 +722,7 @@ private:
 		(ParamBool<px4::params::MAV_HB_FORW_EN>) _param_mav_hb_forw_en,
 		(ParamBool<px4::params::MAV_ODOM_LP>) _param_mav_odom_lp,
 		(ParamInt<px4::params::MAV_RADIO_TOUT>)      _param_mav_radio_timeout,
+		(ParamInt<px4::params::MAV_FTP_BURST>) _param_mav_ftp_burst,
 		(ParamInt<px4::params::SYS_HITL>) _param_sys_hitl,
 		(ParamBool<px4::params::SYS_FAILURE_EN>) _param_sys_failure_injection_enabled
 	)
@@ -687,9 +737,7 @@ private:
 			      const char *uart_name = DEFAULT_DEVICE_NAME,
 			      const FLOW_CONTROL_MODE flow_control = FLOW_CONTROL_AUTO);
 
-	static constexpr unsigned RADIO_BUFFER_CRITICAL_LOW_PERCENTAGE = 25;
 	static constexpr unsigned RADIO_BUFFER_LOW_PERCENTAGE = 35;
-	static constexpr unsigned RADIO_BUFFER_HALF_PERCENTAGE = 50;
 
 	static hrt_abstime _first_start_time;
 
@@ -740,10 +788,27 @@ private:
 	 */
 	void update_rate_mult();
 
+	/**
+	 * Pass the headroom of the transmit path to the bandwidth shaper and update it.
+	 */
+	void update_bandwidth_shaper(const hrt_abstime &t);
+
 #if defined(MAVLINK_UDP)
 	void find_broadcast_address();
 
+	/**
+	 * @return true if the packets have to be sent to the broadcast address as well
+	 */
+	bool udp_broadcast_required();
+
 	void init_udp();
+
+# if defined(MAVLINK_UDP_BATCH)
+	/**
+	 * Send the queued UDP packets, _send_mutex has to be held
+	 */
+	void udp_batch_flush();
+# endif // MAVLINK_UDP_BATCH
 #endif // MAVLINK_UDP
 
 
@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_message_dispatch.h
+ * Lookup of the handlers of a received message by msgid.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Index of a table of message handlers by msgid. Handler is any type with a msgid member,
+ * several entries of the table can have the same msgid.
+ *
+ * The msgids below DIRECT_SIZE (the common message set) are looked up directly,
+ * the others with a search of the table.
+ */
+template<typename Handler, uint8_t MAX_HANDLERS>
+class MavlinkMessageDispatch
+{
+public:
+	static constexpr uint16_t DIRECT_SIZE{512};
+
+	MavlinkMessageDispatch() { init(nullptr, 0); }
+
+	/**
+	 * Index a table of handlers, the table has to outlive the dispatch
+	 *
+	 * @return false if the table has more than MAX_HANDLERS entries, none of them is used then
+	 */
+	bool init(const Handler *handlers, uint8_t num_handlers)
+	{
+		for (auto &first : _first) {
+			first = NO_HANDLER;
+		}
+
+		if (num_handlers > MAX_HANDLERS) {
+			_handlers = nullptr;
+			_num_handlers = 0;
+			return false;
+		}
+
+		_handlers = handlers;
+		_num_handlers = num_handlers;
+
+		// chain the handlers of the same msgid in the order of the table
+		for (uint8_t i = 0; i < num_handlers; i++) {
+			const uint32_t msgid = handlers[i].msgid;
+			_next[i] = NO_HANDLER;
+
+			if (msgid < DIRECT_SIZE) {
+				uint8_t *link = &_first[msgid];
+
+				while (*link != NO_HANDLER) {
+					link = &_next[*link];
+				}
+
+				*link = i;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * Call func(index) for every handler of msgid, in the order of the table
+	 */
+	template<typename Func>
+	void for_each_handler(uint32_t msgid, Func func) const
+	{
+		if (msgid < DIRECT_SIZE) {
+			for (uint8_t i = _first[msgid]; i != NO_HANDLER; i = _next[i]) {
+				func(i);
+			}
+
+		} else {
+			// messages with a large id are rare, look them up in the table
+			for (uint8_t i = 0; i < _num_handlers; i++) {
+				if (_handlers[i].msgid == msgid) {
+					func(i);
+				}
+			}
+		}
+	}
+
+private:
+	static constexpr uint8_t NO_HANDLER{UINT8_MAX};
+	static_assert(MAX_HANDLERS < NO_HANDLER, "too many handlers for the index type");
+
+	const Handler *_handlers{nullptr};
+	uint8_t _num_handlers{0};
+
+	uint8_t _first[DIRECT_SIZE] {};		///< index of the first handler of a msgid
+	uint8_t _next[MAX_HANDLERS] {};		///< index of the next handler of the same msgid
+};
@@ -77,6 +77,12 @@ MavlinkMissionManager::MavlinkMissionManager(Mavlink *mavlink) :
 	init_offboard_mission();
 }
 
+MavlinkMissionManager::~MavlinkMissionManager()
+{
+	// the dataman thread still references the batch
+	dm_wait(&_prefetch_batch);
+}
+
 void
 MavlinkMissionManager::init_offboard_mission()
 {
@@ -144,6 +150,23 @@ MavlinkMissionManager::load_safepoint_stats()
 	return ret;
 }
 
+void
+MavlinkMissionManager::prefetch_mission()
+{
+	// a prefetch still in progress is fine, there is only one mission in flight per instance
+	if (!dm_done(&_prefetch_batch)) {
+		return;
+	}
+
+	_prefetch_request = dm_request_t{DM_REQUEST_PREFETCH, _dataman_id, 0, _transfer_count, nullptr, sizeof(mission_item_s), 0};
+	_prefetch_batch.requests = &_prefetch_request;
+	_prefetch_batch.num_requests = 1;
+
+	if (dm_submit(&_prefetch_batch) != 0) {
+		PX4_DEBUG("WPM: mission prefetch failed");
+	}
+}
+
 /**
  * Publish mission topic to notify navigator about changes.
  */
@@ -750,6 +773,10 @@ MavlinkMissionManager::handle_mission_request_list(const mavlink_message_t *msg)
 				PX4_DEBUG("WPM: MISSION_REQUEST_LIST OK nothing to send, mission is empty, mission type=%i", _mission_type);
 			}
 
+			if (_mission_type == MAV_MISSION_TYPE_MISSION && _transfer_count > 0) {
+				prefetch_mission();
+			}
+
 			send_mission_count(msg->sysid, msg->compid, _transfer_count, _mission_type);
 
 		} else {
@@ -79,7 +79,7 @@ class MavlinkMissionManager
 public:
 	explicit MavlinkMissionManager(Mavlink *mavlink);
 
-	~MavlinkMissionManager() = default;
+	~MavlinkMissionManager();
 
 	/**
 	 * Handle sending of messages. Call this regularly at a fixed frequency.
@@ -134,6 +134,9 @@ private:
 	static uint16_t		_safepoint_update_counter;
 	bool			_geofence_locked{false};		///< if true, we currently hold the dm_lock for the geofence (transaction in progress)
 
+	dm_request_t		_prefetch_request{};
+	dm_batch_t		_prefetch_batch{};			///< Prefetch of the mission to send into the dataman cache
+
 	MavlinkRateLimiter	_slow_rate_limiter{100 * 1000};		///< Rate limit sending of the current WP sequence to 10 Hz
 
 	Mavlink *_mavlink;
@@ -173,6 +176,9 @@ private:
 	/** load safe point stats from dataman */
 	int load_safepoint_stats();
 
+	/** read the mission items of the current transmission into the dataman cache in the background */
+	void prefetch_mission();
+
 	/**
 	 *  @brief Sends an waypoint ack message
 	 */
@@ -0,0 +1,263 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file mavlink_param_pack.cpp
+ */
+
+#include "mavlink_param_pack.h"
+
+#include <drivers/drv_hrt.h>
+#include <parameters/param.h>
+#include <px4_platform_common/atomic.h>
+#include <px4_platform_common/defines.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+constexpr uint16_t MavlinkParamPack::kMagic;
+constexpr uint8_t MavlinkParamPack::kFormatVersion;
+constexpr uint8_t MavlinkParamPack::kFlagDelta;
+constexpr char MavlinkParamPack::kFileName[];
+
+uint32_t MavlinkParamPack::epoch()
+{
+	static px4::atomic<uint32_t> epoch{0};
+
+	if (epoch.load() == 0) {
+		// a counter in the storage that is incremented on the first request of every boot
+		static constexpr char epoch_file[] = PX4_STORAGEDIR "/.param_epoch";
+		uint32_t next = 0;
+		int fd = ::open(epoch_file, O_RDWR | O_CREAT, PX4_O_MODE_666);
+
+		if (fd >= 0) {
+			uint32_t previous = 0;
+
+			if (::read(fd, &previous, sizeof(previous)) != sizeof(previous)) {
+				previous = 0;
+			}
+
+			next = previous + 1;
+
+			if (next == 0) {
+				next = 1;
+			}
+
+			if (::pwrite(fd, &next, sizeof(next), 0) != sizeof(next)) {
+				next = 0;
+			}
+
+			::close(fd);
+		}
+
+		if (next == 0) {
+			// no storage: the time of the first request still differs between most boots
+			next = (uint32_t)hrt_absolute_time() | 1;
+		}
+
+		// another instance may have been faster, all of them use the same epoch
+		uint32_t expected = 0;
+		epoch.compare_exchange(&expected, next);
+	}
+
+	return epoch.load();
+}
+
+bool MavlinkParamPack::parse_query(const char *query, uint32_t &since)
+{
+	if (query == nullptr) {
+		return false;
+	}
+
+	const char *epoch_str = strstr(query, "epoch=");
+	const char *since_str = strstr(query, "since=");
+
+	if (epoch_str == nullptr || since_str == nullptr) {
+		return false;
+	}
+
+	if (strtoul(epoch_str + 6, nullptr, 10) != epoch()) {
+		// different boot: the versions are not related
+		return false;
+	}
+
+	since = strtoul(since_str + 6, nullptr, 10);
+
+	return since > 0 && since <= param_get_version();
+}
+
+int MavlinkParamPack::write(int fd, const char *query)
+{
+	Header header{};
+	header.magic = kMagic;
+	header.format_version = kFormatVersion;
+	header.epoch = epoch();
+
+	uint32_t since = 0;
+
+	if (parse_query(query, since)) {
+		header.flags |= kFlagDelta;
+	}
+
+	// get the version first: a change while writing the file is then contained in the next delta
+	header.version = param_get_version();
+	header.hash = param_hash_check();
+
+	Writer writer(fd);
+
+	// placeholder, rewritten at the end
+	int ret = writer.append(&header, sizeof(header));
+
+	const char *prev_name = "";
+
+	for (param_t param = 0; param < param_count() && ret == 0; param++) {
+		if (!param_used(param)) {
+			continue;
+		}
+
+		header.total_params++;
+
+		if ((header.flags & kFlagDelta) && !param_changed_since(param, since)) {
+			continue;
+		}
+
+		const char *name = param_name(param);
+		const unsigned name_len = strlen(name);
+		unsigned common_len = 0;
+
+		while (common_len < 15 && common_len < name_len - 1 && name[common_len] == prev_name[common_len]) {
+			common_len++;
+		}
+
+		uint8_t entry[2 + 16 + 4];
+		unsigned len = 2;
+
+		memcpy(&entry[len], name + common_len, name_len - common_len);
+		len += name_len - common_len;
+
+		switch (param_type(param)) {
+		case PARAM_TYPE_INT32: {
+				int32_t value = 0;
+				param_get(param, &value);
+
+				if (value >= INT8_MIN && value <= INT8_MAX) {
+					entry[0] = kTypeInt8;
+					entry[len++] = (uint8_t)(int8_t)value;
+
+				} else if (value >= INT16_MIN && value <= INT16_MAX) {
+					const int16_t value16 = value;
+					entry[0] = kTypeInt16;
+					memcpy(&entry[len], &value16, sizeof(value16));
+					len += sizeof(value16);
+
+				} else {
+					entry[0] = kTypeInt32;
+					memcpy(&entry[len], &value, sizeof(value));
+					len += sizeof(value);
+				}
+			}
+			break;
+
+		case PARAM_TYPE_FLOAT: {
+				float value = 0.f;
+				param_get(param, &value);
+				entry[0] = kTypeFloat;
+				memcpy(&entry[len], &value, sizeof(value));
+				len += sizeof(value);
+			}
+			break;
+
+		default:
+			continue;
+		}
+
+		entry[1] = (common_len << 4) | (name_len - common_len - 1);
+
+		ret = writer.append(entry, len);
+		header.num_params++;
+		prev_name = name;
+	}
+
+	if (ret == 0) {
+		ret = writer.flush();
+	}
+
+	if (ret == 0) {
+		if (lseek(fd, 0, SEEK_SET) < 0) {
+			ret = -errno;
+
+		} else {
+			writer.append(&header, sizeof(header));
+			ret = writer.flush();
+		}
+	}
+
+	return ret;
+}
+
+int MavlinkParamPack::Writer::append(const void *data, unsigned len)
+{
+	if (_length + len > sizeof(_buffer)) {
+		int ret = flush();
+
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	memcpy(&_buffer[_length], data, len);
+	_length += len;
+	return 0;
+}
+
+int MavlinkParamPack::Writer::flush()
+{
+	if (_length > 0) {
+		const ssize_t written = ::write(_fd, _buffer, _length);
+
+		if (written < 0) {
+			return -errno;
+
+		} else if (written != (ssize_t)_length) {
+			return -ENOSPC;
+		}
+
+		_length = 0;
+	}
+
+	return 0;
+}
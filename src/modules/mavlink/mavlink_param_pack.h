@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file mavlink_param_pack.h
+ * Packed parameter file for bulk parameter download over MAVLink FTP.
+ *
+ * Instead of one PARAM_VALUE message per parameter, a GCS can download all parameters at
+ * once as the virtual file @PARAM/param.pck. The file starts with a Header, followed by one
+ * entry per parameter, sorted by name:
+ *  - 1 byte: type (Type, lower 4 bits)
+ *  - 1 byte: length of the name prefix shared with the previous entry (upper 4 bits) and
+ *            length of the rest of the name - 1 (lower 4 bits)
+ *  - the rest of the name (not 0-terminated)
+ *  - the value: 1, 2 or 4 bytes for integers (depending on the value), 4 bytes for floats
+ *
+ * Appending "?epoch=<epoch>&since=<version>" with the values from the header of a previous
+ * download only returns the parameters that changed since then (kFlagDelta is set in that case).
+ * After applying it, the GCS must check the hash of its parameters against the header.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class MavlinkParamPack
+{
+public:
+	struct __attribute__((__packed__)) Header {
+		uint16_t magic;
+		uint8_t format_version;
+		uint8_t flags;
+		uint16_t num_params;		///< number of parameters in the file
+		uint16_t total_params;		///< number of used parameters
+		uint32_t hash;			///< hash of all used parameters, same as the _HASH_CHECK value
+		uint32_t epoch;			///< changes on every boot, versions of different boots cannot be compared
+		uint32_t version;		///< parameter version, use with epoch to request the changes since this file
+	};
+
+	enum Type : uint8_t {
+		kTypeInt8 = 1,
+		kTypeInt16 = 2,
+		kTypeInt32 = 3,
+		kTypeFloat = 4,
+	};
+
+	static constexpr uint16_t kMagic = 0x7034;
+	static constexpr uint8_t kFormatVersion = 1;
+	static constexpr uint8_t kFlagDelta = 1; ///< only the parameters that changed since the requested version
+
+	static constexpr char kFileName[] = "@PARAM/param.pck";
+
+	/**
+	 * Write the packed parameter file
+	 * @param fd file to write to, positioned at the start
+	 * @param query query part of the requested file name (after '?'), or nullptr
+	 * @return 0 on success, -errno otherwise
+	 */
+	static int write(int fd, const char *query);
+
+	/// epoch of this boot
+	static uint32_t epoch();
+
+private:
+	/// buffered writes to the file
+	class Writer
+	{
+	public:
+		explicit Writer(int fd) : _fd(fd) {}
+
+		int append(const void *data, unsigned len);
+		int flush();
+
+	private:
+		int _fd;
+		uint8_t _buffer[256];
+		unsigned _length{0};
+	};
+
+	static bool parse_query(const char *query, uint32_t &since);
+};
@@ -166,3 +166,20 @@ PARAM_DEFINE_INT32(MAV_ODOM_LP, 0);
  * @max 250
  */
 PARAM_DEFINE_INT32(MAV_RADIO_TOUT, 5);
+
+/**
+ * Size of an FTP download burst in KB
+ *
+ * Amount of file data, in units of 1024 bytes, sent in one burst of a MAVLink FTP
+ * download, before the GCS has to request missing data and the next burst. A burst
+ * is paused, not ended, while the link is busy. Larger values reduce the number of
+ * round trips.
+ *
+ * Set to 0 to send the whole file in one burst. A burst is ended after 5 seconds
+ * without a request from the GCS in any case.
+ *
+ * @group MAVLink
+ * @min 0
+ * @max 65535
+ */
+PARAM_DEFINE_INT32(MAV_FTP_BURST, 256);
@@ -33,13 +33,22 @@
 
 /**
  * @file mavlink_rate_limiter.cpp
- * Message rate limiter implementation.
+ * Message rate limiter and bandwidth shaper implementation.
  *
  * @author Anton Babushkin <anton.babushkin@me.com>
  */
 
 #include "mavlink_rate_limiter.h"
 
+#include <mathlib/mathlib.h>
+
+constexpr int MavlinkBandwidthShaper::PRIORITY_COUNT;
+constexpr hrt_abstime MavlinkBandwidthShaper::ADAPT_INTERVAL;
+constexpr hrt_abstime MavlinkBandwidthShaper::RATE_INTERVAL;
+constexpr float MavlinkBandwidthShaper::BURST_DURATION;
+constexpr float MavlinkBandwidthShaper::MIN_BUCKET_SIZE;
+constexpr float MavlinkBandwidthShaper::MIN_MULT;
+
 bool
 MavlinkRateLimiter::check(const hrt_abstime &t)
 {
@@ -52,3 +61,144 @@ MavlinkRateLimiter::check(const hrt_abstime &t)
 
 	return false;
 }
+
+const char *
+MavlinkBandwidthShaper::priority_str(Priority priority)
+{
+	switch (priority) {
+	case Priority::CRITICAL: return "critical";
+
+	case Priority::HIGH: return "high";
+
+	case Priority::NORMAL: return "normal";
+
+	case Priority::LOW: return "low";
+
+	case Priority::BULK: return "bulk";
+
+	default: return "unknown";
+	}
+}
+
+void
+MavlinkBandwidthShaper::set_rate(float rate)
+{
+	_rate = rate;
+	_bucket_size = math::max(rate * BURST_DURATION, MIN_BUCKET_SIZE);
+	_tokens = _bucket_size;
+}
+
+void
+MavlinkBandwidthShaper::set_headroom(float headroom)
+{
+	_headroom = math::min(_headroom, math::constrain(headroom, 0.f, 1.f));
+}
+
+bool
+MavlinkBandwidthShaper::check(Priority priority, unsigned bytes)
+{
+	// fill level of the bucket that has to remain after sending a message of the class
+	float reserve = 0.f;
+
+	switch (priority) {
+	case Priority::NORMAL:
+		reserve = 0.25f * _bucket_size;
+		break;
+
+	case Priority::LOW:
+		reserve = 0.5f * _bucket_size;
+		break;
+
+	case Priority::BULK:
+		reserve = 0.625f * _bucket_size;
+		break;
+
+	default:
+		// CRITICAL and HIGH are never held back
+		return true;
+	}
+
+	if ((_rate <= 0.f) || (_tokens - bytes >= reserve)) {
+		return true;
+	}
+
+	_deferred[index(priority)]++;
+	_deferred_total[index(priority)]++;
+	return false;
+}
+
+void
+MavlinkBandwidthShaper::consume(Priority priority, unsigned bytes)
+{
+	// CRITICAL and HIGH can overdraw the bucket by at most one bucket size
+	_tokens = math::max(_tokens - bytes, -_bucket_size);
+	_class_bytes[index(priority)] += bytes;
+}
+
+bool
+MavlinkBandwidthShaper::update(const hrt_abstime &t)
+{
+	if (_last_update == 0) {
+		_last_update = t;
+		_last_adapt = t;
+		_last_rate = t;
+		return false;
+	}
+
+	_tokens = math::min(_tokens + get_rate() * (t - _last_update) * 1e-6f, _bucket_size);
+	_last_update = t;
+
+	bool class_mult_changed = false;
+
+	if (t >= _last_adapt + ADAPT_INTERVAL) {
+		_last_adapt = t;
+		class_mult_changed = adapt();
+	}
+
+	if (t >= _last_rate + RATE_INTERVAL) {
+		const float dt = (t - _last_rate) * 1e-6f;
+
+		for (int i = 0; i < PRIORITY_COUNT; i++) {
+			_class_rate[i] = _class_bytes[i] / dt;
+			_class_bytes[i] = 0;
+		}
+
+		_last_rate = t;
+	}
+
+	return class_mult_changed;
+}
+
+bool
+MavlinkBandwidthShaper::adapt()
+{
+	// same steps as the RADIO_STATUS based throttling: back off quickly when the
+	// transmit path fills up and recover slowly while there is spare room
+	if (_headroom < 0.25f) {
+		_link_mult *= 0.8f;
+
+	} else if (_headroom < 0.35f) {
+		_link_mult *= 0.975f;
+
+	} else if (_headroom > 0.5f) {
+		_link_mult *= 1.025f;
+	}
+
+	_link_mult = math::constrain(_link_mult, MIN_MULT, 1.f);
+	_headroom = 1.f;
+
+	bool class_mult_changed = false;
+
+	for (int i = 0; i < PRIORITY_COUNT; i++) {
+		const float class_mult = math::constrain(_class_mult[i] * ((_deferred[i] > 0) ? 0.9f : 1.025f), MIN_MULT, 1.f);
+
+		if (fabsf(class_mult - _class_mult[i]) > FLT_EPSILON) {
+			_class_mult[i] = class_mult;
+			class_mult_changed = true;
+		}
+
+		_deferred[i] = 0;
+	}
+
+	return class_mult_changed;
+}
@@ -33,7 +33,7 @@
 
 /**
  * @file mavlink_rate_limiter.h
- * Message rate limiter definition.
+ * Message rate limiter and bandwidth shaper definition.
  *
  * @author Anton Babushkin <anton.babushkin@me.com>
  */
@@ -41,6 +41,8 @@
 #ifndef MAVLINK_RATE_LIMITER_H_
 #define MAVLINK_RATE_LIMITER_H_
 
+#include <stdint.h>
+
 #include <drivers/drv_hrt.h>
 
 
@@ -61,5 +63,122 @@ public:
 	bool check(const hrt_abstime &t);
 };
 
+/**
+ * Token bucket shaping the transmit bandwidth of a Mavlink instance by message priority.
+ *
+ * The bucket is filled at the link rate and every sent message consumes its size. A message
+ * of a class may only be sent if the bucket stays above the reserve of its class, so when
+ * the link saturates the low priority classes are held back first and the remaining tokens
+ * are left to the more important messages. CRITICAL and HIGH are never held back, but
+ * their messages consume tokens as well. Bulk transfers (FTP, log download and ULog
+ * streaming) are the lowest class, they only use what the other classes leave.
+ *
+ * The link rate adapts to the headroom of the transmit path (free TX buffer space and
+ * RADIO_STATUS feedback), and every class has a rate multiplier that is decreased while
+ * messages of the class are held back, which stretches the stream intervals of the class
+ * until they fit into the available bandwidth.
+ */
+class MavlinkBandwidthShaper
+{
+public:
+	enum class Priority : uint8_t {
+		CRITICAL = 0,	///< heartbeat, command acks, status texts
+		HIGH,		///< protocol traffic (mission, parameters, FTP replies) and other non-stream messages
+		NORMAL,		///< telemetry streams
+		LOW,		///< high rate sensor and debug streams
+		BULK,		///< file and log transfers
+		COUNT
+	};
+
+	static constexpr int PRIORITY_COUNT = static_cast<int>(Priority::COUNT);
+
+	MavlinkBandwidthShaper() = default;
+	~MavlinkBandwidthShaper() = default;
+
+	static const char *priority_str(Priority priority);
+
+	/**
+	 * Set the nominal link rate
+	 *
+	 * @param rate link rate in bytes per second
+	 */
+	void set_rate(float rate);
+
+	/**
+	 * Report the headroom of the transmit path, the lowest value reported within an
+	 * adaption interval is used to adapt the link rate
+	 *
+	 * @param headroom free fraction of the TX buffer [0, 1], 0 for an overrun
+	 */
+	void set_headroom(float headroom);
+
+	/**
+	 * Check if a message of the class and size can be sent now, a message that is held
+	 * back is counted and decreases the rate multiplier of the class
+	 *
+	 * @return true if the message can be sent
+	 */
+	bool check(Priority priority, unsigned bytes);
+
+	/**
+	 * Count a sent message
+	 */
+	void consume(Priority priority, unsigned bytes);
+
+	/**
+	 * Refill the bucket and adapt the link rate and the class rate multipliers
+	 *
+	 * @return true if a class rate multiplier changed
+	 */
+	bool update(const hrt_abstime &t);
+
+	float get_rate() const { return _rate * _link_mult; }
+	float get_link_mult() const { return _link_mult; }
+	float get_tokens() const { return _tokens; }
+	float get_bucket_size() const { return _bucket_size; }
+
+	/**
+	 * @return rate multiplier to apply to the stream intervals of the class
+	 */
+	float get_class_mult(Priority priority) const { return _class_mult[index(priority)]; }
+
+	/**
+	 * @return measured throughput of the class in bytes per second
+	 */
+	float get_class_rate(Priority priority) const { return _class_rate[index(priority)]; }
+
+	/**
+	 * @return number of messages of the class held back so far
+	 */
+	uint32_t get_deferred_count(Priority priority) const { return _deferred_total[index(priority)]; }
+
+	static constexpr hrt_abstime ADAPT_INTERVAL = 100 * 1000;	///< interval of the rate adaption [us]
+	static constexpr hrt_abstime RATE_INTERVAL = 1000 * 1000;	///< interval of the throughput measurement [us]
+	static constexpr float BURST_DURATION = 0.1f;			///< bucket size in seconds of the link rate
+	static constexpr float MIN_BUCKET_SIZE = 1024.f;		///< fits two messages above the LOW and one above the BULK reserve [B]
+	static constexpr float MIN_MULT = 0.05f;
+
+private:
+	static constexpr int index(Priority priority) { return static_cast<int>(priority); }
+
+	bool adapt();
+
+	float _rate{0.f};
+	float _link_mult{1.f};
+	float _bucket_size{MIN_BUCKET_SIZE};
+	float _tokens{MIN_BUCKET_SIZE};
+	float _headroom{1.f};				///< lowest headroom reported in the current adaption interval
+
+	float _class_mult[PRIORITY_COUNT] {1.f, 1.f, 1.f, 1.f, 1.f};
+	float _class_rate[PRIORITY_COUNT] {};
+	uint32_t _class_bytes[PRIORITY_COUNT] {};
+	uint32_t _deferred[PRIORITY_COUNT] {};		///< held back in the current adaption interval
+	uint32_t _deferred_total[PRIORITY_COUNT] {};
+
+	hrt_abstime _last_update{0};
+	hrt_abstime _last_adapt{0};
+	hrt_abstime _last_rate{0};
+};
+
 
 #endif /* MAVLINK_RATE_LIMITER_H_ */
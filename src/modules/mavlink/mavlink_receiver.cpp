@@ -77,6 +77,7 @@ MavlinkReceiver::~MavlinkReceiver()
 	delete _px4_mag;
 #if !defined(CONSTRAINED_FLASH)
 	delete[] _received_msg_stats;
+	delete[] _message_handler_stats;
 #endif // !CONSTRAINED_FLASH
 }
 
@@ -95,6 +96,8 @@ MavlinkReceiver::MavlinkReceiver(Mavlink *parent) :
 	_handle_sens_flow_rot = param_find("SENS_FLOW_ROT");
 	_handle_ekf2_min_rng = param_find("EKF2_MIN_RNG");
 	_handle_ekf2_rng_a_hmax = param_find("EKF2_RNG_A_HMAX");
+
+	_message_dispatch.init(_message_handlers, NUM_MESSAGE_HANDLERS);
 }
 
 void
@@ -112,250 +115,195 @@ MavlinkReceiver::acknowledge(uint8_t sysid, uint8_t compid, uint16_t command, ui
 	_cmd_ack_pub.publish(command_ack);
 }
 
-void
-MavlinkReceiver::handle_message(mavlink_message_t *msg)
-{
-	switch (msg->msgid) {
-	case MAVLINK_MSG_ID_COMMAND_LONG:
-		handle_message_command_long(msg);
-		break;
-
-	case MAVLINK_MSG_ID_COMMAND_INT:
-		handle_message_command_int(msg);
-		break;
-
-	case MAVLINK_MSG_ID_COMMAND_ACK:
-		handle_message_command_ack(msg);
-		break;
-
-	case MAVLINK_MSG_ID_OPTICAL_FLOW_RAD:
-		handle_message_optical_flow_rad(msg);
-		break;
-
-	case MAVLINK_MSG_ID_PING:
-		handle_message_ping(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_MODE:
-		handle_message_set_mode(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ATT_POS_MOCAP:
-		handle_message_att_pos_mocap(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
-		handle_message_set_position_target_local_ned(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
-		handle_message_set_position_target_global_int(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
-		handle_message_set_attitude_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET:
-		handle_message_set_actuator_control_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE:
-		handle_message_vision_position_estimate(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ODOMETRY:
-		handle_message_odometry(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_GPS_GLOBAL_ORIGIN:
-		handle_message_set_gps_global_origin(msg);
-		break;
-
-	case MAVLINK_MSG_ID_RADIO_STATUS:
-		handle_message_radio_status(msg);
-		break;
-
-	case MAVLINK_MSG_ID_MANUAL_CONTROL:
-		handle_message_manual_control(msg);
-		break;
-
-	case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
-		handle_message_rc_channels_override(msg);
-		break;
-
-	case MAVLINK_MSG_ID_HEARTBEAT:
-		handle_message_heartbeat(msg);
-		break;
-
-	case MAVLINK_MSG_ID_DISTANCE_SENSOR:
-		handle_message_distance_sensor(msg);
-		break;
-
-	case MAVLINK_MSG_ID_FOLLOW_TARGET:
-		handle_message_follow_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_LANDING_TARGET:
-		handle_message_landing_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_CELLULAR_STATUS:
-		handle_message_cellular_status(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ADSB_VEHICLE:
-		handle_message_adsb_vehicle(msg);
-		break;
-
-	case MAVLINK_MSG_ID_UTM_GLOBAL_POSITION:
-		handle_message_utm_global_position(msg);
-		break;
-
-	case MAVLINK_MSG_ID_COLLISION:
-		handle_message_collision(msg);
-		break;
-
-	case MAVLINK_MSG_ID_GPS_RTCM_DATA:
-		handle_message_gps_rtcm_data(msg);
-		break;
-
-	case MAVLINK_MSG_ID_BATTERY_STATUS:
-		handle_message_battery_status(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SERIAL_CONTROL:
-		handle_message_serial_control(msg);
-		break;
-
-	case MAVLINK_MSG_ID_LOGGING_ACK:
-		handle_message_logging_ack(msg);
-		break;
-
-	case MAVLINK_MSG_ID_PLAY_TUNE:
-		handle_message_play_tune(msg);
-		break;
-
-	case MAVLINK_MSG_ID_PLAY_TUNE_V2:
-		handle_message_play_tune_v2(msg);
-		break;
-
-	case MAVLINK_MSG_ID_OBSTACLE_DISTANCE:
-		handle_message_obstacle_distance(msg);
-		break;
-
-	case MAVLINK_MSG_ID_TUNNEL:
-		handle_message_tunnel(msg);
-		break;
-
-	case MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_BEZIER:
-		handle_message_trajectory_representation_bezier(msg);
-		break;
-
-	case MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_WAYPOINTS:
-		handle_message_trajectory_representation_waypoints(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ONBOARD_COMPUTER_STATUS:
-		handle_message_onboard_computer_status(msg);
-		break;
-
-	case MAVLINK_MSG_ID_GENERATOR_STATUS:
-		handle_message_generator_status(msg);
-		break;
-
-	case MAVLINK_MSG_ID_STATUSTEXT:
-		handle_message_statustext(msg);
-		break;
-
+/*
+ * Message handlers by msgid. A received message is only passed to the handlers listed here
+ * for its id, so the messages handled by the components (mission, parameters, ftp, ...)
+ * have to be listed as well.
+ */
+const MavlinkReceiver::MessageHandler MavlinkReceiver::_message_handlers[] {
+	{MAVLINK_MSG_ID_COMMAND_LONG, &MavlinkReceiver::handle_message_command_long},
+	{MAVLINK_MSG_ID_COMMAND_INT, &MavlinkReceiver::handle_message_command_int},
+	{MAVLINK_MSG_ID_COMMAND_ACK, &MavlinkReceiver::handle_message_command_ack},
+	{MAVLINK_MSG_ID_OPTICAL_FLOW_RAD, &MavlinkReceiver::handle_message_optical_flow_rad},
+	{MAVLINK_MSG_ID_PING, &MavlinkReceiver::handle_message_ping},
+	{MAVLINK_MSG_ID_SET_MODE, &MavlinkReceiver::handle_message_set_mode},
+	{MAVLINK_MSG_ID_ATT_POS_MOCAP, &MavlinkReceiver::handle_message_att_pos_mocap},
+	{MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, &MavlinkReceiver::handle_message_set_position_target_local_ned},
+	{MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT, &MavlinkReceiver::handle_message_set_position_target_global_int},
+	{MAVLINK_MSG_ID_SET_ATTITUDE_TARGET, &MavlinkReceiver::handle_message_set_attitude_target},
+	{MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET, &MavlinkReceiver::handle_message_set_actuator_control_target},
+	{MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE, &MavlinkReceiver::handle_message_vision_position_estimate},
+	{MAVLINK_MSG_ID_ODOMETRY, &MavlinkReceiver::handle_message_odometry},
+	{MAVLINK_MSG_ID_SET_GPS_GLOBAL_ORIGIN, &MavlinkReceiver::handle_message_set_gps_global_origin},
+	{MAVLINK_MSG_ID_RADIO_STATUS, &MavlinkReceiver::handle_message_radio_status},
+	{MAVLINK_MSG_ID_MANUAL_CONTROL, &MavlinkReceiver::handle_message_manual_control},
+	{MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE, &MavlinkReceiver::handle_message_rc_channels_override},
+	{MAVLINK_MSG_ID_HEARTBEAT, &MavlinkReceiver::handle_message_heartbeat},
+	{MAVLINK_MSG_ID_DISTANCE_SENSOR, &MavlinkReceiver::handle_message_distance_sensor},
+	{MAVLINK_MSG_ID_FOLLOW_TARGET, &MavlinkReceiver::handle_message_follow_target},
+	{MAVLINK_MSG_ID_LANDING_TARGET, &MavlinkReceiver::handle_message_landing_target},
+	{MAVLINK_MSG_ID_CELLULAR_STATUS, &MavlinkReceiver::handle_message_cellular_status},
+	{MAVLINK_MSG_ID_ADSB_VEHICLE, &MavlinkReceiver::handle_message_adsb_vehicle},
+	{MAVLINK_MSG_ID_UTM_GLOBAL_POSITION, &MavlinkReceiver::handle_message_utm_global_position},
+	{MAVLINK_MSG_ID_COLLISION, &MavlinkReceiver::handle_message_collision},
+	{MAVLINK_MSG_ID_GPS_RTCM_DATA, &MavlinkReceiver::handle_message_gps_rtcm_data},
+	{MAVLINK_MSG_ID_BATTERY_STATUS, &MavlinkReceiver::handle_message_battery_status},
+	{MAVLINK_MSG_ID_SERIAL_CONTROL, &MavlinkReceiver::handle_message_serial_control},
+	{MAVLINK_MSG_ID_LOGGING_ACK, &MavlinkReceiver::handle_message_logging_ack},
+	{MAVLINK_MSG_ID_PLAY_TUNE, &MavlinkReceiver::handle_message_play_tune},
+	{MAVLINK_MSG_ID_PLAY_TUNE_V2, &MavlinkReceiver::handle_message_play_tune_v2},
+	{MAVLINK_MSG_ID_OBSTACLE_DISTANCE, &MavlinkReceiver::handle_message_obstacle_distance},
+	{MAVLINK_MSG_ID_TUNNEL, &MavlinkReceiver::handle_message_tunnel},
+	{MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_BEZIER, &MavlinkReceiver::handle_message_trajectory_representation_bezier},
+	{MAVLINK_MSG_ID_TRAJECTORY_REPRESENTATION_WAYPOINTS, &MavlinkReceiver::handle_message_trajectory_representation_waypoints},
+	{MAVLINK_MSG_ID_ONBOARD_COMPUTER_STATUS, &MavlinkReceiver::handle_message_onboard_computer_status},
+	{MAVLINK_MSG_ID_GENERATOR_STATUS, &MavlinkReceiver::handle_message_generator_status},
+	{MAVLINK_MSG_ID_STATUSTEXT, &MavlinkReceiver::handle_message_statustext},
 #if !defined(CONSTRAINED_FLASH)
+	{MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, &MavlinkReceiver::handle_message_named_value_float},
+	{MAVLINK_MSG_ID_DEBUG, &MavlinkReceiver::handle_message_debug},
+	{MAVLINK_MSG_ID_DEBUG_VECT, &MavlinkReceiver::handle_message_debug_vect},
+	{MAVLINK_MSG_ID_DEBUG_FLOAT_ARRAY, &MavlinkReceiver::handle_message_debug_float_array},
+#endif // !CONSTRAINED_FLASH
+	{MAVLINK_MSG_ID_GIMBAL_MANAGER_SET_ATTITUDE, &MavlinkReceiver::handle_message_gimbal_manager_set_attitude},
+	{MAVLINK_MSG_ID_GIMBAL_MANAGER_SET_MANUAL_CONTROL, &MavlinkReceiver::handle_message_gimbal_manager_set_manual_control},
+	{MAVLINK_MSG_ID_GIMBAL_DEVICE_INFORMATION, &MavlinkReceiver::handle_message_gimbal_device_information},
+	{MAVLINK_MSG_ID_REQUEST_EVENT, &MavlinkReceiver::handle_message_request_event},
+	{MAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS, &MavlinkReceiver::handle_message_gimbal_device_attitude_status},
+
+	// HIL messages, only decoded in HIL mode
+	{MAVLINK_MSG_ID_HIL_SENSOR, &MavlinkReceiver::handle_message_hil_sensor, MessageFilter::Hil},
+	{MAVLINK_MSG_ID_HIL_STATE_QUATERNION, &MavlinkReceiver::handle_message_hil_state_quaternion, MessageFilter::Hil},
+	{MAVLINK_MSG_ID_HIL_OPTICAL_FLOW, &MavlinkReceiver::handle_message_hil_optical_flow, MessageFilter::Hil},
+	{MAVLINK_MSG_ID_HIL_GPS, &MavlinkReceiver::handle_message_hil_gps, MessageFilter::HilGps},
+
+	// mission manager
+	{MAVLINK_MSG_ID_MISSION_ACK, &MavlinkReceiver::handle_message_mission},
+	{MAVLINK_MSG_ID_MISSION_SET_CURRENT, &MavlinkReceiver::handle_message_mission},
+	{MAVLINK_MSG_ID_MISSION_REQUEST_LIST, &MavlinkReceiver::handle_message_mission},
+	{MAVLINK_MSG_ID_MISSION_REQUEST, &MavlinkReceiver::handle_message_mission},
+	{MAVLINK_MSG_ID_MISSION_REQUEST_INT, &MavlinkReceiver::handle_message_mission},
+	{MAVLINK_MSG_ID_MISSION_COUNT, &MavlinkReceiver::handle_message_mission},
+	{MAVLINK_MSG_ID_MISSION_ITEM, &MavlinkReceiver::handle_message_mission},
+	{MAVLINK_MSG_ID_MISSION_ITEM_INT, &MavlinkReceiver::handle_message_mission},
+	{MAVLINK_MSG_ID_MISSION_CLEAR_ALL, &MavlinkReceiver::handle_message_mission},
+
+	// parameters manager
+	{MAVLINK_MSG_ID_PARAM_REQUEST_LIST, &MavlinkReceiver::handle_message_param},
+	{MAVLINK_MSG_ID_PARAM_SET, &MavlinkReceiver::handle_message_param},
+	{MAVLINK_MSG_ID_PARAM_REQUEST_READ, &MavlinkReceiver::handle_message_param},
+	{MAVLINK_MSG_ID_PARAM_MAP_RC, &MavlinkReceiver::handle_message_param},
+
+	// ftp
+	{MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, &MavlinkReceiver::handle_message_file_transfer_protocol},
+
+	// log handler
+	{MAVLINK_MSG_ID_LOG_REQUEST_LIST, &MavlinkReceiver::handle_message_log},
+	{MAVLINK_MSG_ID_LOG_REQUEST_DATA, &MavlinkReceiver::handle_message_log},
+	{MAVLINK_MSG_ID_LOG_ERASE, &MavlinkReceiver::handle_message_log},
+	{MAVLINK_MSG_ID_LOG_REQUEST_END, &MavlinkReceiver::handle_message_log},
+
+	// timesync
+	{MAVLINK_MSG_ID_TIMESYNC, &MavlinkReceiver::handle_message_timesync},
+	{MAVLINK_MSG_ID_SYSTEM_TIME, &MavlinkReceiver::handle_message_timesync},
+};
+
+const uint8_t MavlinkReceiver::NUM_MESSAGE_HANDLERS = sizeof(_message_handlers) / sizeof(_message_handlers[0]);
 
-	case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
-		handle_message_named_value_float(msg);
-		break;
+bool
+MavlinkReceiver::message_accepted(MessageFilter filter, const mavlink_message_t &msg, bool hil_enabled,
+				  bool use_hil_gps)
+{
+	switch (filter) {
+	case MessageFilter::Hil:
+		return hil_enabled;
 
-	case MAVLINK_MSG_ID_DEBUG:
-		handle_message_debug(msg);
-		break;
+	case MessageFilter::HilGps:
+		return hil_enabled || (use_hil_gps && msg.sysid == mavlink_system.sysid);
 
-	case MAVLINK_MSG_ID_DEBUG_VECT:
-		handle_message_debug_vect(msg);
-		break;
+	default:
+		return true;
+	}
+}
 
-	case MAVLINK_MSG_ID_DEBUG_FLOAT_ARRAY:
-		handle_message_debug_float_array(msg);
-		break;
-#endif // !CONSTRAINED_FLASH
+void
+MavlinkReceiver::handle_message(mavlink_message_t *msg)
+{
+	static_assert(NUM_MESSAGE_HANDLERS <= MAX_MESSAGE_HANDLERS, "too many message handlers");
 
-	case MAVLINK_MSG_ID_GIMBAL_MANAGER_SET_ATTITUDE:
-		handle_message_gimbal_manager_set_attitude(msg);
-		break;
+	_message_dispatch.for_each_handler(msg->msgid, [this, msg](uint8_t index) {
+		if (message_accepted(_message_handlers[index].filter, *msg, _mavlink->get_hil_enabled(),
+				     _mavlink->get_use_hil_gps())) {
+			call_message_handler(index, msg);
+		}
+	});
 
-	case MAVLINK_MSG_ID_GIMBAL_MANAGER_SET_MANUAL_CONTROL:
-		handle_message_gimbal_manager_set_manual_control(msg);
-		break;
+	/* If we've received a valid message, mark the flag indicating so.
+	   This is used in the '-w' command-line flag. */
+	_mavlink->set_has_received_messages(true);
+}
 
-	case MAVLINK_MSG_ID_GIMBAL_DEVICE_INFORMATION:
-		handle_message_gimbal_device_information(msg);
-		break;
+void
+MavlinkReceiver::call_message_handler(uint8_t index, mavlink_message_t *msg)
+{
+#if !defined(CONSTRAINED_FLASH)
 
-	case MAVLINK_MSG_ID_REQUEST_EVENT:
-		handle_message_request_event(msg);
-		break;
+	if (_message_statistics_enabled) {
+		if (_message_handler_stats == nullptr) {
+			_message_handler_stats = new MessageHandlerStats[NUM_MESSAGE_HANDLERS];
+		}
 
-	case MAVLINK_MSG_ID_GIMBAL_DEVICE_ATTITUDE_STATUS:
-		handle_message_gimbal_device_attitude_status(msg);
-		break;
+		if (_message_handler_stats) {
+			const hrt_abstime start = hrt_absolute_time();
+			(this->*_message_handlers[index].handle)(msg);
+			const uint32_t elapsed = static_cast<uint32_t>(hrt_elapsed_time(&start));
 
-	default:
-		break;
+			MessageHandlerStats &stats = _message_handler_stats[index];
+			stats.count++;
+			stats.time_total_us += elapsed;
+			stats.time_max_us = math::max(stats.time_max_us, elapsed);
+			return;
+		}
 	}
 
-	/*
-	 * Only decode hil messages in HIL mode.
-	 *
-	 * The HIL mode is enabled by the HIL bit flag
-	 * in the system mode. Either send a set mode
-	 * COMMAND_LONG message or a SET_MODE message
-	 *
-	 * Accept HIL GPS messages if use_hil_gps flag is true.
-	 * This allows to provide fake gps measurements to the system.
-	 */
-	if (_mavlink->get_hil_enabled()) {
-		switch (msg->msgid) {
-		case MAVLINK_MSG_ID_HIL_SENSOR:
-			handle_message_hil_sensor(msg);
-			break;
-
-		case MAVLINK_MSG_ID_HIL_STATE_QUATERNION:
-			handle_message_hil_state_quaternion(msg);
-			break;
+#endif // !CONSTRAINED_FLASH
 
-		case MAVLINK_MSG_ID_HIL_OPTICAL_FLOW:
-			handle_message_hil_optical_flow(msg);
-			break;
+	(this->*_message_handlers[index].handle)(msg);
+}
 
-		default:
-			break;
-		}
+void
+MavlinkReceiver::handle_message_file_transfer_protocol(mavlink_message_t *msg)
+{
+	if (_mavlink->ftp_enabled()) {
+		_mavlink_ftp.handle_message(msg);
 	}
+}
 
+void
+MavlinkReceiver::handle_message_log(mavlink_message_t *msg)
+{
+	_mavlink_log_handler.handle_message(msg);
+}
 
-	if (_mavlink->get_hil_enabled() || (_mavlink->get_use_hil_gps() && msg->sysid == mavlink_system.sysid)) {
-		switch (msg->msgid) {
-		case MAVLINK_MSG_ID_HIL_GPS:
-			handle_message_hil_gps(msg);
-			break;
-
-		default:
-			break;
-		}
+void
+MavlinkReceiver::handle_message_mission(mavlink_message_t *msg)
+{
+	_mission_manager.handle_message(msg);
+}
 
+void
+MavlinkReceiver::handle_message_param(mavlink_message_t *msg)
+{
+	// make sure mavlink app has booted before we start processing parameter sync
+	if (_mavlink->boot_complete()) {
+		_parameters_manager.handle_message(msg);
 	}
+}
 
-	/* If we've received a valid message, mark the flag indicating so.
-	   This is used in the '-w' command-line flag. */
-	_mavlink->set_has_received_messages(true);
+void
+MavlinkReceiver::handle_message_timesync(mavlink_message_t *msg)
+{
+	_mavlink_timesync.handle_message(msg);
 }
 
 bool
@@ -3098,7 +3046,6 @@ MavlinkReceiver::run()
 	/* the serial port buffers internally as well, we just need to fit a small chunk */
 	uint8_t buf[64];
 #endif
-	mavlink_message_t msg;
 
 	struct pollfd fds[1] = {};
 
@@ -3108,8 +3055,10 @@ MavlinkReceiver::run()
 	}
 
 #if defined(MAVLINK_UDP)
+# if !defined(MAVLINK_UDP_BATCH)
 	struct sockaddr_in srcaddr = {};
 	socklen_t addrlen = sizeof(srcaddr);
+# endif // !MAVLINK_UDP_BATCH
 
 	if (_mavlink->get_protocol() == Protocol::UDP) {
 		fds[0].fd = _mavlink->get_socket_fd();
@@ -3145,120 +3094,52 @@ MavlinkReceiver::run()
 				}
 			}
 
-#if defined(MAVLINK_UDP)
+#if defined(MAVLINK_UDP_BATCH)
 
 			else if (_mavlink->get_protocol() == Protocol::UDP) {
-				if (fds[0].revents & POLLIN) {
-					nread = recvfrom(_mavlink->get_socket_fd(), buf, sizeof(buf), 0, (struct sockaddr *)&srcaddr, &addrlen);
-				}
-
-				struct sockaddr_in &srcaddr_last = _mavlink->get_client_source_address();
+				nread = 0;
 
-				int localhost = (127 << 24) + 1;
-
-				if (!_mavlink->get_client_source_initialized()) {
-
-					// set the address either if localhost or if 3 seconds have passed
-					// this ensures that a GCS running on localhost can get a hold of
-					// the system within the first N seconds
-					hrt_abstime stime = _mavlink->get_start_time();
-
-					if ((stime != 0 && (hrt_elapsed_time(&stime) > 3_s))
-					    || (srcaddr_last.sin_addr.s_addr == htonl(localhost))) {
-
-						srcaddr_last.sin_addr.s_addr = srcaddr.sin_addr.s_addr;
-						srcaddr_last.sin_port = srcaddr.sin_port;
-
-						_mavlink->set_client_source_initialized();
-
-						PX4_INFO("partner IP: %s", inet_ntoa(srcaddr.sin_addr));
-					}
-				}
-			}
-
-			// only start accepting messages on UDP once we're sure who we talk to
-			if (_mavlink->get_protocol() != Protocol::UDP || _mavlink->get_client_source_initialized()) {
-#endif // MAVLINK_UDP
-
-				/* if read failed, this loop won't execute */
-				for (ssize_t i = 0; i < nread; i++) {
-					if (mavlink_parse_char(_mavlink->get_channel(), buf[i], &msg, &_status)) {
-
-						/* check if we received version 2 and request a switch. */
-						if (!(_mavlink->get_status()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
-							/* this will only switch to proto version 2 if allowed in settings */
-							_mavlink->set_proto_version(2);
-						}
-
-						/* handle generic messages and commands */
-						handle_message(&msg);
-
-						/* handle packet with mission manager */
-						_mission_manager.handle_message(&msg);
+				if (fds[0].revents & POLLIN) {
+					// drain the socket, bounded so that a flood cannot stall the rest of the loop
+					for (int round = 0; round < 4; round++) {
+						const int count = _udp_rx_batch.receive(_mavlink->get_socket_fd());
 
-						/* handle packet with parameter component */
-						if (_mavlink->boot_complete()) {
-							// make sure mavlink app has booted before we start processing parameter sync
-							_parameters_manager.handle_message(&msg);
+						for (int i = 0; i < count; i++) {
+							update_udp_client_source(_udp_rx_batch.source(i));
 
-						} else {
-							if (hrt_elapsed_time(&_mavlink->get_first_start_time()) > 20_s) {
-								PX4_ERR("system boot did not complete in 20 seconds");
-								_mavlink->set_boot_complete();
+							// only start accepting messages on UDP once we're sure who we talk to
+							if (_mavlink->get_client_source_initialized()) {
+								parse_received_bytes(_udp_rx_batch.data(i), _udp_rx_batch.length(i));
 							}
 						}
 
-						if (_mavlink->ftp_enabled()) {
-							/* handle packet with ftp component */
-							_mavlink_ftp.handle_message(&msg);
-						}
-
-						/* handle packet with log component */
-						_mavlink_log_handler.handle_message(&msg);
-
-						/* handle packet with timesync component */
-						_mavlink_timesync.handle_message(&msg);
-
-						/* handle packet with parent object */
-						_mavlink->handle_message(&msg);
-
-						update_rx_stats(msg);
-
-						if (_message_statistics_enabled) {
-							update_message_statistics(msg);
+						if (count < MavlinkUdpRxBatch::MAX_DATAGRAMS) {
+							break;
 						}
 					}
 				}
+			}
 
-				/* count received bytes (nread will be -1 on read error) */
-				if (nread > 0) {
-					_mavlink->count_rxbytes(nread);
-
-					telemetry_status_s &tstatus = _mavlink->telemetry_status();
-					tstatus.rx_message_count = _total_received_counter;
-					tstatus.rx_message_lost_count = _total_lost_counter;
-					tstatus.rx_message_lost_rate = static_cast<float>(_total_lost_counter) / static_cast<float>(_total_received_counter);
+#elif defined(MAVLINK_UDP)
 
-					if (_mavlink_status_last_buffer_overrun != _status.buffer_overrun) {
-						tstatus.rx_buffer_overruns++;
-						_mavlink_status_last_buffer_overrun = _status.buffer_overrun;
-					}
+			else if (_mavlink->get_protocol() == Protocol::UDP) {
+				if (fds[0].revents & POLLIN) {
+					nread = recvfrom(_mavlink->get_socket_fd(), buf, sizeof(buf), 0, (struct sockaddr *)&srcaddr, &addrlen);
+				}
 
-					if (_mavlink_status_last_parse_error != _status.parse_error) {
-						tstatus.rx_parse_errors++;
-						_mavlink_status_last_parse_error = _status.parse_error;
-					}
+				update_udp_client_source(srcaddr);
+			}
 
-					if (_mavlink_status_last_packet_rx_drop_count != _status.packet_rx_drop_count) {
-						tstatus.rx_packet_drop_count++;
-						_mavlink_status_last_packet_rx_drop_count = _status.packet_rx_drop_count;
-					}
-				}
+#endif // MAVLINK_UDP_BATCH
 
 #if defined(MAVLINK_UDP)
-			}
 
+			// only start accepting messages on UDP once we're sure who we talk to
+			if (_mavlink->get_protocol() != Protocol::UDP || _mavlink->get_client_source_initialized())
 #endif // MAVLINK_UDP
+			{
+				parse_received_bytes(buf, nread);
+			}
 
 		} else if (ret == -1) {
 			usleep(10000);
@@ -3274,20 +3155,115 @@ MavlinkReceiver::run()
 
 			_parameters_manager.send();
 
+			// file and log transfers only use the bandwidth the other messages leave
+			_mavlink->set_tx_priority(MavlinkBandwidthShaper::Priority::BULK);
+
 			if (_mavlink->ftp_enabled()) {
 				_mavlink_ftp.send();
 			}
 
 			_mavlink_log_handler.send();
+
+			_mavlink->set_tx_priority(MavlinkBandwidthShaper::Priority::HIGH);
 			last_send_update = t;
 		}
 
 		if (_tune_publisher != nullptr) {
 			_tune_publisher->publish_next_tune(t);
 		}
+
+		// send the replies (acks, mission and parameter protocol, FTP) of this iteration
+		_mavlink->send_flush();
 	}
 }
 
+void MavlinkReceiver::parse_received_bytes(const uint8_t *buf, ssize_t nread)
+{
+	mavlink_message_t msg;
+
+	/* if read failed, this loop won't execute */
+	for (ssize_t i = 0; i < nread; i++) {
+		if (mavlink_parse_char(_mavlink->get_channel(), buf[i], &msg, &_status)) {
+
+			/* check if we received version 2 and request a switch. */
+			if (!(_mavlink->get_status()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
+				/* this will only switch to proto version 2 if allowed in settings */
+				_mavlink->set_proto_version(2);
+			}
+
+			if (!_mavlink->boot_complete() && (hrt_elapsed_time(&_mavlink->get_first_start_time()) > 20_s)) {
+				PX4_ERR("system boot did not complete in 20 seconds");
+				_mavlink->set_boot_complete();
+			}
+
+			/* handle the message with the handlers registered for its id */
+			handle_message(&msg);
+
+			/* handle packet with parent object */
+			_mavlink->handle_message(&msg);
+
+			update_rx_stats(msg);
+
+			if (_message_statistics_enabled) {
+				update_message_statistics(msg);
+			}
+		}
+	}
+
+	/* count received bytes (nread will be -1 on read error) */
+	if (nread > 0) {
+		_mavlink->count_rxbytes(nread);
+
+		telemetry_status_s &tstatus = _mavlink->telemetry_status();
+		tstatus.rx_message_count = _total_received_counter;
+		tstatus.rx_message_lost_count = _total_lost_counter;
+		tstatus.rx_message_lost_rate = static_cast<float>(_total_lost_counter) / static_cast<float>(_total_received_counter);
+
+		if (_mavlink_status_last_buffer_overrun != _status.buffer_overrun) {
+			tstatus.rx_buffer_overruns++;
+			_mavlink_status_last_buffer_overrun = _status.buffer_overrun;
+		}
+
+		if (_mavlink_status_last_parse_error != _status.parse_error) {
+			tstatus.rx_parse_errors++;
+			_mavlink_status_last_parse_error = _status.parse_error;
+		}
+
+		if (_mavlink_status_last_packet_rx_drop_count != _status.packet_rx_drop_count) {
+			tstatus.rx_packet_drop_count++;
+			_mavlink_status_last_packet_rx_drop_count = _status.packet_rx_drop_count;
+		}
+	}
+}
+
+#if defined(MAVLINK_UDP)
+void MavlinkReceiver::update_udp_client_source(const sockaddr_in &srcaddr)
+{
+	struct sockaddr_in &srcaddr_last = _mavlink->get_client_source_address();
+
+	int localhost = (127 << 24) + 1;
+
+	if (!_mavlink->get_client_source_initialized()) {
+
+		// set the address either if localhost or if 3 seconds have passed
+		// this ensures that a GCS running on localhost can get a hold of
+		// the system within the first N seconds
+		hrt_abstime stime = _mavlink->get_start_time();
+
+		if ((stime != 0 && (hrt_elapsed_time(&stime) > 3_s))
+		    || (srcaddr_last.sin_addr.s_addr == htonl(localhost))) {
+
+			srcaddr_last.sin_addr.s_addr = srcaddr.sin_addr.s_addr;
+			srcaddr_last.sin_port = srcaddr.sin_port;
+
+			_mavlink->set_client_source_initialized();
+
+			PX4_INFO("partner IP: %s", inet_ntoa(srcaddr.sin_addr));
+		}
+	}
+}
+#endif // MAVLINK_UDP
+
 bool MavlinkReceiver::component_was_seen(int system_id, int component_id)
 {
 	// For system broadcast messages return true if at least one component was seen before
@@ -3467,6 +3443,23 @@ void MavlinkReceiver::print_detailed_rx_stats() const
 			}
 		}
 	}
+
+#if !defined(CONSTRAINED_FLASH)
+
+	if (_message_statistics_enabled && _message_handler_stats) {
+		printf("\tMessage handling:\n");
+
+		for (uint8_t i = 0; i < NUM_MESSAGE_HANDLERS; i++) {
+			const MessageHandlerStats &stats = _message_handler_stats[i];
+
+			if (stats.count > 0) {
+				printf("\t  msgid:%5" PRIu32 ", handled: %" PRIu32 ", avg: %.1f us, max: %" PRIu32 " us\n",
+				       _message_handlers[i].msgid, stats.count, (double)stats.time_total_us / stats.count, stats.time_max_us);
+			}
+		}
+	}
+
+#endif // !CONSTRAINED_FLASH
 }
 
 void MavlinkReceiver::start()
@@ -43,10 +43,12 @@
 
 #include "mavlink_ftp.h"
 #include "mavlink_log_handler.h"
+#include "mavlink_message_dispatch.h"
 #include "mavlink_mission.h"
 #include "mavlink_parameters.h"
 #include "MavlinkStatustextHandler.hpp"
 #include "mavlink_timesync.h"
+#include "mavlink_udp_batch.h"
 #include "tune_publisher.h"
 
 #include <geo/geo.h>
@@ -136,10 +138,28 @@ public:
 
 	void request_stop() { _should_exit.store(true); }
 
+	pthread_t get_thread() const { return _thread; }
+
+#if defined(MAVLINK_UDP_BATCH)
+	const MavlinkUdpRxBatch &get_udp_rx_batch() const { return _udp_rx_batch; }
+#endif // MAVLINK_UDP_BATCH
+
 private:
 	static void *start_trampoline(void *context);
 	void run();
 
+	/**
+	 * Parse received bytes and handle the complete messages
+	 */
+	void parse_received_bytes(const uint8_t *buf, ssize_t nread);
+
+#if defined(MAVLINK_UDP)
+	/**
+	 * Take the sender of a datagram as the partner address if none is known yet
+	 */
+	void update_udp_client_source(const sockaddr_in &srcaddr);
+#endif // MAVLINK_UDP
+
 	void acknowledge(uint8_t sysid, uint8_t compid, uint16_t command, uint8_t result, uint8_t progress = 0);
 
 	/**
@@ -152,8 +172,20 @@ private:
 	uint8_t handle_request_message_command(uint16_t message_id, float param2 = 0.0f, float param3 = 0.0f,
 					       float param4 = 0.0f, float param5 = 0.0f, float param6 = 0.0f, float param7 = 0.0f);
 
+	/**
+	 * Handle a message with the handlers registered for its msgid in _message_handlers
+	 */
 	void handle_message(mavlink_message_t *msg);
 
+	void call_message_handler(uint8_t index, mavlink_message_t *msg);
+
+	// handlers of the components of the receiver
+	void handle_message_file_transfer_protocol(mavlink_message_t *msg);
+	void handle_message_log(mavlink_message_t *msg);
+	void handle_message_mission(mavlink_message_t *msg);
+	void handle_message_param(mavlink_message_t *msg);
+	void handle_message_timesync(mavlink_message_t *msg);
+
 	void handle_message_adsb_vehicle(mavlink_message_t *msg);
 	void handle_message_att_pos_mocap(mavlink_message_t *msg);
 	void handle_message_battery_status(mavlink_message_t *msg);
@@ -252,6 +284,36 @@ private:
 
 	mavlink_status_t		_status{}; ///< receiver status, used for mavlink_parse_char()
 
+	/**
+	 * Messages that are only decoded in some modes
+	 */
+	enum class MessageFilter : uint8_t {
+		None,
+		Hil,	///< only in HIL mode
+		HilGps,	///< in HIL mode, or from our own system id if use_hil_gps is set (fake gps measurements)
+	};
+
+	struct MessageHandler {
+		uint32_t msgid;
+		void (MavlinkReceiver::*handle)(mavlink_message_t *msg);
+		MessageFilter filter{MessageFilter::None};
+	};
+
+	static const MessageHandler _message_handlers[];	///< all handlers, a msgid can have several
+	static const uint8_t NUM_MESSAGE_HANDLERS;
+	static constexpr uint8_t MAX_MESSAGE_HANDLERS{96};
+
+	static bool message_accepted(MessageFilter filter, const mavlink_message_t &msg, bool hil_enabled, bool use_hil_gps);
+
+	MavlinkMessageDispatch<MessageHandler, MAX_MESSAGE_HANDLERS> _message_dispatch;
+
+	// the dispatch test needs to be able to check the handler table
+	friend class MavlinkReceiverDispatchTest;
+
+#if defined(MAVLINK_UDP_BATCH)
+	MavlinkUdpRxBatch		_udp_rx_batch;
+#endif // MAVLINK_UDP_BATCH
+
 	orb_advert_t _mavlink_log_pub{nullptr};
 
 	static constexpr unsigned MAX_REMOTE_COMPONENTS{16};
@@ -277,6 +339,13 @@ private:
 		uint8_t component_id{0};
 	};
 	ReceivedMessageStats *_received_msg_stats{nullptr};
+
+	struct MessageHandlerStats {
+		uint32_t count{0};
+		uint32_t time_max_us{0};
+		uint64_t time_total_us{0};
+	};
+	MessageHandlerStats *_message_handler_stats{nullptr};	///< per entry of _message_handlers
 #endif // !CONSTRAINED_FLASH
 
 	uint64_t _total_received_counter{0};                            ///< The total number of successfully received messages
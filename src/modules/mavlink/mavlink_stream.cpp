@@ -50,6 +50,102 @@ MavlinkStream::MavlinkStream(Mavlink *mavlink) :
 	_last_sent = hrt_absolute_time();
 }
 
+void
+MavlinkStream::set_interval(const int interval)
+{
+	_interval = interval;
+
+	if ((interval > 0) && (_last_sent > (hrt_abstime)interval)) {
+		// move the last sent time back to the phase of this message
+		const hrt_abstime phase = ((hrt_abstime)get_id() * 7919) % interval;
+		_last_sent -= (_last_sent + interval - phase) % interval;
+	}
+
+	_mavlink->invalidate_stream_schedule();
+}
+
+void
+MavlinkStream::reset_last_sent()
+{
+	_last_sent = 0;
+	_mavlink->invalidate_stream_schedule();
+}
+
+hrt_abstime
+MavlinkStream::get_next_update_time()
+{
+	if ((_last_sent == 0) || update_data_required()) {
+		return 0;
+	}
+
+	int interval = _interval;
+
+	if (!const_rate()) {
+		interval /= _mavlink->get_rate_mult(get_priority());
+	}
+
+	if (interval == 0) {
+		// only sent on request
+		return UINT64_MAX;
+
+	} else if (interval < 0) {
+		// unlimited rate
+		return 0;
+	}
+
+	// the condition in update()
+	const int64_t next = (int64_t)_last_sent + interval - (_mavlink->get_main_loop_delay() / 10) * 3 + 1;
+	return (next > 0) ? next : 0;
+}
+
+MavlinkBandwidthShaper::Priority
+MavlinkStream::get_priority()
+{
+	switch (get_id()) {
+	case MAVLINK_MSG_ID_HEARTBEAT:
+	case MAVLINK_MSG_ID_HIGH_LATENCY2:
+	case MAVLINK_MSG_ID_STATUSTEXT:
+	case MAVLINK_MSG_ID_COMMAND_LONG:
+		return MavlinkBandwidthShaper::Priority::CRITICAL;
+
+	case MAVLINK_MSG_ID_HIGHRES_IMU:
+	case MAVLINK_MSG_ID_SCALED_IMU:
+	case MAVLINK_MSG_ID_SCALED_IMU2:
+	case MAVLINK_MSG_ID_SCALED_IMU3:
+	case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+	case MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET:
+	case MAVLINK_MSG_ID_DEBUG:
+	case MAVLINK_MSG_ID_DEBUG_VECT:
+	case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
+		return MavlinkBandwidthShaper::Priority::LOW;
+
+	default:
+		return MavlinkBandwidthShaper::Priority::NORMAL;
+	}
+}
+
+bool
+MavlinkStream::send_timed()
+{
+	const MavlinkBandwidthShaper::Priority priority = get_priority();
+
+	// held back by the bandwidth shaper, the stream stays due and is tried again in the next iteration
+	if (!_mavlink->tx_allowed(priority, get_size())) {
+		return false;
+	}
+
+	const hrt_abstime start = hrt_absolute_time();
+
+	_mavlink->set_tx_priority(priority);
+	const bool sent = send();
+	_mavlink->set_tx_priority(MavlinkBandwidthShaper::Priority::HIGH);
+
+	_send_time += hrt_elapsed_time(&start);
+	_send_count++;
+
+	return sent;
+}
+
 /**
  * Update subscriptions and send message if necessary
  */
@@ -64,7 +160,7 @@ MavlinkStream::update(const hrt_abstime &t)
 		// this will give different messages on the same run a different
 		// initial timestamp which will help spacing them out
 		// on the link scheduling
-		if (send()) {
+		if (send_timed()) {
 			_last_sent = hrt_absolute_time();
 
 			if (!_first_message_sent) {
@@ -85,7 +181,7 @@ MavlinkStream::update(const hrt_abstime &t)
 	int interval = _interval;
 
 	if (!const_rate()) {
-		interval /= _mavlink->get_rate_mult();
+		interval /= _mavlink->get_rate_mult(get_priority());
 	}
 
 	// We don't need to send anything if the inverval is 0. send() will be called manually.
@@ -112,7 +208,7 @@ MavlinkStream::update(const hrt_abstime &t)
 		// do not use the actual time but increment at a fixed rate, so that processing delays do not
 		// distort the average rate. The check of the maximum interval is done to ensure that after a
 		// long time not sending anything, sending multiple messages in a short time is avoided.
-		if (send()) {
+		if (send_timed()) {
 			_last_sent = ((interval > 0) && ((int64_t)(1.5f * interval) > dt)) ? _last_sent + interval : t;
 
 			if (!_first_message_sent) {
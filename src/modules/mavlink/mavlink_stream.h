@@ -45,6 +45,8 @@
 #include <px4_platform_common/module_params.h>
 #include <containers/List.hpp>
 
+#include "mavlink_rate_limiter.h"
+
 class Mavlink;
 
 class MavlinkStream : public ListNode<MavlinkStream *>
@@ -62,11 +64,14 @@ public:
 	MavlinkStream &operator=(MavlinkStream &&) = delete;
 
 	/**
-	 * Get the interval
+	 * Set the interval
+	 *
+	 * The send times are aligned to a phase that only depends on the message id and the
+	 * interval, so a stream has the same phase on all Mavlink instances.
 	 *
 	 * @param interval the interval in microseconds (us) between messages
 	 */
-	void set_interval(const int interval) { _interval = interval; }
+	void set_interval(const int interval);
 
 	/**
 	 * Get the interval
@@ -79,6 +84,13 @@ public:
 	 * @return 0 if updated / sent, -1 if unchanged
 	 */
 	int update(const hrt_abstime &t);
+
+	/**
+	 * @return earliest time at which update() can send the next message,
+	 *         0 if update() needs to be called in every iteration
+	 */
+	hrt_abstime get_next_update_time();
+
 	virtual const char *get_name() const = 0;
 	virtual uint16_t get_id() = 0;
 
@@ -87,6 +99,11 @@ public:
 	 */
 	virtual bool const_rate() { return false; }
 
+	/**
+	 * @return priority class of the stream in the bandwidth shaper of the Mavlink instance
+	 */
+	virtual MavlinkBandwidthShaper::Priority get_priority();
+
 	/**
 	 * Get maximal total messages size on update
 	 */
@@ -120,7 +137,17 @@ public:
 	 * Reset the time of last sent to 0. Can be used if a message over this
 	 * stream needs to be sent immediately.
 	 */
-	void reset_last_sent() { _last_sent = 0; }
+	void reset_last_sent();
+
+	/**
+	 * @return number of send() calls
+	 */
+	uint32_t get_send_count() const { return _send_count; }
+
+	/**
+	 * @return average time spent in send() in microseconds (us)
+	 */
+	float get_send_time_avg() const { return (_send_count > 0) ? (float)_send_time / _send_count : 0.f; }
 
 protected:
 	Mavlink      *const _mavlink;
@@ -132,13 +159,20 @@ protected:
 	 * Function to collect/update data for the streams at a high rate independant of
 	 * actual stream rate.
 	 *
-	 * This function is called at every iteration of the mavlink module.
+	 * This function is called at every iteration of the mavlink module
+	 * if update_data_required() returns true.
 	 */
 	virtual void update_data() { }
+	virtual bool update_data_required() const { return false; }
 
 private:
+	bool send_timed();
+
 	hrt_abstime _last_sent{0};
 	bool _first_message_sent{false};
+
+	hrt_abstime _send_time{0};	///< accumulated time spent in send()
+	uint32_t _send_count{0};
 };
 
 
@@ -0,0 +1,173 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_stream_scheduler.cpp
+ * Scheduling of the streams of a Mavlink instance by their next due time.
+ */
+
+#include "mavlink_stream_scheduler.h"
+
+#include <mathlib/mathlib.h>
+
+MavlinkStreamScheduler::~MavlinkStreamScheduler()
+{
+	delete[] _heap;
+	delete[] _due;
+}
+
+void
+MavlinkStreamScheduler::update(List<MavlinkStream *> &streams, const hrt_abstime &t, float rate_mult)
+{
+	// the due times depend on the rate multiplier
+	if (fabsf(rate_mult - _rate_mult) > FLT_EPSILON) {
+		_rate_mult = rate_mult;
+		_rebuild_required.store(true);
+	}
+
+	if (_rebuild_required.load()) {
+		_rebuild_required.store(false);
+
+		if (!rebuild(streams)) {
+			// allocation failed, fall back to polling all streams
+			_rebuild_required.store(true);
+
+			for (const auto &stream : streams) {
+				stream->update(t);
+			}
+
+			return;
+		}
+	}
+
+	// take all due streams from the heap first, a stream that is still due after its update
+	// (e.g. nothing to send yet) must only be visited again in the next iteration
+	size_t due_count = 0;
+
+	while ((_size > 0) && (_heap[0].due <= t)) {
+		_due[due_count++] = pop();
+	}
+
+	for (size_t i = 0; i < due_count; i++) {
+		MavlinkStream *stream = _due[i].stream;
+		stream->update(t);
+
+		push(Entry{math::max(stream->get_next_update_time(), t + 1), stream});
+	}
+
+	_loop_count++;
+	_update_count += due_count;
+}
+
+bool
+MavlinkStreamScheduler::rebuild(List<MavlinkStream *> &streams)
+{
+	const size_t count = streams.size();
+
+	if (count > _capacity) {
+		delete[] _heap;
+		delete[] _due;
+
+		_heap = new Entry[count];
+		_due = new Entry[count];
+		_capacity = (_heap && _due) ? count : 0;
+	}
+
+	_size = 0;
+
+	if (count > _capacity) {
+		return false;
+	}
+
+	for (const auto &stream : streams) {
+		push(Entry{stream->get_next_update_time(), stream});
+	}
+
+	_rebuild_count++;
+	return true;
+}
+
+void
+MavlinkStreamScheduler::push(const Entry &entry)
+{
+	// sift up
+	size_t i = _size++;
+
+	while (i > 0) {
+		const size_t parent = (i - 1) / 2;
+
+		if (_heap[parent].due <= entry.due) {
+			break;
+		}
+
+		_heap[i] = _heap[parent];
+		i = parent;
+	}
+
+	_heap[i] = entry;
+}
+
+MavlinkStreamScheduler::Entry
+MavlinkStreamScheduler::pop()
+{
+	const Entry top = _heap[0];
+	const Entry last = _heap[--_size];
+
+	// sift down
+	size_t i = 0;
+
+	while (true) {
+		size_t child = 2 * i + 1;
+
+		if (child >= _size) {
+			break;
+		}
+
+		if ((child + 1 < _size) && (_heap[child + 1].due < _heap[child].due)) {
+			child++;
+		}
+
+		if (last.due <= _heap[child].due) {
+			break;
+		}
+
+		_heap[i] = _heap[child];
+		i = child;
+	}
+
+	if (_size > 0) {
+		_heap[i] = last;
+	}
+
+	return top;
+}
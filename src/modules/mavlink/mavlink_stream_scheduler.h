@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_stream_scheduler.h
+ * Scheduling of the streams of a Mavlink instance by their next due time.
+ */
+
+#ifndef MAVLINK_STREAM_SCHEDULER_H_
+#define MAVLINK_STREAM_SCHEDULER_H_
+
+#include <drivers/drv_hrt.h>
+#include <containers/List.hpp>
+#include <px4_platform_common/atomic.h>
+
+#include "mavlink_stream.h"
+
+/**
+ * Min-heap of the streams ordered by the time at which they are due next (see
+ * MavlinkStream::get_next_update_time()), so that every main loop iteration only
+ * visits the streams that are due instead of polling all of them.
+ *
+ * The schedule is rebuilt from the stream list after invalidate(), which has to be
+ * called whenever streams are added or removed or their interval or last sent
+ * time is changed, and whenever the rate multiplier changed.
+ */
+class MavlinkStreamScheduler
+{
+public:
+	MavlinkStreamScheduler() = default;
+	~MavlinkStreamScheduler();
+
+	// no copy, assignment, move, move assignment
+	MavlinkStreamScheduler(const MavlinkStreamScheduler &) = delete;
+	MavlinkStreamScheduler &operator=(const MavlinkStreamScheduler &) = delete;
+	MavlinkStreamScheduler(MavlinkStreamScheduler &&) = delete;
+	MavlinkStreamScheduler &operator=(MavlinkStreamScheduler &&) = delete;
+
+	void invalidate() { _rebuild_required.store(true); }
+
+	/**
+	 * Update all streams that are due at time t and schedule them again
+	 */
+	void update(List<MavlinkStream *> &streams, const hrt_abstime &t, float rate_mult);
+
+	/**
+	 * @return average number of streams updated per call of update()
+	 */
+	float get_updates_per_loop() const { return (_loop_count > 0) ? (float)_update_count / _loop_count : 0.f; }
+
+	unsigned get_rebuild_count() const { return _rebuild_count; }
+
+private:
+	struct Entry {
+		hrt_abstime due;
+		MavlinkStream *stream;
+	};
+
+	bool rebuild(List<MavlinkStream *> &streams);
+
+	void push(const Entry &entry);
+	Entry pop();
+
+	Entry *_heap{nullptr};		///< binary min-heap ordered by due time
+	Entry *_due{nullptr};		///< streams taken from the heap in the current update
+	size_t _size{0};
+	size_t _capacity{0};
+
+	px4::atomic_bool _rebuild_required{true};
+	float _rate_mult{1.f};		///< rate multiplier the schedule is based on
+
+	uint64_t _loop_count{0};
+	uint64_t _update_count{0};
+	unsigned _rebuild_count{0};
+};
+
+#endif /* MAVLINK_STREAM_SCHEDULER_H_ */
@@ -644,6 +644,261 @@ bool MavlinkFtpTest::_burst_test()
 	return true;
 }
 
+/// @brief Tests that a burst is completed after the burst window and that the data can be read again afterwards
+bool MavlinkFtpTest::_burst_window_test()
+{
+	MavlinkFTP::PayloadHeader		payload {};
+	const MavlinkFTP::PayloadHeader		*reply;
+
+	// The last test file takes two packets, a window of one packet needs two bursts
+	const DownloadTestCase *test = &_rgDownloadTestCases[2];
+	_ftp_server->_burst_window = MAX_DATA_LEN;
+
+	struct stat st;
+	ut_compare("stat failed", stat(test->file, &st), 0);
+	uint8_t bytes[MAX_DATA_LEN + 1];
+	ut_compare("Test case data files are out of date", (int)sizeof(bytes), st.st_size);
+	int fd = ::open(test->file, O_RDONLY);
+	ut_assert("open failed", fd != -1);
+	int bytes_read = ::read(fd, bytes, sizeof(bytes));
+	::close(fd);
+	ut_compare("read failed", bytes_read, (int)sizeof(bytes));
+
+	payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+	payload.offset = 0;
+	payload.size = strlen(test->file) + 1;
+
+	bool success = _send_receive_msg(&payload, (uint8_t *)test->file, payload.size, &reply);
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	const uint8_t session = reply->session;
+
+	// Burst from the start: a single packet, which completes the burst
+	payload.opcode = MavlinkFTP::kCmdBurstReadFile;
+	payload.session = session;
+	payload.offset = 0;
+	payload.size = MAX_DATA_LEN;
+
+	mavlink_message_t msg;
+	_setup_ftp_msg(&payload, nullptr, 0, &msg);
+	_ftp_server->handle_message(&msg);
+	_ftp_server->send();
+	_decode_message(&_reply_msg, &reply);
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	ut_compare("Offset incorrect", reply->offset, 0);
+	ut_compare("Payload size incorrect", reply->size, MAX_DATA_LEN);
+	ut_compare("burst_complete incorrect", reply->burst_complete, 1);
+	ut_compare("File contents differ", memcmp(reply->data, bytes, MAX_DATA_LEN), 0);
+	ut_compare("Burst should be complete", _ftp_server->get_size(), 0);
+
+	// Read back part of the data, as the GCS does for lost burst packets
+	payload.opcode = MavlinkFTP::kCmdReadFile;
+	payload.session = session;
+	payload.offset = 10;
+	payload.size = 20;
+
+	success = _send_receive_msg(&payload, nullptr, 0, &reply);
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	ut_compare("Payload size incorrect", reply->size, 20);
+	ut_compare("File contents differ", memcmp(reply->data, &bytes[10], 20), 0);
+
+	// Terminate session
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.session = session;
+	payload.size = 0;
+
+	success = _send_receive_msg(&payload, nullptr, 0, &reply);
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	return true;
+}
+
+/// @brief Tests that a burst of a file that is truncated after it was opened ends with EOF
+bool MavlinkFtpTest::_burst_truncated_test()
+{
+	MavlinkFTP::PayloadHeader		payload {};
+	const MavlinkFTP::PayloadHeader		*reply;
+
+	// several pages, so that reading the old file size from a memory mapping would fault
+	static constexpr int file_size = 3 * 4096;
+	static constexpr int truncated_size = MAX_DATA_LEN + 10;
+	uint8_t bytes[file_size];
+
+	for (int i = 0; i < file_size; i++) {
+		bytes[i] = i & 0xff;
+	}
+
+	ut_compare("mkdir failed", ::mkdir(_unittest_microsd_dir, S_IRWXU | S_IRWXG | S_IRWXO), 0);
+	int fd = ::open(_unittest_microsd_file, O_CREAT | O_EXCL | O_WRONLY, S_IRWXU | S_IRWXG | S_IRWXO);
+	ut_assert("open failed", fd != -1);
+	ut_compare("write failed", ::write(fd, bytes, file_size), file_size);
+
+	payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+	payload.offset = 0;
+	payload.size = strlen(_unittest_microsd_file) + 1;
+
+	bool success = _send_receive_msg(&payload, (uint8_t *)_unittest_microsd_file, payload.size, &reply);
+
+	if (!success) {
+		::close(fd);
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	const uint8_t session = reply->session;
+
+	ut_compare("truncate failed", ::ftruncate(fd, truncated_size), 0);
+	::close(fd);
+
+	// Burst the whole file: two packets up to the new end of the file, then EOF
+	BurstInfo burst_info;
+	burst_info.burst_state = burst_state_first_ack;
+	burst_info.single_packet_file = false;
+	burst_info.file_size = truncated_size;
+	burst_info.file_bytes = bytes;
+	burst_info.ftp_test_class = this;
+	_ftp_server->set_unittest_worker(MavlinkFtpTest::receive_message_handler_burst, &burst_info);
+	_ftp_server->_burst_window = 0;
+
+	payload.opcode = MavlinkFTP::kCmdBurstReadFile;
+	payload.session = session;
+	payload.offset = 0;
+	payload.size = MAX_DATA_LEN;
+
+	mavlink_message_t msg;
+	_setup_ftp_msg(&payload, nullptr, 0, &msg);
+	_ftp_server->handle_message(&msg);
+	_ftp_server->send();
+
+	ut_compare("Incorrect sequence of messages", burst_info.burst_state, burst_state_complete);
+
+	_ftp_server->set_unittest_worker(MavlinkFtpTest::receive_message_handler_generic, this);
+
+	// Terminate session
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.session = session;
+	payload.size = 0;
+
+	success = _send_receive_msg(&payload, nullptr, 0, &reply);
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	_cleanup_microsd();
+
+	return true;
+}
+
+/// @brief Tests that reads within the read-ahead buffer are served from it, e.g. re-requests of missed burst packets
+bool MavlinkFtpTest::_read_rerequest_test()
+{
+	MavlinkFTP::PayloadHeader		payload {};
+	const MavlinkFTP::PayloadHeader		*reply;
+
+	static constexpr int buffer_len = MavlinkFTP::_read_ahead_buffer_len;
+	static constexpr int file_size = buffer_len + 2 * MAX_DATA_LEN;
+	static constexpr int straddle = 100; // bytes of the straddling read that are still in the buffer
+	uint8_t old_bytes[file_size];
+	uint8_t new_bytes[file_size];
+
+	for (int i = 0; i < file_size; i++) {
+		old_bytes[i] = i & 0xff;
+		new_bytes[i] = ~old_bytes[i];
+	}
+
+	ut_compare("mkdir failed", ::mkdir(_unittest_microsd_dir, S_IRWXU | S_IRWXG | S_IRWXO), 0);
+	int fd = ::open(_unittest_microsd_file, O_CREAT | O_EXCL | O_RDWR, S_IRWXU | S_IRWXG | S_IRWXO);
+	ut_assert("open failed", fd != -1);
+	ut_compare("write failed", ::write(fd, old_bytes, file_size), file_size);
+
+	payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+	payload.offset = 0;
+	payload.size = strlen(_unittest_microsd_file) + 1;
+
+	bool success = _send_receive_msg(&payload, (uint8_t *)_unittest_microsd_file, payload.size, &reply);
+
+	if (!success) {
+		::close(fd);
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	const uint8_t session = reply->session;
+
+	// The first read fills the buffer. The file is rewritten with different contents afterwards, so that the
+	// bytes served from the buffer can be told apart from the ones read from the file.
+	struct {
+		uint32_t offset;
+		int old_length; // leading bytes expected from the buffer, the rest from the file
+	} reads[] = {
+		{0, MAX_DATA_LEN},
+		{10, MAX_DATA_LEN},				// re-request inside the buffer
+		{buffer_len - straddle, straddle},		// re-request over the end of the buffer
+		{0, 0},						// re-request before the buffer
+	};
+
+	for (unsigned i = 0; i < sizeof(reads) / sizeof(reads[0]); i++) {
+		payload.opcode = MavlinkFTP::kCmdReadFile;
+		payload.session = session;
+		payload.offset = reads[i].offset;
+		payload.size = MAX_DATA_LEN;
+
+		success = _send_receive_msg(&payload, nullptr, 0, &reply);
+
+		if (!success) {
+			::close(fd);
+			return false;
+		}
+
+		ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+		ut_compare("Payload size incorrect", reply->size, MAX_DATA_LEN);
+		ut_compare("Buffered content differs", memcmp(reply->data, old_bytes + reads[i].offset, reads[i].old_length), 0);
+		ut_compare("File content differs", memcmp(reply->data + reads[i].old_length,
+				new_bytes + reads[i].offset + reads[i].old_length, MAX_DATA_LEN - reads[i].old_length), 0);
+
+		if (i == 0) {
+			ut_compare("rewrite failed", ::pwrite(fd, new_bytes, file_size, 0), file_size);
+		}
+	}
+
+	::close(fd);
+
+	// Terminate session
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.session = session;
+	payload.size = 0;
+
+	success = _send_receive_msg(&payload, nullptr, 0, &reply);
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	_cleanup_microsd();
+
+	return true;
+}
+
 /// @brief Tests for correct reponse to a Read command on an invalid session.
 bool MavlinkFtpTest::_read_badsession_test()
 {
@@ -1017,6 +1272,9 @@ bool MavlinkFtpTest::run_tests()
 	ut_run_test(_read_test);
 	ut_run_test(_read_badsession_test);
 	ut_run_test(_burst_test);
+	ut_run_test(_burst_window_test);
+	ut_run_test(_burst_truncated_test);
+	ut_run_test(_read_rerequest_test);
 	ut_run_test(_removedirectory_test);
 	ut_run_test(_createdirectory_test);
 	ut_run_test(_removefile_test);
@@ -0,0 +1,196 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file mavlink_udp_batch.cpp
+ * Batched UDP transmission and reception with sendmmsg() / recvmmsg() (Linux only).
+ */
+
+#include "mavlink_udp_batch.h"
+
+#if defined(MAVLINK_UDP_BATCH)
+
+#include <errno.h>
+#include <string.h>
+
+bool MavlinkUdpTxBatch::append(const uint8_t *buf, size_t len)
+{
+	if (_overflow || full() || (_fill + len > PACKET_LEN_MAX)) {
+		_overflow = true;
+		return false;
+	}
+
+	memcpy(&_packets[_count][_fill], buf, len);
+	_fill += len;
+	return true;
+}
+
+bool MavlinkUdpTxBatch::finish_packet(hrt_abstime now)
+{
+	const bool valid = !_overflow && (_fill > 0);
+
+	if (valid) {
+		if (_count == 0) {
+			_first_packet_time = now;
+		}
+
+		_length[_count] = _fill;
+		_count++;
+	}
+
+	_fill = 0;
+	_overflow = false;
+	return valid;
+}
+
+MavlinkUdpTxBatch::Result MavlinkUdpTxBatch::flush(int socket_fd, const sockaddr_in &destination,
+		const sockaddr_in *broadcast)
+{
+	Result result{};
+
+	if (_count == 0) {
+		return result;
+	}
+
+	// all packets to the partner first, then the same packets to the broadcast address
+	const sockaddr_in *destinations[2] {&destination, broadcast};
+	size_t total = 0;
+
+	for (const sockaddr_in *dest : destinations) {
+		if (dest == nullptr) {
+			continue;
+		}
+
+		for (size_t i = 0; i < _count; i++) {
+			_iovs[total].iov_base = _packets[i];
+			_iovs[total].iov_len = _length[i];
+
+			msghdr &hdr = _msgs[total].msg_hdr;
+			hdr.msg_name = (void *)dest;
+			hdr.msg_namelen = sizeof(sockaddr_in);
+			hdr.msg_iov = &_iovs[total];
+			hdr.msg_iovlen = 1;
+			hdr.msg_control = nullptr;
+			hdr.msg_controllen = 0;
+			hdr.msg_flags = 0;
+			_msgs[total].msg_len = 0;
+			_failed[total] = false;
+			total++;
+		}
+	}
+
+	size_t next = 0;
+	int broadcast_errno = 0;
+
+	while (next < total) {
+		const int ret = sendmmsg(socket_fd, &_msgs[next], total - next, 0);
+		_syscall_count++;
+
+		if (ret > 0) {
+			next += ret;
+			continue;
+		}
+
+		// sendmmsg() stops at the first failing datagram, skip it and carry on with the next one
+		const int err = errno;
+		_failed[next] = true;
+
+		if (next >= _count) {
+			broadcast_errno = err;
+		}
+
+		next++;
+
+		if (err == EAGAIN || err == ENOBUFS) {
+			// no space in the socket buffer, drop the rest of the batch (EWOULDBLOCK is EAGAIN on Linux)
+			for (; next < total; next++) {
+				_failed[next] = true;
+			}
+
+			if (total > _count) {
+				broadcast_errno = err;
+			}
+		}
+	}
+
+	// statistics only count the packets to the partner, as the previous per packet sendto() did
+	for (size_t i = 0; i < _count; i++) {
+		if (!_failed[i] && (_msgs[i].msg_len == _length[i])) {
+			result.packets_sent++;
+			result.bytes_sent += _length[i];
+
+		} else {
+			result.packets_failed++;
+			result.bytes_failed += _length[i];
+		}
+	}
+
+	result.broadcast_errno = broadcast_errno;
+
+	_datagram_count += total;
+	_count = 0;
+
+	return result;
+}
+
+int MavlinkUdpRxBatch::receive(int socket_fd)
+{
+	for (int i = 0; i < MAX_DATAGRAMS; i++) {
+		_iovs[i].iov_base = _datagrams[i];
+		_iovs[i].iov_len = DATAGRAM_LEN_MAX;
+
+		msghdr &hdr = _msgs[i].msg_hdr;
+		hdr.msg_name = &_sources[i];
+		hdr.msg_namelen = sizeof(sockaddr_in);
+		hdr.msg_iov = &_iovs[i];
+		hdr.msg_iovlen = 1;
+		hdr.msg_control = nullptr;
+		hdr.msg_controllen = 0;
+		hdr.msg_flags = 0;
+		_msgs[i].msg_len = 0;
+	}
+
+	const int ret = recvmmsg(socket_fd, _msgs, MAX_DATAGRAMS, MSG_DONTWAIT, nullptr);
+	_syscall_count++;
+
+	if (ret < 0) {
+		// EWOULDBLOCK is EAGAIN on Linux
+		return (errno == EAGAIN) ? 0 : -1;
+	}
+
+	_datagram_count += ret;
+	return ret;
+}
+
+#endif // MAVLINK_UDP_BATCH
@@ -0,0 +1,185 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file mavlink_udp_batch.h
+ * Batched UDP transmission and reception with sendmmsg() / recvmmsg() (Linux only).
+ */
+
+#ifndef MAVLINK_UDP_BATCH_H_
+#define MAVLINK_UDP_BATCH_H_
+
+#if defined(__PX4_LINUX)
+# define MAVLINK_UDP_BATCH
+#endif
+
+#if defined(MAVLINK_UDP_BATCH)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <drivers/drv_hrt.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+using namespace time_literals;
+
+/**
+ * Outgoing MAVLink packets of one loop iteration. Every packet is assembled in
+ * its own slot and all of them are sent with a single sendmmsg() call on flush(),
+ * to the partner address and optionally again to the broadcast address.
+ *
+ * The batch should be flushed at the end of every loop iteration, and in between
+ * as soon as flush_required() tells that it is full or its first packet is too old.
+ */
+class MavlinkUdpTxBatch
+{
+public:
+	static constexpr size_t MAX_PACKETS = 32;
+	static constexpr size_t PACKET_LEN_MAX = 280; ///< MAVLINK_MAX_PACKET_LEN
+	static constexpr hrt_abstime MAX_DELAY_US = 5_ms; ///< longest a packet is queued, e.g. replies from the receiver thread
+
+	struct Result {
+		unsigned packets_sent;
+		unsigned bytes_sent;
+		unsigned packets_failed;
+		unsigned bytes_failed;
+		int broadcast_errno;	///< errno of the last failed broadcast datagram, 0 if none failed
+	};
+
+	MavlinkUdpTxBatch() = default;
+	~MavlinkUdpTxBatch() = default;
+
+	// no copy, assignment, move, move assignment
+	MavlinkUdpTxBatch(const MavlinkUdpTxBatch &) = delete;
+	MavlinkUdpTxBatch &operator=(const MavlinkUdpTxBatch &) = delete;
+	MavlinkUdpTxBatch(MavlinkUdpTxBatch &&) = delete;
+	MavlinkUdpTxBatch &operator=(MavlinkUdpTxBatch &&) = delete;
+
+	/**
+	 * Append bytes to the packet currently being assembled
+	 *
+	 * @return false if the packet does not fit into a slot, it is dropped on finish_packet()
+	 */
+	bool append(const uint8_t *buf, size_t len);
+
+	/**
+	 * Complete the current packet and queue it for the next flush()
+	 *
+	 * @param now time of the packet, the first one of a batch starts the flush timeout
+	 * @return false if the packet was dropped (empty or too long)
+	 */
+	bool finish_packet(hrt_abstime now);
+
+	bool full() const { return _count >= MAX_PACKETS; }
+	bool empty() const { return _count == 0; }
+
+	/**
+	 * @return true if the batch is full or its first packet has been queued for MAX_DELAY_US
+	 */
+	bool flush_required(hrt_abstime now) const
+	{
+		return full() || (!empty() && (now >= _first_packet_time + MAX_DELAY_US));
+	}
+
+	/**
+	 * Send all queued packets to destination (and to broadcast if not null) and clear the batch
+	 */
+	Result flush(int socket_fd, const sockaddr_in &destination, const sockaddr_in *broadcast);
+
+	unsigned get_syscall_count() const { return _syscall_count; }
+	unsigned get_datagram_count() const { return _datagram_count; }
+
+private:
+	uint8_t _packets[MAX_PACKETS][PACKET_LEN_MAX] {};
+	uint16_t _length[MAX_PACKETS] {};
+	size_t _count{0};		///< number of completed packets
+	size_t _fill{0};		///< bytes of the packet being assembled
+	bool _overflow{false};		///< the packet being assembled did not fit
+	hrt_abstime _first_packet_time{0};	///< time of the first queued packet
+
+	mmsghdr _msgs[2 * MAX_PACKETS] {};
+	iovec _iovs[2 * MAX_PACKETS] {};
+	bool _failed[2 * MAX_PACKETS] {};
+
+	unsigned _syscall_count{0};
+	unsigned _datagram_count{0};
+};
+
+/**
+ * Incoming datagrams, drained from the socket with a single recvmmsg() call.
+ */
+class MavlinkUdpRxBatch
+{
+public:
+	static constexpr int MAX_DATAGRAMS = 8;
+	static constexpr size_t DATAGRAM_LEN_MAX = 1600; ///< 1500 is the Wifi MTU, so we make sure to fit a full packet
+
+	MavlinkUdpRxBatch() = default;
+	~MavlinkUdpRxBatch() = default;
+
+	// no copy, assignment, move, move assignment
+	MavlinkUdpRxBatch(const MavlinkUdpRxBatch &) = delete;
+	MavlinkUdpRxBatch &operator=(const MavlinkUdpRxBatch &) = delete;
+	MavlinkUdpRxBatch(MavlinkUdpRxBatch &&) = delete;
+	MavlinkUdpRxBatch &operator=(MavlinkUdpRxBatch &&) = delete;
+
+	/**
+	 * Receive the pending datagrams without blocking
+	 *
+	 * @return number of datagrams received (MAX_DATAGRAMS if more might be pending), 0 if none, -1 on error
+	 */
+	int receive(int socket_fd);
+
+	const uint8_t *data(int i) const { return _datagrams[i]; }
+	size_t length(int i) const { return _msgs[i].msg_len; }
+	const sockaddr_in &source(int i) const { return _sources[i]; }
+
+	unsigned get_syscall_count() const { return _syscall_count; }
+	unsigned get_datagram_count() const { return _datagram_count; }
+
+private:
+	uint8_t _datagrams[MAX_DATAGRAMS][DATAGRAM_LEN_MAX] {};
+	sockaddr_in _sources[MAX_DATAGRAMS] {};
+	mmsghdr _msgs[MAX_DATAGRAMS] {};
+	iovec _iovs[MAX_DATAGRAMS] {};
+
+	unsigned _syscall_count{0};
+	unsigned _datagram_count{0};
+};
+
+#endif // MAVLINK_UDP_BATCH
+
+#endif /* MAVLINK_UDP_BATCH_H_ */
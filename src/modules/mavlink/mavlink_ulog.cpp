@@ -39,6 +39,7 @@
  */
 
 #include "mavlink_ulog.h"
+#include "mavlink_main.h"
 #include <px4_platform_common/log.h>
 #include <errno.h>
 #include <mathlib/mathlib.h>
@@ -56,39 +57,37 @@ MavlinkULog::MavlinkULog(int datarate, float max_rate_factor, uint8_t target_sys
 				      (MAVLINK_MSG_ID_LOGGING_DATA_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES)))),
 	  _current_rate_factor(max_rate_factor)
 {
-	// make sure we won't read any old messages
-	while (_ulog_stream_sub.update()) {
+	// make sure we won't send any data of a previous log: wait for the logger to start a new session
+	ULogStreamBuffer *buffer = ULogStreamBuffer::get();
 
+	if (buffer) {
+		buffer->lock();
+		_reader.session = buffer->session();
+		buffer->unlock();
 	}
 
 	_waiting_for_initial_ack = true;
-	_last_sent_time = hrt_absolute_time(); //(ab)use this timestamp during initialization
-	_next_rate_check = _last_sent_time + _rate_calculation_delta_t * 1.e6f;
-}
-
-MavlinkULog::~MavlinkULog()
-{
-	perf_free(_msg_missed_ulog_stream_perf);
+	_start_time = hrt_absolute_time();
+	_next_rate_check = _start_time + _rate_calculation_delta_t * 1.e6f;
 }
 
 void MavlinkULog::start_ack_received()
 {
 	if (_waiting_for_initial_ack) {
-		_last_sent_time = 0;
 		_waiting_for_initial_ack = false;
 		PX4_DEBUG("got logger ack");
 	}
 }
 
-int MavlinkULog::handle_update(mavlink_channel_t channel)
+int MavlinkULog::handle_update(Mavlink *mavlink)
 {
-	static_assert(sizeof(ulog_stream_s::data) == MAVLINK_MSG_LOGGING_DATA_FIELD_DATA_LEN,
-		      "Invalid uorb ulog_stream.data length");
-	static_assert(sizeof(ulog_stream_s::data) == MAVLINK_MSG_LOGGING_DATA_ACKED_FIELD_DATA_LEN,
-		      "Invalid uorb ulog_stream.data length");
+	static_assert(ULogStreamBuffer::DATA_LEN == MAVLINK_MSG_LOGGING_DATA_FIELD_DATA_LEN,
+		      "Invalid ULogStreamBuffer data length");
+	static_assert(ULogStreamBuffer::DATA_LEN == MAVLINK_MSG_LOGGING_DATA_ACKED_FIELD_DATA_LEN,
+		      "Invalid ULogStreamBuffer data length");
 
 	if (_waiting_for_initial_ack) {
-		if (hrt_elapsed_time(&_last_sent_time) > 3e5) {
+		if (hrt_elapsed_time(&_start_time) > 3e5) {
 			PX4_WARN("no ack from logger (is it running?)");
 			return -1;
 		}
@@ -96,91 +95,38 @@ int MavlinkULog::handle_update(mavlink_channel_t channel)
 		return 0;
 	}
 
-	// check if we're waiting for an ACK
-	if (_last_sent_time) {
-		bool check_for_updates = false;
-
-		if (_ack_received) {
-			_last_sent_time = 0;
-			check_for_updates = true;
+	ULogStreamBuffer *buffer = ULogStreamBuffer::get();
 
-		} else {
-
-			if (hrt_elapsed_time(&_last_sent_time) > ulog_stream_ack_s::ACK_TIMEOUT * 1000) {
-				if (++_sent_tries > ulog_stream_ack_s::ACK_MAX_TRIES) {
-					return -ETIMEDOUT;
-
-				} else {
-					PX4_DEBUG("re-sending ulog mavlink message (try=%i)", _sent_tries);
-					_last_sent_time = hrt_absolute_time();
-
-					const ulog_stream_s &ulog_data = _ulog_stream_sub.get();
-
-					mavlink_logging_data_acked_t msg;
-					msg.sequence = ulog_data.msg_sequence;
-					msg.length = ulog_data.length;
-					msg.first_message_offset = ulog_data.first_message_offset;
-					msg.target_system = _target_system;
-					msg.target_component = _target_component;
-					memcpy(msg.data, ulog_data.data, sizeof(msg.data));
-					mavlink_msg_logging_data_acked_send_struct(channel, &msg);
-				}
-			}
-		}
-
-		if (!check_for_updates) {
-			return 0;
-		}
+	if (buffer == nullptr) {
+		// the logger did not start writing yet
+		return 0;
 	}
 
+	const hrt_abstime now = hrt_absolute_time();
+	int ret = 0;
 
-	while ((_current_num_msgs < _max_num_messages) && _ulog_stream_sub.updated()) {
-		const unsigned last_generation = _ulog_stream_sub.get_last_generation();
-		_ulog_stream_sub.update();
+	// the chunk is copied out of the buffer, so that the buffer is not locked while sending
+	ULogStreamBuffer::Chunk chunk;
 
-		if (_ulog_stream_sub.get_last_generation() != last_generation + 1) {
-			perf_count(_msg_missed_ulog_stream_perf);
+	// the ULog data only uses the bandwidth left by the streams, a chunk that is held back stays in the buffer
+	while ((_current_num_msgs < _max_num_messages)
+	       && mavlink->tx_allowed(MavlinkBandwidthShaper::Priority::BULK, CHUNK_MESSAGE_SIZE)) {
+		ret = buffer->next_to_send(_reader, MAX_PENDING_ACKS, now, chunk);
+
+		if (ret <= 0) {
+			break;
 		}
 
-		const ulog_stream_s &ulog_data = _ulog_stream_sub.get();
-
-		if (ulog_data.timestamp > 0) {
-			if (ulog_data.flags & ulog_stream_s::FLAGS_NEED_ACK) {
-				_sent_tries = 1;
-				_last_sent_time = hrt_absolute_time();
-				lock();
-				_wait_for_ack_sequence = ulog_data.msg_sequence;
-				_ack_received = false;
-				unlock();
-
-				mavlink_logging_data_acked_t msg;
-				msg.sequence = ulog_data.msg_sequence;
-				msg.length = ulog_data.length;
-				msg.first_message_offset = ulog_data.first_message_offset;
-				msg.target_system = _target_system;
-				msg.target_component = _target_component;
-				memcpy(msg.data, ulog_data.data, sizeof(msg.data));
-				mavlink_msg_logging_data_acked_send_struct(channel, &msg);
-
-			} else {
-				mavlink_logging_data_t msg;
-				msg.sequence = ulog_data.msg_sequence;
-				msg.length = ulog_data.length;
-				msg.first_message_offset = ulog_data.first_message_offset;
-				msg.target_system = _target_system;
-				msg.target_component = _target_component;
-				memcpy(msg.data, ulog_data.data, sizeof(msg.data));
-				mavlink_msg_logging_data_send_struct(channel, &msg);
-			}
+		if (chunk.tries > 1) {
+			PX4_DEBUG("re-sending ulog mavlink message %i (try=%i)", chunk.sequence, chunk.tries);
 		}
 
-		++_current_num_msgs;
+		send_chunk(mavlink->get_channel(), chunk);
+		ret = 0;
 	}
 
 	//need to update the rate?
-	hrt_abstime t = hrt_absolute_time();
-
-	if (t > _next_rate_check) {
+	if (now > _next_rate_check) {
 		if (_current_num_msgs < _max_num_messages) {
 			_current_rate_factor = _max_rate_factor * (float)_current_num_msgs / _max_num_messages;
 
@@ -189,12 +135,26 @@ int MavlinkULog::handle_update(mavlink_channel_t channel)
 		}
 
 		_current_num_msgs = 0;
-		_next_rate_check = t + _rate_calculation_delta_t * 1.e6f;
+		_next_rate_check = now + _rate_calculation_delta_t * 1.e6f;
 		PX4_DEBUG("current rate=%.3f (max=%i msgs in %.3fs)", (double)_current_rate_factor, _max_num_messages,
 			  (double)_rate_calculation_delta_t);
 	}
 
-	return 0;
+	return ret;
+}
+
+void MavlinkULog::send_chunk(mavlink_channel_t channel, const ULogStreamBuffer::Chunk &chunk)
+{
+	if (chunk.need_ack) {
+		mavlink_msg_logging_data_acked_send(channel, _target_system, _target_component, chunk.sequence, chunk.length,
+						    chunk.first_message_offset, chunk.data);
+
+	} else {
+		mavlink_msg_logging_data_send(channel, _target_system, _target_component, chunk.sequence, chunk.length,
+					      chunk.first_message_offset, chunk.data);
+	}
+
+	++_current_num_msgs;
 }
 
 void MavlinkULog::initialize()
@@ -247,21 +207,11 @@ void MavlinkULog::handle_ack(mavlink_logging_ack_t ack)
 {
 	lock();
 
-	if (_instance) { // make sure stop() was not called right before
-		if (_wait_for_ack_sequence == ack.sequence) {
-			_ack_received = true;
-			publish_ack(ack.sequence);
-		}
+	ULogStreamBuffer *buffer = ULogStreamBuffer::get();
+
+	if (_instance && buffer) { // make sure stop() was not called right before
+		buffer->ack(_reader, ack.sequence);
 	}
 
 	unlock();
 }
-
-void MavlinkULog::publish_ack(uint16_t sequence)
-{
-	ulog_stream_ack_s ack;
-	ack.timestamp = hrt_absolute_time();
-	ack.msg_sequence = sequence;
-
-	_ulog_stream_ack_pub.publish(ack);
-}
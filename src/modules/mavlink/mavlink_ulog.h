@@ -45,18 +45,17 @@
 #include <px4_platform_common/tasks.h>
 #include <px4_platform_common/sem.h>
 #include <drivers/drv_hrt.h>
-#include <lib/perf/perf_counter.h>
-
-#include <uORB/Publication.hpp>
-#include <uORB/Subscription.hpp>
-#include <uORB/topics/ulog_stream.h>
-#include <uORB/topics/ulog_stream_ack.h>
+#include <lib/ulog_stream/ULogStreamBuffer.hpp>
 
 #include "mavlink_bridge_header.h"
 
+class Mavlink;
+
 /**
  * @class MavlinkULog
  * ULog streaming class. At most one instance (stream) can exist, assigned to a specific mavlink channel.
+ * The data is sent from the ULogStreamBuffer filled by the logger. Only one chunk that needs an ack is
+ * in flight at a time, as expected by the receivers (QGC, Tools/mavlink_ulog_streaming.py).
  */
 class MavlinkULog
 {
@@ -85,10 +84,11 @@ public:
 	void stop();
 
 	/**
-	 * periodic update method: check for ulog stream messages and handle retransmission.
+	 * periodic update method: send new chunks of the ulog stream buffer and handle retransmission.
+	 * Chunks are only sent while the bandwidth shaper of the instance allows BULK traffic.
 	 * @return 0 on success, <0 otherwise
 	 */
-	int handle_update(mavlink_channel_t channel);
+	int handle_update(Mavlink *mavlink);
 
 	/** ack from mavlink for a data message */
 	void handle_ack(mavlink_logging_ack_t ack);
@@ -103,7 +103,7 @@ private:
 
 	MavlinkULog(int datarate, float max_rate_factor, uint8_t target_system, uint8_t target_component);
 
-	~MavlinkULog();
+	~MavlinkULog() = default;
 
 	static void lock()
 	{
@@ -115,19 +115,18 @@ private:
 		px4_sem_post(&_lock);
 	}
 
-	void publish_ack(uint16_t sequence);
+	void send_chunk(mavlink_channel_t channel, const ULogStreamBuffer::Chunk &chunk);
 
 	static px4_sem_t _lock;
 	static bool _init;
 	static MavlinkULog *_instance;
 	static const float _rate_calculation_delta_t; ///< rate update interval
 
-	uORB::SubscriptionData<ulog_stream_s> _ulog_stream_sub{ORB_ID(ulog_stream)};
-	uORB::Publication<ulog_stream_ack_s> _ulog_stream_ack_pub{ORB_ID(ulog_stream_ack)};
-	uint16_t _wait_for_ack_sequence;
-	uint8_t _sent_tries = 0;
-	volatile bool _ack_received = false; ///< set to true if a matching ack received
-	hrt_abstime _last_sent_time = 0; ///< last time we sent a message that requires an ack
+	static constexpr int MAX_PENDING_ACKS = 1; ///< maximum number of chunks waiting for an ack
+	static constexpr unsigned CHUNK_MESSAGE_SIZE = MAVLINK_MSG_ID_LOGGING_DATA_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+
+	ULogStreamBuffer::Reader _reader{}; ///< sent chunks of the ULogStreamBuffer
+	hrt_abstime _start_time = 0; ///< time at which we started waiting for the logger
 	bool _waiting_for_initial_ack = false;
 	const uint8_t _target_system;
 	const uint8_t _target_component;
@@ -138,8 +137,6 @@ private:
 	int _current_num_msgs = 0;  ///< number of messages sent within the current time interval
 	hrt_abstime _next_rate_check; ///< next timestamp at which to update the rate
 
-	perf_counter_t _msg_missed_ulog_stream_perf{perf_alloc(PC_COUNT, MODULE_NAME": ulog_stream messages missed")};
-
 	/* do not allow copying this class */
 	MavlinkULog(const MavlinkULog &) = delete;
 	MavlinkULog operator=(const MavlinkULog &) = delete;
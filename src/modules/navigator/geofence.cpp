@@ -389,33 +389,50 @@ bool Geofence::insidePolygon(const PolygonInfo &polygon, double lat, double lon,
 	 * Only supports non-complex polygons (not self intersecting)
 	 */
 
-	mission_fence_point_s temp_vertex_i{};
+	// the vertices are read in chunks of one dataman access each, so every vertex is read only once
+	static constexpr unsigned VERTEX_CHUNK_SIZE = 8;
+	mission_fence_point_s vertices[VERTEX_CHUNK_SIZE];
 	mission_fence_point_s temp_vertex_j{};
 	bool c = false;
 
-	for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + i, &temp_vertex_i,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
+	if (polygon.vertex_count == 0) {
+		return c;
+	}
 
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + j, &temp_vertex_j,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
+	// the first vertex is paired with the last one
+	if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + polygon.vertex_count - 1, &temp_vertex_j,
+		    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
+		return c;
+	}
 
-		if (temp_vertex_i.frame != NAV_FRAME_GLOBAL && temp_vertex_i.frame != NAV_FRAME_GLOBAL_INT
-		    && temp_vertex_i.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT
-		    && temp_vertex_i.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-			// TODO: handle different frames
-			PX4_ERR("Frame type %i not supported", (int)temp_vertex_i.frame);
-			break;
+	for (unsigned chunk = 0; chunk < polygon.vertex_count; chunk += VERTEX_CHUNK_SIZE) {
+		const unsigned chunk_count = math::min((unsigned)polygon.vertex_count - chunk, VERTEX_CHUNK_SIZE);
+		const ssize_t read_count = dm_read_range(DM_KEY_FENCE_POINTS, polygon.dataman_index + chunk, chunk_count, vertices,
+					   sizeof(mission_fence_point_s));
+		const unsigned valid_count = (read_count > 0) ? (unsigned)read_count : 0;
+
+		for (unsigned k = 0; k < valid_count; k++) {
+			const mission_fence_point_s &temp_vertex_i = vertices[k];
+
+			if (temp_vertex_i.frame != NAV_FRAME_GLOBAL && temp_vertex_i.frame != NAV_FRAME_GLOBAL_INT
+			    && temp_vertex_i.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT
+			    && temp_vertex_i.frame != NAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
+				// TODO: handle different frames
+				PX4_ERR("Frame type %i not supported", (int)temp_vertex_i.frame);
+				return c;
+			}
+
+			if (((double)temp_vertex_i.lon >= lon) != ((double)temp_vertex_j.lon >= lon) &&
+			    (lat <= (double)(temp_vertex_j.lat - temp_vertex_i.lat) * (lon - (double)temp_vertex_i.lon) /
+			     (double)(temp_vertex_j.lon - temp_vertex_i.lon) + (double)temp_vertex_i.lat)) {
+				c = !c;
+			}
+
+			temp_vertex_j = temp_vertex_i;
 		}
 
-		if (((double)temp_vertex_i.lon >= lon) != ((double)temp_vertex_j.lon >= lon) &&
-		    (lat <= (double)(temp_vertex_j.lat - temp_vertex_i.lat) * (lon - (double)temp_vertex_i.lon) /
-		     (double)(temp_vertex_j.lon - temp_vertex_i.lon) + (double)temp_vertex_i.lat)) {
-			c = !c;
+		if (valid_count < chunk_count) {
+			break;
 		}
 	}
 
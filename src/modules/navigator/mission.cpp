@@ -1740,6 +1740,16 @@ Mission::check_mission_valid(bool force)
 {
 	if ((!_home_inited && _navigator->home_global_position_valid()) || force) {
 
+		// read the whole mission with a single batch, the checks below are then served from the dataman cache
+		dm_request_t prefetch{DM_REQUEST_PREFETCH, (dm_item_t)_mission.dataman_id, 0, _mission.count, nullptr, sizeof(mission_item_s), 0};
+		dm_batch_t batch{};
+		batch.requests = &prefetch;
+		batch.num_requests = 1;
+
+		if (dm_submit(&batch) == 0) {
+			dm_wait(&batch);
+		}
+
 		MissionFeasibilityChecker _missionFeasibilityChecker(_navigator);
 
 		_navigator->get_mission_result()->valid =
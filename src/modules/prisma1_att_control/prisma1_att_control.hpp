@@ -87,7 +87,7 @@ private:
 	uORB::SubscriptionInterval _parameter_update_sub{ORB_ID(parameter_update), 1_s};
 
 	// Input from UAV
-	uORB::SubscriptionCallbackWorkItem _vehicle_angular_velocity_sub{this, ORB_ID(vehicle_angular_velocity)};
+	uORB::SubscriptionCallbackWorkItem _vehicle_angular_velocity_sub{this, ORB_ID(vehicle_angular_velocity_medium)};
 	uORB::Subscription _vehicle_attitude_sub {ORB_ID(vehicle_attitude)};
 	uORB::Subscription _hover_thrust_estimate_sub {ORB_ID(hover_thrust_estimate)};
 	uORB::Subscription _vehicle_control_mode_sub {ORB_ID(vehicle_control_mode)};
@@ -45,102 +45,271 @@
 
 #include <float.h>
 
-DataValidatorGroup::DataValidatorGroup(unsigned siblings)
-{
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
-	DataValidator *next = nullptr;
-	DataValidator *prev = nullptr;
+static_assert(DataValidatorGroup::MAX_VALIDATORS == 4, "statistics update assumes 4 lanes");
 
+DataValidatorGroup::DataValidatorGroup(unsigned siblings)
+{
 	for (unsigned i = 0; i < siblings; i++) {
-		next = new DataValidator();
-
-		if (i == 0) {
-			_first = next;
-
-		} else {
-			prev->setSibling(next);
-		}
-
-		prev = next;
+		add_new_validator();
 	}
+}
 
-	_last = next;
-
-	if (_first) {
-		_timeout_interval_us = _first->get_timeout();
+bool DataValidatorGroup::add_new_validator()
+{
+	if (_validator_count >= MAX_VALIDATORS) {
+		return false;
 	}
+
+	_value_equal_count_threshold[_validator_count] = DataValidator::VALUE_EQUAL_COUNT_DEFAULT;
+	_validator_count++;
+	return true;
 }
 
-DataValidatorGroup::~DataValidatorGroup()
+void DataValidatorGroup::set_equal_value_threshold(uint32_t threshold)
 {
-	while (_first) {
-		DataValidator *next = _first->sibling();
-		delete (_first);
-		_first = next;
+	for (unsigned i = 0; i < _validator_count; i++) {
+		_value_equal_count_threshold[i] = threshold;
 	}
 }
 
-DataValidator *DataValidatorGroup::add_new_validator()
+void DataValidatorGroup::put(unsigned index, uint64_t timestamp, const float val[3], uint32_t error_count,
+			     uint8_t priority)
 {
+	if (index >= _validator_count) {
+		return;
+	}
 
-	DataValidator *validator = new DataValidator();
+	const uint8_t lane = 1 << index;
 
-	if (!validator) {
-		return nullptr;
+	if (_input_pending & lane) {
+		// this validator already has an item waiting
+		update_statistics();
 	}
 
-	_last->setSibling(validator);
-	_last = validator;
-	_last->set_timeout(_timeout_interval_us);
-	return _last;
-}
+	_event_count[index]++;
 
-void DataValidatorGroup::set_timeout(uint32_t timeout_interval_us)
-{
+	if (error_count > _error_count[index]) {
+		_error_density[index] += (error_count - _error_count[index]);
+
+	} else if (_error_density[index] > 0) {
+		_error_density[index]--;
+	}
+
+	_error_count[index] = error_count;
+	_priority[index] = priority;
 
-	DataValidator *next = _first;
+	for (unsigned axis = 0; axis < dimensions; axis++) {
+		_input[axis][index] = val[axis];
 
-	while (next != nullptr) {
-		next->set_timeout(timeout_interval_us);
-		next = next->sibling();
+		if (PX4_ISFINITE(val[axis])) {
+			_input_finite[axis] |= lane;
+
+		} else {
+			_input_finite[axis] &= ~lane;
+		}
+	}
+
+	if (_time_last[index] == 0) {
+		_input_first |= lane;
+
+	} else {
+		_input_first &= ~lane;
 	}
 
-	_timeout_interval_us = timeout_interval_us;
+	_input_pending |= lane;
+	_time_last[index] = timestamp;
 }
 
-void DataValidatorGroup::set_equal_value_threshold(uint32_t threshold)
+void DataValidatorGroup::update_statistics()
 {
+	if (_input_pending == 0) {
+		return;
+	}
+
+	// stale data check, counted sequentially over the axes of each validator
+	for (unsigned i = 0; i < _validator_count; i++) {
+		const uint8_t lane = 1 << i;
+
+		if ((_input_pending & lane) && !(_input_first & lane)) {
+			for (unsigned axis = 0; axis < dimensions; axis++) {
+				if (_input_finite[axis] & lane) {
+					if (fabsf(_value[i][axis] - _input[axis][i]) < 0.000001f) {
+						_value_equal_count[i]++;
+
+					} else {
+						_value_equal_count[i] = 0;
+					}
+				}
+			}
+		}
+	}
+
+	float event_count[MAX_VALIDATORS];
+	float event_count_m1[MAX_VALIDATORS];
+
+	for (unsigned i = 0; i < MAX_VALIDATORS; i++) {
+		// inactive lanes are computed and discarded, keep them finite
+		event_count[i] = (_event_count[i] > 1) ? _event_count[i] : 2.f;
+		event_count_m1[i] = (_event_count[i] > 1) ? _event_count[i] - 1 : 1.f;
+	}
+
+	// all validators for one axis per step, same operation order as DataValidator::put()
+	for (unsigned axis = 0; axis < dimensions; axis++) {
+		const uint8_t update = _input_pending & _input_finite[axis];
+		const uint8_t running = update & ~_input_first;
+
+#if defined(__SSE__)
+		const uint8_t first = update & _input_first;
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 update_mask = _mm_cmpneq_ps(_mm_setr_ps(update & 1, update & 2, update & 4, update & 8), zero);
+		const __m128 first_mask = _mm_cmpneq_ps(_mm_setr_ps(first & 1, first & 2, first & 4, first & 8), zero);
+		const __m128 running_mask = _mm_cmpneq_ps(_mm_setr_ps(running & 1, running & 2, running & 4, running & 8), zero);
+
+		const __m128 val = _mm_loadu_ps(_input[axis]);
+		const __m128 lp = _mm_loadu_ps(_lp[axis]);
+		const __m128 mean = _mm_loadu_ps(_mean[axis]);
+		const __m128 M2 = _mm_loadu_ps(_M2[axis]);
+		const __m128 rms = _mm_loadu_ps(_rms[axis]);
+
+		const __m128 lp_val = _mm_sub_ps(val, lp);
+		const __m128 delta_val = _mm_sub_ps(lp_val, mean);
+		const __m128 mean_new = _mm_add_ps(mean, _mm_div_ps(delta_val, _mm_loadu_ps(event_count)));
+		const __m128 M2_new = _mm_add_ps(M2, _mm_mul_ps(delta_val, _mm_sub_ps(lp_val, mean_new)));
+		const __m128 rms_new = _mm_sqrt_ps(_mm_div_ps(M2_new, _mm_loadu_ps(event_count_m1)));
+
+		// first item: mean = 0, lp = val, M2 = 0
+		const __m128 lp_init = _mm_or_ps(_mm_and_ps(first_mask, val), _mm_andnot_ps(first_mask, lp));
+		const __m128 lp_new = _mm_add_ps(_mm_mul_ps(lp_init, _mm_set1_ps(0.99f)), _mm_mul_ps(_mm_set1_ps(0.01f), val));
+
+		_mm_storeu_ps(_lp[axis], _mm_or_ps(_mm_and_ps(update_mask, lp_new), _mm_andnot_ps(update_mask, lp)));
+		_mm_storeu_ps(_mean[axis], _mm_andnot_ps(first_mask,
+				_mm_or_ps(_mm_and_ps(running_mask, mean_new), _mm_andnot_ps(running_mask, mean))));
+		_mm_storeu_ps(_M2[axis], _mm_andnot_ps(first_mask,
+				_mm_or_ps(_mm_and_ps(running_mask, M2_new), _mm_andnot_ps(running_mask, M2))));
+		_mm_storeu_ps(_rms[axis], _mm_or_ps(_mm_and_ps(running_mask, rms_new), _mm_andnot_ps(running_mask, rms)));
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		const uint8_t first = update & _input_first;
+		const float32x4_t zero = vdupq_n_f32(0.f);
+		const float update_lanes[4] {(float)(update & 1), (float)(update & 2), (float)(update & 4), (float)(update & 8)};
+		const float first_lanes[4] {(float)(first & 1), (float)(first & 2), (float)(first & 4), (float)(first & 8)};
+		const float running_lanes[4] {(float)(running & 1), (float)(running & 2), (float)(running & 4), (float)(running & 8)};
+		const uint32x4_t update_mask = vcgtq_f32(vld1q_f32(update_lanes), zero);
+		const uint32x4_t first_mask = vcgtq_f32(vld1q_f32(first_lanes), zero);
+		const uint32x4_t running_mask = vcgtq_f32(vld1q_f32(running_lanes), zero);
+
+		const float32x4_t val = vld1q_f32(_input[axis]);
+		const float32x4_t lp = vld1q_f32(_lp[axis]);
+		const float32x4_t mean = vld1q_f32(_mean[axis]);
+		const float32x4_t M2 = vld1q_f32(_M2[axis]);
+		const float32x4_t rms = vld1q_f32(_rms[axis]);
+
+		const float32x4_t lp_val = vsubq_f32(val, lp);
+		const float32x4_t delta_val = vsubq_f32(lp_val, mean);
+		const float32x4_t mean_new = vaddq_f32(mean, vdivq_f32(delta_val, vld1q_f32(event_count)));
+		const float32x4_t M2_new = vaddq_f32(M2, vmulq_f32(delta_val, vsubq_f32(lp_val, mean_new)));
+		const float32x4_t rms_new = vsqrtq_f32(vdivq_f32(M2_new, vld1q_f32(event_count_m1)));
+
+		// first item: mean = 0, lp = val, M2 = 0
+		const float32x4_t lp_init = vbslq_f32(first_mask, val, lp);
+		const float32x4_t lp_new = vaddq_f32(vmulq_f32(lp_init, vdupq_n_f32(0.99f)), vmulq_f32(vdupq_n_f32(0.01f), val));
+
+		vst1q_f32(_lp[axis], vbslq_f32(update_mask, lp_new, lp));
+		vst1q_f32(_mean[axis], vbslq_f32(first_mask, zero, vbslq_f32(running_mask, mean_new, mean)));
+		vst1q_f32(_M2[axis], vbslq_f32(first_mask, zero, vbslq_f32(running_mask, M2_new, M2)));
+		vst1q_f32(_rms[axis], vbslq_f32(running_mask, rms_new, rms));
+
+#else
+		(void)event_count_m1;
+
+		for (unsigned i = 0; i < _validator_count; i++) {
+			const uint8_t lane = 1 << i;
+
+			if (update & lane) {
+				const float val = _input[axis][i];
+
+				if (!(running & lane)) {
+					_mean[axis][i] = 0;
+					_lp[axis][i] = val;
+					_M2[axis][i] = 0;
+
+				} else {
+					const float lp_val = val - _lp[axis][i];
+
+					const float delta_val = lp_val - _mean[axis][i];
+					_mean[axis][i] += delta_val / event_count[i];
+					_M2[axis][i] += delta_val * (lp_val - _mean[axis][i]);
+					_rms[axis][i] = sqrtf(_M2[axis][i] / event_count_m1[i]);
+				}
+
+				_lp[axis][i] = _lp[axis][i] * 0.99f + 0.01f * val;
+			}
+		}
 
-	DataValidator *next = _first;
+#endif
 
-	while (next != nullptr) {
-		next->set_equal_value_threshold(threshold);
-		next = next->sibling();
+		for (unsigned i = 0; i < _validator_count; i++) {
+			if (update & (1 << i)) {
+				_value[i][axis] = _input[axis][i];
+			}
+		}
 	}
+
+	_input_pending = 0;
 }
 
-void DataValidatorGroup::put(unsigned index, uint64_t timestamp, const float val[3], uint32_t error_count,
-			     uint8_t priority)
+float DataValidatorGroup::confidence(unsigned index, uint64_t timestamp)
 {
+	float ret = 1.0f;
+
+	/* check if we have any data */
+	if (_time_last[index] == 0) {
+		_error_mask[index] |= DataValidator::ERROR_FLAG_NO_DATA;
+		ret = 0.0f;
+
+	} else if (timestamp > _time_last[index] + _timeout_interval_us) {
+		/* timed out - that's it */
+		_error_mask[index] |= DataValidator::ERROR_FLAG_TIMEOUT;
+		ret = 0.0f;
+
+	} else if (_value_equal_count[index] > _value_equal_count_threshold[index]) {
+		/* we got the exact same sensor value N times in a row */
+		_error_mask[index] |= DataValidator::ERROR_FLAG_STALE_DATA;
+		ret = 0.0f;
+
+	} else if (_error_count[index] > DataValidator::NORETURN_ERRCOUNT) {
+		/* check error count limit */
+		_error_mask[index] |= DataValidator::ERROR_FLAG_HIGH_ERRCOUNT;
+		ret = 0.0f;
+
+	} else if (_error_density[index] > DataValidator::ERROR_DENSITY_WINDOW) {
+		/* cap error density counter at window size */
+		_error_mask[index] |= DataValidator::ERROR_FLAG_HIGH_ERRDENSITY;
+		_error_density[index] = DataValidator::ERROR_DENSITY_WINDOW;
+	}
 
-	DataValidator *next = _first;
-	unsigned i = 0;
+	/* no critical errors */
+	if (ret > 0.0f) {
+		/* return local error density for last N measurements */
+		ret = 1.0f - (_error_density[index] / DataValidator::ERROR_DENSITY_WINDOW);
 
-	while (next != nullptr) {
-		if (i == index) {
-			next->put(timestamp, val, error_count, priority);
-			break;
+		if (ret > 0.0f) {
+			_error_mask[index] = DataValidator::ERROR_FLAG_NO_ERROR;
 		}
-
-		next = next->sibling();
-		i++;
 	}
+
+	return ret;
 }
 
 float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 {
-
-	DataValidator *next = _first;
+	update_statistics();
 
 	// XXX This should eventually also include voting
 	int pre_check_best = _curr_best;
@@ -149,16 +318,13 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 	float max_confidence = -1.0f;
 	int max_priority = -1000;
 	int max_index = -1;
-	DataValidator *best = nullptr;
-
-	int i = 0;
 
-	while (next != nullptr) {
-		float confidence = next->confidence(timestamp);
+	for (unsigned i = 0; i < _validator_count; i++) {
+		float confidence_i = confidence(i, timestamp);
 
-		if (i == pre_check_best) {
-			pre_check_prio = next->priority();
-			pre_check_confidence = confidence;
+		if ((int)i == pre_check_best) {
+			pre_check_prio = _priority[i];
+			pre_check_confidence = confidence_i;
 		}
 
 		/*
@@ -166,18 +332,14 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 		 * 1) the confidence is higher and priority is equal or higher
 		 * 2) the confidence is less than 1% different and the priority is higher
 		 */
-		if ((((max_confidence < MIN_REGULAR_CONFIDENCE) && (confidence >= MIN_REGULAR_CONFIDENCE)) ||
-		     (confidence > max_confidence && (next->priority() >= max_priority)) ||
-		     (fabsf(confidence - max_confidence) < 0.01f && (next->priority() > max_priority))) &&
-		    (confidence > 0.0f)) {
+		if ((((max_confidence < MIN_REGULAR_CONFIDENCE) && (confidence_i >= MIN_REGULAR_CONFIDENCE)) ||
+		     (confidence_i > max_confidence && (_priority[i] >= max_priority)) ||
+		     (fabsf(confidence_i - max_confidence) < 0.01f && (_priority[i] > max_priority))) &&
+		    (confidence_i > 0.0f)) {
 			max_index = i;
-			max_confidence = confidence;
-			max_priority = next->priority();
-			best = next;
+			max_confidence = confidence_i;
+			max_priority = _priority[i];
 		}
-
-		next = next->sibling();
-		i++;
 	}
 
 	/* the current best sensor is not matching the previous best sensor,
@@ -192,8 +354,8 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 			true_failsafe = false;
 
 			/* reset error flags, this is likely a hotplug sensor coming online late */
-			if (best != nullptr) {
-				best->reset_state();
+			if (max_index >= 0) {
+				_error_mask[max_index] = DataValidator::ERROR_FLAG_NO_ERROR;
 			}
 		}
 
@@ -220,22 +382,21 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 	}
 
 	*index = max_index;
-	return (best) ? best->value() : nullptr;
+	return (max_index >= 0) ? _value[max_index] : nullptr;
 }
 
 void DataValidatorGroup::print()
 {
+	update_statistics();
+
 	PX4_INFO_RAW("validator: best: %d, prev best: %d, failsafe: %s (%u events)\n", _curr_best, _prev_best,
 		     (_toggle_count > 0) ? "YES" : "NO", _toggle_count);
 
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used()) {
-			uint32_t flags = next->state();
+	for (unsigned i = 0; i < _validator_count; i++) {
+		if (used(i)) {
+			uint32_t flags = _error_mask[i];
 
-			PX4_INFO_RAW("sensor #%u, prio: %d, state:%s%s%s%s%s%s\n", i, next->priority(),
+			PX4_INFO_RAW("sensor #%u, prio: %d, state:%s%s%s%s%s%s\n", i, _priority[i],
 				     ((flags & DataValidator::ERROR_FLAG_NO_DATA) ? " OFF" : ""),
 				     ((flags & DataValidator::ERROR_FLAG_STALE_DATA) ? " STALE" : ""),
 				     ((flags & DataValidator::ERROR_FLAG_TIMEOUT) ? " TOUT" : ""),
@@ -243,27 +404,20 @@ void DataValidatorGroup::print()
 				     ((flags & DataValidator::ERROR_FLAG_HIGH_ERRDENSITY) ? " EDNST" : ""),
 				     ((flags == DataValidator::ERROR_FLAG_NO_ERROR) ? " OK" : ""));
 
-			next->print();
+			for (unsigned axis = 0; axis < dimensions; axis++) {
+				PX4_INFO_RAW("\tval: %8.4f, lp: %8.4f mean dev: %8.4f RMS: %8.4f conf: %8.4f\n", (double)_value[i][axis],
+					     (double)_lp[axis][i], (double)_mean[axis][i], (double)_rms[axis][i],
+					     (double)confidence(i, hrt_absolute_time()));
+			}
 		}
-
-		next = next->sibling();
-		i++;
 	}
 }
 
 int DataValidatorGroup::failover_index()
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used() && (next->state() != DataValidator::ERROR_FLAG_NO_ERROR) &&
-		    (i == (unsigned)_prev_best)) {
-			return i;
-		}
-
-		next = next->sibling();
-		i++;
+	if ((_prev_best >= 0) && ((unsigned)_prev_best < _validator_count) && used(_prev_best)
+	    && (_error_mask[_prev_best] != DataValidator::ERROR_FLAG_NO_ERROR)) {
+		return _prev_best;
 	}
 
 	return -1;
@@ -271,18 +425,10 @@ int DataValidatorGroup::failover_index()
 
 uint32_t DataValidatorGroup::failover_state()
 {
+	const int index = failover_index();
 
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used() && (next->state() != DataValidator::ERROR_FLAG_NO_ERROR) &&
-		    (i == (unsigned)_prev_best)) {
-			return next->state();
-		}
-
-		next = next->sibling();
-		i++;
+	if (index >= 0) {
+		return _error_mask[index];
 	}
 
 	return DataValidator::ERROR_FLAG_NO_ERROR;
@@ -290,16 +436,8 @@ uint32_t DataValidatorGroup::failover_state()
 
 uint32_t DataValidatorGroup::get_sensor_state(unsigned index)
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (i == index) {
-			return next->state();
-		}
-
-		next = next->sibling();
-		i++;
+	if (index < _validator_count) {
+		return _error_mask[index];
 	}
 
 	// sensor index not found
@@ -308,18 +446,45 @@ uint32_t DataValidatorGroup::get_sensor_state(unsigned index)
 
 uint8_t DataValidatorGroup::get_sensor_priority(unsigned index)
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
+	if (index < _validator_count) {
+		return _priority[index];
+	}
+
+	// sensor index not found
+	return 0;
+}
+
+float DataValidatorGroup::get_sensor_confidence(unsigned index, uint64_t timestamp)
+{
+	if (index < _validator_count) {
+		update_statistics();
+		return confidence(index, timestamp);
+	}
+
+	return 0.f;
+}
+
+const float *DataValidatorGroup::get_sensor_value(unsigned index)
+{
+	if (index < _validator_count) {
+		update_statistics();
+		return _value[index];
+	}
 
-	while (next != nullptr) {
-		if (i == index) {
-			return next->priority();
+	return nullptr;
+}
+
+bool DataValidatorGroup::get_sensor_rms(unsigned index, float rms[dimensions])
+{
+	if (index < _validator_count) {
+		update_statistics();
+
+		for (unsigned axis = 0; axis < dimensions; axis++) {
+			rms[axis] = _rms[axis][index];
 		}
 
-		next = next->sibling();
-		i++;
+		return true;
 	}
 
-	// sensor index not found
-	return 0;
+	return false;
 }
@@ -46,21 +46,28 @@
 class DataValidatorGroup
 {
 public:
+	static constexpr unsigned MAX_VALIDATORS = 4; /**< one SIMD lane per validator */
+	static constexpr unsigned dimensions = DataValidator::dimensions;
+
 	/**
-	 * @param siblings initial number of DataValidator's. Must be > 0.
+	 * @param siblings initial number of validators. Must be > 0 and <= MAX_VALIDATORS.
 	 */
 	DataValidatorGroup(unsigned siblings);
-	~DataValidatorGroup();
+	~DataValidatorGroup() = default;
 
 	/**
 	 * Create a new Validator (with index equal to the number of currently existing validators)
-	 * @return the newly created DataValidator or nullptr on error
+	 * @return true if the validator was added, false if the group is full
 	 */
-	DataValidator *add_new_validator();
+	bool add_new_validator();
 
 	/**
 	 * Put an item into the validator group.
 	 *
+	 * The statistics of all validators are updated together in a single vectorized pass,
+	 * deferred until the group state is needed (get_best(), print(), ...) or the same
+	 * validator receives another item.
+	 *
 	 * @param index		Sensor index
 	 * @param timestamp	The timestamp of the measurement
 	 * @param val		The 3D vector
@@ -111,6 +118,26 @@ public:
 	 */
 	uint8_t get_sensor_priority(unsigned index);
 
+	/**
+	 * Get the confidence of the sensor with the specified index
+	 *
+	 * @return		the confidence between 0 and 1
+	 */
+	float get_sensor_confidence(unsigned index, uint64_t timestamp);
+
+	/**
+	 * Get the last value and RMS of the sensor with the specified index
+	 *
+	 * @return		pointer to the 3D vector, nullptr if the index is invalid
+	 */
+	const float *get_sensor_value(unsigned index);
+	bool get_sensor_rms(unsigned index, float rms[dimensions]);
+
+	/**
+	 * Get the number of validators in the group
+	 */
+	unsigned validator_count() const { return _validator_count; }
+
 	/**
 	 * Print the validator value
 	 *
@@ -122,20 +149,56 @@ public:
 	 *
 	 * @param timeout_interval_us The timeout interval in microseconds
 	 */
-	void set_timeout(uint32_t timeout_interval_us);
+	void set_timeout(uint32_t timeout_interval_us) { _timeout_interval_us = timeout_interval_us; }
 
 	/**
-	 * Set the equal count threshold for the whole group
+	 * Get the timeout value of the group
+	 *
+	 * @return The timeout interval in microseconds
+	 */
+	uint32_t get_timeout() const { return _timeout_interval_us; }
+
+	/**
+	 * Set the equal count threshold for all current validators of the group
 	 *
 	 * @param threshold The number of equal values before considering the sensor stale
 	 */
 	void set_equal_value_threshold(uint32_t threshold);
 
 private:
-	DataValidator *_first{nullptr}; /**< first node in the group */
-	DataValidator *_last{nullptr};  /**< last node in the group */
+	void update_statistics();
+
+	float confidence(unsigned index, uint64_t timestamp);
+
+	bool used(unsigned index) const { return (_time_last[index] > 0); }
+
+	// per validator state
+	uint64_t _time_last[MAX_VALIDATORS] {};   /**< last timestamp */
+	uint64_t _event_count[MAX_VALIDATORS] {}; /**< total data counter */
+	uint32_t _error_count[MAX_VALIDATORS] {}; /**< error count */
+	uint32_t _error_mask[MAX_VALIDATORS] {};  /**< sensor error state */
+	int _error_density[MAX_VALIDATORS] {};    /**< ratio between successful reads and errors */
+	uint8_t _priority[MAX_VALIDATORS] {};     /**< sensor nominal priority */
+
+	unsigned _value_equal_count[MAX_VALIDATORS] {};           /**< equal values in a row */
+	unsigned _value_equal_count_threshold[MAX_VALIDATORS] {}; /**< when to consider an equal count as a problem */
+
+	// per axis state, structure of arrays with the validators as lanes
+	float _mean[dimensions][MAX_VALIDATORS] {};  /**< mean of value */
+	float _lp[dimensions][MAX_VALIDATORS] {};    /**< low pass value */
+	float _M2[dimensions][MAX_VALIDATORS] {};    /**< RMS component value */
+	float _rms[dimensions][MAX_VALIDATORS] {};   /**< root mean square error */
+	float _input[dimensions][MAX_VALIDATORS] {}; /**< items waiting for the next statistics update */
+
+	float _value[MAX_VALIDATORS][dimensions] {}; /**< last value */
+
+	uint8_t _input_pending{0}; /**< validators with an item in _input */
+	uint8_t _input_first{0};   /**< validators receiving their first item */
+	uint8_t _input_finite[dimensions] {}; /**< per axis, validators with a finite item */
+
+	unsigned _validator_count{0};
 
-	uint32_t _timeout_interval_us{0}; /**< currently set timeout */
+	uint32_t _timeout_interval_us{40000}; /**< currently set timeout */
 
 	int _curr_best{-1}; /**< currently best index */
 	int _prev_best{-1}; /**< the previous best index */
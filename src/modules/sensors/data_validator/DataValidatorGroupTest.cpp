@@ -0,0 +1,197 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * Test code for the DataValidatorGroup, checked against individual DataValidator instances
+ * Run this test only using make tests TESTFILTER=DataValidatorGroup
+ */
+
+#include <gtest/gtest.h>
+
+#include "DataValidator.hpp"
+#include "DataValidatorGroup.hpp"
+
+// The SSE and scalar statistics update are checked bit by bit. The aarch64 NEON path has not been run against the
+// reference and the compiler may contract the scalar reference into fused multiply-adds there, so it is only
+// checked to be close.
+#if defined(__ARM_NEON) && defined(__aarch64__) && !defined(__SSE__)
+#define EXPECT_STATISTICS_EQ(val, ref) EXPECT_NEAR(val, ref, 1e-5f * fmaxf(1.f, fabsf(ref)))
+#else
+#define EXPECT_STATISTICS_EQ(val, ref) EXPECT_EQ(val, ref)
+#endif
+
+class DataValidatorGroupTest : public ::testing::Test
+{
+public:
+	static constexpr unsigned MAX = DataValidatorGroup::MAX_VALIDATORS;
+
+	void put(unsigned index, uint64_t timestamp, const float val[3], uint32_t error_count, uint8_t priority)
+	{
+		_group.put(index, timestamp, val, error_count, priority);
+		_reference[index].put(timestamp, val, error_count, priority);
+	}
+
+	void compare(unsigned index, uint64_t timestamp)
+	{
+		const float *value = _group.get_sensor_value(index);
+		ASSERT_NE(value, nullptr);
+
+		float rms[3];
+		ASSERT_TRUE(_group.get_sensor_rms(index, rms));
+
+		for (int axis = 0; axis < 3; axis++) {
+			EXPECT_EQ(value[axis], _reference[index].value()[axis]) << "sensor " << index << " axis " << axis;
+			EXPECT_STATISTICS_EQ(rms[axis], _reference[index].rms()[axis]) << "sensor " << index << " axis " << axis;
+		}
+
+		EXPECT_EQ(_group.get_sensor_confidence(index, timestamp), _reference[index].confidence(timestamp));
+		EXPECT_EQ(_group.get_sensor_state(index), _reference[index].state());
+		EXPECT_EQ(_group.get_sensor_priority(index), _reference[index].priority());
+	}
+
+	DataValidatorGroup _group{1};
+	DataValidator _reference[MAX];
+};
+
+TEST_F(DataValidatorGroupTest, addValidators)
+{
+	EXPECT_EQ(_group.validator_count(), 1u);
+
+	for (unsigned i = 1; i < MAX; i++) {
+		EXPECT_TRUE(_group.add_new_validator());
+	}
+
+	EXPECT_EQ(_group.validator_count(), (unsigned)MAX);
+	EXPECT_FALSE(_group.add_new_validator());
+
+	int index = 0;
+	EXPECT_EQ(_group.get_best(1000, &index), nullptr);
+	EXPECT_EQ(index, -1);
+
+	EXPECT_EQ(_group.get_sensor_state(MAX), (uint32_t)UINT32_MAX);
+	EXPECT_EQ(_group.get_sensor_value(MAX), nullptr);
+}
+
+TEST_F(DataValidatorGroupTest, matchesDataValidator)
+{
+	for (unsigned i = 1; i < MAX; i++) {
+		ASSERT_TRUE(_group.add_new_validator());
+	}
+
+	uint64_t timestamp = 1000;
+	uint32_t error_count[MAX] {};
+
+	for (int n = 0; n < 2000; n++) {
+		timestamp += 4000;
+
+		for (unsigned i = 0; i < MAX; i++) {
+			// sensor 3 only every other cycle, sensor 2 twice per cycle
+			if ((i == 3) && (n % 2)) {
+				continue;
+			}
+
+			const int repeat = (i == 2) ? 2 : 1;
+
+			for (int r = 0; r < repeat; r++) {
+				float val[3];
+
+				for (int axis = 0; axis < 3; axis++) {
+					val[axis] = sinf(0.01f * n + axis + i) * (1.f + i) + 0.001f * r;
+				}
+
+				if ((i == 1) && (n % 97 == 0)) {
+					// occasional invalid axis
+					val[1] = NAN;
+				}
+
+				if ((i == 0) && (n > 1500)) {
+					// stuck sensor
+					val[0] = val[1] = val[2] = 1.f;
+				}
+
+				if (n % 50 == 0) {
+					error_count[i] += i;
+				}
+
+				put(i, timestamp + r, val, error_count[i], 100 - 10 * i);
+			}
+		}
+
+		if (n % 10 == 0) {
+			int best = -1;
+			_group.get_best(timestamp, &best);
+
+			for (unsigned i = 0; i < MAX; i++) {
+				compare(i, timestamp);
+			}
+		}
+	}
+}
+
+TEST_F(DataValidatorGroupTest, failover)
+{
+	ASSERT_TRUE(_group.add_new_validator());
+	_group.set_timeout(20000);
+
+	uint64_t timestamp = 1000;
+	int best = -1;
+
+	for (int n = 0; n < 100; n++) {
+		timestamp += 5000;
+		const float val[3] {0.1f * n, 1.f, -0.1f * n};
+
+		_group.put(0, timestamp, val, 0, 100);
+		_group.put(1, timestamp, val, 0, 50);
+
+		const float *best_value = _group.get_best(timestamp, &best);
+		ASSERT_NE(best_value, nullptr);
+		EXPECT_EQ(best_value[0], val[0]);
+	}
+
+	// highest priority sensor selected
+	EXPECT_EQ(best, 0);
+	EXPECT_EQ(_group.failover_count(), 0u);
+
+	// sensor 0 stops publishing
+	for (int n = 0; n < 10; n++) {
+		timestamp += 5000;
+		const float val[3] {1.f * n, 1.f, 1.f};
+		_group.put(1, timestamp, val, 0, 50);
+		_group.get_best(timestamp, &best);
+	}
+
+	EXPECT_EQ(best, 1);
+	EXPECT_EQ(_group.failover_count(), 1u);
+	EXPECT_EQ(_group.failover_index(), 0);
+	EXPECT_EQ(_group.failover_state(), (uint32_t)DataValidator::ERROR_FLAG_TIMEOUT);
+}
@@ -50,7 +50,7 @@
 const uint32_t base_timeout_usec = 2000;//from original private value
 const int equal_value_count = 100; //default is private VALUE_EQUAL_COUNT_DEFAULT
 const uint64_t base_timestamp = 666;
-const unsigned base_num_siblings = 4;
+const unsigned base_num_siblings = DataValidatorGroup::MAX_VALIDATORS - 2; // leave room for two more
 
 
 /**
@@ -144,41 +144,64 @@ void fill_two_with_valid_data(DataValidatorGroup *group, int val1_idx, int val2_
 
 }
 
+/**
+ * Insert a time series of samples into one validator of the group
+ * @param group
+ * @param val_idx Index of the validator to fill with samples
+ * @param incr_value The amount to increment the value by on each iteration
+ * @param value_io (in/out) in: initial value, out: final value
+ * @param timestamp_io (in/out) in: initial timestamp, out: final timestamp
+ */
+void fill_group_validator_with_samples(DataValidatorGroup *group, int val_idx, const float incr_value,
+				       float *value_io, uint64_t *timestamp_io)
+{
+	uint64_t timestamp = *timestamp_io;
+	const uint64_t timestamp_incr = 5; //usec
+	float val = *value_io;
+
+	//put a bunch of values that are all different
+	for (int i = 0; i < equal_value_count; i++, val += incr_value) {
+		timestamp += timestamp_incr;
+		float data[DataValidator::dimensions] = {val};
+		group->put(val_idx, timestamp, data, 0, 50);
+	}
+
+	*timestamp_io = timestamp;
+	*value_io = val;
+}
+
 /**
  * Dynamically add a validator to the group after construction
  * @param group
- * @return
+ * @return index of the new validator
  */
-DataValidator *add_validator_to_group(DataValidatorGroup *group)
+int add_validator_to_group(DataValidatorGroup *group)
 {
-	DataValidator *validator = group->add_new_validator();
+	const bool added = group->add_new_validator();
+	assert(added);
+	(void)added;
 	//verify the previously set timeout applies to the new group member
-	assert(validator->get_timeout() == base_timeout_usec);
+	assert(group->get_timeout() == base_timeout_usec);
 	//for testing purposes, ensure this newly added member is consistent with the rest of the group
 	//TODO this is likely a bug in DataValidatorGroup
-	validator->set_equal_value_threshold(equal_value_count);
+	group->set_equal_value_threshold(equal_value_count);
 
-	return validator;
+	return (int)group->validator_count() - 1;
 }
 
 /**
  * Create a DataValidatorGroup and tack on two additional DataValidators
  *
- * @param validator1_handle (out) first DataValidator added to the group
- * @param validator2_handle (out) second DataValidator added to the group
  * @param sibling_count (in/out) in: number of initial siblings to create, out: total
  * @return
  */
-DataValidatorGroup *setup_group_with_two_validator_handles(
-	DataValidator **validator1_handle,
-	DataValidator **validator2_handle,
-	unsigned *sibling_count)
+DataValidatorGroup *setup_group_with_two_validators(unsigned *sibling_count)
 {
 	DataValidatorGroup *group = setup_base_group(sibling_count);
 
 	//now we add validators
-	*validator1_handle = add_validator_to_group(group);
-	*validator2_handle = add_validator_to_group(group);
+	add_validator_to_group(group);
+	add_validator_to_group(group);
 	*sibling_count += 2;
 
 	return group;
@@ -205,12 +228,10 @@ void test_init()
 void test_put()
 {
 	unsigned num_siblings = 0;
-	DataValidator *validator1 = nullptr;
-	DataValidator *validator2 = nullptr;
 
 	uint64_t timestamp = base_timestamp;
 
-	DataValidatorGroup *group = setup_group_with_two_validator_handles(&validator1, &validator2, &num_siblings);
+	DataValidatorGroup *group = setup_group_with_two_validators(&num_siblings);
 	printf("num_siblings: %d \n", num_siblings);
 	unsigned val1_idx = num_siblings - 2;
 	unsigned val2_idx = num_siblings - 1;
@@ -221,12 +242,12 @@ void test_put()
 	assert(nullptr != best_data);
 	float best_val = best_data[0];
 
-	float *cur_val1 = validator1->value();
+	const float *cur_val1 = group->get_sensor_value(val1_idx);
 	assert(nullptr != cur_val1);
 	//printf("cur_val1 %p \n", cur_val1);
 	assert(best_val == cur_val1[0]);
 
-	float *cur_val2 = validator2->value();
+	const float *cur_val2 = group->get_sensor_value(val2_idx);
 	assert(nullptr != cur_val2);
 	//printf("cur_val12 %p \n", cur_val2);
 	assert(best_val == cur_val2[0]);
@@ -241,12 +262,10 @@ void test_put()
 void test_priority_switch()
 {
 	unsigned num_siblings = 0;
-	DataValidator *validator1 = nullptr;
-	DataValidator *validator2 = nullptr;
 
 	uint64_t timestamp = base_timestamp;
 
-	DataValidatorGroup *group = setup_group_with_two_validator_handles(&validator1, &validator2, &num_siblings);
+	DataValidatorGroup *group = setup_group_with_two_validators(&num_siblings);
 	//printf("num_siblings: %d \n",num_siblings);
 	int val1_idx = (int)num_siblings - 2;
 	int val2_idx = (int)num_siblings - 1;
@@ -278,12 +297,10 @@ void test_priority_switch()
 void test_simple_failover()
 {
 	unsigned num_siblings = 0;
-	DataValidator *validator1 = nullptr;
-	DataValidator *validator2 = nullptr;
 
 	uint64_t timestamp = base_timestamp;
 
-	DataValidatorGroup *group = setup_group_with_two_validator_handles(&validator1, &validator2, &num_siblings);
+	DataValidatorGroup *group = setup_group_with_two_validators(&num_siblings);
 	//printf("num_siblings: %d \n",num_siblings);
 	int val1_idx = (int)num_siblings - 2;
 	int val2_idx = (int)num_siblings - 1;
@@ -305,8 +322,6 @@ void test_simple_failover()
 		group->put(val2_idx, timestamp, data, 0, 10);
 	}
 
-	assert(validator1->error_count() == val1_err_count);
-
 	//since validator1 is experiencing errors, we should see a failover to validator2
 	best_data = group->get_best(timestamp + 1, &best_idx);
 	assert(nullptr != best_data);
@@ -317,7 +332,7 @@ void test_simple_failover()
 	assert(1 == group->failover_count());
 
 	//even though validator1 has encountered a bunch of errors, it hasn't failed
-	assert(DataValidator::ERROR_FLAG_NO_ERROR == validator1->state());
+	assert(DataValidator::ERROR_FLAG_NO_ERROR == group->get_sensor_state(val1_idx));
 
 	// although we failed over from one sensor to another, this is not the same thing tracked by failover_index
 	int fail_idx = group->failover_index();
@@ -345,12 +360,10 @@ void test_sensor_failure()
 	DataValidatorGroup *group =  setup_base_group(&num_siblings);
 
 	//now we add validators
-	DataValidator *validator  = add_validator_to_group(group);
-	assert(nullptr != validator);
+	int val_idx = add_validator_to_group(group);
 	num_siblings++;
-	int val_idx = num_siblings - 1;
 
-	fill_validator_with_samples(validator,  sufficient_incr_value, &val, &timestamp);
+	fill_group_validator_with_samples(group, val_idx, sufficient_incr_value, &val, &timestamp);
 	//the best should now be the one validator we've filled with samples
 
 	int best_idx = -1;
@@ -360,8 +373,8 @@ void test_sensor_failure()
 	assert(best_idx == val_idx);
 
 	//now force a timeout failure in the one validator, by checking confidence long past timeout
-	validator->confidence(timestamp + (1.1 * timeout_usec));
-	assert(DataValidator::ERROR_FLAG_TIMEOUT == (DataValidator::ERROR_FLAG_TIMEOUT & validator->state()));
+	group->get_sensor_confidence(val_idx, timestamp + (1.1 * timeout_usec));
+	assert(DataValidator::ERROR_FLAG_TIMEOUT == (DataValidator::ERROR_FLAG_TIMEOUT & group->get_sensor_state(val_idx)));
 
 	//now that the one sensor has failed, the group should detect this as well
 	int fail_idx = group->failover_index();
@@ -48,6 +48,10 @@ VehicleAcceleration::VehicleAcceleration() :
 {
 	_vehicle_acceleration_pub.advertise();
 
+	for (auto &pub : _vehicle_acceleration_decimated_pub) {
+		pub.advertise();
+	}
+
 	CheckAndUpdateFilters();
 }
 
@@ -126,6 +130,16 @@ void VehicleAcceleration::CheckAndUpdateFilters()
 		_lp_filter.set_cutoff_frequency(_filter_sample_rate, _param_imu_accel_cutoff.get());
 		_lp_filter.reset(_acceleration_prev);
 	}
+
+	// update decimated streams
+	const float decimated_rate_hz[DecimatedStream::Count] {(float)_param_imu_rate_medium.get(), (float)_param_imu_rate_low.get()};
+
+	for (int i = 0; i < DecimatedStream::Count; i++) {
+		if (sample_rate_changed || (fabsf(_decimating_filter[i].getRequestedOutputFreq() - decimated_rate_hz[i]) > 0.01f)) {
+			_decimating_filter[i].setParameters(_filter_sample_rate, decimated_rate_hz[i]);
+			_decimating_filter[i].reset(_acceleration_prev);
+		}
+	}
 }
 
 void VehicleAcceleration::SensorBiasUpdate(bool force)
@@ -244,6 +258,17 @@ void VehicleAcceleration::Run()
 
 			_acceleration_prev = accel_corrected;
 
+			// anti-aliased and decimated streams
+			for (int i = 0; i < DecimatedStream::Count; i++) {
+				if (_decimating_filter[i].apply(accel_filtered)) {
+					vehicle_acceleration_s v_acceleration;
+					v_acceleration.timestamp_sample = sensor_data.timestamp_sample;
+					_decimating_filter[i].getOutput().copyTo(v_acceleration.xyz);
+					v_acceleration.timestamp = hrt_absolute_time();
+					_vehicle_acceleration_decimated_pub[i].publish(v_acceleration);
+				}
+			}
+
 			// publish once all new samples are processed
 			if (!_sensor_sub.updated()) {
 				// Publish vehicle_acceleration
@@ -265,6 +290,12 @@ void VehicleAcceleration::PrintStatus()
 		     _calibration.device_id(), (double)_filter_sample_rate,
 		     (double)_bias(0), (double)_bias(1), (double)_bias(2));
 
+	for (int i = 0; i < DecimatedStream::Count; i++) {
+		PX4_INFO_RAW("[vehicle_acceleration] %s rate stream: %.1f Hz, anti-aliasing cutoff: %.1f Hz\n",
+			     (i == DecimatedStream::Medium) ? "medium" : "low",
+			     (double)_decimating_filter[i].getOutputFreq(), (double)_decimating_filter[i].getCutoffFreq());
+	}
+
 	_calibration.PrintStatus();
 }
 
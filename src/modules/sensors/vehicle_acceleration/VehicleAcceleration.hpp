@@ -36,6 +36,7 @@
 #include <lib/sensor_calibration/Accelerometer.hpp>
 #include <lib/mathlib/math/Limits.hpp>
 #include <lib/matrix/matrix/math.hpp>
+#include <lib/mathlib/math/filter/DecimatingFilter.hpp>
 #include <lib/mathlib/math/filter/LowPassFilter2p.hpp>
 #include <px4_platform_common/log.h>
 #include <px4_platform_common/module_params.h>
@@ -79,6 +80,18 @@ private:
 
 	uORB::Publication<vehicle_acceleration_s> _vehicle_acceleration_pub{ORB_ID(vehicle_acceleration)};
 
+	// decimated acceleration streams (IMU_RATE_MEDIUM, IMU_RATE_LOW)
+	enum DecimatedStream {
+		Medium = 0,
+		Low,
+		Count
+	};
+
+	uORB::Publication<vehicle_acceleration_s> _vehicle_acceleration_decimated_pub[DecimatedStream::Count] {
+		{ORB_ID(vehicle_acceleration_medium)},
+		{ORB_ID(vehicle_acceleration_low)},
+	};
+
 	uORB::Subscription _estimator_selector_status_sub{ORB_ID(estimator_selector_status)};
 	uORB::Subscription _estimator_sensor_bias_sub{ORB_ID(estimator_sensor_bias)};
 
@@ -97,9 +110,14 @@ private:
 
 	math::LowPassFilter2p<matrix::Vector3f> _lp_filter{};
 
+	// anti-aliasing and decimation of the filtered acceleration for the decimated streams
+	math::DecimatingFilter<matrix::Vector3f> _decimating_filter[DecimatedStream::Count] {};
+
 	DEFINE_PARAMETERS(
 		(ParamFloat<px4::params::IMU_ACCEL_CUTOFF>) _param_imu_accel_cutoff,
-		(ParamInt<px4::params::IMU_INTEG_RATE>) _param_imu_integ_rate
+		(ParamInt<px4::params::IMU_INTEG_RATE>) _param_imu_integ_rate,
+		(ParamInt<px4::params::IMU_RATE_MEDIUM>) _param_imu_rate_medium,
+		(ParamInt<px4::params::IMU_RATE_LOW>) _param_imu_rate_low
 	)
 };
 
@@ -48,6 +48,12 @@ VehicleAngularVelocity::VehicleAngularVelocity() :
 {
 	_vehicle_angular_acceleration_pub.advertise();
 	_vehicle_angular_velocity_pub.advertise();
+
+	for (auto &pub : _vehicle_angular_velocity_decimated_pub) {
+		pub.advertise();
+	}
+
+	_notch_filter_bank.allocate(NOTCH_SECTIONS);
 }
 
 VehicleAngularVelocity::~VehicleAngularVelocity()
@@ -59,7 +65,6 @@ VehicleAngularVelocity::~VehicleAngularVelocity()
 	perf_free(_selection_changed_perf);
 
 #if !defined(CONSTRAINED_FLASH)
-	delete[] _dynamic_notch_filter_esc_rpm;
 	perf_free(_dynamic_notch_filter_esc_rpm_disable_perf);
 	perf_free(_dynamic_notch_filter_esc_rpm_update_perf);
 
@@ -70,6 +75,11 @@ VehicleAngularVelocity::~VehicleAngularVelocity()
 
 bool VehicleAngularVelocity::Start()
 {
+	if (_notch_filter_bank.sections() != NOTCH_SECTIONS) {
+		PX4_ERR("notch filter allocation failed");
+		return false;
+	}
+
 	// force initial updates
 	ParametersUpdate(true);
 
@@ -170,14 +180,14 @@ void VehicleAngularVelocity::ResetFilters(const hrt_abstime &time_now_us)
 			_lp_filter_velocity[axis].reset(angular_velocity_uncalibrated(axis));
 
 			// angular velocity notch 0
-			_notch_filter0_velocity[axis].setParameters(_filter_sample_rate_hz, _param_imu_gyro_nf0_frq.get(),
-					_param_imu_gyro_nf0_bw.get());
-			_notch_filter0_velocity[axis].reset();
+			_notch_filter_bank.setParameters(NOTCH_SECTION_NF0, axis, _filter_sample_rate_hz, _param_imu_gyro_nf0_frq.get(),
+							 _param_imu_gyro_nf0_bw.get());
+			_notch_filter_bank.reset(NOTCH_SECTION_NF0, axis);
 
 			// angular velocity notch 1
-			_notch_filter1_velocity[axis].setParameters(_filter_sample_rate_hz, _param_imu_gyro_nf1_frq.get(),
-					_param_imu_gyro_nf1_bw.get());
-			_notch_filter1_velocity[axis].reset();
+			_notch_filter_bank.setParameters(NOTCH_SECTION_NF1, axis, _filter_sample_rate_hz, _param_imu_gyro_nf1_frq.get(),
+							 _param_imu_gyro_nf1_bw.get());
+			_notch_filter_bank.reset(NOTCH_SECTION_NF1, axis);
 
 			// angular acceleration low pass
 			if ((_param_imu_dgyro_cutoff.get() > 0.f)
@@ -190,6 +200,14 @@ void VehicleAngularVelocity::ResetFilters(const hrt_abstime &time_now_us)
 			}
 		}
 
+		// decimated streams
+		const float decimated_rate_hz[DecimatedStream::Count] {(float)_param_imu_rate_medium.get(), (float)_param_imu_rate_low.get()};
+
+		for (int i = 0; i < DecimatedStream::Count; i++) {
+			_decimating_filter[i].setParameters(_filter_sample_rate_hz, decimated_rate_hz[i]);
+			_decimating_filter[i].reset(angular_velocity_uncalibrated);
+		}
+
 		// force reset notch filters on any scale change
 		UpdateDynamicNotchEscRpm(time_now_us, true);
 		UpdateDynamicNotchFFT(time_now_us, true);
@@ -403,9 +421,11 @@ void VehicleAngularVelocity::ParametersUpdate(bool force)
 		}
 
 		// gyro notch filter 0 frequency or bandwidth changed
-		for (auto &nf : _notch_filter0_velocity) {
-			const bool nf_freq_changed = (fabsf(nf.getNotchFreq() - _param_imu_gyro_nf0_frq.get()) > 0.01f);
-			const bool nf_bw_changed   = (fabsf(nf.getBandwidth() - _param_imu_gyro_nf0_bw.get()) > 0.01f);
+		for (int axis = 0; axis < 3; axis++) {
+			const float nf_freq = _notch_filter_bank.getNotchFreq(NOTCH_SECTION_NF0, axis);
+			const float nf_bw = _notch_filter_bank.getBandwidth(NOTCH_SECTION_NF0, axis);
+			const bool nf_freq_changed = (fabsf(nf_freq - _param_imu_gyro_nf0_frq.get()) > 0.01f);
+			const bool nf_bw_changed   = (fabsf(nf_bw - _param_imu_gyro_nf0_bw.get()) > 0.01f);
 
 			if ((nf0_enabled_prev != nf0_enabled) || (nf0_enabled && (nf_freq_changed || nf_bw_changed))) {
 				_reset_filters = true;
@@ -414,9 +434,11 @@ void VehicleAngularVelocity::ParametersUpdate(bool force)
 		}
 
 		// gyro notch filter 1 frequency or bandwidth changed
-		for (auto &nf : _notch_filter1_velocity) {
-			const bool nf_freq_changed = (fabsf(nf.getNotchFreq() - _param_imu_gyro_nf1_frq.get()) > 0.01f);
-			const bool nf_bw_changed   = (fabsf(nf.getBandwidth() - _param_imu_gyro_nf1_bw.get()) > 0.01f);
+		for (int axis = 0; axis < 3; axis++) {
+			const float nf_freq = _notch_filter_bank.getNotchFreq(NOTCH_SECTION_NF1, axis);
+			const float nf_bw = _notch_filter_bank.getBandwidth(NOTCH_SECTION_NF1, axis);
+			const bool nf_freq_changed = (fabsf(nf_freq - _param_imu_gyro_nf1_frq.get()) > 0.01f);
+			const bool nf_bw_changed   = (fabsf(nf_bw - _param_imu_gyro_nf1_bw.get()) > 0.01f);
 
 			if ((nf1_enabled_prev != nf1_enabled) || (nf1_enabled && (nf_freq_changed || nf_bw_changed))) {
 				_reset_filters = true;
@@ -432,23 +454,27 @@ void VehicleAngularVelocity::ParametersUpdate(bool force)
 			}
 		}
 
+		// decimated stream rates changed
+		if ((fabsf(_decimating_filter[DecimatedStream::Medium].getRequestedOutputFreq() - _param_imu_rate_medium.get()) > 0.01f)
+		    || (fabsf(_decimating_filter[DecimatedStream::Low].getRequestedOutputFreq() - _param_imu_rate_low.get()) > 0.01f)) {
+			_reset_filters = true;
+		}
+
 #if !defined(CONSTRAINED_FLASH)
 
 		if (_param_imu_gyro_dnf_en.get() & DynamicNotch::EscRpm) {
 
 			const int32_t esc_rpm_harmonics = math::constrain(_param_imu_gyro_dnf_hmc.get(), (int32_t)1, (int32_t)10);
 
-			if (_dynamic_notch_filter_esc_rpm && (esc_rpm_harmonics != _esc_rpm_harmonics)) {
-				delete[] _dynamic_notch_filter_esc_rpm;
-				_dynamic_notch_filter_esc_rpm = nullptr;
+			if ((_esc_rpm_harmonics != 0) && (esc_rpm_harmonics != _esc_rpm_harmonics)) {
+				_dynamic_notch_filter_esc_rpm.allocate(0);
+				_esc_available.reset();
 				_esc_rpm_harmonics = 0;
 			}
 
-			if (_dynamic_notch_filter_esc_rpm == nullptr) {
-
-				_dynamic_notch_filter_esc_rpm = new NotchFilterHarmonic[esc_rpm_harmonics];
+			if (_esc_rpm_harmonics == 0) {
 
-				if (_dynamic_notch_filter_esc_rpm) {
+				if (_dynamic_notch_filter_esc_rpm.allocate(esc_rpm_harmonics * MAX_NUM_ESCS)) {
 					_esc_rpm_harmonics = esc_rpm_harmonics;
 
 					if (_dynamic_notch_filter_esc_rpm_disable_perf == nullptr) {
@@ -530,11 +556,11 @@ void VehicleAngularVelocity::DisableDynamicNotchEscRpm()
 {
 #if !defined(CONSTRAINED_FLASH)
 
-	if (_dynamic_notch_filter_esc_rpm) {
+	if (_esc_rpm_harmonics > 0) {
 		for (int harmonic = 0; harmonic < _esc_rpm_harmonics; harmonic++) {
 			for (int axis = 0; axis < 3; axis++) {
 				for (int esc = 0; esc < MAX_NUM_ESCS; esc++) {
-					_dynamic_notch_filter_esc_rpm[harmonic][axis][esc].disable();
+					_dynamic_notch_filter_esc_rpm.disable(EscRpmNotchSection(esc, harmonic), axis);
 					_esc_available.set(esc, false);
 					perf_count(_dynamic_notch_filter_esc_rpm_disable_perf);
 				}
@@ -552,7 +578,7 @@ void VehicleAngularVelocity::DisableDynamicNotchFFT()
 	if (_dynamic_notch_fft_available) {
 		for (int axis = 0; axis < 3; axis++) {
 			for (int peak = 0; peak < MAX_NUM_FFT_PEAKS; peak++) {
-				_dynamic_notch_filter_fft[axis][peak].disable();
+				_notch_filter_bank.disable(NotchSectionFFT(peak), axis);
 				perf_count(_dynamic_notch_filter_fft_disable_perf);
 			}
 		}
@@ -566,7 +592,7 @@ void VehicleAngularVelocity::DisableDynamicNotchFFT()
 void VehicleAngularVelocity::UpdateDynamicNotchEscRpm(const hrt_abstime &time_now_us, bool force)
 {
 #if !defined(CONSTRAINED_FLASH)
-	const bool enabled = _dynamic_notch_filter_esc_rpm && (_param_imu_gyro_dnf_en.get() & DynamicNotch::EscRpm);
+	const bool enabled = (_esc_rpm_harmonics > 0) && (_param_imu_gyro_dnf_en.get() & DynamicNotch::EscRpm);
 
 	if (enabled && (_esc_status_sub.updated() || force)) {
 
@@ -591,14 +617,16 @@ void VehicleAngularVelocity::UpdateDynamicNotchEscRpm(const hrt_abstime &time_no
 						const float frequency_hz = esc_hz * (harmonic + 1);
 
 						// for each ESC harmonic determine if enabled/disabled from first notch (x axis)
-						auto &nfx = _dynamic_notch_filter_esc_rpm[harmonic][0][esc];
+						const int section = EscRpmNotchSection(esc, harmonic);
+						const float nfx_freq = _dynamic_notch_filter_esc_rpm.getNotchFreq(section, 0);
 
 						if (frequency_hz > FREQ_MIN) {
 							// update filter parameters if frequency changed or forced
-							if (update || !nfx.initialized() || (fabsf(nfx.getNotchFreq() - frequency_hz) > 0.1f)) {
+							if (update || !_dynamic_notch_filter_esc_rpm.initialized(section, 0)
+							    || (fabsf(nfx_freq - frequency_hz) > 0.1f)) {
 								for (int axis = 0; axis < 3; axis++) {
-									auto &nf = _dynamic_notch_filter_esc_rpm[harmonic][axis][esc];
-									nf.setParameters(_filter_sample_rate_hz, frequency_hz, _param_imu_gyro_dnf_bw.get());
+									_dynamic_notch_filter_esc_rpm.setParameters(section, axis, _filter_sample_rate_hz, frequency_hz,
+											_param_imu_gyro_dnf_bw.get());
 									perf_count(_dynamic_notch_filter_esc_rpm_update_perf);
 								}
 							}
@@ -607,10 +635,9 @@ void VehicleAngularVelocity::UpdateDynamicNotchEscRpm(const hrt_abstime &time_no
 
 						} else {
 							// disable these notch filters (if they aren't already)
-							if (nfx.getNotchFreq() > 0.f) {
+							if (nfx_freq > 0.f) {
 								for (int axis = 0; axis < 3; axis++) {
-									auto &nf = _dynamic_notch_filter_esc_rpm[harmonic][axis][esc];
-									nf.disable();
+									_dynamic_notch_filter_esc_rpm.disable(section, axis);
 									perf_count(_dynamic_notch_filter_esc_rpm_disable_perf);
 								}
 							}
@@ -636,7 +663,7 @@ void VehicleAngularVelocity::UpdateDynamicNotchEscRpm(const hrt_abstime &time_no
 
 				for (int harmonic = 0; harmonic < _esc_rpm_harmonics; harmonic++) {
 					for (int axis = 0; axis < 3; axis++) {
-						_dynamic_notch_filter_esc_rpm[harmonic][axis][esc].disable();
+						_dynamic_notch_filter_esc_rpm.disable(EscRpmNotchSection(esc, harmonic), axis);
 						perf_count(_dynamic_notch_filter_esc_rpm_disable_perf);
 					}
 				}
@@ -677,12 +704,13 @@ void VehicleAngularVelocity::UpdateDynamicNotchFFT(const hrt_abstime &time_now_u
 
 					const float peak_freq = peak_frequencies[axis][peak];
 
-					auto &nf = _dynamic_notch_filter_fft[axis][peak];
+					const int section = NotchSectionFFT(peak);
+					const float nf_freq = _notch_filter_bank.getNotchFreq(section, axis);
 
 					if (peak_freq > peak_freq_min) {
 						// update filter parameters if frequency changed or forced
-						if (force || !nf.initialized() || (fabsf(nf.getNotchFreq() - peak_freq) > 0.1f)) {
-							nf.setParameters(_filter_sample_rate_hz, peak_freq, bandwidth);
+						if (force || !_notch_filter_bank.initialized(section, axis) || (fabsf(nf_freq - peak_freq) > 0.1f)) {
+							_notch_filter_bank.setParameters(section, axis, _filter_sample_rate_hz, peak_freq, bandwidth);
 							perf_count(_dynamic_notch_filter_fft_update_perf);
 						}
 
@@ -690,8 +718,8 @@ void VehicleAngularVelocity::UpdateDynamicNotchFFT(const hrt_abstime &time_now_u
 
 					} else {
 						// disable this notch filter (if it isn't already)
-						if (nf.getNotchFreq() > 0.f) {
-							nf.disable();
+						if (nf_freq > 0.f) {
+							_notch_filter_bank.disable(section, axis);
 							perf_count(_dynamic_notch_filter_fft_disable_perf);
 						}
 					}
@@ -706,58 +734,66 @@ void VehicleAngularVelocity::UpdateDynamicNotchFFT(const hrt_abstime &time_now_u
 #endif // !CONSTRAINED_FLASH
 }
 
-float VehicleAngularVelocity::FilterAngularVelocity(int axis, float data[], int N)
+Vector3f VehicleAngularVelocity::FilterAngularVelocity(float data[][math::NotchFilterBank::LANES], int N)
 {
 #if !defined(CONSTRAINED_FLASH)
 
-	// Apply dynamic notch filter from ESC RPM
-	if (_dynamic_notch_filter_esc_rpm) {
-		for (int esc = 0; esc < MAX_NUM_ESCS; esc++) {
-			if (_esc_available[esc]) {
-				for (int harmonic = 0; harmonic < _esc_rpm_harmonics; harmonic++) {
-					_dynamic_notch_filter_esc_rpm[harmonic][axis][esc].applyArray(data, N);
-				}
-			}
-		}
+	// Apply dynamic notch filter from ESC RPM (all ESCs and harmonics, only sections of available ESCs are enabled)
+	if (_esc_rpm_harmonics > 0) {
+		_dynamic_notch_filter_esc_rpm.applyArray(data, N);
 	}
 
-	// Apply dynamic notch filter from FFT
-	if (_dynamic_notch_fft_available) {
-		for (int peak = MAX_NUM_FFT_PEAKS - 1; peak >= 0; peak--) {
-			if (_dynamic_notch_filter_fft[axis][peak].getNotchFreq() > 0.f) {
-				_dynamic_notch_filter_fft[axis][peak].applyArray(data, N);
-			}
+#endif // !CONSTRAINED_FLASH
+
+	// Apply dynamic notch filter from FFT and general notch filters 0 and 1 (IMU_GYRO_NF0_FRQ, IMU_GYRO_NF1_FRQ),
+	//  disabled notches are skipped
+	_notch_filter_bank.applyArray(data, N);
+
+	// Apply general low-pass filter (IMU_GYRO_CUTOFF)
+	for (int axis = 0; axis < 3; axis++) {
+		for (int n = 0; n < N; n++) {
+			data[n][axis] = _lp_filter_velocity[axis].apply(data[n][axis]);
 		}
 	}
 
-#endif // !CONSTRAINED_FLASH
+	// return last filtered sample
+	return Vector3f{data[N - 1][0], data[N - 1][1], data[N - 1][2]};
+}
 
-	// Apply general notch filter 0 (IMU_GYRO_NF0_FRQ)
-	if (_notch_filter0_velocity[axis].getNotchFreq() > 0.f) {
-		_notch_filter0_velocity[axis].applyArray(data, N);
-	}
+void VehicleAngularVelocity::UpdateDecimatedOutputs(const hrt_abstime &timestamp_sample, float dt_us,
+		const float data[][math::NotchFilterBank::LANES], int N)
+{
+	// the filtered angular velocity at the full sample rate is anti-aliased and decimated for each stream
+	for (int n = 0; n < N; n++) {
+		const Vector3f angular_velocity_uncalibrated{data[n][0], data[n][1], data[n][2]};
 
-	// Apply general notch filter 1 (IMU_GYRO_NF1_FRQ)
-	if (_notch_filter1_velocity[axis].getNotchFreq() > 0.f) {
-		_notch_filter1_velocity[axis].applyArray(data, N);
-	}
+		for (int i = 0; i < DecimatedStream::Count; i++) {
+			if (_decimating_filter[i].apply(angular_velocity_uncalibrated)) {
+				vehicle_angular_velocity_s v_angular_velocity;
+				v_angular_velocity.timestamp_sample = timestamp_sample - (hrt_abstime)roundf((N - 1 - n) * dt_us);
 
-	// Apply general low-pass filter (IMU_GYRO_CUTOFF)
-	_lp_filter_velocity[axis].applyArray(data, N);
+				const Vector3f angular_velocity{_calibration.Correct(_decimating_filter[i].getOutput()) - _bias};
+				angular_velocity.copyTo(v_angular_velocity.xyz);
 
-	// return last filtered sample
-	return data[N - 1];
+				v_angular_velocity.timestamp = hrt_absolute_time();
+				_vehicle_angular_velocity_decimated_pub[i].publish(v_angular_velocity);
+			}
+		}
+	}
 }
 
-float VehicleAngularVelocity::FilterAngularAcceleration(int axis, float inverse_dt_s, float data[], int N)
+Vector3f VehicleAngularVelocity::FilterAngularAcceleration(float inverse_dt_s,
+		float data[][math::NotchFilterBank::LANES], int N)
 {
 	// angular acceleration: Differentiate & apply specific angular acceleration (D-term) low-pass (IMU_DGYRO_CUTOFF)
-	float angular_acceleration_filtered = 0.f;
+	Vector3f angular_acceleration_filtered{};
 
-	for (int n = 0; n < N; n++) {
-		const float angular_acceleration = (data[n] - _angular_velocity_raw_prev(axis)) * inverse_dt_s;
-		angular_acceleration_filtered = _lp_filter_acceleration[axis].update(angular_acceleration);
-		_angular_velocity_raw_prev(axis) = data[n];
+	for (int axis = 0; axis < 3; axis++) {
+		for (int n = 0; n < N; n++) {
+			const float angular_acceleration = (data[n][axis] - _angular_velocity_raw_prev(axis)) * inverse_dt_s;
+			angular_acceleration_filtered(axis) = _lp_filter_acceleration[axis].update(angular_acceleration);
+			_angular_velocity_raw_prev(axis) = data[n][axis];
+		}
 	}
 
 	return angular_acceleration_filtered;
@@ -811,23 +847,21 @@ void VehicleAngularVelocity::Run()
 			static constexpr int FIFO_SIZE_MAX = sizeof(sensor_fifo_data.x) / sizeof(sensor_fifo_data.x[0]);
 
 			if ((sensor_fifo_data.dt > 0) && (N > 0) && (N <= FIFO_SIZE_MAX)) {
-				Vector3f angular_velocity_uncalibrated;
-				Vector3f angular_acceleration_uncalibrated;
-
-				int16_t *raw_data_array[] {sensor_fifo_data.x, sensor_fifo_data.y, sensor_fifo_data.z};
+				// copy raw int16 sensor samples to float array (x, y, z, padding) for filtering
+				float data[FIFO_SIZE_MAX][math::NotchFilterBank::LANES];
+
+				for (int n = 0; n < N; n++) {
+					data[n][0] = sensor_fifo_data.scale * sensor_fifo_data.x[n];
+					data[n][1] = sensor_fifo_data.scale * sensor_fifo_data.y[n];
+					data[n][2] = sensor_fifo_data.scale * sensor_fifo_data.z[n];
+					data[n][3] = 0.f;
+				}
 
-				for (int axis = 0; axis < 3; axis++) {
-					// copy raw int16 sensor samples to float array for filtering
-					float data[FIFO_SIZE_MAX];
+				// save last filtered sample
+				const Vector3f angular_velocity_uncalibrated{FilterAngularVelocity(data, N)};
+				const Vector3f angular_acceleration_uncalibrated{FilterAngularAcceleration(inverse_dt_s, data, N)};
 
-					for (int n = 0; n < N; n++) {
-						data[n] = sensor_fifo_data.scale * raw_data_array[axis][n];
-					}
-
-					// save last filtered sample
-					angular_velocity_uncalibrated(axis) = FilterAngularVelocity(axis, data, N);
-					angular_acceleration_uncalibrated(axis) = FilterAngularAcceleration(axis, inverse_dt_s, data, N);
-				}
+				UpdateDecimatedOutputs(sensor_fifo_data.timestamp_sample, sensor_fifo_data.dt, data, N);
 
 				// Publish
 				if (!_sensor_fifo_sub.updated()) {
@@ -856,19 +890,14 @@ void VehicleAngularVelocity::Run()
 							   0.00002f, 0.02f);
 				_timestamp_sample_last = sensor_data.timestamp_sample;
 
-				Vector3f angular_velocity_uncalibrated;
-				Vector3f angular_acceleration_uncalibrated;
-
-				float raw_data_array[] {sensor_data.x, sensor_data.y, sensor_data.z};
+				// copy sensor sample to float array (x, y, z, padding) for filtering
+				float data[1][math::NotchFilterBank::LANES] {{sensor_data.x, sensor_data.y, sensor_data.z, 0.f}};
 
-				for (int axis = 0; axis < 3; axis++) {
-					// copy sensor sample to float array for filtering
-					float data[1] {raw_data_array[axis]};
+				// save last filtered sample
+				const Vector3f angular_velocity_uncalibrated{FilterAngularVelocity(data)};
+				const Vector3f angular_acceleration_uncalibrated{FilterAngularAcceleration(inverse_dt_s, data)};
 
-					// save last filtered sample
-					angular_velocity_uncalibrated(axis) = FilterAngularVelocity(axis, data);
-					angular_acceleration_uncalibrated(axis) = FilterAngularAcceleration(axis, inverse_dt_s, data);
-				}
+				UpdateDecimatedOutputs(sensor_data.timestamp_sample, 0.f, data);
 
 				// Publish
 				if (!_sensor_sub.updated()) {
@@ -939,6 +968,12 @@ void VehicleAngularVelocity::PrintStatus()
 
 	_calibration.PrintStatus();
 
+	for (int i = 0; i < DecimatedStream::Count; i++) {
+		PX4_INFO_RAW("[vehicle_angular_velocity] %s rate stream: %.1f Hz, anti-aliasing cutoff: %.1f Hz\n",
+			     (i == DecimatedStream::Medium) ? "medium" : "low",
+			     (double)_decimating_filter[i].getOutputFreq(), (double)_decimating_filter[i].getCutoffFreq());
+	}
+
 	perf_print_counter(_cycle_perf);
 	perf_print_counter(_filter_reset_perf);
 	perf_print_counter(_selection_changed_perf);
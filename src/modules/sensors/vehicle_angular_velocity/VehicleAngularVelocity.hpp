@@ -38,8 +38,9 @@
 #include <lib/mathlib/math/Limits.hpp>
 #include <lib/matrix/matrix/math.hpp>
 #include <lib/mathlib/math/filter/AlphaFilter.hpp>
+#include <lib/mathlib/math/filter/DecimatingFilter.hpp>
 #include <lib/mathlib/math/filter/LowPassFilter2p.hpp>
-#include <lib/mathlib/math/filter/NotchFilter.hpp>
+#include <lib/mathlib/math/filter/NotchFilterBank.hpp>
 #include <px4_platform_common/log.h>
 #include <px4_platform_common/module_params.h>
 #include <px4_platform_common/px4_config.h>
@@ -79,8 +80,12 @@ private:
 	bool CalibrateAndPublish(const hrt_abstime &timestamp_sample, const matrix::Vector3f &angular_velocity_uncalibrated,
 				 const matrix::Vector3f &angular_acceleration_uncalibrated);
 
-	inline float FilterAngularVelocity(int axis, float data[], int N = 1);
-	inline float FilterAngularAcceleration(int axis, float inverse_dt_s, float data[], int N = 1);
+	inline matrix::Vector3f FilterAngularVelocity(float data[][math::NotchFilterBank::LANES], int N = 1);
+	inline matrix::Vector3f FilterAngularAcceleration(float inverse_dt_s, float data[][math::NotchFilterBank::LANES],
+			int N = 1);
+
+	void UpdateDecimatedOutputs(const hrt_abstime &timestamp_sample, float dt_us,
+				    const float data[][math::NotchFilterBank::LANES], int N = 1);
 
 	void DisableDynamicNotchEscRpm();
 	void DisableDynamicNotchFFT();
@@ -102,6 +107,18 @@ private:
 	uORB::Publication<vehicle_angular_acceleration_s> _vehicle_angular_acceleration_pub{ORB_ID(vehicle_angular_acceleration)};
 	uORB::Publication<vehicle_angular_velocity_s>     _vehicle_angular_velocity_pub{ORB_ID(vehicle_angular_velocity)};
 
+	// decimated angular velocity streams (IMU_RATE_MEDIUM, IMU_RATE_LOW)
+	enum DecimatedStream {
+		Medium = 0,
+		Low,
+		Count
+	};
+
+	uORB::Publication<vehicle_angular_velocity_s> _vehicle_angular_velocity_decimated_pub[DecimatedStream::Count] {
+		{ORB_ID(vehicle_angular_velocity_medium)},
+		{ORB_ID(vehicle_angular_velocity_low)},
+	};
+
 	uORB::Subscription _estimator_selector_status_sub{ORB_ID(estimator_selector_status)};
 	uORB::Subscription _estimator_sensor_bias_sub{ORB_ID(estimator_sensor_bias)};
 #if !defined(CONSTRAINED_FLASH)
@@ -130,11 +147,6 @@ private:
 
 	float _filter_sample_rate_hz{NAN};
 
-	// angular velocity filters
-	math::LowPassFilter2p<float> _lp_filter_velocity[3] {};
-	math::NotchFilter<float> _notch_filter0_velocity[3] {};
-	math::NotchFilter<float> _notch_filter1_velocity[3] {};
-
 #if !defined(CONSTRAINED_FLASH)
 
 	enum DynamicNotch {
@@ -147,8 +159,9 @@ private:
 	// ESC RPM
 	static constexpr int MAX_NUM_ESCS = sizeof(esc_status_s::esc) / sizeof(esc_status_s::esc[0]);
 
-	using NotchFilterHarmonic = math::NotchFilter<float>[3][MAX_NUM_ESCS];
-	NotchFilterHarmonic *_dynamic_notch_filter_esc_rpm{nullptr};
+	// one notch per ESC and harmonic (ESC major)
+	int EscRpmNotchSection(int esc, int harmonic) const { return esc * _esc_rpm_harmonics + harmonic; }
+	math::NotchFilterBank _dynamic_notch_filter_esc_rpm{};
 
 	int _esc_rpm_harmonics{0};
 	px4::Bitset<MAX_NUM_ESCS> _esc_available{};
@@ -161,17 +174,31 @@ private:
 	static constexpr int MAX_NUM_FFT_PEAKS = sizeof(sensor_gyro_fft_s::peak_frequencies_x)
 			/ sizeof(sensor_gyro_fft_s::peak_frequencies_x[0]);
 
-	math::NotchFilter<float> _dynamic_notch_filter_fft[3][MAX_NUM_FFT_PEAKS] {};
-
 	perf_counter_t _dynamic_notch_filter_fft_disable_perf{nullptr};
 	perf_counter_t _dynamic_notch_filter_fft_update_perf{nullptr};
 
 	bool _dynamic_notch_fft_available{false};
+
+	// notch filter bank sections (applied in this order): FFT peaks (last peak first), notch 0, notch 1
+	static constexpr int NotchSectionFFT(int peak) { return MAX_NUM_FFT_PEAKS - 1 - peak; }
+	static constexpr int NOTCH_SECTION_NF0 = MAX_NUM_FFT_PEAKS;
+#else
+	static constexpr int NOTCH_SECTION_NF0 = 0;
 #endif // !CONSTRAINED_FLASH
 
+	static constexpr int NOTCH_SECTION_NF1 = NOTCH_SECTION_NF0 + 1;
+	static constexpr int NOTCH_SECTIONS = NOTCH_SECTION_NF1 + 1;
+
+	// angular velocity filters
+	math::LowPassFilter2p<float> _lp_filter_velocity[3] {};
+	math::NotchFilterBank _notch_filter_bank{};
+
 	// angular acceleration filter
 	AlphaFilter<float> _lp_filter_acceleration[3] {};
 
+	// anti-aliasing and decimation of the filtered angular velocity for the decimated streams
+	math::DecimatingFilter<matrix::Vector3f> _decimating_filter[DecimatedStream::Count] {};
+
 	uint32_t _selected_sensor_device_id{0};
 
 	bool _reset_filters{true};
@@ -194,7 +221,9 @@ private:
 		(ParamFloat<px4::params::IMU_GYRO_NF1_FRQ>) _param_imu_gyro_nf1_frq,
 		(ParamFloat<px4::params::IMU_GYRO_NF1_BW>) _param_imu_gyro_nf1_bw,
 		(ParamInt<px4::params::IMU_GYRO_RATEMAX>) _param_imu_gyro_ratemax,
-		(ParamFloat<px4::params::IMU_DGYRO_CUTOFF>) _param_imu_dgyro_cutoff
+		(ParamFloat<px4::params::IMU_DGYRO_CUTOFF>) _param_imu_dgyro_cutoff,
+		(ParamInt<px4::params::IMU_RATE_MEDIUM>) _param_imu_rate_medium,
+		(ParamInt<px4::params::IMU_RATE_LOW>) _param_imu_rate_low
 	)
 };
 
@@ -139,6 +139,41 @@ PARAM_DEFINE_FLOAT(IMU_GYRO_CUTOFF, 40.0f);
 */
 PARAM_DEFINE_INT32(IMU_GYRO_RATEMAX, 400);
 
+/**
+* IMU medium rate output.
+*
+* Rate of the anti-aliased and decimated angular velocity and acceleration
+* streams (vehicle_angular_velocity_medium, vehicle_acceleration_medium)
+* for consumers that don't need the full rate, eg attitude control.
+*
+* @min 10
+* @max 2000
+* @value 100 100 Hz
+* @value 200 200 Hz
+* @value 250 250 Hz
+* @value 400 400 Hz
+* @unit Hz
+* @group Sensors
+*/
+PARAM_DEFINE_INT32(IMU_RATE_MEDIUM, 250);
+
+/**
+* IMU low rate output.
+*
+* Rate of the anti-aliased and decimated angular velocity and acceleration
+* streams (vehicle_angular_velocity_low, vehicle_acceleration_low)
+* for slow consumers, eg the land detector.
+*
+* @min 10
+* @max 2000
+* @value 50 50 Hz
+* @value 100 100 Hz
+* @value 200 200 Hz
+* @unit Hz
+* @group Sensors
+*/
+PARAM_DEFINE_INT32(IMU_RATE_LOW, 100);
+
 /**
 * Cutoff frequency for angular acceleration (D-Term filter)
 *
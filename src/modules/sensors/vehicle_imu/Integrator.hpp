@@ -84,8 +84,8 @@ public:
 	 *
 	 * @param reset_samples	    	New reset time interval for the integrator.
 	 */
-	void set_reset_samples(uint8_t reset_samples) { _reset_samples_min = reset_samples; }
-	uint8_t get_reset_samples() const { return _reset_samples_min; }
+	void set_reset_samples(uint16_t reset_samples) { _reset_samples_min = reset_samples; }
+	uint16_t get_reset_samples() const { return _reset_samples_min; }
 
 	/**
 	 * Is the Integrator ready to reset?
@@ -138,9 +138,9 @@ protected:
 	float _integral_dt{0};
 
 	float _reset_interval_min{0.005f}; /**< the interval after which the content will be published and the integrator reset */
-	uint8_t _reset_samples_min{1};
+	uint16_t _reset_samples_min{1};
 
-	uint8_t _integrated_samples{0};
+	uint16_t _integrated_samples{0};
 };
 
 class IntegratorConing : public Integrator
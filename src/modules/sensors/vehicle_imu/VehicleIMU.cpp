@@ -100,6 +100,7 @@ void VehicleIMU::Stop()
 {
 	// clear all registered callbacks
 	_sensor_gyro_sub.unregisterCallback();
+	_sensor_gyro_fifo_sub.unregisterCallback();
 
 	Deinit();
 }
@@ -173,10 +174,22 @@ void VehicleIMU::Run()
 
 	if (!_accel_calibration.enabled() || !_gyro_calibration.enabled()) {
 		_sensor_gyro_sub.unregisterCallback();
+		_sensor_gyro_fifo_sub.unregisterCallback();
 		ScheduleDelayed(1_s);
 		return;
 	}
 
+	// once the sensors are known switch to their raw FIFO data if it's published, check again whenever the sensors
+	// change and periodically as long as the FIFO data isn't available
+	if ((_accel_calibration.device_id() != 0) && (_gyro_calibration.device_id() != 0)) {
+		if ((_accel_calibration.device_id() != _fifo_checked_accel_device_id)
+		    || (_gyro_calibration.device_id() != _fifo_checked_gyro_device_id)
+		    || (!_fifo_available && (hrt_elapsed_time(&_fifo_checked_timestamp) > 1_s))) {
+
+			SensorFifoSelectionUpdate();
+		}
+	}
+
 	// backup schedule
 	ScheduleDelayed(_backup_schedule_timeout_us);
 
@@ -192,70 +205,66 @@ void VehicleIMU::Run()
 	// reset data gap monitor
 	_data_gap = false;
 
-	while (_sensor_gyro_sub.updated() || _sensor_accel_sub.updated()) {
-		bool updated = false;
+	if (_fifo_available) {
+		UpdateFifo(now_us);
 
-		bool consume_all_gyro = !_intervals_configured || _data_gap;
+	} else {
+		while (_sensor_gyro_sub.updated() || _sensor_accel_sub.updated()) {
+			bool updated = false;
 
-		// monitor scheduling latency and force catch up with latest gyro if falling behind
-		if (_sensor_gyro_sub.updated() && (_gyro_update_latency_mean.count() > 100)
-		    && (_gyro_update_latency_mean.mean()(1) > _gyro_interval_us * 1e-6f)) {
+			bool consume_all_gyro = !_intervals_configured || _data_gap;
 
-			PX4_DEBUG("gyro update mean sample latency: %.6f, publish latency %.6f",
-				  (double)_gyro_update_latency_mean.mean()(0),
-				  (double)_gyro_update_latency_mean.mean()(1));
+			// monitor scheduling latency and force catch up with latest gyro if falling behind
+			if (_sensor_gyro_sub.updated() && (_gyro_update_latency_mean.count() > 100)
+			    && (_gyro_update_latency_mean.mean()(1) > _gyro_interval_us * 1e-6f)) {
 
-			consume_all_gyro = true;
-		}
+				PX4_DEBUG("gyro update mean sample latency: %.6f, publish latency %.6f",
+					  (double)_gyro_update_latency_mean.mean()(0),
+					  (double)_gyro_update_latency_mean.mean()(1));
 
-		// update gyro until integrator ready and not falling behind
-		if (!_gyro_integrator.integral_ready() || consume_all_gyro) {
-			if (UpdateGyro()) {
-				updated = true;
+				consume_all_gyro = true;
 			}
-		}
-
-
-		// update accel until integrator ready and caught up to gyro
-		while (_sensor_accel_sub.updated()
-		       && (!_accel_integrator.integral_ready() || !_intervals_configured || _data_gap
-			   || (_accel_timestamp_sample_last < (_gyro_timestamp_sample_last - 0.5f * _accel_interval_us)))) {
 
-			if (UpdateAccel()) {
-				updated = true;
+			// update gyro until integrator ready and not falling behind
+			if (!_gyro_integrator.integral_ready() || consume_all_gyro) {
+				if (UpdateGyro()) {
+					updated = true;
+				}
 			}
-		}
 
-		// reconfigure integrators if calculated sensor intervals have changed
-		if (_update_integrator_config || !_intervals_configured) {
-			UpdateIntegratorConfiguration();
-		}
 
-		// check for additional updates and that we're fully caught up before publishing
-		if ((consume_all_gyro || _data_gap) && _sensor_gyro_sub.updated()) {
-			continue;
-		}
+			// update accel until integrator ready and caught up to gyro
+			while (_sensor_accel_sub.updated()
+			       && (!_accel_integrator.integral_ready() || !_intervals_configured || _data_gap
+				   || (_accel_timestamp_sample_last < (_gyro_timestamp_sample_last - 0.5f * _accel_interval_us)))) {
 
-		// publish if both accel & gyro integrators are ready
-		if (_intervals_configured && _accel_integrator.integral_ready() && _gyro_integrator.integral_ready()) {
-			if (Publish()) {
-				// record gyro publication latency and integrated samples
-				if (_gyro_update_latency_mean.count() > 10000) {
-					// reset periodically to avoid numerical issues
-					_gyro_update_latency_mean.reset();
+				if (UpdateAccel()) {
+					updated = true;
 				}
+			}
 
-				const float time_run_s = now_us * 1e-6f;
+			// reconfigure integrators if calculated sensor intervals have changed
+			if (_update_integrator_config || !_intervals_configured) {
+				UpdateIntegratorConfiguration();
+			}
 
-				_gyro_update_latency_mean.update(Vector2f{time_run_s - _gyro_timestamp_sample_last * 1e-6f, time_run_s - _gyro_timestamp_last * 1e-6f});
+			// check for additional updates and that we're fully caught up before publishing
+			if ((consume_all_gyro || _data_gap) && _sensor_gyro_sub.updated()) {
+				continue;
+			}
 
-				break;
+			// publish if both accel & gyro integrators are ready
+			if (_intervals_configured && _accel_integrator.integral_ready() && _gyro_integrator.integral_ready()) {
+				if (Publish()) {
+					UpdateGyroPublishLatency(now_us);
+					break;
+				}
 			}
-		}
 
-		// finish if there are no more updates, but didn't publish
-		if (!updated) {
-			break;
+			// finish if there are no more updates, but didn't publish
+			if (!updated) {
+				break;
+			}
 		}
 	}
 
@@ -289,63 +298,7 @@ bool VehicleIMU::UpdateAccel()
 			_accel_interval_mean.reset();
 
 		} else {
-			// collect sample interval average for filters
-			if (accel.timestamp_sample > _accel_timestamp_sample_last) {
-				if ((_accel_timestamp_sample_last != 0) && (accel.samples > 0)) {
-					float interval_us = accel.timestamp_sample - _accel_timestamp_sample_last;
-					_accel_interval_mean.update(Vector2f{interval_us, interval_us / accel.samples});
-				}
-
-			} else {
-				PX4_ERR("%d - accel %" PRIu32 " timestamp error timestamp_sample: %" PRIu64 ", previous timestamp_sample: %" PRIu64,
-					_instance, accel.device_id, accel.timestamp_sample, _accel_timestamp_sample_last);
-			}
-
-			if (accel.timestamp < accel.timestamp_sample) {
-				PX4_ERR("%d - accel %" PRIu32 " timestamp (%" PRIu64 ") < timestamp_sample (%" PRIu64 ")",
-					_instance, accel.device_id, accel.timestamp, accel.timestamp_sample);
-			}
-
-			const int interval_count = _accel_interval_mean.count();
-			const float interval_variance = _accel_interval_mean.variance()(0);
-
-			// check measured interval periodically
-			if ((_accel_interval_mean.valid() && (interval_count % 10 == 0))
-			    && (!PX4_ISFINITE(_accel_interval_best_variance)
-				|| (interval_variance < _accel_interval_best_variance)
-				|| (interval_count > 1000))) {
-
-				const float interval_mean = _accel_interval_mean.mean()(0);
-				const float interval_mean_fifo = _accel_interval_mean.mean()(1);
-
-				// update sample rate if previously invalid or changed
-				const float interval_delta_us = fabsf(interval_mean - _accel_interval_us);
-				const float percent_changed = interval_delta_us / _accel_interval_us;
-
-				if (!PX4_ISFINITE(_accel_interval_us) || (percent_changed > 0.001f)) {
-					if (PX4_ISFINITE(interval_mean) && PX4_ISFINITE(interval_mean_fifo) && PX4_ISFINITE(interval_variance)) {
-						// update integrator configuration if interval has changed by more than 10%
-						if (interval_delta_us > 0.1f * _accel_interval_us) {
-							_update_integrator_config = true;
-						}
-
-						_accel_interval_us = interval_mean;
-						_accel_interval_best_variance = interval_variance;
-
-						_status.accel_rate_hz = 1e6f / interval_mean;
-						_status.accel_raw_rate_hz = 1e6f / interval_mean_fifo; // FIFO
-						_publish_status = true;
-
-					} else {
-						_accel_interval_mean.reset();
-					}
-				}
-			}
-
-			if (interval_count > 10000) {
-				// reset periodically to prevent numerical issues
-				_accel_interval_mean.reset();
-			}
+			UpdateAccelInterval(accel.timestamp_sample, accel.timestamp, accel.samples, accel.device_id);
 		}
 
 		_accel_last_generation = _sensor_accel_sub.get_last_generation();
@@ -379,49 +332,7 @@ bool VehicleIMU::UpdateAccel()
 		updated = true;
 
 		if (accel.clip_counter[0] > 0 || accel.clip_counter[1] > 0 || accel.clip_counter[2] > 0) {
-			// rotate sensor clip counts into vehicle body frame
-			const Vector3f clipping{_accel_calibration.rotation() *
-						Vector3f{(float)accel.clip_counter[0], (float)accel.clip_counter[1], (float)accel.clip_counter[2]}};
-
-			// round to get reasonble clip counts per axis (after board rotation)
-			const uint8_t clip_x = roundf(fabsf(clipping(0)));
-			const uint8_t clip_y = roundf(fabsf(clipping(1)));
-			const uint8_t clip_z = roundf(fabsf(clipping(2)));
-
-			_status.accel_clipping[0] += clip_x;
-			_status.accel_clipping[1] += clip_y;
-			_status.accel_clipping[2] += clip_z;
-
-			if (clip_x > 0) {
-				_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_X;
-			}
-
-			if (clip_y > 0) {
-				_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_Y;
-			}
-
-			if (clip_z > 0) {
-				_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_Z;
-			}
-
-			_publish_status = true;
-
-			if (_accel_calibration.enabled() && (hrt_elapsed_time(&_last_clipping_notify_time) > 3_s)) {
-				// start notifying the user periodically if there's significant continuous clipping
-				const uint64_t clipping_total = _status.accel_clipping[0] + _status.accel_clipping[1] + _status.accel_clipping[2];
-
-				if (clipping_total > _last_clipping_notify_total_count + 1000) {
-					mavlink_log_critical(&_mavlink_log_pub, "Accel %" PRIu8 " clipping, not safe to fly!\t", _instance);
-					/* EVENT
-					 * @description Land now, and check the vehicle setup.
-					 * Clipping can lead to fly-aways.
-					 */
-					events::send<uint8_t>(events::ID("vehicle_imu_accel_clipping"), events::Log::Critical,
-							      "Accel {1} clipping, not safe to fly!", _instance);
-					_last_clipping_notify_time = accel.timestamp_sample;
-					_last_clipping_notify_total_count = clipping_total;
-				}
-			}
+			UpdateAccelClipping(accel.clip_counter, accel.timestamp_sample);
 		}
 	}
 
@@ -444,63 +355,7 @@ bool VehicleIMU::UpdateGyro()
 			_gyro_interval_mean.reset();
 
 		} else {
-			// collect sample interval average for filters
-			if (gyro.timestamp_sample > _gyro_timestamp_sample_last) {
-				if ((_gyro_timestamp_sample_last != 0) && (gyro.samples > 0)) {
-					float interval_us = gyro.timestamp_sample - _gyro_timestamp_sample_last;
-					_gyro_interval_mean.update(Vector2f{interval_us, interval_us / gyro.samples});
-				}
-
-			} else {
-				PX4_ERR("%d - gyro %" PRIu32 " timestamp error timestamp_sample: %" PRIu64 ", previous timestamp_sample: %" PRIu64,
-					_instance, gyro.device_id, gyro.timestamp_sample, _gyro_timestamp_sample_last);
-			}
-
-			if (gyro.timestamp < gyro.timestamp_sample) {
-				PX4_ERR("%d - gyro %" PRIu32 " timestamp (%" PRIu64 ") < timestamp_sample (%" PRIu64 ")",
-					_instance, gyro.device_id, gyro.timestamp, gyro.timestamp_sample);
-			}
-
-			const int interval_count = _gyro_interval_mean.count();
-			const float interval_variance = _gyro_interval_mean.variance()(0);
-
-			// check measured interval periodically
-			if ((_gyro_interval_mean.valid() && (interval_count % 10 == 0))
-			    && (!PX4_ISFINITE(_gyro_interval_best_variance)
-				|| (interval_variance < _gyro_interval_best_variance)
-				|| (interval_count > 1000))) {
-
-				const float interval_mean = _gyro_interval_mean.mean()(0);
-				const float interval_mean_fifo = _gyro_interval_mean.mean()(1);
-
-				// update sample rate if previously invalid or changed
-				const float interval_delta_us = fabsf(interval_mean - _gyro_interval_us);
-				const float percent_changed = interval_delta_us / _gyro_interval_us;
-
-				if (!PX4_ISFINITE(_gyro_interval_us) || (percent_changed > 0.001f)) {
-					if (PX4_ISFINITE(interval_mean) && PX4_ISFINITE(interval_mean_fifo) && PX4_ISFINITE(interval_variance)) {
-						// update integrator configuration if interval has changed by more than 10%
-						if (interval_delta_us > 0.1f * _gyro_interval_us) {
-							_update_integrator_config = true;
-						}
-
-						_gyro_interval_us = interval_mean;
-						_gyro_interval_best_variance = interval_variance;
-
-						_status.gyro_rate_hz = 1e6f / interval_mean;
-						_status.gyro_raw_rate_hz = 1e6f / interval_mean_fifo; // FIFO
-						_publish_status = true;
-
-					} else {
-						_gyro_interval_mean.reset();
-					}
-				}
-			}
-
-			if (interval_count > 10000) {
-				// reset periodically to prevent numerical issues
-				_gyro_interval_mean.reset();
-			}
+			UpdateGyroInterval(gyro.timestamp_sample, gyro.timestamp, gyro.samples, gyro.device_id);
 		}
 
 		_gyro_last_generation = _sensor_gyro_sub.get_last_generation();
@@ -538,6 +393,452 @@ bool VehicleIMU::UpdateGyro()
 	return updated;
 }
 
+void VehicleIMU::ResetIntegration()
+{
+	// start over on the raw samples, intervals and integrator configuration depend on the data source
+	_accel_integrator.reset();
+	_gyro_integrator.reset();
+
+	_accel_interval_mean.reset();
+	_gyro_interval_mean.reset();
+	_accel_interval_best_variance = INFINITY;
+	_gyro_interval_best_variance = INFINITY;
+	_accel_interval_us = NAN;
+	_gyro_interval_us = NAN;
+
+	_accel_fifo.samples = 0;
+	_accel_fifo_index = 0;
+
+	_intervals_configured = false;
+}
+
+bool VehicleIMU::SensorFifoSelectionUpdate()
+{
+	_fifo_checked_accel_device_id = _accel_calibration.device_id();
+	_fifo_checked_gyro_device_id = _gyro_calibration.device_id();
+	_fifo_checked_timestamp = hrt_absolute_time();
+
+	int accel_fifo_instance = -1;
+	int gyro_fifo_instance = -1;
+
+	for (uint8_t i = 0; i < ORB_MULTI_MAX_INSTANCES; i++) {
+		uORB::SubscriptionData<sensor_accel_fifo_s> sensor_accel_fifo_sub{ORB_ID(sensor_accel_fifo), i};
+
+		if ((sensor_accel_fifo_sub.get().timestamp != 0)
+		    && (sensor_accel_fifo_sub.get().device_id == _accel_calibration.device_id())) {
+			accel_fifo_instance = i;
+		}
+
+		uORB::SubscriptionData<sensor_gyro_fifo_s> sensor_gyro_fifo_sub{ORB_ID(sensor_gyro_fifo), i};
+
+		if ((sensor_gyro_fifo_sub.get().timestamp != 0)
+		    && (sensor_gyro_fifo_sub.get().device_id == _gyro_calibration.device_id())) {
+			gyro_fifo_instance = i;
+		}
+	}
+
+	if ((accel_fifo_instance < 0) || (gyro_fifo_instance < 0)) {
+		if (_fifo_available) {
+			// no FIFO data from the new sensors, back to sensor_accel/sensor_gyro
+			_sensor_gyro_fifo_sub.unregisterCallback();
+			_sensor_gyro_sub.registerCallback();
+
+			ResetIntegration();
+			_fifo_available = false;
+
+			PX4_DEBUG("%d - FIFO data not available anymore", _instance);
+		}
+
+		return false;
+	}
+
+	if (_sensor_accel_fifo_sub.ChangeInstance(accel_fifo_instance)
+	    && _sensor_gyro_fifo_sub.ChangeInstance(gyro_fifo_instance)
+	    && _sensor_gyro_fifo_sub.registerCallback()) {
+
+		_sensor_gyro_sub.unregisterCallback();
+
+		// intervals and integrator configuration are now per FIFO sample
+		ResetIntegration();
+		_fifo_available = true;
+
+		PX4_DEBUG("%d - using FIFO accel %" PRIu32 " (%d), gyro %" PRIu32 " (%d)", _instance,
+			  _accel_calibration.device_id(), accel_fifo_instance, _gyro_calibration.device_id(), gyro_fifo_instance);
+
+		return true;
+	}
+
+	return false;
+}
+
+void VehicleIMU::UpdateFifo(const hrt_abstime &now_us)
+{
+	if (hrt_elapsed_time(&_status.timestamp) >= kIMUStatusPublishingInterval) {
+		UpdateSensorStatusFifo();
+	}
+
+	// integrate each gyro FIFO block in one pass, pulling in the accel samples that line up with every gyro sample
+	sensor_gyro_fifo_s gyro_fifo;
+
+	while (_sensor_gyro_fifo_sub.update(&gyro_fifo)) {
+		if (_sensor_gyro_fifo_sub.get_last_generation() != _gyro_last_generation + 1) {
+			_data_gap = true;
+			perf_count(_gyro_generation_gap_perf);
+
+			// reset average sample measurement and restart integration
+			_gyro_interval_mean.reset();
+			_gyro_timestamp_sample_last = 0;
+
+		} else {
+			UpdateGyroInterval(gyro_fifo.timestamp_sample, gyro_fifo.timestamp, gyro_fifo.samples, gyro_fifo.device_id);
+		}
+
+		_gyro_last_generation = _sensor_gyro_fifo_sub.get_last_generation();
+		_gyro_timestamp_last = gyro_fifo.timestamp;
+
+		// a new device is picked up by the FIFO selection in the next cycle
+		_gyro_calibration.set_device_id(gyro_fifo.device_id);
+
+		const int N = math::min((int)gyro_fifo.samples, (int)(sizeof(gyro_fifo.x) / sizeof(gyro_fifo.x[0])));
+
+		if (N <= 0) {
+			continue;
+		}
+
+		if (_update_integrator_config || !_intervals_configured) {
+			UpdateIntegratorConfiguration();
+		}
+
+		const float dt_s = gyro_fifo.dt * 1e-6f;
+		Vector3f gyro_sum{};
+
+		for (int n = 0; n < N; n++) {
+			const hrt_abstime timestamp_sample = gyro_fifo.timestamp_sample - (hrt_abstime)roundf((N - 1 - n) * gyro_fifo.dt);
+
+			// first sample continues from the previous block (integrator restarts after a gap)
+			float dt = dt_s;
+
+			if (n == 0) {
+				dt = ((_gyro_timestamp_sample_last != 0) && (timestamp_sample > _gyro_timestamp_sample_last)) ?
+				     (timestamp_sample - _gyro_timestamp_sample_last) * 1e-6f : 0.f;
+			}
+
+			const Vector3f gyro_raw{gyro_fifo.scale * gyro_fifo.x[n], gyro_fifo.scale * gyro_fifo.y[n], gyro_fifo.scale * gyro_fifo.z[n]};
+			gyro_sum += gyro_raw;
+
+			_gyro_integrator.put(gyro_raw, dt);
+			_gyro_timestamp_sample_last = timestamp_sample;
+
+			if (_gyro_integrator.integral_ready()) {
+				IntegrateAccelFifo(timestamp_sample);
+
+				// publish if both accel & gyro integrators are ready
+				if (_intervals_configured && _accel_integrator.integral_ready()) {
+					if (Publish()) {
+						UpdateGyroPublishLatency(now_us);
+					}
+				}
+			}
+		}
+
+		_raw_gyro_mean.update(gyro_sum / N);
+	}
+}
+
+bool VehicleIMU::UpdateAccelFifo()
+{
+	if (_sensor_accel_fifo_sub.update(&_accel_fifo)) {
+		if (_sensor_accel_fifo_sub.get_last_generation() != _accel_last_generation + 1) {
+			_data_gap = true;
+			perf_count(_accel_generation_gap_perf);
+
+			// reset average sample measurement and restart integration
+			_accel_interval_mean.reset();
+			_accel_timestamp_sample_last = 0;
+
+		} else {
+			UpdateAccelInterval(_accel_fifo.timestamp_sample, _accel_fifo.timestamp, _accel_fifo.samples, _accel_fifo.device_id);
+		}
+
+		_accel_last_generation = _sensor_accel_fifo_sub.get_last_generation();
+
+		_accel_calibration.set_device_id(_accel_fifo.device_id);
+
+		_accel_fifo.samples = math::min((int)_accel_fifo.samples, (int)(sizeof(_accel_fifo.x) / sizeof(_accel_fifo.x[0])));
+		_accel_fifo_index = 0;
+
+		return true;
+	}
+
+	return false;
+}
+
+void VehicleIMU::IntegrateAccelFifo(const hrt_abstime &timestamp_sample)
+{
+	// integrate accel until caught up to the gyro sample (within half an accel sample)
+	uint8_t clip_counter[3] {};
+	Vector3f accel_sum{};
+	int accel_count = 0;
+
+	while ((_accel_fifo_index < _accel_fifo.samples) || UpdateAccelFifo()) {
+		const int N = _accel_fifo.samples;
+		const int n = _accel_fifo_index;
+
+		const hrt_abstime accel_timestamp_sample = _accel_fifo.timestamp_sample - (hrt_abstime)roundf((N - 1 - n) *
+						  _accel_fifo.dt);
+
+		if ((int64_t)(accel_timestamp_sample - timestamp_sample) > 0.5f * _accel_fifo.dt) {
+			break;
+		}
+
+		float dt = _accel_fifo.dt * 1e-6f;
+
+		if (n == 0) {
+			dt = ((_accel_timestamp_sample_last != 0) && (accel_timestamp_sample > _accel_timestamp_sample_last)) ?
+			     (accel_timestamp_sample - _accel_timestamp_sample_last) * 1e-6f : 0.f;
+		}
+
+		const int16_t x = _accel_fifo.x[n];
+		const int16_t y = _accel_fifo.y[n];
+		const int16_t z = _accel_fifo.z[n];
+
+		// consider data clipped/saturated if it's INT16_MIN/INT16_MAX or within 1 (same as the drivers)
+		clip_counter[0] += (x <= INT16_MIN + 1) || (x >= INT16_MAX - 1);
+		clip_counter[1] += (y <= INT16_MIN + 1) || (y >= INT16_MAX - 1);
+		clip_counter[2] += (z <= INT16_MIN + 1) || (z >= INT16_MAX - 1);
+
+		const Vector3f accel_raw{_accel_fifo.scale * x, _accel_fifo.scale * y, _accel_fifo.scale * z};
+		accel_sum += accel_raw;
+		accel_count++;
+
+		_accel_integrator.put(accel_raw, dt);
+		_accel_timestamp_sample_last = accel_timestamp_sample;
+		_accel_fifo_index++;
+	}
+
+	if (accel_count > 0) {
+		_raw_accel_mean.update(accel_sum / accel_count);
+	}
+
+	if (clip_counter[0] > 0 || clip_counter[1] > 0 || clip_counter[2] > 0) {
+		UpdateAccelClipping(clip_counter, _accel_timestamp_sample_last);
+	}
+}
+
+void VehicleIMU::UpdateSensorStatusFifo()
+{
+	// temperature and error counts aren't part of the FIFO data, only sample them for the next status publication
+	sensor_accel_s accel;
+
+	if (_sensor_accel_sub.update(&accel)) {
+		if (accel.error_count != _status.accel_error_count) {
+			_publish_status = true;
+			_status.accel_error_count = accel.error_count;
+		}
+
+		_accel_temperature_sum = accel.temperature;
+		_accel_temperature_sum_count = 1;
+	}
+
+	sensor_gyro_s gyro;
+
+	if (_sensor_gyro_sub.update(&gyro)) {
+		if (gyro.error_count != _status.gyro_error_count) {
+			_publish_status = true;
+			_status.gyro_error_count = gyro.error_count;
+		}
+
+		_gyro_temperature_sum = gyro.temperature;
+		_gyro_temperature_sum_count = 1;
+	}
+}
+
+void VehicleIMU::UpdateAccelClipping(const uint8_t clip_counter[3], const hrt_abstime &timestamp_sample)
+{
+	// rotate sensor clip counts into vehicle body frame
+	const Vector3f clipping{_accel_calibration.rotation() *
+				Vector3f{(float)clip_counter[0], (float)clip_counter[1], (float)clip_counter[2]}};
+
+	// round to get reasonble clip counts per axis (after board rotation)
+	const uint8_t clip_x = roundf(fabsf(clipping(0)));
+	const uint8_t clip_y = roundf(fabsf(clipping(1)));
+	const uint8_t clip_z = roundf(fabsf(clipping(2)));
+
+	_status.accel_clipping[0] += clip_x;
+	_status.accel_clipping[1] += clip_y;
+	_status.accel_clipping[2] += clip_z;
+
+	if (clip_x > 0) {
+		_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_X;
+	}
+
+	if (clip_y > 0) {
+		_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_Y;
+	}
+
+	if (clip_z > 0) {
+		_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_Z;
+	}
+
+	_publish_status = true;
+
+	if (_accel_calibration.enabled() && (hrt_elapsed_time(&_last_clipping_notify_time) > 3_s)) {
+		// start notifying the user periodically if there's significant continuous clipping
+		const uint64_t clipping_total = _status.accel_clipping[0] + _status.accel_clipping[1] + _status.accel_clipping[2];
+
+		if (clipping_total > _last_clipping_notify_total_count + 1000) {
+			mavlink_log_critical(&_mavlink_log_pub, "Accel %" PRIu8 " clipping, not safe to fly!\t", _instance);
+			/* EVENT
+			 * @description Land now, and check the vehicle setup.
+			 * Clipping can lead to fly-aways.
+			 */
+			events::send<uint8_t>(events::ID("vehicle_imu_accel_clipping"), events::Log::Critical,
+					      "Accel {1} clipping, not safe to fly!", _instance);
+			_last_clipping_notify_time = timestamp_sample;
+			_last_clipping_notify_total_count = clipping_total;
+		}
+	}
+}
+
+void VehicleIMU::UpdateGyroPublishLatency(const hrt_abstime &now_us)
+{
+	// record gyro publication latency and integrated samples
+	if (_gyro_update_latency_mean.count() > 10000) {
+		// reset periodically to avoid numerical issues
+		_gyro_update_latency_mean.reset();
+	}
+
+	const float time_run_s = now_us * 1e-6f;
+
+	_gyro_update_latency_mean.update(Vector2f{time_run_s - _gyro_timestamp_sample_last * 1e-6f, time_run_s - _gyro_timestamp_last * 1e-6f});
+}
+
+void VehicleIMU::UpdateAccelInterval(const hrt_abstime &timestamp_sample, const hrt_abstime &timestamp, uint8_t samples,
+				     uint32_t device_id)
+{
+	// collect sample interval average for filters
+	if (timestamp_sample > _accel_timestamp_sample_last) {
+		if ((_accel_timestamp_sample_last != 0) && (samples > 0)) {
+			float interval_us = timestamp_sample - _accel_timestamp_sample_last;
+			_accel_interval_mean.update(Vector2f{interval_us, interval_us / samples});
+		}
+
+	} else {
+		PX4_ERR("%d - accel %" PRIu32 " timestamp error timestamp_sample: %" PRIu64 ", previous timestamp_sample: %" PRIu64,
+			_instance, device_id, timestamp_sample, _accel_timestamp_sample_last);
+	}
+
+	if (timestamp < timestamp_sample) {
+		PX4_ERR("%d - accel %" PRIu32 " timestamp (%" PRIu64 ") < timestamp_sample (%" PRIu64 ")",
+			_instance, device_id, timestamp, timestamp_sample);
+	}
+
+	const int interval_count = _accel_interval_mean.count();
+	const float interval_variance = _accel_interval_mean.variance()(0);
+
+	// check measured interval periodically
+	if ((_accel_interval_mean.valid() && (interval_count % 10 == 0))
+	    && (!PX4_ISFINITE(_accel_interval_best_variance)
+		|| (interval_variance < _accel_interval_best_variance)
+		|| (interval_count > 1000))) {
+
+		const float interval_mean = _accel_interval_mean.mean()(0);
+		const float interval_mean_fifo = _accel_interval_mean.mean()(1);
+
+		// update sample rate if previously invalid or changed
+		const float interval_delta_us = fabsf(interval_mean - _accel_interval_us);
+		const float percent_changed = interval_delta_us / _accel_interval_us;
+
+		if (!PX4_ISFINITE(_accel_interval_us) || (percent_changed > 0.001f)) {
+			if (PX4_ISFINITE(interval_mean) && PX4_ISFINITE(interval_mean_fifo) && PX4_ISFINITE(interval_variance)) {
+				// update integrator configuration if interval has changed by more than 10%
+				if (interval_delta_us > 0.1f * _accel_interval_us) {
+					_update_integrator_config = true;
+				}
+
+				_accel_interval_us = interval_mean;
+				_accel_interval_best_variance = interval_variance;
+
+				_status.accel_rate_hz = 1e6f / interval_mean;
+				_status.accel_raw_rate_hz = 1e6f / interval_mean_fifo; // FIFO
+				_accel_raw_interval_us = interval_mean_fifo;
+				_publish_status = true;
+
+			} else {
+				_accel_interval_mean.reset();
+			}
+		}
+	}
+
+	if (interval_count > 10000) {
+		// reset periodically to prevent numerical issues
+		_accel_interval_mean.reset();
+	}
+}
+
+void VehicleIMU::UpdateGyroInterval(const hrt_abstime &timestamp_sample, const hrt_abstime &timestamp, uint8_t samples,
+				    uint32_t device_id)
+{
+	// collect sample interval average for filters
+	if (timestamp_sample > _gyro_timestamp_sample_last) {
+		if ((_gyro_timestamp_sample_last != 0) && (samples > 0)) {
+			float interval_us = timestamp_sample - _gyro_timestamp_sample_last;
+			_gyro_interval_mean.update(Vector2f{interval_us, interval_us / samples});
+		}
+
+	} else {
+		PX4_ERR("%d - gyro %" PRIu32 " timestamp error timestamp_sample: %" PRIu64 ", previous timestamp_sample: %" PRIu64,
+			_instance, device_id, timestamp_sample, _gyro_timestamp_sample_last);
+	}
+
+	if (timestamp < timestamp_sample) {
+		PX4_ERR("%d - gyro %" PRIu32 " timestamp (%" PRIu64 ") < timestamp_sample (%" PRIu64 ")",
+			_instance, device_id, timestamp, timestamp_sample);
+	}
+
+	const int interval_count = _gyro_interval_mean.count();
+	const float interval_variance = _gyro_interval_mean.variance()(0);
+
+	// check measured interval periodically
+	if ((_gyro_interval_mean.valid() && (interval_count % 10 == 0))
+	    && (!PX4_ISFINITE(_gyro_interval_best_variance)
+		|| (interval_variance < _gyro_interval_best_variance)
+		|| (interval_count > 1000))) {
+
+		const float interval_mean = _gyro_interval_mean.mean()(0);
+		const float interval_mean_fifo = _gyro_interval_mean.mean()(1);
+
+		// update sample rate if previously invalid or changed
+		const float interval_delta_us = fabsf(interval_mean - _gyro_interval_us);
+		const float percent_changed = interval_delta_us / _gyro_interval_us;
+
+		if (!PX4_ISFINITE(_gyro_interval_us) || (percent_changed > 0.001f)) {
+			if (PX4_ISFINITE(interval_mean) && PX4_ISFINITE(interval_mean_fifo) && PX4_ISFINITE(interval_variance)) {
+				// update integrator configuration if interval has changed by more than 10%
+				if (interval_delta_us > 0.1f * _gyro_interval_us) {
+					_update_integrator_config = true;
+				}
+
+				_gyro_interval_us = interval_mean;
+				_gyro_interval_best_variance = interval_variance;
+
+				_status.gyro_rate_hz = 1e6f / interval_mean;
+				_status.gyro_raw_rate_hz = 1e6f / interval_mean_fifo; // FIFO
+				_gyro_raw_interval_us = interval_mean_fifo;
+				_publish_status = true;
+
+			} else {
+				_gyro_interval_mean.reset();
+			}
+		}
+	}
+
+	if (interval_count > 10000) {
+		// reset periodically to prevent numerical issues
+		_gyro_interval_mean.reset();
+	}
+}
+
 bool VehicleIMU::Publish()
 {
 	bool updated = false;
@@ -646,6 +947,11 @@ bool VehicleIMU::Publish()
 
 void VehicleIMU::UpdateIntegratorConfiguration()
 {
+	if (_fifo_available) {
+		UpdateIntegratorConfigurationFifo();
+		return;
+	}
+
 	if (PX4_ISFINITE(_accel_interval_us) && PX4_ISFINITE(_gyro_interval_us)) {
 
 		// determine number of sensor samples that will get closest to the desired integration interval
@@ -696,6 +1002,52 @@ void VehicleIMU::UpdateIntegratorConfiguration()
 	}
 }
 
+void VehicleIMU::UpdateIntegratorConfigurationFifo()
+{
+	if (PX4_ISFINITE(_accel_interval_us) && PX4_ISFINITE(_gyro_interval_us)
+	    && PX4_ISFINITE(_accel_raw_interval_us) && PX4_ISFINITE(_gyro_raw_interval_us)) {
+
+		// integrators count individual FIFO samples, publish at most once per gyro FIFO block
+		const int gyro_fifo_samples = math::max(1, (int)roundf(_gyro_interval_us / _gyro_raw_interval_us));
+		const uint16_t gyro_integral_samples = math::max(gyro_fifo_samples,
+						       (int)roundf(_imu_integration_interval_us / _gyro_raw_interval_us));
+
+		const float integration_interval_us = gyro_integral_samples * _gyro_raw_interval_us;
+
+		// accel follows gyro as closely as possible
+		const uint16_t accel_integral_samples = math::max(1, (int)roundf(integration_interval_us / _accel_raw_interval_us));
+
+		_accel_integrator.set_reset_interval(roundf((accel_integral_samples - 0.5f) * _accel_raw_interval_us));
+		_accel_integrator.set_reset_samples(accel_integral_samples);
+
+		_gyro_integrator.set_reset_interval(roundf((gyro_integral_samples - 0.5f) * _gyro_raw_interval_us));
+		_gyro_integrator.set_reset_samples(gyro_integral_samples);
+
+		_backup_schedule_timeout_us = math::constrain((int)math::min(sensor_accel_fifo_s::ORB_QUEUE_LENGTH * _accel_interval_us,
+					      sensor_gyro_fifo_s::ORB_QUEUE_LENGTH * _gyro_interval_us) / 2, 1000, 20000);
+
+		// gyro: wake up on the largest number of FIFO blocks that evenly divides the integration interval
+		const int gyro_fifo_blocks = math::max(1, (int)roundf(integration_interval_us / _gyro_interval_us));
+
+		for (int n = sensor_gyro_fifo_s::ORB_QUEUE_LENGTH; n > 0; n--) {
+			if (gyro_fifo_blocks % n == 0) {
+				_sensor_gyro_fifo_sub.set_required_updates(n);
+				_sensor_gyro_fifo_sub.registerCallback();
+
+				_intervals_configured = true;
+				_update_integrator_config = false;
+
+				PX4_DEBUG("accel (%" PRIu32 "), gyro (%" PRIu32 "), accel samples: %" PRIu16 ", gyro samples: %" PRIu16
+					  ", accel interval: %.1f, gyro interval: %.1f sub samples: %d (FIFO)",
+					  _accel_calibration.device_id(), _gyro_calibration.device_id(), accel_integral_samples, gyro_integral_samples,
+					  (double)_accel_raw_interval_us, (double)_gyro_raw_interval_us, n);
+
+				break;
+			}
+		}
+	}
+}
+
 void VehicleIMU::UpdateAccelVibrationMetrics(const Vector3f &acceleration)
 {
 	// Accel high frequency vibe = filtered length of (acceleration - acceleration_prev)
@@ -722,6 +1074,11 @@ void VehicleIMU::PrintStatus()
 		     _accel_calibration.device_id(), (double)_accel_interval_us, (double)sqrtf(_accel_interval_best_variance),
 		     _gyro_calibration.device_id(), (double)_gyro_interval_us, (double)sqrtf(_gyro_interval_best_variance));
 
+	if (_fifo_available) {
+		PX4_INFO_RAW("[vehicle_imu] %" PRIu8 " - FIFO accel interval: %.1f us, gyro interval: %.1f us\n", _instance,
+			     (double)_accel_raw_interval_us, (double)_gyro_raw_interval_us);
+	}
+
 	PX4_DEBUG("gyro update mean sample latency: %.6f s, publish latency %.6f s, gyro interval %.6f s",
 		  (double)_gyro_update_latency_mean.mean()(0), (double)_gyro_update_latency_mean.mean()(1),
 		  (double)(_gyro_interval_us * 1e-6f));
@@ -52,7 +52,9 @@
 #include <uORB/topics/estimator_sensor_bias.h>
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_accel_fifo.h>
 #include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
 #include <uORB/topics/vehicle_control_mode.h>
 #include <uORB/topics/vehicle_imu.h>
 #include <uORB/topics/vehicle_imu_status.h>
@@ -83,7 +85,23 @@ private:
 	bool UpdateAccel();
 	bool UpdateGyro();
 
+	bool SensorFifoSelectionUpdate();
+	void ResetIntegration();
+	void UpdateFifo(const hrt_abstime &now_us);
+	bool UpdateAccelFifo();
+	void IntegrateAccelFifo(const hrt_abstime &timestamp_sample);
+	void UpdateSensorStatusFifo();
+
+	void UpdateAccelInterval(const hrt_abstime &timestamp_sample, const hrt_abstime &timestamp, uint8_t samples,
+				 uint32_t device_id);
+	void UpdateGyroInterval(const hrt_abstime &timestamp_sample, const hrt_abstime &timestamp, uint8_t samples,
+				uint32_t device_id);
+
+	void UpdateAccelClipping(const uint8_t clip_counter[3], const hrt_abstime &timestamp_sample);
+	void UpdateGyroPublishLatency(const hrt_abstime &now_us);
+
 	void UpdateIntegratorConfiguration();
+	void UpdateIntegratorConfigurationFifo();
 
 	inline void UpdateAccelVibrationMetrics(const matrix::Vector3f &acceleration);
 	inline void UpdateGyroVibrationMetrics(const matrix::Vector3f &angular_velocity);
@@ -105,6 +123,13 @@ private:
 	uORB::Subscription _sensor_accel_sub;
 	uORB::SubscriptionCallbackWorkItem _sensor_gyro_sub;
 
+	// raw FIFO data, integrated directly instead of sensor_accel/sensor_gyro if available
+	uORB::Subscription _sensor_accel_fifo_sub{ORB_ID(sensor_accel_fifo)};
+	uORB::SubscriptionCallbackWorkItem _sensor_gyro_fifo_sub{this, ORB_ID(sensor_gyro_fifo)};
+
+	sensor_accel_fifo_s _accel_fifo{}; // current accel FIFO block, partially consumed
+	int _accel_fifo_index{0};          // next accel sample to integrate from _accel_fifo
+
 	uORB::Subscription _vehicle_control_mode_sub{ORB_ID(vehicle_control_mode)};
 
 	calibration::Accelerometer _accel_calibration{};
@@ -133,6 +158,9 @@ private:
 	float _accel_interval_us{NAN};
 	float _gyro_interval_us{NAN};
 
+	float _accel_raw_interval_us{NAN}; // interval between individual FIFO samples
+	float _gyro_raw_interval_us{NAN};
+
 	unsigned _accel_last_generation{0};
 	unsigned _gyro_last_generation{0};
 
@@ -163,6 +191,13 @@ private:
 	bool _intervals_configured{false};
 	bool _publish_status{false};
 
+	bool _fifo_available{false};
+
+	// sensors the FIFO selection was last done for
+	uint32_t _fifo_checked_accel_device_id{0};
+	uint32_t _fifo_checked_gyro_device_id{0};
+	hrt_abstime _fifo_checked_timestamp{0};
+
 	const uint8_t _instance;
 
 	bool _armed{false};
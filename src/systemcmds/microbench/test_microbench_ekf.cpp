@@ -0,0 +1,193 @@
+/****************************************************************************
+ *
+ *  Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_microbench_ekf.cpp
+ * Microbenchmark EKF data structures.
+ */
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <perf/perf_counter.h>
+#include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/micro_hal.h>
+
+#include <modules/ekf2/EKF/RingBuffer.h>
+
+namespace MicroBenchEKF
+{
+
+#ifdef __PX4_NUTTX
+#include <nuttx/irq.h>
+static irqstate_t flags;
+#endif
+
+void lock()
+{
+#ifdef __PX4_NUTTX
+	flags = px4_enter_critical_section();
+#endif
+}
+
+void unlock()
+{
+#ifdef __PX4_NUTTX
+	px4_leave_critical_section(flags);
+#endif
+}
+
+#define PERF(name, op, count) do { \
+		px4_usleep(1000); \
+		reset(); \
+		perf_counter_t p = perf_alloc(PC_ELAPSED, name); \
+		for (int i = 0; i < count; i++) { \
+			px4_usleep(1); \
+			lock(); \
+			perf_begin(p); \
+			op; \
+			perf_end(p); \
+			unlock(); \
+		} \
+		perf_print_counter(p); \
+		perf_free(p); \
+	} while (0)
+
+struct sample {
+	uint64_t time_us;
+	float data[6];
+};
+
+class MicroBenchEKF : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	static constexpr uint64_t SAMPLE_INTERVAL_US = 10000; // observations at the EKF prediction rate
+
+	bool time_ringbuffer_pop();
+	bool time_ringbuffer_pop_miss();
+
+	void reset();
+
+	// one fusion cycle: push a new observation and pop the one at the delayed fusion time horizon
+	template<typename Buffer>
+	bool fuse(Buffer &buffer, uint64_t delay_us)
+	{
+		timestamp += SAMPLE_INTERVAL_US;
+		_sample.time_us = timestamp;
+		buffer.push(_sample);
+		return buffer.pop_first_older_than(timestamp - delay_us, &_sample_delayed);
+	}
+
+	// asking for a time older than any buffered sample, the common case between observations
+	template<typename Buffer>
+	bool miss(Buffer &buffer)
+	{
+		return buffer.pop_first_older_than(buffer.get_oldest().time_us - 1, &_sample_delayed);
+	}
+
+	// fill the buffer so that fuse() matches the oldest sample
+	template<typename Buffer>
+	void fill(Buffer &buffer)
+	{
+		for (int i = 0; i < buffer.get_length(); i++) {
+			timestamp += SAMPLE_INTERVAL_US;
+			_sample.time_us = timestamp;
+			buffer.push(_sample);
+		}
+	}
+
+	// buffer sizes: minimum, default (_imu_buffer_length with default delays) and maximum delay (300 ms at 100 Hz)
+	RingBuffer<sample> buffer3{3};
+	RingBuffer<sample> buffer12{12};
+	RingBuffer<sample> buffer30{30};
+	RingBuffer<sample, 12> buffer12_static{};
+
+	sample _sample{};
+	sample _sample_delayed{};
+	uint64_t timestamp{0};
+};
+
+bool MicroBenchEKF::run_tests()
+{
+	ut_run_test(time_ringbuffer_pop);
+	ut_run_test(time_ringbuffer_pop_miss);
+
+	return (_tests_failed == 0);
+}
+
+void MicroBenchEKF::reset()
+{
+	timestamp = hrt_absolute_time();
+
+	buffer3.allocate(1);
+	buffer3.allocate(3);
+	buffer12.allocate(1);
+	buffer12.allocate(12);
+	buffer30.allocate(1);
+	buffer30.allocate(30);
+	buffer12_static.allocate(1);
+	buffer12_static.allocate(12);
+
+	fill(buffer3);
+	fill(buffer12);
+	fill(buffer30);
+	fill(buffer12_static);
+}
+
+bool MicroBenchEKF::time_ringbuffer_pop()
+{
+	PERF("RingBuffer size 3 push+pop oldest", fuse(buffer3, 2 * SAMPLE_INTERVAL_US), 1000);
+	PERF("RingBuffer size 12 push+pop oldest", fuse(buffer12, 11 * SAMPLE_INTERVAL_US), 1000);
+	PERF("RingBuffer size 30 push+pop oldest", fuse(buffer30, 29 * SAMPLE_INTERVAL_US), 1000);
+	PERF("RingBuffer size 12 (static) push+pop oldest", fuse(buffer12_static, 11 * SAMPLE_INTERVAL_US), 1000);
+	return true;
+}
+
+bool MicroBenchEKF::time_ringbuffer_pop_miss()
+{
+	PERF("RingBuffer size 3 pop miss", miss(buffer3), 1000);
+	PERF("RingBuffer size 12 pop miss", miss(buffer12), 1000);
+	PERF("RingBuffer size 30 pop miss", miss(buffer30), 1000);
+	return true;
+}
+
+ut_declare_test_c(test_microbench_ekf, MicroBenchEKF)
+
+} // namespace MicroBenchEKF
@@ -88,6 +88,13 @@ void unlock()
 		perf_free(p); \
 	} while (0)
 
+template<typename T>
+T random(T min, T max)
+{
+	const T scale = rand() / (T) RAND_MAX; /* [0, 1.0] */
+	return min + scale * (max - min);      /* [min, max] */
+}
+
 class MicroBenchMatrix : public UnitTest
 {
 public:
@@ -99,15 +106,38 @@ private:
 	bool time_matrix_quaternion();
 	bool time_matrix_dcm();
 	bool time_matrix_pseduo_inverse();
+	bool time_matrix_multiply();
+	bool time_matrix_quaternion_rotate();
+	bool time_matrix_expression();
 
 	void reset();
 
+	template<size_t M, size_t N>
+	void randomize(matrix::Matrix<float, M, N> &m)
+	{
+		for (size_t i = 0; i < M; i++) {
+			for (size_t j = 0; j < N; j++) {
+				m(i, j) = random(-10.f, 10.f);
+			}
+		}
+	}
+
 	matrix::Quatf q;
 	matrix::Eulerf e;
 	matrix::Dcmf d;
 	matrix::Matrix<float, 16, 6> A16;
 	matrix::Matrix<float, 6, 16> B16;
 	matrix::Matrix<float, 6, 16> B16_4;
+
+	matrix::Matrix3f A3, B3, C3;
+	matrix::Matrix<float, 4, 4> A4, B4, C4;
+	matrix::Matrix<float, 6, 6> A6, B6, C6;
+	matrix::Vector3f v3, w3;
+	matrix::Vector<float, 6> v6, w6;
+	matrix::Quatf q2;
+
+	// velocity PID as in PositionControl
+	matrix::Vector3f vel_error, vel_int, vel_dot, gain_p, gain_i, gain_d, acc_sp;
 };
 
 bool MicroBenchMatrix::run_tests()
@@ -116,17 +146,13 @@ bool MicroBenchMatrix::run_tests()
 	ut_run_test(time_matrix_quaternion);
 	ut_run_test(time_matrix_dcm);
 	ut_run_test(time_matrix_pseduo_inverse);
+	ut_run_test(time_matrix_multiply);
+	ut_run_test(time_matrix_quaternion_rotate);
+	ut_run_test(time_matrix_expression);
 
 	return (_tests_failed == 0);
 }
 
-template<typename T>
-T random(T min, T max)
-{
-	const T scale = rand() / (T) RAND_MAX; /* [0, 1.0] */
-	return min + scale * (max - min);      /* [min, max] */
-}
-
 void MicroBenchMatrix::reset()
 {
 	srand(time(nullptr));
@@ -145,6 +171,24 @@ void MicroBenchMatrix::reset()
 			B16_4(j, i) = random(-10.0, 10.0);
 		}
 	}
+
+	randomize(A3);
+	randomize(B3);
+	randomize(A4);
+	randomize(B4);
+	randomize(A6);
+	randomize(B6);
+	randomize(v3);
+	randomize(v6);
+	q2 = matrix::Quatf(rand(), rand(), rand(), rand());
+	q2.normalize();
+
+	randomize(vel_error);
+	randomize(vel_int);
+	randomize(vel_dot);
+	randomize(gain_p);
+	randomize(gain_i);
+	randomize(gain_d);
 }
 
 bool MicroBenchMatrix::time_matrix_euler()
@@ -175,6 +219,36 @@ bool MicroBenchMatrix::time_matrix_pseduo_inverse()
 	return true;
 }
 
+bool MicroBenchMatrix::time_matrix_multiply()
+{
+	PERF("matrix 3x3 * 3x3", C3 = A3 * B3, 1000);
+	PERF("matrix 3x3 * 3x1", w3 = A3 * v3, 1000);
+	PERF("matrix 4x4 * 4x4", C4 = A4 * B4, 1000);
+	PERF("matrix 6x6 * 6x6", C6 = A6 * B6, 1000);
+	PERF("matrix 6x6 * 6x1", w6 = A6 * v6, 1000);
+	PERF("matrix Quaternion * Quaternion", q = q2 * q, 1000);
+	return true;
+}
+
+bool MicroBenchMatrix::time_matrix_quaternion_rotate()
+{
+	PERF("matrix Quaternion rotateVector", w3 = q2.rotateVector(v3), 1000);
+	PERF("matrix Quaternion rotateVectorInverse", w3 = q2.rotateVectorInverse(v3), 1000);
+	PERF("matrix Dcm * Vector3", w3 = d * v3, 1000);
+	return true;
+}
+
+bool MicroBenchMatrix::time_matrix_expression()
+{
+	using matrix::lazy;
+
+	PERF("matrix PID eager", acc_sp = vel_error.emult(gain_p) + vel_int - vel_dot.emult(gain_d); vel_int += vel_error.emult(gain_i) * 0.01f, 1000);
+	PERF("matrix PID lazy", acc_sp = lazy(vel_error).emult(gain_p) + vel_int - lazy(vel_dot).emult(gain_d); vel_int += lazy(vel_error).emult(gain_i) * 0.01f, 1000);
+	PERF("matrix 6x6 linear combination eager", C6 = A6 * 0.5f + B6 - A6.emult(B6), 1000);
+	PERF("matrix 6x6 linear combination lazy", C6 = lazy(A6) * 0.5f + B6 - lazy(A6).emult(B6), 1000);
+	return true;
+}
+
 ut_declare_test_c(test_microbench_matrix, MicroBenchMatrix)
 
 } // namespace MicroBenchMatrix
@@ -0,0 +1,187 @@
+/****************************************************************************
+ *
+ *  Copyright (C) 2022 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_microbench_sensors.cpp
+ * Tests for the microbench sensor voting.
+ */
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <perf/perf_counter.h>
+#include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/micro_hal.h>
+
+#include <modules/sensors/data_validator/DataValidator.hpp>
+#include <modules/sensors/data_validator/DataValidatorGroup.hpp>
+
+namespace MicroBenchSensors
+{
+
+#ifdef __PX4_NUTTX
+#include <nuttx/irq.h>
+static irqstate_t flags;
+#endif
+
+void lock()
+{
+#ifdef __PX4_NUTTX
+	flags = px4_enter_critical_section();
+#endif
+}
+
+void unlock()
+{
+#ifdef __PX4_NUTTX
+	px4_leave_critical_section(flags);
+#endif
+}
+
+#define PERF(name, op, count) do { \
+		px4_usleep(1000); \
+		reset(); \
+		perf_counter_t p = perf_alloc(PC_ELAPSED, name); \
+		for (int i = 0; i < count; i++) { \
+			px4_usleep(1); \
+			lock(); \
+			perf_begin(p); \
+			op; \
+			perf_end(p); \
+			unlock(); \
+			update(); \
+		} \
+		perf_print_counter(p); \
+		perf_free(p); \
+	} while (0)
+
+class MicroBenchSensors : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	static constexpr int MAX_SENSORS = DataValidatorGroup::MAX_VALIDATORS;
+
+	bool time_data_validator_group();
+	bool time_data_validator();
+
+	void reset();
+	void update();
+
+	// one voting cycle as done by VotedSensorsUpdate: put every sensor, then select the best
+	void vote_group(DataValidatorGroup &group, int sensors)
+	{
+		for (int i = 0; i < sensors; i++) {
+			group.put(i, timestamp, values[i], 0, 100 - i);
+		}
+
+		int best_index = -1;
+		group.get_best(timestamp, &best_index);
+	}
+
+	// same cycle with independent scalar validators
+	void vote_validators(int sensors)
+	{
+		for (int i = 0; i < sensors; i++) {
+			validators[i].put(timestamp, values[i], 0, 100 - i);
+		}
+
+		for (int i = 0; i < sensors; i++) {
+			confidence[i] = validators[i].confidence(timestamp);
+		}
+	}
+
+	DataValidatorGroup group1{1};
+	DataValidatorGroup group2{2};
+	DataValidatorGroup group3{3};
+	DataValidatorGroup group4{4};
+
+	DataValidator validators[MAX_SENSORS] {};
+
+	float values[MAX_SENSORS][3] {};
+	float confidence[MAX_SENSORS] {};
+	uint64_t timestamp{0};
+};
+
+bool MicroBenchSensors::run_tests()
+{
+	ut_run_test(time_data_validator_group);
+	ut_run_test(time_data_validator);
+
+	return (_tests_failed == 0);
+}
+
+void MicroBenchSensors::reset()
+{
+	srand(time(nullptr));
+	timestamp = hrt_absolute_time();
+	update();
+}
+
+void MicroBenchSensors::update()
+{
+	timestamp += 1000;
+
+	for (int i = 0; i < MAX_SENSORS; i++) {
+		for (int j = 0; j < 3; j++) {
+			values[i][j] = rand() / (float)RAND_MAX;
+		}
+	}
+}
+
+bool MicroBenchSensors::time_data_validator_group()
+{
+	PERF("DataValidatorGroup 1 sensor", vote_group(group1, 1), 1000);
+	PERF("DataValidatorGroup 2 sensors", vote_group(group2, 2), 1000);
+	PERF("DataValidatorGroup 3 sensors", vote_group(group3, 3), 1000);
+	PERF("DataValidatorGroup 4 sensors", vote_group(group4, 4), 1000);
+	return true;
+}
+
+bool MicroBenchSensors::time_data_validator()
+{
+	PERF("DataValidator 1 sensor", vote_validators(1), 1000);
+	PERF("DataValidator 2 sensors", vote_validators(2), 1000);
+	PERF("DataValidator 3 sensors", vote_validators(3), 1000);
+	PERF("DataValidator 4 sensors", vote_validators(4), 1000);
+	return true;
+}
+
+ut_declare_test_c(test_microbench_sensors, MicroBenchSensors)
+
+} // namespace MicroBenchSensors